@@ -1,6 +1,6 @@
 /*
  *	 Copyright (C) 2012 by Ian Wraith
- *   Copyright (C) 2015,2024 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2015,2024,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -16,28 +16,48 @@
  *   along with this program; if not, write to the Free Software
  *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
  */
-
 #include "BPTC19696.h"
 
 #include "Hamming.h"
-#include "Utils.h"
 
 #include <cstdio>
 #include <cassert>
 #include <cstring>
 
+const uint8_t BIT_MASK_TABLE[] = {0x80U, 0x40U, 0x20U, 0x10U, 0x08U, 0x04U, 0x02U, 0x01U};
+
+#define READ_BIT(p,i)    (p[(i)>>3] & BIT_MASK_TABLE[(i)&7])
+
+// For each deinterleaved bit, its position in the 33 byte burst. This combines
+// the (a * 181) % 196 interleave with the split of the raw bits around the
+// sync, the first 98 bits are 0-97, the next two are 166-167 and the rest
+// run from 168.
+const uint16_t INTERLEAVE_TABLE[] = {
+	0U, 249U, 234U, 219U, 204U, 189U, 174U, 91U, 76U, 61U, 46U, 31U, 16U, 1U,
+	250U, 235U, 220U, 205U, 190U, 175U, 92U, 77U, 62U, 47U, 32U, 17U, 2U, 251U,
+	236U, 221U, 206U, 191U, 176U, 93U, 78U, 63U, 48U, 33U, 18U, 3U, 252U, 237U,
+	222U, 207U, 192U, 177U, 94U, 79U, 64U, 49U, 34U, 19U, 4U, 253U, 238U, 223U,
+	208U, 193U, 178U, 95U, 80U, 65U, 50U, 35U, 20U, 5U, 254U, 239U, 224U, 209U,
+	194U, 179U, 96U, 81U, 66U, 51U, 36U, 21U, 6U, 255U, 240U, 225U, 210U, 195U,
+	180U, 97U, 82U, 67U, 52U, 37U, 22U, 7U, 256U, 241U, 226U, 211U, 196U, 181U,
+	166U, 83U, 68U, 53U, 38U, 23U, 8U, 257U, 242U, 227U, 212U, 197U, 182U, 167U,
+	84U, 69U, 54U, 39U, 24U, 9U, 258U, 243U, 228U, 213U, 198U, 183U, 168U, 85U,
+	70U, 55U, 40U, 25U, 10U, 259U, 244U, 229U, 214U, 199U, 184U, 169U, 86U, 71U,
+	56U, 41U, 26U, 11U, 260U, 245U, 230U, 215U, 200U, 185U, 170U, 87U, 72U, 57U,
+	42U, 27U, 12U, 261U, 246U, 231U, 216U, 201U, 186U, 171U, 88U, 73U, 58U, 43U,
+	28U, 13U, 262U, 247U, 232U, 217U, 202U, 187U, 172U, 89U, 74U, 59U, 44U, 29U,
+	14U, 263U, 248U, 233U, 218U, 203U, 188U, 173U, 90U, 75U, 60U, 45U, 30U, 15U};
+
+const unsigned int ROWS    = 13U;
+const unsigned int COLUMNS = 15U;
+
 CBPTC19696::CBPTC19696() :
-m_rawData(nullptr),
-m_deInterData(nullptr)
+m_rows()
 {
-	m_rawData     = new bool[196];
-	m_deInterData = new bool[196];
 }
 
 CBPTC19696::~CBPTC19696()
 {
-	delete[] m_rawData;
-	delete[] m_deInterData;
 }
 
 // The main decode function
@@ -46,11 +66,8 @@ void CBPTC19696::decode(const uint8_t* in, uint8_t* out)
 	assert(in != nullptr);
 	assert(out != nullptr);
 
-	//  Get the raw binary
-	decodeExtractBinary(in);
-
-	// Deinterleave
-	decodeDeInterleave();
+	// Deinterleave straight from the burst
+	decodeDeInterleave(in);
 
 	// Error check
 	decodeErrorCheck();
@@ -71,66 +88,26 @@ void CBPTC19696::encode(const uint8_t* in, uint8_t* out)
 	// Error check
 	encodeErrorCheck();
 
-	// Deinterleave
-	encodeInterleave();
-
-	//  Get the raw binary
-	encodeExtractBinary(out);
-}
-
-void CBPTC19696::decodeExtractBinary(const uint8_t* in)
-{
-	// First block
-	CUtils::byteToBitsBE(in[0U],  m_rawData + 0U);
-	CUtils::byteToBitsBE(in[1U],  m_rawData + 8U);
-	CUtils::byteToBitsBE(in[2U],  m_rawData + 16U);
-	CUtils::byteToBitsBE(in[3U],  m_rawData + 24U);
-	CUtils::byteToBitsBE(in[4U],  m_rawData + 32U);
-	CUtils::byteToBitsBE(in[5U],  m_rawData + 40U);
-	CUtils::byteToBitsBE(in[6U],  m_rawData + 48U);
-	CUtils::byteToBitsBE(in[7U],  m_rawData + 56U);
-	CUtils::byteToBitsBE(in[8U],  m_rawData + 64U);
-	CUtils::byteToBitsBE(in[9U],  m_rawData + 72U);
-	CUtils::byteToBitsBE(in[10U], m_rawData + 80U);
-	CUtils::byteToBitsBE(in[11U], m_rawData + 88U);
-	CUtils::byteToBitsBE(in[12U], m_rawData + 96U);
-
-	// Handle the two bits
-	bool bits[8U];
-	CUtils::byteToBitsBE(in[20U], bits);
-	m_rawData[98U] = bits[6U];
-	m_rawData[99U] = bits[7U];
-
-	// Second block
-	CUtils::byteToBitsBE(in[21U], m_rawData + 100U);
-	CUtils::byteToBitsBE(in[22U], m_rawData + 108U);
-	CUtils::byteToBitsBE(in[23U], m_rawData + 116U);
-	CUtils::byteToBitsBE(in[24U], m_rawData + 124U);
-	CUtils::byteToBitsBE(in[25U], m_rawData + 132U);
-	CUtils::byteToBitsBE(in[26U], m_rawData + 140U);
-	CUtils::byteToBitsBE(in[27U], m_rawData + 148U);
-	CUtils::byteToBitsBE(in[28U], m_rawData + 156U);
-	CUtils::byteToBitsBE(in[29U], m_rawData + 164U);
-	CUtils::byteToBitsBE(in[30U], m_rawData + 172U);
-	CUtils::byteToBitsBE(in[31U], m_rawData + 180U);
-	CUtils::byteToBitsBE(in[32U], m_rawData + 188U);
+	// Interleave straight into the burst
+	encodeInterleave(out);
 }
 
-// Deinterleave the raw data
-void CBPTC19696::decodeDeInterleave()
+void CBPTC19696::decodeDeInterleave(const uint8_t* in)
 {
-	for (unsigned int i = 0U; i < 196U; i++)
-		m_deInterData[i] = false;
-
 	// The first bit is R(3) which is not used so can be ignored
-	for (unsigned int a = 0U; a < 196U; a++)	{
-		// Calculate the interleave sequence
-		unsigned int interleaveSequence = (a * 181U) % 196U;
-		// Shuffle the data
-		m_deInterData[a] = m_rawData[interleaveSequence];
+	unsigned int a = 1U;
+	for (unsigned int r = 0U; r < ROWS; r++) {
+		uint16_t row = 0U;
+		for (unsigned int c = 0U; c < COLUMNS; c++, a++) {
+			row <<= 1;
+			if (READ_BIT(in, INTERLEAVE_TABLE[a]))
+				row |= 0x01U;
+		}
+
+		m_rows[r] = row;
 	}
 }
-	
+
 // Check each row with a Hamming (15,11,3) code and each column with a Hamming (13,9,3) code
 void CBPTC19696::decodeErrorCheck()
 {
@@ -139,30 +116,13 @@ void CBPTC19696::decodeErrorCheck()
 	do {
 		fixing = false;
 
-		// Run through each of the 15 columns
-		bool col[13U];
-		for (unsigned int c = 0U; c < 15U; c++) {
-			unsigned int pos = c + 1U;
-			for (unsigned int a = 0U; a < 13U; a++) {
-				col[a] = m_deInterData[pos];
-				pos = pos + 15U;
-			}
-
-			if (CHamming::decode1393(col)) {
-				unsigned int pos = c + 1U;
-				for (unsigned int a = 0U; a < 13U; a++) {
-					m_deInterData[pos] = col[a];
-					pos = pos + 15U;
-				}
+		// Run through all 15 columns at once
+		if (CHamming::decode1393Columns(m_rows) != 0U)
+			fixing = true;
 
-				fixing = true;
-			}
-		}
-		
 		// Run through each of the 9 rows containing data
 		for (unsigned int r = 0U; r < 9U; r++) {
-			unsigned int pos = (r * 15U) + 1U;
-			if (CHamming::decode15113_2(m_deInterData + pos))
+			if (CHamming::decode15113_2(m_rows[r]))
 				fixing = true;
 		}
 
@@ -170,178 +130,76 @@ void CBPTC19696::decodeErrorCheck()
 	} while (fixing && count < 5U);
 }
 
-// Extract the 96 bits of payload
+// Extract the 96 bits of payload, the last 8 bits of the first row and the first 11 of the next eight
 void CBPTC19696::decodeExtractData(uint8_t* data) const
 {
-	bool bData[96U];
+	uint32_t acc = (m_rows[0U] >> 4) & 0xFFU;
+	unsigned int n = 8U;
 	unsigned int pos = 0U;
-	for (unsigned int a = 4U; a <= 11U; a++, pos++)
-		bData[pos] = m_deInterData[a];
-
-	for (unsigned int a = 16U; a <= 26U; a++, pos++)
-		bData[pos] = m_deInterData[a];
-
-	for (unsigned int a = 31U; a <= 41U; a++, pos++)
-		bData[pos] = m_deInterData[a];
-
-	for (unsigned int a = 46U; a <= 56U; a++, pos++)
-		bData[pos] = m_deInterData[a];
-
-	for (unsigned int a = 61U; a <= 71U; a++, pos++)
-		bData[pos] = m_deInterData[a];
-
-	for (unsigned int a = 76U; a <= 86U; a++, pos++)
-		bData[pos] = m_deInterData[a];
-
-	for (unsigned int a = 91U; a <= 101U; a++, pos++)
-		bData[pos] = m_deInterData[a];
-
-	for (unsigned int a = 106U; a <= 116U; a++, pos++)
-		bData[pos] = m_deInterData[a];
 
-	for (unsigned int a = 121U; a <= 131U; a++, pos++)
-		bData[pos] = m_deInterData[a];
+	for (unsigned int r = 1U; r < 9U; r++) {
+		acc = (acc << 11) | ((m_rows[r] >> 4) & 0x7FFU);
+		n += 11U;
 
-	CUtils::bitsToByteBE(bData + 0U,  data[0U]);
-	CUtils::bitsToByteBE(bData + 8U,  data[1U]);
-	CUtils::bitsToByteBE(bData + 16U, data[2U]);
-	CUtils::bitsToByteBE(bData + 24U, data[3U]);
-	CUtils::bitsToByteBE(bData + 32U, data[4U]);
-	CUtils::bitsToByteBE(bData + 40U, data[5U]);
-	CUtils::bitsToByteBE(bData + 48U, data[6U]);
-	CUtils::bitsToByteBE(bData + 56U, data[7U]);
-	CUtils::bitsToByteBE(bData + 64U, data[8U]);
-	CUtils::bitsToByteBE(bData + 72U, data[9U]);
-	CUtils::bitsToByteBE(bData + 80U, data[10U]);
-	CUtils::bitsToByteBE(bData + 88U, data[11U]);
+		while (n >= 8U) {
+			n -= 8U;
+			data[pos++] = uint8_t(acc >> n);
+		}
+	}
 }
 
-// Extract the 96 bits of payload
-void CBPTC19696::encodeExtractData(const uint8_t* in) const
+void CBPTC19696::encodeExtractData(const uint8_t* in)
 {
-	bool bData[96U];
-	CUtils::byteToBitsBE(in[0U],  bData + 0U);
-	CUtils::byteToBitsBE(in[1U],  bData + 8U);
-	CUtils::byteToBitsBE(in[2U],  bData + 16U);
-	CUtils::byteToBitsBE(in[3U],  bData + 24U);
-	CUtils::byteToBitsBE(in[4U],  bData + 32U);
-	CUtils::byteToBitsBE(in[5U],  bData + 40U);
-	CUtils::byteToBitsBE(in[6U],  bData + 48U);
-	CUtils::byteToBitsBE(in[7U],  bData + 56U);
-	CUtils::byteToBitsBE(in[8U],  bData + 64U);
-	CUtils::byteToBitsBE(in[9U],  bData + 72U);
-	CUtils::byteToBitsBE(in[10U], bData + 80U);
-	CUtils::byteToBitsBE(in[11U], bData + 88U);
-
-	for (unsigned int i = 0U; i < 196U; i++)
-		m_deInterData[i] = false;
-
-	unsigned int pos = 0U;
-	for (unsigned int a = 4U; a <= 11U; a++, pos++)
-		m_deInterData[a] = bData[pos];
-
-	for (unsigned int a = 16U; a <= 26U; a++, pos++)
-		m_deInterData[a] = bData[pos];
+	::memset(m_rows, 0x00U, ROWS * sizeof(uint16_t));
 
-	for (unsigned int a = 31U; a <= 41U; a++, pos++)
-		m_deInterData[a] = bData[pos];
+	m_rows[0U] = uint16_t(in[0U]) << 4;
 
-	for (unsigned int a = 46U; a <= 56U; a++, pos++)
-		m_deInterData[a] = bData[pos];
+	uint32_t acc = 0U;
+	unsigned int n = 0U;
+	unsigned int pos = 1U;
 
-	for (unsigned int a = 61U; a <= 71U; a++, pos++)
-		m_deInterData[a] = bData[pos];
-
-	for (unsigned int a = 76U; a <= 86U; a++, pos++)
-		m_deInterData[a] = bData[pos];
-
-	for (unsigned int a = 91U; a <= 101U; a++, pos++)
-		m_deInterData[a] = bData[pos];
-
-	for (unsigned int a = 106U; a <= 116U; a++, pos++)
-		m_deInterData[a] = bData[pos];
+	for (unsigned int r = 1U; r < 9U; r++) {
+		while (n < 11U) {
+			acc = (acc << 8) | in[pos++];
+			n += 8U;
+		}
 
-	for (unsigned int a = 121U; a <= 131U; a++, pos++)
-		m_deInterData[a] = bData[pos];
+		n -= 11U;
+		m_rows[r] = uint16_t(((acc >> n) & 0x7FFU) << 4);
+	}
 }
 
 // Check each row with a Hamming (15,11,3) code and each column with a Hamming (13,9,3) code
 void CBPTC19696::encodeErrorCheck()
 {
-	
 	// Run through each of the 9 rows containing data
-	for (unsigned int r = 0U; r < 9U; r++) {
-		unsigned int pos = (r * 15U) + 1U;
-		CHamming::encode15113_2(m_deInterData + pos);
-	}
-	
-	// Run through each of the 15 columns
-	bool col[13U];
-	for (unsigned int c = 0U; c < 15U; c++) {
-		unsigned int pos = c + 1U;
-		for (unsigned int a = 0U; a < 13U; a++) {
-			col[a] = m_deInterData[pos];
-			pos = pos + 15U;
-		}
-
-		CHamming::encode1393(col);
+	for (unsigned int r = 0U; r < 9U; r++)
+		CHamming::encode15113_2(m_rows[r]);
 
-		pos = c + 1U;
-		for (unsigned int a = 0U; a < 13U; a++) {
-			m_deInterData[pos] = col[a];
-			pos = pos + 15U;
-		}
-	}
+	// Run through all 15 columns at once
+	CHamming::encode1393Columns(m_rows);
 }
 
-// Interleave the raw data
-void CBPTC19696::encodeInterleave()
+void CBPTC19696::encodeInterleave(uint8_t* data) const
 {
-	for (unsigned int i = 0U; i < 196U; i++)
-		m_rawData[i] = false;
-
-	// The first bit is R(3) which is not used so can be ignored
-	for (unsigned int a = 0U; a < 196U; a++)	{
-		// Calculate the interleave sequence
-		unsigned int interleaveSequence = (a * 181U) % 196U;
-		// Unshuffle the data
-		m_rawData[interleaveSequence] = m_deInterData[a];
+	// The R(3) bit is always zero
+	uint8_t burst[33U];
+	::memset(burst, 0x00U, 33U);
+
+	unsigned int a = 1U;
+	for (unsigned int r = 0U; r < ROWS; r++) {
+		for (unsigned int c = 0U; c < COLUMNS; c++, a++) {
+			uint16_t pos = INTERLEAVE_TABLE[a];
+			uint8_t bit  = (m_rows[r] >> (14U - c)) & 0x01U;
+			burst[pos >> 3] |= bit << (7U - (pos & 7U));
+		}
 	}
-}
 
-void CBPTC19696::encodeExtractBinary(uint8_t* data)
-{
-	// First block
-	CUtils::bitsToByteBE(m_rawData + 0U,  data[0U]);
-	CUtils::bitsToByteBE(m_rawData + 8U,  data[1U]);
-	CUtils::bitsToByteBE(m_rawData + 16U, data[2U]);
-	CUtils::bitsToByteBE(m_rawData + 24U, data[3U]);
-	CUtils::bitsToByteBE(m_rawData + 32U, data[4U]);
-	CUtils::bitsToByteBE(m_rawData + 40U, data[5U]);
-	CUtils::bitsToByteBE(m_rawData + 48U, data[6U]);
-	CUtils::bitsToByteBE(m_rawData + 56U, data[7U]);
-	CUtils::bitsToByteBE(m_rawData + 64U, data[8U]);
-	CUtils::bitsToByteBE(m_rawData + 72U, data[9U]);
-	CUtils::bitsToByteBE(m_rawData + 80U, data[10U]);
-	CUtils::bitsToByteBE(m_rawData + 88U, data[11U]);
-
-	// Handle the two bits
-	uint8_t byte;
-	CUtils::bitsToByteBE(m_rawData + 96U, byte);
-	data[12U] = (data[12U] & 0x3FU) | ((byte >> 0) & 0xC0U);
-	data[20U] = (data[20U] & 0xFCU) | ((byte >> 4) & 0x03U);
-
-	// Second block
-	CUtils::bitsToByteBE(m_rawData + 100U,  data[21U]);
-	CUtils::bitsToByteBE(m_rawData + 108U,  data[22U]);
-	CUtils::bitsToByteBE(m_rawData + 116U,  data[23U]);
-	CUtils::bitsToByteBE(m_rawData + 124U,  data[24U]);
-	CUtils::bitsToByteBE(m_rawData + 132U,  data[25U]);
-	CUtils::bitsToByteBE(m_rawData + 140U,  data[26U]);
-	CUtils::bitsToByteBE(m_rawData + 148U,  data[27U]);
-	CUtils::bitsToByteBE(m_rawData + 156U,  data[28U]);
-	CUtils::bitsToByteBE(m_rawData + 164U,  data[29U]);
-	CUtils::bitsToByteBE(m_rawData + 172U,  data[30U]);
-	CUtils::bitsToByteBE(m_rawData + 180U,  data[31U]);
-	CUtils::bitsToByteBE(m_rawData + 188U,  data[32U]);
+	// Bytes 12 and 20 are shared with the sync or slot type
+	for (unsigned int i = 0U; i < 12U; i++)
+		data[i] = burst[i];
+	data[12U] = (data[12U] & 0x3FU) | burst[12U];
+	data[20U] = (data[20U] & 0xFCU) | burst[20U];
+	for (unsigned int i = 21U; i < 33U; i++)
+		data[i] = burst[i];
 }
@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2015,2024 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2015,2024,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -32,18 +32,16 @@ public:
 	void encode(const uint8_t* in, uint8_t* out);
 
 private:
-	bool* m_rawData;
-	bool* m_deInterData;
+	// The deinterleaved matrix, one 15 bit row per word with the leading R(3) bit dropped
+	uint16_t m_rows[13U];
 
-	void decodeExtractBinary(const uint8_t* in);
+	void decodeDeInterleave(const uint8_t* in);
 	void decodeErrorCheck();
-	void decodeDeInterleave();
 	void decodeExtractData(uint8_t* data) const;
 
-	void encodeExtractData(const uint8_t* in) const;
-	void encodeInterleave();
+	void encodeExtractData(const uint8_t* in);
 	void encodeErrorCheck();
-	void encodeExtractBinary(uint8_t* data);
+	void encodeInterleave(uint8_t* data) const;
 };
 
 #endif
@@ -0,0 +1,1109 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+// Times the codec and FEC kernels over fixed sets of random inputs and
+// writes one JSON object per line for each of them. Where a kernel has been
+// rewritten for speed it is also checked against the code it replaced, and
+// the exit status is non-zero if any of them disagree. An optional argument
+// only runs the benchmarks and checks whose names contain it.
+
+#include "TranscoderDefines.h"
+#include "NXDNDefines.h"
+#include "DMRDefines.h"
+#include "YSFDefines.h"
+#include "Golay24128.h"
+#include "NXDNFACCH1.h"
+#include "YSFPayload.h"
+#include "YSFNetwork.h"
+#include "BPTC19696.h"
+#include "ViterbiACS.h"
+#include "NXDNLICH.h"
+#include "NXDNCRC.h"
+#include "Hamming.h"
+#include "YSFFICH.h"
+#include "DMRLC.h"
+#include "RS129.h"
+#include "Utils.h"
+#include "CRC.h"
+
+#include "Reference.h"
+
+#include <nlohmann/json.hpp>
+
+#include <functional>
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <string>
+#include <new>
+
+// The number of different inputs each benchmark cycles through
+const unsigned int INPUT_COUNT = 256U;
+
+// Each benchmark runs for at least this long
+const std::chrono::milliseconds RUN_TIME(200);
+
+const uint32_t SEED = 0x4B4C5847U;
+
+static std::atomic<uint64_t> g_allocations(0U);
+
+// The replacements allocate with malloc() and free with free(). They are kept
+// out of line, so that the compiler never sees one side of the pair inlined
+// against a call to the other and warns about a mismatch.
+__attribute__((noinline)) void* operator new(size_t size)
+{
+	g_allocations.fetch_add(1U, std::memory_order_relaxed);
+
+	void* p = std::malloc(size > 0U ? size : 1U);
+	if (p == nullptr)
+		throw std::bad_alloc();
+
+	return p;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	operator delete(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+	operator delete(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+	operator delete[](p);
+}
+
+class CBenchmarks {
+public:
+	CBenchmarks(const std::string& filter) :
+	m_filter(filter),
+	m_random(SEED),
+	m_sink(0U),
+	m_mismatches(0U)
+	{
+	}
+
+	// bytes is the amount of payload handled by one call of func
+	void run(const std::string& name, unsigned int bytes, const std::function<void(unsigned int)>& func)
+	{
+		if (!m_filter.empty() && (name.find(m_filter) == std::string::npos))
+			return;
+
+		// Warm up the caches and the branch predictors
+		for (unsigned int i = 0U; i < INPUT_COUNT; i++)
+			func(i);
+
+		uint64_t iterations  = 0U;
+		uint64_t allocations = g_allocations.load();
+
+		auto start = std::chrono::steady_clock::now();
+		std::chrono::steady_clock::duration elapsed;
+
+		do {
+			for (unsigned int i = 0U; i < INPUT_COUNT; i++)
+				func(i);
+
+			iterations += INPUT_COUNT;
+			elapsed = std::chrono::steady_clock::now() - start;
+		} while (elapsed < RUN_TIME);
+
+		allocations = g_allocations.load() - allocations;
+
+		double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+
+		nlohmann::json json;
+		json["name"]          = name;
+		json["iterations"]    = iterations;
+		json["ns_per_op"]     = ns / double(iterations);
+		json["ops_per_sec"]   = double(iterations) * 1.0E9 / ns;
+		json["bytes_per_op"]  = bytes;
+		json["mb_per_sec"]    = double(iterations) * double(bytes) * 1.0E3 / ns;
+		json["allocs_per_op"] = double(allocations) / double(iterations);
+
+		std::cout << json.dump() << std::endl;
+	}
+
+	// func compares the new code with the old for one random input, and returns whether they agreed
+	void check(const std::string& name, unsigned int count, const std::function<bool(unsigned int)>& func)
+	{
+		if (!m_filter.empty() && (name.find(m_filter) == std::string::npos))
+			return;
+
+		unsigned int mismatches = 0U;
+		for (unsigned int i = 0U; i < count; i++) {
+			if (!func(i))
+				mismatches++;
+		}
+
+		nlohmann::json json;
+		json["check"]      = name;
+		json["inputs"]     = count;
+		json["mismatches"] = mismatches;
+
+		std::cout << json.dump() << std::endl;
+
+		m_mismatches += mismatches;
+	}
+
+	void fill(uint8_t* data, unsigned int length)
+	{
+		for (unsigned int i = 0U; i < length; i++)
+			data[i] = uint8_t(m_random());
+	}
+
+	unsigned int random(unsigned int range)
+	{
+		return m_random() % range;
+	}
+
+	// Flips up to count bits in the first length bits of data
+	void corrupt(uint8_t* data, unsigned int length, unsigned int count)
+	{
+		for (unsigned int i = 0U; i < count; i++) {
+			unsigned int n = random(length);
+			data[n / 8U] ^= 0x80U >> (n % 8U);
+		}
+	}
+
+	// Keeps the results alive so that the work is not optimised away
+	void consume(unsigned int value)
+	{
+		m_sink += value;
+	}
+
+	unsigned int getSink() const
+	{
+		return m_sink;
+	}
+
+	unsigned int getMismatches() const
+	{
+		return m_mismatches;
+	}
+
+private:
+	std::string  m_filter;
+	std::mt19937 m_random;
+	unsigned int m_sink;
+	unsigned int m_mismatches;
+};
+
+static void benchGolay(CBenchmarks& bench)
+{
+	unsigned int data[INPUT_COUNT];
+	unsigned int code[INPUT_COUNT];
+	uint8_t      bytes[INPUT_COUNT * 12U];
+
+	for (unsigned int i = 0U; i < INPUT_COUNT; i++) {
+		data[i] = bench.random(4096U);
+
+		code[i] = CGolay24128::encode24128(data[i]);
+		for (unsigned int j = bench.random(4U); j > 0U; j--)
+			code[i] ^= 1U << bench.random(24U);
+	}
+
+	for (unsigned int i = 0U; i < INPUT_COUNT; i++) {
+		unsigned int words[4U];
+		for (unsigned int j = 0U; j < 4U; j++)
+			words[j] = bench.random(4096U);
+
+		CGolay24128::encode24128(words, bytes + i * 12U, 4U);
+		bench.corrupt(bytes + i * 12U, 96U, bench.random(4U));
+	}
+
+	bench.run("Golay24128.encode24128", 3U, [&](unsigned int i) {
+		bench.consume(CGolay24128::encode24128(data[i]));
+	});
+
+	bench.run("Golay24128.decode24128", 3U, [&](unsigned int i) {
+		unsigned int out;
+		CGolay24128::decode24128(code[i], out);
+		bench.consume(out);
+	});
+
+	bench.run("Golay24128.decode23127", 3U, [&](unsigned int i) {
+		bench.consume(CGolay24128::decode23127(code[i] >> 1));
+	});
+
+	bench.run("Golay24128.decode24128x4", 12U, [&](unsigned int i) {
+		unsigned int out[4U];
+		unsigned int errors;
+		CGolay24128::decode24128(bytes + i * 12U, out, 4U, errors);
+		bench.consume(out[0U] + errors);
+	});
+}
+
+// Codewords are held most significant bit first, so d[0] is bit n - 1
+static void wordToBools(uint32_t word, unsigned int n, bool* d)
+{
+	for (unsigned int i = 0U; i < n; i++)
+		d[i] = ((word >> (n - 1U - i)) & 0x01U) == 0x01U;
+}
+
+static uint32_t boolsToWord(const bool* d, unsigned int n)
+{
+	uint32_t word = 0U;
+	for (unsigned int i = 0U; i < n; i++)
+		word = (word << 1) | (d[i] ? 0x01U : 0x00U);
+
+	return word;
+}
+
+// Runs the new and the old decoder over every n bit word, and the new and
+// the old encoder over every k bit data value
+static void checkHamming(CBenchmarks& bench, const std::string& name, unsigned int n, unsigned int k,
+						 const std::function<bool(uint32_t&)>& decode, bool (*decodeReference)(bool*),
+						 const std::function<void(uint32_t&)>& encode, void (*encodeReference)(bool*))
+{
+	bench.check("Hamming.decode" + name, 1U << n, [&](unsigned int i) {
+		uint32_t word = i;
+		bool ret1 = decode(word);
+
+		bool d[17U];
+		wordToBools(i, n, d);
+		bool ret2 = decodeReference(d);
+
+		return (ret1 == ret2) && (word == boolsToWord(d, n));
+	});
+
+	bench.check("Hamming.encode" + name, 1U << k, [&](unsigned int i) {
+		uint32_t word = i << (n - k);
+		encode(word);
+
+		bool d[17U];
+		wordToBools(i << (n - k), n, d);
+		encodeReference(d);
+
+		return word == boolsToWord(d, n);
+	});
+}
+
+static void benchHamming(CBenchmarks& bench)
+{
+	uint16_t data15[INPUT_COUNT];
+	uint16_t data13[INPUT_COUNT];
+	uint16_t data16[INPUT_COUNT];
+	uint32_t data17[INPUT_COUNT];
+	uint16_t rows[INPUT_COUNT][13U];
+
+	for (unsigned int i = 0U; i < INPUT_COUNT; i++) {
+		data15[i] = uint16_t(bench.random(2048U) << 4);
+		CHamming::encode15113_2(data15[i]);
+		data15[i] ^= uint16_t(1U << bench.random(15U));
+
+		data13[i] = uint16_t(bench.random(512U) << 4);
+		CHamming::encode1393(data13[i]);
+		data13[i] ^= uint16_t(1U << bench.random(13U));
+
+		data16[i] = uint16_t(bench.random(2048U) << 5);
+		CHamming::encode16114(data16[i]);
+		data16[i] ^= uint16_t(1U << bench.random(16U));
+
+		data17[i] = uint32_t(bench.random(4096U) << 5);
+		CHamming::encode17123(data17[i]);
+		data17[i] ^= 1U << bench.random(17U);
+
+		for (unsigned int j = 0U; j < 13U; j++)
+			rows[i][j] = uint16_t(bench.random(65536U));
+		CHamming::encode1393Columns(rows[i]);
+		rows[i][bench.random(13U)] ^= uint16_t(bench.random(65536U));
+	}
+
+	bench.run("Hamming.encode15113_2", 2U, [&](unsigned int i) {
+		uint16_t d = data15[i] & 0x7FF0U;
+		CHamming::encode15113_2(d);
+		bench.consume(d);
+	});
+
+	bench.run("Hamming.decode15113_2", 2U, [&](unsigned int i) {
+		uint16_t d = data15[i];
+		bench.consume(CHamming::decode15113_2(d) ? d : 0U);
+	});
+
+	bench.run("Hamming.decode1393", 2U, [&](unsigned int i) {
+		uint16_t d = data13[i];
+		bench.consume(CHamming::decode1393(d) ? d : 0U);
+	});
+
+	bench.run("Hamming.decode16114", 2U, [&](unsigned int i) {
+		uint16_t d = data16[i];
+		bench.consume(CHamming::decode16114(d) ? d : 0U);
+	});
+
+	bench.run("Hamming.decode17123", 3U, [&](unsigned int i) {
+		uint32_t d = data17[i];
+		bench.consume(CHamming::decode17123(d) ? d : 0U);
+	});
+
+	bench.run("Hamming.decode1393Columns", 26U, [&](unsigned int i) {
+		uint16_t r[13U];
+		::memcpy(r, rows[i], sizeof(r));
+		bench.consume(CHamming::decode1393Columns(r));
+	});
+
+	checkHamming(bench, "15113_1", 15U, 11U,
+		[](uint32_t& d) { uint16_t w = uint16_t(d); bool ret = CHamming::decode15113_1(w); d = w; return ret; }, CHammingReference::decode15113_1,
+		[](uint32_t& d) { uint16_t w = uint16_t(d); CHamming::encode15113_1(w); d = w; }, CHammingReference::encode15113_1);
+	checkHamming(bench, "15113_2", 15U, 11U,
+		[](uint32_t& d) { uint16_t w = uint16_t(d); bool ret = CHamming::decode15113_2(w); d = w; return ret; }, CHammingReference::decode15113_2,
+		[](uint32_t& d) { uint16_t w = uint16_t(d); CHamming::encode15113_2(w); d = w; }, CHammingReference::encode15113_2);
+	checkHamming(bench, "1393", 13U, 9U,
+		[](uint32_t& d) { uint16_t w = uint16_t(d); bool ret = CHamming::decode1393(w); d = w; return ret; }, CHammingReference::decode1393,
+		[](uint32_t& d) { uint16_t w = uint16_t(d); CHamming::encode1393(w); d = w; }, CHammingReference::encode1393);
+	checkHamming(bench, "1063", 10U, 6U,
+		[](uint32_t& d) { uint16_t w = uint16_t(d); bool ret = CHamming::decode1063(w); d = w; return ret; }, CHammingReference::decode1063,
+		[](uint32_t& d) { uint16_t w = uint16_t(d); CHamming::encode1063(w); d = w; }, CHammingReference::encode1063);
+	checkHamming(bench, "16114", 16U, 11U,
+		[](uint32_t& d) { uint16_t w = uint16_t(d); bool ret = CHamming::decode16114(w); d = w; return ret; }, CHammingReference::decode16114,
+		[](uint32_t& d) { uint16_t w = uint16_t(d); CHamming::encode16114(w); d = w; }, CHammingReference::encode16114);
+	checkHamming(bench, "17123", 17U, 12U,
+		[](uint32_t& d) { return CHamming::decode17123(d); }, CHammingReference::decode17123,
+		[](uint32_t& d) { CHamming::encode17123(d); }, CHammingReference::encode17123);
+
+	// Sixteen columns at once against one column at a time
+	bench.check("Hamming.decode1393Columns", 100000U, [&](unsigned int) {
+		uint16_t r[13U];
+		for (unsigned int j = 0U; j < 13U; j++)
+			r[j] = uint16_t(bench.random(65536U));
+		if (bench.random(2U) == 0U)
+			CHamming::encode1393Columns(r);
+
+		uint16_t columns[13U];
+		::memcpy(columns, r, sizeof(r));
+		uint16_t corrected = CHamming::decode1393Columns(r);
+
+		for (unsigned int c = 0U; c < 16U; c++) {
+			bool d[13U];
+			for (unsigned int j = 0U; j < 13U; j++)
+				d[j] = (columns[j] & (1U << c)) != 0U;
+
+			bool ret = CHammingReference::decode1393(d);
+			if (ret != ((corrected & (1U << c)) != 0U))
+				return false;
+
+			for (unsigned int j = 0U; j < 13U; j++) {
+				if (d[j] != ((r[j] & (1U << c)) != 0U))
+					return false;
+			}
+		}
+
+		return true;
+	});
+
+	bench.check("Hamming.encode1393Columns", 100000U, [&](unsigned int) {
+		uint16_t r[13U];
+		for (unsigned int j = 0U; j < 13U; j++)
+			r[j] = uint16_t(bench.random(65536U));
+		CHamming::encode1393Columns(r);
+
+		for (unsigned int c = 0U; c < 16U; c++) {
+			bool d[13U];
+			for (unsigned int j = 0U; j < 9U; j++)
+				d[j] = (r[j] & (1U << c)) != 0U;
+
+			CHammingReference::encode1393(d);
+
+			for (unsigned int j = 9U; j < 13U; j++) {
+				if (d[j] != ((r[j] & (1U << c)) != 0U))
+					return false;
+			}
+		}
+
+		return true;
+	});
+}
+
+static void benchBPTC(CBenchmarks& bench)
+{
+	uint8_t data[INPUT_COUNT * 12U];
+	uint8_t bursts[INPUT_COUNT * DMR_FRAME_LENGTH_BYTES];
+
+	bench.fill(data, INPUT_COUNT * 12U);
+
+	CBPTC19696 bptc;
+	for (unsigned int i = 0U; i < INPUT_COUNT; i++) {
+		uint8_t* burst = bursts + i * DMR_FRAME_LENGTH_BYTES;
+		::memset(burst, 0x00U, DMR_FRAME_LENGTH_BYTES);
+		bptc.encode(data + i * 12U, burst);
+		bench.corrupt(burst, 98U, bench.random(3U));
+	}
+
+	bench.run("BPTC19696.encode", 12U, [&](unsigned int i) {
+		uint8_t burst[DMR_FRAME_LENGTH_BYTES];
+		bptc.encode(data + i * 12U, burst);
+		bench.consume(burst[0U]);
+	});
+
+	bench.run("BPTC19696.decode", 12U, [&](unsigned int i) {
+		uint8_t out[12U];
+		bptc.decode(bursts + i * DMR_FRAME_LENGTH_BYTES, out);
+		bench.consume(out[0U]);
+	});
+
+	CBPTC19696Reference reference;
+
+	// The bits of the burst outside of the BPTC must be left alone
+	bench.check("BPTC19696.encode", 100000U, [&](unsigned int) {
+		uint8_t in[12U];
+		bench.fill(in, 12U);
+
+		uint8_t burst1[DMR_FRAME_LENGTH_BYTES];
+		bench.fill(burst1, DMR_FRAME_LENGTH_BYTES);
+		uint8_t burst2[DMR_FRAME_LENGTH_BYTES];
+		::memcpy(burst2, burst1, DMR_FRAME_LENGTH_BYTES);
+
+		bptc.encode(in, burst1);
+		reference.encode(in, burst2);
+
+		return ::memcmp(burst1, burst2, DMR_FRAME_LENGTH_BYTES) == 0;
+	});
+
+	// From no errors to more than the code can correct
+	bench.check("BPTC19696.decode", 100000U, [&](unsigned int) {
+		uint8_t in[12U];
+		bench.fill(in, 12U);
+
+		uint8_t burst[DMR_FRAME_LENGTH_BYTES];
+		bench.fill(burst, DMR_FRAME_LENGTH_BYTES);
+		reference.encode(in, burst);
+
+		unsigned int errors = bench.random(8U);
+		for (unsigned int j = 0U; j < errors; j++) {
+			// Skip over the 48 bits of the sync or EMB in the middle
+			unsigned int n = bench.random(196U);
+			n += (n >= 98U) ? 48U : 0U;
+			burst[n / 8U] ^= 0x80U >> (n % 8U);
+		}
+
+		uint8_t out1[12U];
+		bptc.decode(burst, out1);
+		uint8_t out2[12U];
+		reference.decode(burst, out2);
+
+		return ::memcmp(out1, out2, 12U) == 0;
+	});
+}
+
+static void benchDMRLC(CBenchmarks& bench)
+{
+	uint32_t ids[INPUT_COUNT];
+	for (unsigned int i = 0U; i < INPUT_COUNT; i++)
+		ids[i] = bench.random(16777215U) + 1U;
+
+	bench.run("DMRLC.encode", 12U, [&](unsigned int i) {
+		uint8_t burst[DMR_FRAME_LENGTH_BYTES];
+
+		CDMRLC lc;
+		lc.setParameters(FLCO::GROUP, ids[i], ids[(i + 1U) % INPUT_COUNT]);
+		lc.encode(burst, DT_VOICE_LC_HEADER);
+		bench.consume(burst[0U]);
+	});
+
+	bench.run("DMRLC.getData", 16U, [&](unsigned int i) {
+		uint8_t fragment[DMR_FRAME_LENGTH_BYTES];
+
+		CDMRLC lc;
+		lc.setParameters(FLCO::GROUP, ids[i], ids[(i + 1U) % INPUT_COUNT]);
+		for (uint8_t n = 0U; n < 4U; n++)
+			lc.getData(fragment, n);
+		bench.consume(fragment[14U]);
+	});
+}
+
+const uint8_t BIT_MASK_TABLE[] = { 0x80U, 0x40U, 0x20U, 0x10U, 0x08U, 0x04U, 0x02U, 0x01U };
+
+#define WRITE_BIT8(p,i,b) p[(i)>>3] = (b) ? (p[(i)>>3] | BIT_MASK_TABLE[(i)&7]) : (p[(i)>>3] & ~BIT_MASK_TABLE[(i)&7])
+#define READ_BIT8(p,i)    (p[(i)>>3] & BIT_MASK_TABLE[(i)&7])
+
+// The bit at a time loop that CUtils::copyBits replaced
+static void copyBitsReference(const uint8_t* in, unsigned int inOffset, uint8_t* out, unsigned int outOffset, unsigned int length)
+{
+	for (unsigned int i = 0U; i < length; i++, inOffset++, outOffset++) {
+		bool b = READ_BIT8(in, inOffset) != 0U;
+		WRITE_BIT8(out, outOffset, b);
+	}
+}
+
+static void benchCopyBits(CBenchmarks& bench)
+{
+	// The three AMBE frames of a DMR burst
+	const unsigned int AMBE_LENGTH = DMR_NXDN_DATA_LENGTH * 3U;
+	const unsigned int LENGTH      = 64U;
+
+	uint8_t data[INPUT_COUNT * AMBE_LENGTH];
+	bench.fill(data, INPUT_COUNT * AMBE_LENGTH);
+
+	// Placing them either side of the sync in a DMR burst
+	bench.run("Utils.copyBits", AMBE_LENGTH, [&](unsigned int i) {
+		uint8_t buffer[20U + 33U] = { 0x00U };
+		CUtils::copyBits(data + i * AMBE_LENGTH, 0U,   buffer, (20U * 8U) + 0U,   108U);
+		CUtils::copyBits(data + i * AMBE_LENGTH, 108U, buffer, (20U * 8U) + 156U, 108U);
+		bench.consume(buffer[20U + 32U]);
+	});
+
+	bench.run("Utils.copyBitsReference", AMBE_LENGTH, [&](unsigned int i) {
+		uint8_t buffer[20U + 33U] = { 0x00U };
+		copyBitsReference(data + i * AMBE_LENGTH, 0U,   buffer, (20U * 8U) + 0U,   108U);
+		copyBitsReference(data + i * AMBE_LENGTH, 108U, buffer, (20U * 8U) + 156U, 108U);
+		bench.consume(buffer[20U + 32U]);
+	});
+
+	// Random offsets and lengths into outputs full of random bytes, which
+	// must be left alone outside of the bits copied
+	bench.check("Utils.copyBits", 100000U, [&](unsigned int) {
+		uint8_t in[LENGTH];
+		bench.fill(in, LENGTH);
+
+		unsigned int inOffset  = bench.random(LENGTH * 8U);
+		unsigned int outOffset = bench.random(LENGTH * 8U);
+		unsigned int length    = bench.random((LENGTH * 8U) - std::max(inOffset, outOffset) + 1U);
+
+		uint8_t out1[LENGTH];
+		bench.fill(out1, LENGTH);
+		uint8_t out2[LENGTH];
+		::memcpy(out2, out1, LENGTH);
+
+		CUtils::copyBits(in, inOffset, out1, outOffset, length);
+		copyBitsReference(in, inOffset, out2, outOffset, length);
+
+		return ::memcmp(out1, out2, LENGTH) == 0;
+	});
+}
+
+// The communications frame as CYSFNetwork built it before the templates
+static void encodeCommunications(uint8_t* frame, const uint8_t* source, uint8_t dgId, uint8_t fn, const uint8_t* audio)
+{
+	::memcpy(frame, YSF_SYNC_BYTES, YSF_SYNC_LENGTH_BYTES);
+
+	CYSFFICH fich;
+	fich.setFI(YSF_FI_COMMUNICATIONS);
+	fich.setCS(YSF_CS_ASSIGN);
+	fich.setCM(YSF_CM_GROUP_CQ);
+	fich.setBN(0U);
+	fich.setBT(0U);
+	fich.setFN(fn);
+	fich.setFT(6U);
+	fich.setDev(false);
+	fich.setMR(YSF_MR_DIRECT);
+	fich.setVoIP(false);
+	fich.setDT(YSF_DT_VD_MODE2);
+	fich.setDGId(dgId);
+	fich.encode(frame);
+
+	CYSFPayload payload;
+	payload.createVDMode2Audio(frame, audio);
+
+	switch (fn) {
+	case 2U:
+	case 3U:
+	case 4U:
+	case 5U:
+		payload.createVDMode2Data(frame, YSF_NULL_CALLSIGN1);
+		break;
+	case 0U:
+		payload.createVDMode2Data(frame, YSF_NULL_CALLSIGN2);
+		break;
+	case 1U:
+		payload.createVDMode2Data(frame, source);
+		break;
+	default:
+		payload.createVDMode2Data(frame, YSF_NULL_DT);
+		break;
+	}
+}
+
+static void benchYSFTemplates(CBenchmarks& bench)
+{
+	const unsigned int TEMPLATES_LENGTH = YSF_FRAME_LENGTH_BYTES * 7U;
+
+	uint8_t sources[INPUT_COUNT * YSF_CALLSIGN_LENGTH];
+	uint8_t audio[INPUT_COUNT * YSFDN_DATA_LENGTH * 5U];
+	uint8_t dgIds[INPUT_COUNT];
+	for (unsigned int i = 0U; i < (INPUT_COUNT * YSF_CALLSIGN_LENGTH); i++)
+		sources[i] = uint8_t('A' + bench.random(26U));
+	bench.fill(audio, INPUT_COUNT * YSFDN_DATA_LENGTH * 5U);
+	bench.fill(dgIds, INPUT_COUNT);
+
+	uint8_t templates[TEMPLATES_LENGTH];
+	CYSFNetwork::encodeTemplates(templates, sources, dgIds[0U] % 100U);
+
+	bench.run("YSFNetwork.encodeTemplates", TEMPLATES_LENGTH, [&](unsigned int i) {
+		uint8_t out[TEMPLATES_LENGTH];
+		CYSFNetwork::encodeTemplates(out, sources + i * YSF_CALLSIGN_LENGTH, dgIds[i] % 100U);
+		bench.consume(out[YSF_FRAME_LENGTH_BYTES - 1U]);
+	});
+
+	bench.run("YSFNetwork.communicationsFrame", YSF_FRAME_LENGTH_BYTES, [&](unsigned int i) {
+		uint8_t frame[YSF_FRAME_LENGTH_BYTES];
+		::memcpy(frame, templates + (i % 7U) * YSF_FRAME_LENGTH_BYTES, YSF_FRAME_LENGTH_BYTES);
+
+		CYSFPayload payload;
+		payload.createVDMode2Audio(frame, audio + i * YSFDN_DATA_LENGTH * 5U);
+		bench.consume(frame[YSF_FRAME_LENGTH_BYTES - 1U]);
+	});
+
+	bench.run("YSFNetwork.communicationsFrameReference", YSF_FRAME_LENGTH_BYTES, [&](unsigned int i) {
+		uint8_t frame[YSF_FRAME_LENGTH_BYTES];
+		encodeCommunications(frame, sources, dgIds[0U] % 100U, uint8_t(i % 7U), audio + i * YSFDN_DATA_LENGTH * 5U);
+		bench.consume(frame[YSF_FRAME_LENGTH_BYTES - 1U]);
+	});
+
+	// A random call, then every FN of two superframes with random audio, each
+	// built both ways into buffers full of random bytes
+	bench.check("YSFNetwork.encodeTemplates", 2000U, [&](unsigned int) {
+		uint8_t source[YSF_CALLSIGN_LENGTH];
+		for (unsigned int i = 0U; i < YSF_CALLSIGN_LENGTH; i++)
+			source[i] = uint8_t(' ' + bench.random(64U));
+		uint8_t dgId = uint8_t(bench.random(128U));
+
+		uint8_t call[TEMPLATES_LENGTH];
+		CYSFNetwork::encodeTemplates(call, source, dgId);
+
+		for (unsigned int n = 0U; n < 14U; n++) {
+			uint8_t fn = uint8_t(n % 7U);
+
+			uint8_t voice[YSFDN_DATA_LENGTH * 5U];
+			bench.fill(voice, YSFDN_DATA_LENGTH * 5U);
+
+			uint8_t frame1[YSF_FRAME_LENGTH_BYTES];
+			bench.fill(frame1, YSF_FRAME_LENGTH_BYTES);
+			::memcpy(frame1, call + fn * YSF_FRAME_LENGTH_BYTES, YSF_FRAME_LENGTH_BYTES);
+
+			CYSFPayload payload;
+			payload.createVDMode2Audio(frame1, voice);
+
+			uint8_t frame2[YSF_FRAME_LENGTH_BYTES];
+			bench.fill(frame2, YSF_FRAME_LENGTH_BYTES);
+			encodeCommunications(frame2, source, dgId, fn, voice);
+
+			if (::memcmp(frame1, frame2, YSF_FRAME_LENGTH_BYTES) != 0)
+				return false;
+		}
+
+		return true;
+	});
+}
+
+static void benchYSF(CBenchmarks& bench)
+{
+	uint8_t frames[INPUT_COUNT * YSF_FRAME_LENGTH_BYTES];
+	uint8_t audio[INPUT_COUNT * YSFDN_DATA_LENGTH * 5U];
+	uint8_t data[INPUT_COUNT * 10U];
+
+	bench.fill(audio, INPUT_COUNT * YSFDN_DATA_LENGTH * 5U);
+	bench.fill(data, INPUT_COUNT * 10U);
+
+	CYSFPayload payload;
+	for (unsigned int i = 0U; i < INPUT_COUNT; i++) {
+		uint8_t* frame = frames + i * YSF_FRAME_LENGTH_BYTES;
+		::memset(frame, 0x00U, YSF_FRAME_LENGTH_BYTES);
+
+		CYSFFICH fich;
+		fich.setFI(YSF_FI_COMMUNICATIONS);
+		fich.setDT(YSF_DT_VD_MODE2);
+		fich.setFN(uint8_t(i % 7U));
+		fich.setFT(6U);
+		fich.setDGId(uint8_t(bench.random(100U)));
+		fich.encode(frame);
+
+		payload.createVDMode2Data(frame, data + i * 10U);
+		payload.createVDMode2Audio(frame, audio + i * YSFDN_DATA_LENGTH * 5U);
+
+		bench.corrupt(frame + YSF_SYNC_LENGTH_BYTES, (YSF_FRAME_LENGTH_BYTES - YSF_SYNC_LENGTH_BYTES) * 8U, bench.random(4U));
+	}
+
+	bench.run("YSFFICH.encode", 4U, [&](unsigned int i) {
+		uint8_t frame[YSF_FRAME_LENGTH_BYTES];
+
+		CYSFFICH fich;
+		fich.setFI(YSF_FI_COMMUNICATIONS);
+		fich.setDT(YSF_DT_VD_MODE2);
+		fich.setFN(uint8_t(i % 7U));
+		fich.encode(frame);
+		bench.consume(frame[YSF_SYNC_LENGTH_BYTES]);
+	});
+
+	bench.run("YSFFICH.decode", 4U, [&](unsigned int i) {
+		unsigned int errors;
+		CYSFFICH fich;
+		fich.decode(frames + i * YSF_FRAME_LENGTH_BYTES, errors);
+		bench.consume(fich.getFN() + errors);
+	});
+
+	bench.run("YSFPayload.createVDMode2Audio", YSFDN_DATA_LENGTH * 5U, [&](unsigned int i) {
+		uint8_t frame[YSF_FRAME_LENGTH_BYTES];
+		payload.createVDMode2Audio(frame, audio + i * YSFDN_DATA_LENGTH * 5U);
+		bench.consume(frame[YSF_FRAME_LENGTH_BYTES - 1U]);
+	});
+
+	bench.run("YSFPayload.processVDMode2Audio", YSFDN_DATA_LENGTH * 5U, [&](unsigned int i) {
+		uint8_t out[YSFDN_DATA_LENGTH * 5U];
+		payload.processVDMode2Audio(frames + i * YSF_FRAME_LENGTH_BYTES, out);
+		bench.consume(out[0U]);
+	});
+
+	bench.run("YSFPayload.createVDMode2Data", 10U, [&](unsigned int i) {
+		uint8_t frame[YSF_FRAME_LENGTH_BYTES];
+		payload.createVDMode2Data(frame, data + i * 10U);
+		bench.consume(frame[YSF_SYNC_LENGTH_BYTES + YSF_FICH_LENGTH_BYTES]);
+	});
+
+	bench.run("YSFPayload.processVDMode2Data", 10U, [&](unsigned int i) {
+		uint8_t out[20U];
+		payload.processVDMode2Data(frames + i * YSF_FRAME_LENGTH_BYTES, out);
+		bench.consume(out[0U]);
+	});
+}
+
+static void benchNXDN(CBenchmarks& bench)
+{
+	uint8_t frames[INPUT_COUNT * NXDN_FRAME_LENGTH_BYTES];
+	uint8_t data[INPUT_COUNT * 10U];
+
+	bench.fill(data, INPUT_COUNT * 10U);
+
+	for (unsigned int i = 0U; i < INPUT_COUNT; i++) {
+		uint8_t* frame = frames + i * NXDN_FRAME_LENGTH_BYTES;
+		::memset(frame, 0x00U, NXDN_FRAME_LENGTH_BYTES);
+
+		CNXDNLICH lich;
+		lich.setRFCT(NXDN_LICH_RFCT_RDCH);
+		lich.setFCT(NXDN_LICH_USC_SACCH_NS);
+		lich.setOption(NXDN_LICH_STEAL_FACCH);
+		lich.setDirection(NXDN_LICH_DIRECTION_OUTBOUND);
+		lich.encode(frame);
+
+		CNXDNFACCH1 facch;
+		facch.setData(data + i * 10U);
+		facch.encode(frame, NXDN_FSW_LICH_SACCH_LENGTH_BITS);
+
+		bench.corrupt(frame, NXDN_FRAME_LENGTH_BITS, bench.random(3U));
+	}
+
+	bench.run("NXDNLICH.encode", 1U, [&](unsigned int i) {
+		uint8_t frame[NXDN_FRAME_LENGTH_BYTES];
+
+		CNXDNLICH lich;
+		lich.setRaw(uint8_t(i));
+		lich.encode(frame);
+		bench.consume(frame[3U]);
+	});
+
+	bench.run("NXDNLICH.decode", 1U, [&](unsigned int i) {
+		CNXDNLICH lich;
+		lich.decode(frames + i * NXDN_FRAME_LENGTH_BYTES);
+		bench.consume(lich.getRaw());
+	});
+
+	bench.run("NXDNFACCH1.encode", 10U, [&](unsigned int i) {
+		uint8_t frame[NXDN_FRAME_LENGTH_BYTES];
+
+		CNXDNFACCH1 facch;
+		facch.setData(data + i * 10U);
+		facch.encode(frame, NXDN_FSW_LICH_SACCH_LENGTH_BITS);
+		bench.consume(frame[20U]);
+	});
+
+	bench.run("NXDNFACCH1.decode", 10U, [&](unsigned int i) {
+		unsigned int errors;
+		CNXDNFACCH1 facch;
+		facch.decode(frames + i * NXDN_FRAME_LENGTH_BYTES, NXDN_FSW_LICH_SACCH_LENGTH_BITS, errors);
+
+		uint8_t out[10U];
+		facch.getData(out);
+		bench.consume(out[0U] + errors);
+	});
+}
+
+static void benchViterbi(CBenchmarks& bench)
+{
+	const unsigned int STATES_D2 = 8U;
+	const unsigned int STEPS     = 200U;
+
+	// Old metrics of the size seen part of the way through a frame
+	uint16_t oldMetrics[INPUT_COUNT * STATES_D2 * 2U];
+	uint16_t branchMetrics[INPUT_COUNT * STATES_D2];
+	for (unsigned int i = 0U; i < (INPUT_COUNT * STATES_D2 * 2U); i++)
+		oldMetrics[i] = uint16_t(bench.random(400U));
+	for (unsigned int i = 0U; i < (INPUT_COUNT * STATES_D2); i++)
+		branchMetrics[i] = uint16_t(bench.random(5U));
+
+	bench.run("ViterbiACS.decode", 1U, [&](unsigned int i) {
+		uint16_t newMetrics[STATES_D2 * 2U];
+		uint64_t decisions = CViterbiACS::decode(oldMetrics + i * STATES_D2 * 2U, newMetrics, branchMetrics + i * STATES_D2, 4U);
+		bench.consume(unsigned(decisions) + newMetrics[0U]);
+	});
+
+	bench.run("ViterbiACS.decodeScalar", 1U, [&](unsigned int i) {
+		uint16_t newMetrics[STATES_D2 * 2U];
+		uint64_t decisions = CViterbiACS::decodeScalar(oldMetrics + i * STATES_D2 * 2U, newMetrics, branchMetrics + i * STATES_D2, 4U);
+		bench.consume(unsigned(decisions) + newMetrics[0U]);
+	});
+
+	// Whole frames of random soft bits through both versions, with the branch
+	// metrics of the YSF (hard bits, M = 2) and NXDN (soft bits, M = 4) decoders
+	auto frame = [&](uint16_t m) {
+		uint16_t metrics1[STATES_D2 * 2U];
+		uint16_t metrics2[STATES_D2 * 2U];
+		::memset(metrics1, 0x00U, sizeof(metrics1));
+
+		for (unsigned int n = 0U; n < STEPS; n++) {
+			uint16_t branch[STATES_D2];
+			for (unsigned int i = 0U; i < STATES_D2; i++)
+				branch[i] = uint16_t(bench.random(m + 1U));
+
+			uint64_t decisions1 = CViterbiACS::decode(metrics1, metrics2, branch, m);
+
+			uint16_t scalar[STATES_D2 * 2U];
+			uint64_t decisions2 = CViterbiACS::decodeScalar(metrics1, scalar, branch, m);
+
+			if ((decisions1 != decisions2) || (::memcmp(metrics2, scalar, sizeof(scalar)) != 0))
+				return false;
+
+			::memcpy(metrics1, metrics2, sizeof(metrics1));
+		}
+
+		return true;
+	};
+
+	bench.check("ViterbiACS.decode.YSF", 1000U, [&](unsigned int) {
+		return frame(2U);
+	});
+
+	bench.check("ViterbiACS.decode.NXDN", 1000U, [&](unsigned int) {
+		return frame(4U);
+	});
+}
+
+static void benchRS129(CBenchmarks& bench)
+{
+	uint8_t data[INPUT_COUNT * 12U];
+
+	bench.fill(data, INPUT_COUNT * 12U);
+
+	for (unsigned int i = 0U; i < INPUT_COUNT; i++) {
+		uint8_t* lc = data + i * 12U;
+
+		// Half of them are left with a bad checksum
+		if ((i % 2U) == 0U) {
+			uint8_t parity[4U];
+			CRS129::encode(lc, 9U, parity);
+			lc[9U]  = parity[2U];
+			lc[10U] = parity[1U];
+			lc[11U] = parity[0U];
+		}
+	}
+
+	bench.run("RS129.encode", 9U, [&](unsigned int i) {
+		uint8_t parity[4U];
+		CRS129::encode(data + i * 12U, 9U, parity);
+		bench.consume(parity[0U]);
+	});
+
+	bench.run("RS129.check", 12U, [&](unsigned int i) {
+		bench.consume(CRS129::check(data + i * 12U) ? 1U : 0U);
+	});
+}
+
+static void benchCRC(CBenchmarks& bench)
+{
+	// Long enough for a D-Star header
+	const unsigned int LENGTH = 41U;
+
+	uint8_t data[INPUT_COUNT * LENGTH];
+
+	bench.fill(data, INPUT_COUNT * LENGTH);
+
+	bench.run("CRC.addCCITT161", LENGTH, [&](unsigned int i) {
+		uint8_t buffer[LENGTH];
+		::memcpy(buffer, data + i * LENGTH, LENGTH);
+		CCRC::addCCITT161(buffer, LENGTH);
+		bench.consume(buffer[LENGTH - 1U]);
+	});
+
+	bench.run("CRC.checkCCITT161", LENGTH, [&](unsigned int i) {
+		bench.consume(CCRC::checkCCITT161(data + i * LENGTH, LENGTH) ? 1U : 0U);
+	});
+
+	bench.run("CRC.addCCITT162", 22U, [&](unsigned int i) {
+		uint8_t buffer[22U];
+		::memcpy(buffer, data + i * LENGTH, 22U);
+		CCRC::addCCITT162(buffer, 22U);
+		bench.consume(buffer[21U]);
+	});
+
+	bench.run("CRC.checkCCITT162", 22U, [&](unsigned int i) {
+		bench.consume(CCRC::checkCCITT162(data + i * LENGTH, 22U) ? 1U : 0U);
+	});
+
+	bench.run("CRC.crc8", LENGTH, [&](unsigned int i) {
+		bench.consume(CCRC::crc8(data + i * LENGTH, LENGTH));
+	});
+
+	bench.run("CRC.encodeFiveBit", 9U, [&](unsigned int i) {
+		unsigned int crc;
+		CCRC::encodeFiveBit(data + i * LENGTH, crc);
+		bench.consume(crc);
+	});
+
+	// Random lengths, so that both the slicing by eight and the byte at a time
+	// loops are covered
+	bench.check("CRC.addCCITT161", 100000U, [&](unsigned int) {
+		uint8_t buffer[200U];
+		unsigned int length = 3U + bench.random(198U);
+		bench.fill(buffer, length);
+
+		CCRC::addCCITT161(buffer, length);
+
+		uint16_t crc16 = CCRCReference::createCCITT161(buffer, length - 2U);
+
+		return buffer[length - 2U] == uint8_t(crc16 >> 0) && buffer[length - 1U] == uint8_t(crc16 >> 8);
+	});
+
+	bench.check("CRC.checkCCITT161", 100000U, [&](unsigned int) {
+		uint8_t buffer[200U];
+		unsigned int length = 3U + bench.random(198U);
+		bench.fill(buffer, length);
+
+		uint16_t crc16 = CCRCReference::createCCITT161(buffer, length - 2U);
+		buffer[length - 2U] = uint8_t(crc16 >> 0);
+		buffer[length - 1U] = uint8_t(crc16 >> 8);
+
+		// Any single bit error must be seen
+		bool valid = bench.random(2U) == 0U;
+		if (!valid)
+			bench.corrupt(buffer, length * 8U, 1U);
+
+		return CCRC::checkCCITT161(buffer, length) == valid;
+	});
+
+	bench.check("CRC.addCCITT162", 100000U, [&](unsigned int) {
+		uint8_t buffer[200U];
+		unsigned int length = 3U + bench.random(198U);
+		bench.fill(buffer, length);
+
+		CCRC::addCCITT162(buffer, length);
+
+		uint16_t crc16 = CCRCReference::createCCITT162(buffer, length - 2U);
+
+		return buffer[length - 2U] == uint8_t(crc16 >> 8) && buffer[length - 1U] == uint8_t(crc16 >> 0);
+	});
+
+	bench.check("CRC.checkCCITT162", 100000U, [&](unsigned int) {
+		uint8_t buffer[200U];
+		unsigned int length = 3U + bench.random(198U);
+		bench.fill(buffer, length);
+
+		uint16_t crc16 = CCRCReference::createCCITT162(buffer, length - 2U);
+		buffer[length - 2U] = uint8_t(crc16 >> 8);
+		buffer[length - 1U] = uint8_t(crc16 >> 0);
+
+		bool valid = bench.random(2U) == 0U;
+		if (!valid)
+			bench.corrupt(buffer, length * 8U, 1U);
+
+		return CCRC::checkCCITT162(buffer, length) == valid;
+	});
+
+	// The NXDN lengths are bit counts, the SACCH using 26 and the FACCH1 80
+	const unsigned int NXDN_LENGTHS[] = {26U, 80U};
+
+	auto nxdn = [&](unsigned int bits, void (*encode)(uint8_t*, unsigned int), void (*encodeReference)(uint8_t*, unsigned int),
+					bool (*check)(const uint8_t*, unsigned int), bool (*checkReference)(const uint8_t*, unsigned int)) {
+		unsigned int length = (bench.random(4U) == 0U) ? NXDN_LENGTHS[bench.random(2U)] : 1U + bench.random(200U);
+
+		uint8_t buffer1[30U];
+		bench.fill(buffer1, 30U);
+		uint8_t buffer2[30U];
+		::memcpy(buffer2, buffer1, 30U);
+
+		// A random CRC field first, then the one that was added
+		if (check(buffer1, length) != checkReference(buffer1, length))
+			return false;
+
+		encode(buffer1, length);
+		encodeReference(buffer2, length);
+
+		if (::memcmp(buffer1, buffer2, 30U) != 0)
+			return false;
+
+		if (!check(buffer1, length))
+			return false;
+
+		bench.corrupt(buffer1, length + bits, 1U);
+
+		return check(buffer1, length) == checkReference(buffer1, length);
+	};
+
+	bench.check("NXDNCRC.CRC6", 100000U, [&](unsigned int) {
+		return nxdn(6U, CNXDNCRC::encodeCRC6, CNXDNCRCReference::encodeCRC6, CNXDNCRC::checkCRC6, CNXDNCRCReference::checkCRC6);
+	});
+
+	bench.check("NXDNCRC.CRC12", 100000U, [&](unsigned int) {
+		return nxdn(12U, CNXDNCRC::encodeCRC12, CNXDNCRCReference::encodeCRC12, CNXDNCRC::checkCRC12, CNXDNCRCReference::checkCRC12);
+	});
+
+	bench.check("NXDNCRC.CRC15", 100000U, [&](unsigned int) {
+		return nxdn(15U, CNXDNCRC::encodeCRC15, CNXDNCRCReference::encodeCRC15, CNXDNCRC::checkCRC15, CNXDNCRCReference::checkCRC15);
+	});
+}
+
+int main(int argc, char** argv)
+{
+	std::string filter;
+	if (argc > 1)
+		filter = argv[1];
+
+	CBenchmarks bench(filter);
+
+	benchGolay(bench);
+	benchHamming(bench);
+	benchBPTC(bench);
+	benchDMRLC(bench);
+	benchCopyBits(bench);
+	benchYSF(bench);
+	benchYSFTemplates(bench);
+	benchNXDN(bench);
+	benchViterbi(bench);
+	benchRS129(bench);
+	benchCRC(bench);
+
+	if (bench.getMismatches() > 0U)
+		return 1;
+
+	// Stops the compiler from discarding the results
+	return (bench.getSink() == 0xFFFFFFFFU) ? 1 : 0;
+}
@@ -0,0 +1,571 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+// Runs MMDVM-CrossMode with the given ini file against local stand-ins for
+// the gateways and the transcoder, makes a call in the RF to Net direction
+// for every enabled mode pair, and writes one JSON object per line for each
+// of them with the latency from ingress to egress of every voice frame, the
+// jitter and the loss. Each frame carries its index, which the stand-in
+// transcoder copies into its output, so the frames can be matched on the way
+// out. The stand-in answers at once, so the delay of a real vocoder is not
+// included.
+
+#include "DMRLookup.h"
+#include "UDPSocket.h"
+#include "Traffic.h"
+#include "Defines.h"
+#include "Thread.h"
+#include "Utils.h"
+#include "Conf.h"
+#include "Log.h"
+
+#include <nlohmann/json.hpp>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+
+// The length of each call, in seconds
+const unsigned int DEFAULT_CALL_TIME = 10U;
+
+// How long MMDVM-CrossMode is given to open its connections
+const unsigned int STARTUP_TIME = 2000U;
+
+// How long to wait for the last frames after the end of a call
+const unsigned int TAIL_TIME = 1000U;
+
+// The width of the latency histogram buckets in ms
+const unsigned int BUCKET_WIDTH = 10U;
+
+const unsigned int BUFFER_LENGTH = 2000U;
+
+struct CStandIn {
+	CUDPSocket*      m_socket;
+	sockaddr_storage m_addr;
+	size_t           m_addrLen;
+};
+
+class CLatencyBench {
+public:
+	CLatencyBench(const std::string& file, const std::string& binary, unsigned int callTime) :
+	m_conf(file),
+	m_file(file),
+	m_binary(binary),
+	m_callTime(callTime),
+	m_pairs(),
+	m_rf(),
+	m_net(),
+	m_transcoder(),
+	m_ports(),
+	m_pid(-1),
+	m_traffic(nullptr),
+	m_coder("LatencyBench"),
+	m_pair(nullptr),
+	m_sent(),
+	m_received(),
+	m_latencies(),
+	m_duplicates(0U),
+	m_untagged(0U)
+	{
+		m_transcoder.m_socket = nullptr;
+	}
+
+	~CLatencyBench()
+	{
+		stop();
+
+		close(m_rf);
+		close(m_net);
+
+		if (m_transcoder.m_socket != nullptr) {
+			m_transcoder.m_socket->close();
+			delete m_transcoder.m_socket;
+		}
+
+		delete m_traffic;
+	}
+
+	int run()
+	{
+		// CConf reports the mappings on stdout, which is kept for the results
+		::fflush(stdout);
+		int out = ::dup(STDOUT_FILENO);
+		::dup2(STDERR_FILENO, STDOUT_FILENO);
+
+		bool ret = m_conf.read();
+
+		::fflush(stdout);
+		::dup2(out, STDOUT_FILENO);
+		::close(out);
+
+		if (!ret) {
+			::fprintf(stderr, "LatencyBench: cannot read the .ini file - %s\n", m_file.c_str());
+			return 1;
+		}
+
+		if (m_conf.getTranscoderProtocol() != "udp") {
+			::fprintf(stderr, "LatencyBench: the transcoder protocol must be udp\n");
+			return 1;
+		}
+
+		if (m_conf.getDaemon()) {
+			::fprintf(stderr, "LatencyBench: MMDVM-CrossMode cannot run as a daemon\n");
+			return 1;
+		}
+
+		// Only the results go to stdout
+		::LogInitialise(0U, 0U, 0U);
+
+		CUDPSocket::startup();
+
+		// The DMR and P25 calls are only converted when the source id has a callsign
+		uint32_t dmrId = 0U;
+
+		CDMRLookup lookup;
+		if (lookup.load(m_conf.getDMRLookupFile(), 0U))
+			dmrId = lookup.lookup(m_conf.getCallsign());
+
+		if (dmrId == 0U)
+			dmrId = m_conf.getDMRId();
+
+		m_traffic = new CTraffic(m_conf.getCallsign(), dmrId, m_conf.getNXDNId());
+
+		m_pairs = CTraffic::getPairs(m_conf);
+
+		if (!openTranscoder())
+			return 1;
+
+		openStandIns();
+
+		if (m_pairs.empty()) {
+			::fprintf(stderr, "LatencyBench: no usable mode pairs are enabled\n");
+			return 1;
+		}
+
+		if (!start())
+			return 1;
+
+		for (unsigned int i = 0U; i < m_pairs.size(); i++) {
+			// Let the mode hang from the previous call run out
+			if (i > 0U)
+				pause((m_conf.getRFModeHang() + 1U) * 1000U);
+
+			if (::waitpid(m_pid, nullptr, WNOHANG) == m_pid) {
+				::fprintf(stderr, "LatencyBench: MMDVM-CrossMode has exited\n");
+				m_pid = -1;
+				return 1;
+			}
+
+			runCall(m_pairs.at(i));
+		}
+
+		stop();
+
+		CUDPSocket::shutdown();
+
+		return 0;
+	}
+
+private:
+	CConf        m_conf;
+	std::string  m_file;
+	std::string  m_binary;
+	unsigned int m_callTime;
+	std::vector<CPair>             m_pairs;
+	std::map<DATA_MODE, CStandIn>  m_rf;
+	std::map<DATA_MODE, CStandIn>  m_net;
+	CStandIn     m_transcoder;
+	std::set<std::pair<std::string, uint16_t>> m_ports;
+	pid_t        m_pid;
+	CTraffic*    m_traffic;
+	CTranscoderStandIn m_coder;
+	const CPair* m_pair;
+	std::vector<std::chrono::steady_clock::time_point> m_sent;
+	std::vector<bool>   m_received;
+	std::vector<double> m_latencies;
+	unsigned int m_duplicates;
+	unsigned int m_untagged;
+
+	bool open(CStandIn& standIn, const std::string& bindAddress, uint16_t bindPort, const std::string& sendAddress, uint16_t sendPort)
+	{
+		// The sockets share SO_REUSEADDR, so a clash has to be found here
+		if (!m_ports.insert(std::make_pair(bindAddress, bindPort)).second)
+			return false;
+
+		if (CUDPSocket::lookup(sendAddress, sendPort, standIn.m_addr, standIn.m_addrLen) != 0)
+			return false;
+
+		standIn.m_socket = new CUDPSocket(bindAddress, bindPort);
+		if (!standIn.m_socket->open(standIn.m_addr)) {
+			delete standIn.m_socket;
+			standIn.m_socket = nullptr;
+			return false;
+		}
+
+		return true;
+	}
+
+	bool open(std::map<DATA_MODE, CStandIn>& standIns, DATA_MODE mode, NETWORK network)
+	{
+		if (standIns.count(mode) > 0U)
+			return true;
+
+		std::string bindAddress, sendAddress;
+		uint16_t bindPort = 0U, sendPort = 0U;
+		CTraffic::getAddresses(m_conf, mode, network, bindAddress, bindPort, sendAddress, sendPort);
+
+		CStandIn standIn;
+		if (!open(standIn, bindAddress, bindPort, sendAddress, sendPort)) {
+			::fprintf(stderr, "LatencyBench: cannot open the %s %s stand-in on %s:%u\n", CUtils::getModeName(mode).c_str(), network == NETWORK::RF ? "RF" : "Net", bindAddress.c_str(), bindPort);
+			return false;
+		}
+
+		standIns[mode] = standIn;
+
+		return true;
+	}
+
+	bool openTranscoder()
+	{
+		if (!open(m_transcoder, m_conf.getTranscoderRemoteAddress(), m_conf.getTranscoderRemotePort(), m_conf.getTranscoderLocalAddress(), m_conf.getTranscoderLocalPort())) {
+			::fprintf(stderr, "LatencyBench: cannot open the transcoder stand-in on %s:%u\n", m_conf.getTranscoderRemoteAddress().c_str(), m_conf.getTranscoderRemotePort());
+			return false;
+		}
+
+		return true;
+	}
+
+	// A pair is dropped when either of its stand-ins cannot be opened
+	void openStandIns()
+	{
+		std::vector<CPair> pairs;
+
+		for (const auto& pair : m_pairs) {
+			bool from = open(m_rf, pair.m_from, NETWORK::RF);
+			bool to   = open(m_net, pair.m_to, NETWORK::NET);
+
+			if (from && to)
+				pairs.push_back(pair);
+			else
+				::fprintf(stderr, "LatencyBench: skipping %s to %s\n", CUtils::getModeName(pair.m_from).c_str(), CUtils::getModeName(pair.m_to).c_str());
+		}
+
+		m_pairs = pairs;
+	}
+
+	void close(std::map<DATA_MODE, CStandIn>& standIns)
+	{
+		for (auto& it : standIns) {
+			it.second.m_socket->close();
+			delete it.second.m_socket;
+		}
+
+		standIns.clear();
+	}
+
+	bool start()
+	{
+		m_pid = ::fork();
+		if (m_pid == -1) {
+			::fprintf(stderr, "LatencyBench: cannot fork()\n");
+			return false;
+		}
+
+		if (m_pid == 0) {
+			// Keep the log out of the results
+			::dup2(STDERR_FILENO, STDOUT_FILENO);
+
+			::execl(m_binary.c_str(), m_binary.c_str(), m_file.c_str(), (char*)nullptr);
+
+			::fprintf(stderr, "LatencyBench: cannot run %s\n", m_binary.c_str());
+			::_exit(1);
+		}
+
+		// The transcoder is queried as it starts up
+		pause(STARTUP_TIME);
+
+		if (::waitpid(m_pid, nullptr, WNOHANG) == m_pid) {
+			::fprintf(stderr, "LatencyBench: MMDVM-CrossMode failed to start\n");
+			m_pid = -1;
+			return false;
+		}
+
+		return true;
+	}
+
+	void stop()
+	{
+		if (m_pid <= 0)
+			return;
+
+		::kill(m_pid, SIGTERM);
+		::waitpid(m_pid, nullptr, 0);
+
+		m_pid = -1;
+	}
+
+	void pause(unsigned int ms)
+	{
+		auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+
+		while (std::chrono::steady_clock::now() < end) {
+			service();
+			CThread::sleep(1U);
+		}
+	}
+
+	void service()
+	{
+		uint8_t buffer[BUFFER_LENGTH];
+		sockaddr_storage address;
+		size_t addrLen;
+		int length;
+
+		while ((length = m_transcoder.m_socket->read(buffer, BUFFER_LENGTH, address, addrLen)) > 0)
+			transcode(buffer, length);
+
+		// Polls and pings from MMDVM-CrossMode
+		for (auto& it : m_rf) {
+			while (it.second.m_socket->read(buffer, BUFFER_LENGTH, address, addrLen) > 0)
+				;
+		}
+
+		for (auto& it : m_net) {
+			while ((length = it.second.m_socket->read(buffer, BUFFER_LENGTH, address, addrLen)) > 0) {
+				if ((m_pair != nullptr) && (it.first == m_pair->m_to))
+					receive(buffer, length);
+			}
+		}
+	}
+
+	// The stand-in transcoder answers every message at once
+	void transcode(const uint8_t* buffer, int length)
+	{
+		int pos = 0;
+
+		for (;;) {
+			uint8_t out[BUFFER_LENGTH];
+			uint16_t outLen = 0U;
+
+			uint16_t len = m_coder.reply(buffer + pos, length - pos, out, outLen);
+			if (len == 0U)
+				return;
+
+			m_transcoder.m_socket->write(out, outLen, m_transcoder.m_addr, m_transcoder.m_addrLen);
+
+			pos += len;
+		}
+	}
+
+	// Sends the header (start), a packet of voice frames, or the end of the call
+	void writePacket(const CPair& pair, const uint8_t* frames, unsigned int index, bool start, bool end)
+	{
+		uint8_t buffer[BUFFER_LENGTH];
+		unsigned int length = m_traffic->write(pair, frames, index, start, end, buffer);
+		if (length == 0U)
+			return;
+
+		const CStandIn& standIn = m_rf.at(pair.m_from);
+
+		standIn.m_socket->write(buffer, length, standIn.m_addr, standIn.m_addrLen);
+	}
+
+	void receive(const uint8_t* buffer, int length)
+	{
+		auto now = std::chrono::steady_clock::now();
+
+		uint8_t frames[BUFFER_LENGTH];
+		unsigned int count = CTraffic::getFrames(m_pair->m_to, buffer, length, frames);
+
+		uint16_t frameLength = CTraffic::getFrameLength(m_pair->m_to);
+
+		for (unsigned int i = 0U; i < count; i++) {
+			const uint8_t* frame = frames + i * frameLength;
+
+			// Concealment and silence carry no tag
+			unsigned int index;
+			if (!CTraffic::getIndex(frame, index) || (index >= m_sent.size())) {
+				m_untagged++;
+				continue;
+			}
+
+			// A lost frame may be replaced by a repeat of the one before
+			if (m_received.at(index)) {
+				m_duplicates++;
+				continue;
+			}
+
+			m_received.at(index) = true;
+
+			m_latencies.push_back(std::chrono::duration<double, std::milli>(now - m_sent.at(index)).count());
+		}
+	}
+
+	void runCall(const CPair& pair)
+	{
+		::fprintf(stderr, "LatencyBench: %s to %s\n", CUtils::getModeName(pair.m_from).c_str(), CUtils::getModeName(pair.m_to).c_str());
+
+		m_sent.clear();
+		m_received.clear();
+		m_latencies.clear();
+		m_duplicates = 0U;
+		m_untagged   = 0U;
+
+		m_traffic->start(uint32_t(::rand() % 0xFFFEU) + 1U);
+
+		m_pair = &pair;
+
+		unsigned int count, period;
+		CTraffic::getCadence(pair.m_from, count, period);
+
+		uint16_t frameLength = CTraffic::getFrameLength(pair.m_from);
+
+		auto start = std::chrono::steady_clock::now();
+
+		writePacket(pair, nullptr, 0U, true, false);
+
+		unsigned int packets = (m_callTime * 1000U) / period;
+
+		for (unsigned int n = 1U; n <= packets; n++) {
+			auto due = start + std::chrono::milliseconds(n * period);
+			while (std::chrono::steady_clock::now() < due) {
+				service();
+				CThread::sleep(1U);
+			}
+
+			uint8_t frames[BUFFER_LENGTH];
+
+			unsigned int index = m_sent.size();
+			for (unsigned int i = 0U; i < count; i++)
+				CTraffic::createFrame(pair.m_from, frames + i * frameLength, index + i);
+
+			writePacket(pair, frames, index, false, false);
+
+			auto now = std::chrono::steady_clock::now();
+			for (unsigned int i = 0U; i < count; i++) {
+				m_sent.push_back(now);
+				m_received.push_back(false);
+			}
+		}
+
+		pause(period);
+
+		writePacket(pair, nullptr, m_sent.size(), false, true);
+
+		pause(TAIL_TIME);
+
+		m_pair = nullptr;
+
+		report(pair);
+	}
+
+	static double getPercentile(const std::vector<double>& sorted, double percentile)
+	{
+		// The nearest rank
+		size_t rank = size_t(percentile * double(sorted.size()) + 0.999999);
+		if (rank < 1U)
+			rank = 1U;
+		if (rank > sorted.size())
+			rank = sorted.size();
+
+		return sorted.at(rank - 1U);
+	}
+
+	void report(const CPair& pair) const
+	{
+		nlohmann::json json;
+		json["from"]       = CUtils::getModeName(pair.m_from);
+		json["to"]         = CUtils::getModeName(pair.m_to);
+		json["sent"]       = m_sent.size();
+		json["received"]   = m_latencies.size();
+		json["lost"]       = m_sent.size() - m_latencies.size();
+		json["duplicated"] = m_duplicates;
+		json["untagged"]   = m_untagged;
+
+		if (!m_latencies.empty()) {
+			std::vector<double> sorted = m_latencies;
+			std::sort(sorted.begin(), sorted.end());
+
+			double total  = 0.0;
+			double jitter = 0.0;
+			for (size_t i = 0U; i < m_latencies.size(); i++) {
+				total += m_latencies.at(i);
+				if (i > 0U)
+					jitter += std::abs(m_latencies.at(i) - m_latencies.at(i - 1U));
+			}
+
+			json["latency_ms"]["p50"]  = getPercentile(sorted, 0.50);
+			json["latency_ms"]["p99"]  = getPercentile(sorted, 0.99);
+			json["latency_ms"]["max"]  = sorted.back();
+			json["latency_ms"]["mean"] = total / double(sorted.size());
+
+			// The mean change in latency from one frame to the next
+			json["jitter_ms"] = (sorted.size() > 1U) ? jitter / double(sorted.size() - 1U) : 0.0;
+
+			std::map<unsigned int, unsigned int> buckets;
+			for (double latency : sorted)
+				buckets[(unsigned int)(latency / double(BUCKET_WIDTH)) + 1U]++;
+
+			nlohmann::json histogram = nlohmann::json::array();
+			for (const auto& it : buckets) {
+				nlohmann::json bucket;
+				bucket["le_ms"] = it.first * BUCKET_WIDTH;
+				bucket["count"] = it.second;
+				histogram.push_back(bucket);
+			}
+
+			json["histogram"] = histogram;
+		}
+
+		std::cout << json.dump() << std::endl;
+	}
+};
+
+int main(int argc, char** argv)
+{
+	if (argc < 2) {
+		::fprintf(stderr, "Usage: LatencyBench <ini file> [MMDVM-CrossMode binary] [call seconds]\n");
+		return 1;
+	}
+
+	std::string file   = argv[1];
+	std::string binary = (argc > 2) ? argv[2] : "./MMDVM-CrossMode";
+
+	unsigned int callTime = DEFAULT_CALL_TIME;
+	if (argc > 3)
+		callTime = (unsigned int)::atoi(argv[3]);
+
+	if (callTime == 0U)
+		callTime = DEFAULT_CALL_TIME;
+
+	CLatencyBench bench(file, binary, callTime);
+
+	return bench.run();
+}
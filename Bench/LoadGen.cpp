@@ -0,0 +1,1383 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+// Runs a number of copies of MMDVM-CrossMode, each one a repeater with the
+// ports in the given ini file moved up by a fixed amount, and a talker for
+// each of them that makes call after call from RF to Net in the wire format
+// of the source mode. The mode pair of each call is picked from those that are
+// enabled, evenly or with a Zipf distribution, and the voice packets can be
+// lost, reordered and delayed on their way in. The repeaters are brought in
+// a step at a time, and at the end of each step one line of JSON gives the
+// throughput, loss and latency of the frames sent during it, and whether it
+// was within the latency budget and loss limit. The last line gives the
+// largest step that was, and the first that was not.
+//
+// The transcoder stand-ins share a pool of vocoders that each take a fixed
+// time per frame, so that the size of a real transcoder pool can be tried. By
+// default they answer at once.
+
+#include "TranscoderDefines.h"
+#include "DMRLookup.h"
+#include "UDPSocket.h"
+#include "Traffic.h"
+#include "Defines.h"
+#include "Thread.h"
+#include "Utils.h"
+#include "Conf.h"
+#include "Log.h"
+
+#include <nlohmann/json.hpp>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <deque>
+#include <map>
+#include <set>
+
+typedef std::chrono::steady_clock::time_point TIME;
+
+// How long the copies of MMDVM-CrossMode are given to open their connections
+const unsigned int STARTUP_TIME = 2000U;
+
+// How long to wait for the last frames sent in a step before reporting on it
+const unsigned int TAIL_TIME = 2000U;
+
+// The p99 latency budget when the ini file has none
+const unsigned int DEFAULT_BUDGET = 500U;
+
+const unsigned int BUFFER_LENGTH = 2000U;
+
+// The frames of each repeater that are remembered, about 20 minutes of any mode
+const unsigned int SENT_LENGTH = 65536U;
+
+// The frame index carried in the tag
+const unsigned int INDEX_MASK = 0xFFFFFFU;
+
+// The latency histograms have 0.1 ms buckets up to 10 s
+const unsigned int BUCKETS_PER_MS = 10U;
+const unsigned int BUCKET_COUNT   = 10000U * BUCKETS_PER_MS;
+
+struct CLoadOptions {
+	unsigned int m_repeaters;	// The most that are run
+	unsigned int m_step;		// Those added each step
+	unsigned int m_stepTime;	// In seconds
+	unsigned int m_callTime;	// The mean, in seconds
+	unsigned int m_gapTime;		// The mean between calls after the mode hang, in seconds
+	double       m_zipf;		// The exponent for the mode pairs, 0 for even
+	double       m_loss;		// The chance of each voice packet being lost, in %
+	double       m_reorder;		// The chance of each one being late by a packet, in %
+	unsigned int m_jitter;		// The most by which each one is delayed, in ms
+	unsigned int m_vocoders;	// In the transcoder pool, 0 for as many as are needed
+	double       m_vocoderTime;	// For each frame, in ms
+	unsigned int m_budget;		// For the p99 latency, in ms
+	double       m_maxLoss;		// In %
+	std::string  m_binary;
+};
+
+class CHistogram {
+public:
+	CHistogram() :
+	m_buckets(BUCKET_COUNT + 1U, 0U),
+	m_count(0U),
+	m_total(0.0),
+	m_max(0.0)
+	{
+	}
+
+	void add(double ms)
+	{
+		unsigned int bucket = (unsigned int)(ms * double(BUCKETS_PER_MS));
+		if (bucket > BUCKET_COUNT)
+			bucket = BUCKET_COUNT;
+
+		m_buckets.at(bucket)++;
+		m_count++;
+		m_total += ms;
+		if (ms > m_max)
+			m_max = ms;
+	}
+
+	uint64_t getCount() const
+	{
+		return m_count;
+	}
+
+	// The nearest rank, as the top of its bucket
+	double getPercentile(double percentile) const
+	{
+		uint64_t rank = uint64_t(percentile * double(m_count) + 0.999999);
+		if (rank < 1U)
+			rank = 1U;
+
+		uint64_t count = 0U;
+		for (unsigned int i = 0U; i < BUCKET_COUNT; i++) {
+			count += m_buckets.at(i);
+			if (count >= rank)
+				return std::min(double(i + 1U) / double(BUCKETS_PER_MS), m_max);
+		}
+
+		return m_max;
+	}
+
+	nlohmann::json toJSON() const
+	{
+		nlohmann::json json;
+		json["p50"]  = getPercentile(0.50);
+		json["p99"]  = getPercentile(0.99);
+		json["max"]  = m_max;
+		json["mean"] = (m_count > 0U) ? m_total / double(m_count) : 0.0;
+
+		return json;
+	}
+
+private:
+	std::vector<uint32_t> m_buckets;
+	uint64_t m_count;
+	double   m_total;
+	double   m_max;
+};
+
+struct CStep {
+	CStep() :
+	m_repeaters(0U),
+	m_start(),
+	m_end(),
+	m_calls(0U),
+	m_packetsIn(0U),
+	m_packetsOut(0U),
+	m_sent(0U),
+	m_dropped(0U),
+	m_received(0U),
+	m_duplicates(0U),
+	m_untagged(0U),
+	m_conversions(0U),
+	m_latency(),
+	m_wait()
+	{
+	}
+
+	unsigned int m_repeaters;
+	TIME         m_start;
+	TIME         m_end;
+	uint64_t     m_calls;
+	uint64_t     m_packetsIn;
+	uint64_t     m_packetsOut;
+	uint64_t     m_sent;
+	uint64_t     m_dropped;
+	uint64_t     m_received;
+	uint64_t     m_duplicates;
+	uint64_t     m_untagged;
+	uint64_t     m_conversions;
+	CHistogram   m_latency;
+	CHistogram   m_wait;		// For a vocoder
+};
+
+// The results of every step that has yet to be reported. Those about the
+// frames sent go to the step they were sent in, the rest to the current one.
+class CLoadStats {
+public:
+	CLoadStats() :
+	m_mutex(),
+	m_steps(),
+	m_current(0U)
+	{
+	}
+
+	void startStep(unsigned int n, unsigned int repeaters)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (m_steps.count(m_current) > 0U)
+			m_steps[m_current].m_end = std::chrono::steady_clock::now();
+
+		CStep& step = m_steps[n];
+		step = CStep();
+		step.m_repeaters = repeaters;
+		step.m_start = std::chrono::steady_clock::now();
+
+		m_current = n;
+	}
+
+	void endStep()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (m_steps.count(m_current) > 0U)
+			m_steps[m_current].m_end = std::chrono::steady_clock::now();
+	}
+
+	// Removes the step, so that anything that arrives for it later is ignored
+	bool takeStep(unsigned int n, CStep& step)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto it = m_steps.find(n);
+		if (it == m_steps.end())
+			return false;
+
+		step = it->second;
+		m_steps.erase(it);
+
+		return true;
+	}
+
+	void addCall()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		current().m_calls++;
+	}
+
+	// Returns the step the frames are counted in
+	unsigned int addSent(unsigned int frames)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		CStep& step = current();
+		step.m_packetsIn++;
+		step.m_sent += frames;
+
+		return m_current;
+	}
+
+	void addDropped(unsigned int frames)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		current().m_dropped += frames;
+	}
+
+	void addPacketOut()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		current().m_packetsOut++;
+	}
+
+	void addReceived(unsigned int n, double latency)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto it = m_steps.find(n);
+		if (it == m_steps.end())
+			return;
+
+		it->second.m_received++;
+		it->second.m_latency.add(latency);
+	}
+
+	void addDuplicate()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		current().m_duplicates++;
+	}
+
+	void addUntagged()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		current().m_untagged++;
+	}
+
+	void addConversion(double wait)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		CStep& step = current();
+		step.m_conversions++;
+		step.m_wait.add(wait);
+	}
+
+private:
+	std::mutex   m_mutex;
+	std::map<unsigned int, CStep> m_steps;
+	unsigned int m_current;
+
+	CStep& current()
+	{
+		return m_steps[m_current];
+	}
+};
+
+// The vocoders shared by all of the transcoder stand-ins, each one taking the
+// frames in turn
+class CVocoderPool {
+public:
+	CVocoderPool(unsigned int vocoders, double time) :
+	m_mutex(),
+	m_free(vocoders, std::chrono::steady_clock::now()),
+	m_time(std::chrono::nanoseconds(uint64_t(time * 1000000.0)))
+	{
+	}
+
+	// When a frame asked for now will have been converted
+	TIME schedule(TIME now)
+	{
+		if (m_free.empty())
+			return now;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto it = std::min_element(m_free.begin(), m_free.end());
+
+		TIME start = std::max(*it, now);
+		*it = start + m_time;
+
+		return *it;
+	}
+
+private:
+	std::mutex                m_mutex;
+	std::vector<TIME>         m_free;
+	std::chrono::nanoseconds  m_time;
+};
+
+struct CStandIn {
+	CUDPSocket*      m_socket;
+	sockaddr_storage m_addr;
+	size_t           m_addrLen;
+};
+
+struct CSent {
+	uint32_t     m_index;
+	TIME         m_time;
+	unsigned int m_step;
+	bool         m_valid;
+	bool         m_received;
+};
+
+struct CPacket {
+	DATA_MODE            m_mode;
+	std::vector<uint8_t> m_data;
+	uint32_t             m_index;
+	unsigned int         m_frames;	// Zero for the header and the end
+};
+
+struct CReply {
+	TIME                 m_due;
+	TIME                 m_asked;
+	std::vector<uint8_t> m_data;
+	bool                 m_converted;
+};
+
+// A copy of MMDVM-CrossMode, the stand-ins for its gateways and transcoder,
+// and the talker that makes calls through it
+class CRepeater : public CThread {
+public:
+	CRepeater(unsigned int n, unsigned int offset, const CConf& conf, const CLoadOptions& options, const std::vector<CPair>& pairs, uint32_t dmrId, CLoadStats& stats, CVocoderPool& pool) :
+	CThread(),
+	m_n(n),
+	m_offset(offset),
+	m_conf(conf),
+	m_options(options),
+	m_pairs(pairs),
+	m_weights(),
+	m_stats(stats),
+	m_pool(pool),
+	m_traffic(conf.getCallsign(), dmrId, conf.getNXDNId()),
+	m_coder("LoadGen"),
+	m_rf(),
+	m_net(),
+	m_transcoder(),
+	m_ports(),
+	m_pid(-1),
+	m_random(n + 1U),
+	m_active(false),
+	m_running(false),
+	m_idle(true),
+	m_sent(SENT_LENGTH),
+	m_queue(),
+	m_replies(),
+	m_lastReply(),
+	m_index(0U),
+	m_pair(nullptr),
+	m_inCall(false),
+	m_packets(0U),
+	m_packet(0U),
+	m_nextPacket(),
+	m_nextCall()
+	{
+		m_transcoder.m_socket = nullptr;
+
+		// The pairs are ranked in the order that they are listed in the ini file
+		double total = 0.0;
+		for (unsigned int i = 0U; i < m_pairs.size(); i++) {
+			total += 1.0 / std::pow(double(i + 1U), m_options.m_zipf);
+			m_weights.push_back(total);
+		}
+	}
+
+	virtual ~CRepeater()
+	{
+		close(m_rf);
+		close(m_net);
+
+		if (m_transcoder.m_socket != nullptr) {
+			m_transcoder.m_socket->close();
+			delete m_transcoder.m_socket;
+		}
+	}
+
+	bool open()
+	{
+		if (!open(m_transcoder, m_conf.getTranscoderRemoteAddress(), m_conf.getTranscoderRemotePort(), m_conf.getTranscoderLocalAddress(), m_conf.getTranscoderLocalPort())) {
+			::fprintf(stderr, "LoadGen: cannot open the transcoder stand-in of repeater %u\n", m_n);
+			return false;
+		}
+
+		for (const auto& pair : m_pairs) {
+			if (!open(m_rf, pair.m_from, NETWORK::RF) || !open(m_net, pair.m_to, NETWORK::NET))
+				return false;
+		}
+
+		return true;
+	}
+
+	bool start(const std::string& binary, const std::string& file)
+	{
+		m_pid = ::fork();
+		if (m_pid == -1) {
+			::fprintf(stderr, "LoadGen: cannot fork()\n");
+			return false;
+		}
+
+		if (m_pid == 0) {
+			// Keep the logs of all of the copies out of the way
+			int fd = ::open("/dev/null", O_WRONLY);
+			if (fd != -1)
+				::dup2(fd, STDOUT_FILENO);
+
+			::execl(binary.c_str(), binary.c_str(), file.c_str(), (char*)nullptr);
+
+			::fprintf(stderr, "LoadGen: cannot run %s\n", binary.c_str());
+			::_exit(1);
+		}
+
+		return true;
+	}
+
+	void stop()
+	{
+		if (m_pid <= 0)
+			return;
+
+		::kill(m_pid, SIGTERM);
+		::waitpid(m_pid, nullptr, 0);
+
+		m_pid = -1;
+	}
+
+	bool hasExited()
+	{
+		if (m_pid <= 0)
+			return true;
+
+		int status = 0;
+		if (::waitpid(m_pid, &status, WNOHANG) == m_pid) {
+			if (WIFSIGNALED(status))
+				::fprintf(stderr, "LoadGen: MMDVM-CrossMode of repeater %u was killed by signal %d\n", m_n, WTERMSIG(status));
+			else
+				::fprintf(stderr, "LoadGen: MMDVM-CrossMode of repeater %u has exited with %d\n", m_n, WEXITSTATUS(status));
+
+			m_pid = -1;
+			return true;
+		}
+
+		return false;
+	}
+
+	// An inactive talker finishes the call it is in, if any
+	void setActive(bool active)
+	{
+		m_active.store(active);
+	}
+
+	bool isIdle() const
+	{
+		return m_idle.load();
+	}
+
+	void setRunning(bool running)
+	{
+		m_running.store(running);
+	}
+
+	virtual void entry()
+	{
+		// Each one starts at a different time
+		m_nextCall = std::chrono::steady_clock::now() + getGap();
+
+		while (m_running.load()) {
+			TIME now = std::chrono::steady_clock::now();
+
+			service(now);
+			reply(now);
+			talk(now);
+			send(now);
+
+			m_idle.store(!m_inCall && m_queue.empty());
+
+			CThread::sleep(1U);
+		}
+	}
+
+private:
+	unsigned int        m_n;
+	unsigned int        m_offset;
+	const CConf&        m_conf;
+	const CLoadOptions& m_options;
+	std::vector<CPair>  m_pairs;
+	std::vector<double> m_weights;
+	CLoadStats&         m_stats;
+	CVocoderPool&       m_pool;
+	CTraffic            m_traffic;
+	CTranscoderStandIn  m_coder;
+	std::map<DATA_MODE, CStandIn> m_rf;
+	std::map<DATA_MODE, CStandIn> m_net;
+	CStandIn            m_transcoder;
+	std::set<std::pair<std::string, uint16_t>> m_ports;
+	pid_t               m_pid;
+	std::mt19937        m_random;
+	std::atomic<bool>   m_active;
+	std::atomic<bool>   m_running;
+	std::atomic<bool>   m_idle;
+	std::vector<CSent>  m_sent;
+	std::multimap<TIME, CPacket> m_queue;
+	std::deque<CReply>  m_replies;
+	TIME                m_lastReply;
+	uint32_t            m_index;
+	const CPair*        m_pair;
+	bool                m_inCall;
+	unsigned int        m_packets;
+	unsigned int        m_packet;
+	TIME                m_nextPacket;
+	TIME                m_nextCall;
+
+	bool open(CStandIn& standIn, const std::string& bindAddress, uint16_t bindPort, const std::string& sendAddress, uint16_t sendPort)
+	{
+		bindPort += m_offset;
+		sendPort += m_offset;
+
+		// The sockets share SO_REUSEADDR, so a clash has to be found here
+		if (!m_ports.insert(std::make_pair(bindAddress, bindPort)).second)
+			return false;
+
+		if (CUDPSocket::lookup(sendAddress, sendPort, standIn.m_addr, standIn.m_addrLen) != 0)
+			return false;
+
+		standIn.m_socket = new CUDPSocket(bindAddress, bindPort);
+		if (!standIn.m_socket->open(standIn.m_addr)) {
+			delete standIn.m_socket;
+			standIn.m_socket = nullptr;
+			return false;
+		}
+
+		return true;
+	}
+
+	bool open(std::map<DATA_MODE, CStandIn>& standIns, DATA_MODE mode, NETWORK network)
+	{
+		if (standIns.count(mode) > 0U)
+			return true;
+
+		std::string bindAddress, sendAddress;
+		uint16_t bindPort = 0U, sendPort = 0U;
+		CTraffic::getAddresses(m_conf, mode, network, bindAddress, bindPort, sendAddress, sendPort);
+
+		CStandIn standIn;
+		if (!open(standIn, bindAddress, bindPort, sendAddress, sendPort)) {
+			::fprintf(stderr, "LoadGen: cannot open the %s %s stand-in of repeater %u on %s:%u\n", CUtils::getModeName(mode).c_str(), network == NETWORK::RF ? "RF" : "Net", m_n, bindAddress.c_str(), bindPort + m_offset);
+			return false;
+		}
+
+		standIns[mode] = standIn;
+
+		return true;
+	}
+
+	void close(std::map<DATA_MODE, CStandIn>& standIns)
+	{
+		for (auto& it : standIns) {
+			it.second.m_socket->close();
+			delete it.second.m_socket;
+		}
+
+		standIns.clear();
+	}
+
+	std::chrono::milliseconds getGap()
+	{
+		std::exponential_distribution<double> gap(1.0 / double(m_options.m_gapTime * 1000U + 1U));
+
+		// Let the mode hang from the previous call run out
+		return std::chrono::milliseconds((m_conf.getRFModeHang() + 1U) * 1000U + (unsigned int)gap(m_random));
+	}
+
+	bool chance(double percent)
+	{
+		std::uniform_real_distribution<double> value(0.0, 100.0);
+
+		return value(m_random) < percent;
+	}
+
+	void service(TIME now)
+	{
+		uint8_t buffer[BUFFER_LENGTH];
+		sockaddr_storage address;
+		size_t addrLen;
+		int length;
+
+		while ((length = m_transcoder.m_socket->read(buffer, BUFFER_LENGTH, address, addrLen)) > 0)
+			transcode(now, buffer, length);
+
+		// Polls and pings from MMDVM-CrossMode
+		for (auto& it : m_rf) {
+			while (it.second.m_socket->read(buffer, BUFFER_LENGTH, address, addrLen) > 0)
+				;
+		}
+
+		for (auto& it : m_net) {
+			while ((length = it.second.m_socket->read(buffer, BUFFER_LENGTH, address, addrLen)) > 0)
+				receive(now, it.first, buffer, length);
+		}
+	}
+
+	// The replies go back in the order they were asked for, the frames once
+	// a vocoder has converted them
+	void transcode(TIME now, const uint8_t* buffer, int length)
+	{
+		int pos = 0;
+
+		for (;;) {
+			uint8_t out[BUFFER_LENGTH];
+			uint16_t outLen = 0U;
+
+			uint16_t len = m_coder.reply(buffer + pos, length - pos, out, outLen);
+			if (len == 0U)
+				return;
+
+			CReply reply;
+			reply.m_asked     = now;
+			reply.m_converted = out[TYPE_POS] == TYPE_DATA;
+			reply.m_due       = reply.m_converted ? m_pool.schedule(now) : now;
+			reply.m_data.assign(out, out + outLen);
+
+			m_lastReply  = std::max(m_lastReply, reply.m_due);
+			reply.m_due  = m_lastReply;
+
+			m_replies.push_back(reply);
+
+			pos += len;
+		}
+	}
+
+	void reply(TIME now)
+	{
+		while (!m_replies.empty() && (m_replies.front().m_due <= now)) {
+			const CReply& reply = m_replies.front();
+
+			m_transcoder.m_socket->write(reply.m_data.data(), reply.m_data.size(), m_transcoder.m_addr, m_transcoder.m_addrLen);
+
+			if (reply.m_converted)
+				m_stats.addConversion(std::chrono::duration<double, std::milli>(now - reply.m_asked).count());
+
+			m_replies.pop_front();
+		}
+	}
+
+	void receive(TIME now, DATA_MODE mode, const uint8_t* buffer, int length)
+	{
+		m_stats.addPacketOut();
+
+		uint8_t frames[BUFFER_LENGTH];
+		unsigned int count = CTraffic::getFrames(mode, buffer, length, frames);
+
+		uint16_t frameLength = CTraffic::getFrameLength(mode);
+
+		for (unsigned int i = 0U; i < count; i++) {
+			// Concealment and silence carry no tag, and a frame can be from so far back it's been forgotten
+			unsigned int index;
+			if (!CTraffic::getIndex(frames + i * frameLength, index)) {
+				m_stats.addUntagged();
+				continue;
+			}
+
+			CSent& sent = m_sent.at(index % SENT_LENGTH);
+			if (!sent.m_valid || (sent.m_index != index)) {
+				m_stats.addUntagged();
+				continue;
+			}
+
+			// A lost frame may be replaced by a repeat of the one before
+			if (sent.m_received) {
+				m_stats.addDuplicate();
+				continue;
+			}
+
+			sent.m_received = true;
+
+			m_stats.addReceived(sent.m_step, std::chrono::duration<double, std::milli>(now - sent.m_time).count());
+		}
+	}
+
+	void talk(TIME now)
+	{
+		if (!m_inCall) {
+			if (!m_active.load() || m_pairs.empty() || (now < m_nextCall))
+				return;
+
+			startCall(now);
+		}
+
+		unsigned int count, period;
+		CTraffic::getCadence(m_pair->m_from, count, period);
+
+		uint16_t frameLength = CTraffic::getFrameLength(m_pair->m_from);
+
+		while (m_inCall && (now >= m_nextPacket)) {
+			uint8_t frames[BUFFER_LENGTH];
+			for (unsigned int i = 0U; i < count; i++)
+				CTraffic::createFrame(m_pair->m_from, frames + i * frameLength, (m_index + i) & INDEX_MASK);
+
+			CPacket packet;
+			packet.m_mode   = m_pair->m_from;
+			packet.m_index  = m_index;
+			packet.m_frames = count;
+
+			uint8_t buffer[BUFFER_LENGTH];
+			unsigned int length = m_traffic.write(*m_pair, frames, m_packet * count, false, false, buffer);
+			packet.m_data.assign(buffer, buffer + length);
+
+			m_index = (m_index + count) & INDEX_MASK;
+
+			if (chance(m_options.m_loss)) {
+				m_stats.addDropped(count);
+			} else {
+				TIME due = m_nextPacket;
+
+				if (m_options.m_jitter > 0U) {
+					std::uniform_int_distribution<unsigned int> jitter(0U, m_options.m_jitter * 1000U);
+					due += std::chrono::microseconds(jitter(m_random));
+				}
+
+				// Late enough to arrive after the next one
+				if (chance(m_options.m_reorder))
+					due += std::chrono::milliseconds(period);
+
+				m_queue.insert(std::make_pair(due, packet));
+			}
+
+			m_packet++;
+			m_nextPacket += std::chrono::milliseconds(period);
+
+			if (m_packet >= m_packets)
+				endCall();
+		}
+	}
+
+	void startCall(TIME now)
+	{
+		std::uniform_real_distribution<double> pick(0.0, m_weights.back());
+		size_t n = std::upper_bound(m_weights.begin(), m_weights.end(), pick(m_random)) - m_weights.begin();
+		m_pair = &m_pairs.at(std::min(n, m_pairs.size() - 1U));
+
+		std::uniform_int_distribution<uint32_t> streamId(1U, 0xFFFEU);
+		m_traffic.start(streamId(m_random));
+
+		unsigned int count, period;
+		CTraffic::getCadence(m_pair->m_from, count, period);
+
+		// Between half and one and a half times the mean
+		std::uniform_int_distribution<unsigned int> callTime(m_options.m_callTime * 500U, m_options.m_callTime * 1500U);
+		m_packets = std::max(callTime(m_random) / period, 1U);
+		m_packet  = 0U;
+
+		CPacket packet;
+		packet.m_mode   = m_pair->m_from;
+		packet.m_index  = 0U;
+		packet.m_frames = 0U;
+
+		uint8_t buffer[BUFFER_LENGTH];
+		unsigned int length = m_traffic.write(*m_pair, nullptr, 0U, true, false, buffer);
+		packet.m_data.assign(buffer, buffer + length);
+
+		if (length > 0U)
+			m_queue.insert(std::make_pair(now, packet));
+
+		m_nextPacket = now + std::chrono::milliseconds(period);
+		m_inCall     = true;
+
+		m_stats.addCall();
+	}
+
+	void endCall()
+	{
+		unsigned int count, period;
+		CTraffic::getCadence(m_pair->m_from, count, period);
+
+		CPacket packet;
+		packet.m_mode   = m_pair->m_from;
+		packet.m_index  = 0U;
+		packet.m_frames = 0U;
+
+		uint8_t buffer[BUFFER_LENGTH];
+		unsigned int length = m_traffic.write(*m_pair, nullptr, m_packet * count, false, true, buffer);
+		packet.m_data.assign(buffer, buffer + length);
+
+		// After every voice packet, however late
+		TIME due = m_nextPacket;
+		if (!m_queue.empty())
+			due = std::max(due, m_queue.rbegin()->first + std::chrono::milliseconds(1));
+
+		m_queue.insert(std::make_pair(due, packet));
+
+		m_nextCall = due + getGap();
+		m_inCall   = false;
+	}
+
+	void send(TIME now)
+	{
+		while (!m_queue.empty() && (m_queue.begin()->first <= now)) {
+			const CPacket& packet = m_queue.begin()->second;
+
+			const CStandIn& standIn = m_rf.at(packet.m_mode);
+			standIn.m_socket->write(packet.m_data.data(), packet.m_data.size(), standIn.m_addr, standIn.m_addrLen);
+
+			unsigned int step = m_stats.addSent(packet.m_frames);
+
+			TIME sent = std::chrono::steady_clock::now();
+			for (unsigned int i = 0U; i < packet.m_frames; i++) {
+				uint32_t index = (packet.m_index + i) & INDEX_MASK;
+
+				CSent& entry = m_sent.at(index % SENT_LENGTH);
+				entry.m_index    = index;
+				entry.m_time     = sent;
+				entry.m_step     = step;
+				entry.m_valid    = true;
+				entry.m_received = false;
+			}
+
+			m_queue.erase(m_queue.begin());
+		}
+	}
+};
+
+class CLoadGen {
+public:
+	CLoadGen(const std::string& file, const CLoadOptions& options) :
+	m_conf(file),
+	m_file(file),
+	m_options(options),
+	m_stats(),
+	m_pool(options.m_vocoders, options.m_vocoderTime),
+	m_repeaters(),
+	m_directory(),
+	m_files(),
+	m_sustained(),
+	m_breakdown()
+	{
+	}
+
+	~CLoadGen()
+	{
+		for (CRepeater* repeater : m_repeaters) {
+			repeater->stop();
+			repeater->setRunning(false);
+			repeater->wait();
+			delete repeater;
+		}
+
+		for (const std::string& file : m_files)
+			::unlink(file.c_str());
+
+		if (!m_directory.empty())
+			::rmdir(m_directory.c_str());
+	}
+
+	int run()
+	{
+		// CConf reports the mappings on stdout, which is kept for the results
+		::fflush(stdout);
+		int out = ::dup(STDOUT_FILENO);
+		::dup2(STDERR_FILENO, STDOUT_FILENO);
+
+		bool ret = m_conf.read();
+
+		::fflush(stdout);
+		::dup2(out, STDOUT_FILENO);
+		::close(out);
+
+		if (!ret) {
+			::fprintf(stderr, "LoadGen: cannot read the .ini file - %s\n", m_file.c_str());
+			return 1;
+		}
+
+		if (m_conf.getTranscoderProtocol() != "udp") {
+			::fprintf(stderr, "LoadGen: the transcoder protocol must be udp\n");
+			return 1;
+		}
+
+		if (m_conf.getDaemon()) {
+			::fprintf(stderr, "LoadGen: MMDVM-CrossMode cannot run as a daemon\n");
+			return 1;
+		}
+
+		if (!m_conf.getReplayFile().empty()) {
+			::fprintf(stderr, "LoadGen: MMDVM-CrossMode cannot be replaying\n");
+			return 1;
+		}
+
+		if (m_options.m_budget == 0U)
+			m_options.m_budget = m_conf.getLatencyDefault();
+
+		if (m_options.m_budget == 0U)
+			m_options.m_budget = DEFAULT_BUDGET;
+
+		// Only the results go to stdout
+		::LogInitialise(0U, 0U, 0U);
+
+		CUDPSocket::startup();
+
+		// The DMR and P25 calls are only converted when the source id has a callsign
+		uint32_t dmrId = 0U;
+
+		CDMRLookup lookup;
+		if (lookup.load(m_conf.getDMRLookupFile(), 0U))
+			dmrId = lookup.lookup(m_conf.getCallsign());
+
+		if (dmrId == 0U)
+			dmrId = m_conf.getDMRId();
+
+		std::vector<CPair> pairs = CTraffic::getPairs(m_conf);
+		if (pairs.empty()) {
+			::fprintf(stderr, "LoadGen: no usable mode pairs are enabled\n");
+			return 1;
+		}
+
+		if (!createRepeaters(pairs, dmrId))
+			return 1;
+
+		unsigned int steps = (m_options.m_repeaters + m_options.m_step - 1U) / m_options.m_step;
+
+		for (unsigned int n = 0U; n < steps; n++) {
+			unsigned int active = std::min((n + 1U) * m_options.m_step, m_options.m_repeaters);
+
+			::fprintf(stderr, "LoadGen: step %u with %u repeaters\n", n + 1U, active);
+
+			m_stats.startStep(n, active);
+
+			for (unsigned int i = 0U; i < active; i++)
+				m_repeaters.at(i)->setActive(true);
+
+			auto end  = std::chrono::steady_clock::now() + std::chrono::seconds(m_options.m_stepTime);
+			auto tail = std::chrono::steady_clock::now() + std::chrono::milliseconds(TAIL_TIME);
+			bool reported = n == 0U;
+
+			while (std::chrono::steady_clock::now() < end) {
+				if (!reported && (std::chrono::steady_clock::now() >= tail)) {
+					report(n - 1U);
+					reported = true;
+				}
+
+				if (hasExited())
+					return 1;
+
+				CThread::sleep(10U);
+			}
+
+			if (!reported)
+				report(n - 1U);
+		}
+
+		// Let the calls in progress finish before the last report
+		for (CRepeater* repeater : m_repeaters)
+			repeater->setActive(false);
+
+		for (;;) {
+			bool idle = true;
+			for (CRepeater* repeater : m_repeaters)
+				idle = idle && repeater->isIdle();
+
+			if (idle)
+				break;
+
+			if (hasExited())
+				return 1;
+
+			CThread::sleep(10U);
+		}
+
+		m_stats.endStep();
+
+		CThread::sleep(TAIL_TIME);
+
+		report(steps - 1U);
+
+		summarise();
+
+		CUDPSocket::shutdown();
+
+		return 0;
+	}
+
+private:
+	CConf               m_conf;
+	std::string         m_file;
+	CLoadOptions        m_options;
+	CLoadStats          m_stats;
+	CVocoderPool        m_pool;
+	std::vector<CRepeater*> m_repeaters;
+	std::string         m_directory;
+	std::vector<std::string> m_files;
+	nlohmann::json      m_sustained;
+	nlohmann::json      m_breakdown;
+
+	static bool isPortKey(const std::string& key)
+	{
+		return (key == "RemotePort") || (key == "LocalPort");
+	}
+
+	// Splits a line of the ini file into its key and value, if it has them
+	static bool getKey(const std::string& line, std::string& key, std::string& value)
+	{
+		if (line.empty() || (line.at(0U) == '#') || (line.at(0U) == '['))
+			return false;
+
+		size_t pos = line.find('=');
+		if (pos == std::string::npos)
+			return false;
+
+		key   = line.substr(0U, pos);
+		value = line.substr(pos + 1U);
+
+		return true;
+	}
+
+	// The ports of each copy are moved up by a multiple of the smallest step
+	// that keeps them clear of those of every other copy
+	bool getStride(const std::vector<std::string>& lines, unsigned int& stride) const
+	{
+		std::set<unsigned int> ports;
+		for (const std::string& line : lines) {
+			std::string key, value;
+			if (getKey(line, key, value) && isPortKey(key))
+				ports.insert((unsigned int)::atoi(value.c_str()));
+		}
+
+		if (ports.empty())
+			return false;
+
+		unsigned int copies = m_options.m_repeaters - 1U;
+
+		for (stride = 1U; (*ports.rbegin() + copies * stride) <= 65535U; stride++) {
+			bool clear = true;
+
+			for (auto it1 = ports.begin(); clear && (it1 != ports.end()); ++it1) {
+				for (auto it2 = std::next(it1); clear && (it2 != ports.end()); ++it2) {
+					unsigned int gap = *it2 - *it1;
+					clear = ((gap % stride) != 0U) || ((gap / stride) > copies);
+				}
+			}
+
+			if (clear)
+				return true;
+		}
+
+		return false;
+	}
+
+	// Every copy needs its own ports, MQTT client name, and output files
+	bool writeIni(const std::vector<std::string>& lines, unsigned int n, unsigned int offset, const std::string& file) const
+	{
+		std::ofstream out(file);
+		if (!out)
+			return false;
+
+		std::string section;
+
+		for (const std::string& line : lines) {
+			std::string key, value;
+
+			if (!line.empty() && (line.at(0U) == '[')) {
+				section = line.substr(0U, line.find(']') + 1U);
+				out << line << "\n";
+			} else if (!getKey(line, key, value)) {
+				out << line << "\n";
+			} else if (isPortKey(key)) {
+				out << key << "=" << ((unsigned int)::atoi(value.c_str()) + offset) << "\n";
+			} else if ((section == "[MQTT]") && (key == "Name")) {
+				out << key << "=" << value << "-" << n << "\n";
+			} else if ((((section == "[Capture]") && (key == "File")) || ((section == "[Metrics]") && (key == "TextFile"))) && !value.empty()) {
+				out << key << "=" << value << "." << n << "\n";
+			} else {
+				out << line << "\n";
+			}
+		}
+
+		return bool(out);
+	}
+
+	bool createRepeaters(const std::vector<CPair>& pairs, uint32_t dmrId)
+	{
+		std::vector<std::string> lines;
+
+		std::ifstream in(m_file);
+		std::string line;
+		while (std::getline(in, line)) {
+			if (!line.empty() && (line.back() == '\r'))
+				line.pop_back();
+			lines.push_back(line);
+		}
+
+		unsigned int stride = 0U;
+		if (!getStride(lines, stride)) {
+			::fprintf(stderr, "LoadGen: there are not enough ports for %u repeaters\n", m_options.m_repeaters);
+			return false;
+		}
+
+		char directory[] = "/tmp/LoadGen.XXXXXX";
+		if (::mkdtemp(directory) == nullptr) {
+			::fprintf(stderr, "LoadGen: cannot create a directory for the .ini files\n");
+			return false;
+		}
+
+		m_directory = directory;
+
+		for (unsigned int n = 0U; n < m_options.m_repeaters; n++) {
+			unsigned int offset = n * stride;
+
+			std::string file = m_directory + "/" + std::to_string(n) + ".ini";
+			m_files.push_back(file);
+
+			if (!writeIni(lines, n, offset, file)) {
+				::fprintf(stderr, "LoadGen: cannot write %s\n", file.c_str());
+				return false;
+			}
+
+			CRepeater* repeater = new CRepeater(n, offset, m_conf, m_options, pairs, dmrId, m_stats, m_pool);
+			if (!repeater->open()) {
+				delete repeater;
+				return false;
+			}
+
+			// The transcoder stand-in has to answer as MMDVM-CrossMode starts up
+			repeater->setRunning(true);
+			if (!repeater->run()) {
+				::fprintf(stderr, "LoadGen: cannot start the thread of repeater %u\n", n);
+				delete repeater;
+				return false;
+			}
+
+			m_repeaters.push_back(repeater);
+
+			if (!repeater->start(m_options.m_binary, file))
+				return false;
+		}
+
+		CThread::sleep(STARTUP_TIME);
+
+		return !hasExited();
+	}
+
+	bool hasExited()
+	{
+		for (CRepeater* repeater : m_repeaters) {
+			if (repeater->hasExited())
+				return true;
+		}
+
+		return false;
+	}
+
+	void report(unsigned int n)
+	{
+		CStep step;
+		if (!m_stats.takeStep(n, step))
+			return;
+
+		double seconds = std::chrono::duration<double>(step.m_end - step.m_start).count();
+		if (seconds <= 0.0)
+			seconds = double(m_options.m_stepTime);
+
+		uint64_t lost = (step.m_sent > step.m_received) ? step.m_sent - step.m_received : 0U;
+		double   loss = (step.m_sent > 0U) ? (100.0 * double(lost)) / double(step.m_sent) : 0.0;
+		double   p99  = step.m_latency.getPercentile(0.99);
+
+		nlohmann::json json;
+		json["step"]       = n + 1U;
+		json["repeaters"]  = step.m_repeaters;
+		json["seconds"]    = seconds;
+		json["calls"]      = step.m_calls;
+		json["sent"]       = step.m_sent;
+		json["received"]   = step.m_received;
+		json["lost"]       = lost;
+		json["loss_pct"]   = loss;
+		json["dropped"]    = step.m_dropped;
+		json["duplicated"] = step.m_duplicates;
+		json["untagged"]   = step.m_untagged;
+
+		json["frames_per_s"]         = double(step.m_received) / seconds;
+		json["packets_per_s"]["in"]  = double(step.m_packetsIn) / seconds;
+		json["packets_per_s"]["out"] = double(step.m_packetsOut) / seconds;
+		json["conversions_per_s"]    = double(step.m_conversions) / seconds;
+
+		if (step.m_latency.getCount() > 0U)
+			json["latency_ms"] = step.m_latency.toJSON();
+
+		if ((m_options.m_vocoders > 0U) && (step.m_wait.getCount() > 0U))
+			json["vocoder_wait_ms"] = step.m_wait.toJSON();
+
+		bool ok = (step.m_latency.getCount() > 0U) && (p99 <= double(m_options.m_budget)) && (loss <= m_options.m_maxLoss);
+		json["ok"] = ok;
+
+		std::cout << json.dump() << std::endl;
+
+		nlohmann::json summary;
+		summary["repeaters"]    = step.m_repeaters;
+		summary["frames_per_s"] = json["frames_per_s"];
+		summary["p99_ms"]       = p99;
+		summary["loss_pct"]     = loss;
+
+		if (ok && m_breakdown.is_null())
+			m_sustained = summary;
+		else if (!ok && m_breakdown.is_null())
+			m_breakdown = summary;
+	}
+
+	void summarise() const
+	{
+		nlohmann::json json;
+		json["budget_ms"]    = m_options.m_budget;
+		json["max_loss_pct"] = m_options.m_maxLoss;
+		json["sustained"]    = m_sustained;
+		json["breakdown"]    = m_breakdown;
+
+		std::cout << json.dump() << std::endl;
+	}
+};
+
+static void usage()
+{
+	::fprintf(stderr, "Usage: LoadGen [options] <ini file>\n");
+	::fprintf(stderr, "  -r n    the most repeaters to run (1)\n");
+	::fprintf(stderr, "  -s n    the repeaters added at each step (1)\n");
+	::fprintf(stderr, "  -t s    the length of each step (30)\n");
+	::fprintf(stderr, "  -c s    the mean length of a call (10)\n");
+	::fprintf(stderr, "  -g s    the mean gap between calls after the RF mode hang (2)\n");
+	::fprintf(stderr, "  -z e    the Zipf exponent for the choice of mode pair, 0 for even (0)\n");
+	::fprintf(stderr, "  -l %%    the chance of losing a voice packet (0)\n");
+	::fprintf(stderr, "  -o %%    the chance of a voice packet arriving after the next (0)\n");
+	::fprintf(stderr, "  -j ms   the most a voice packet is delayed by (0)\n");
+	::fprintf(stderr, "  -v n    the vocoders in the transcoder pool, 0 for unlimited (0)\n");
+	::fprintf(stderr, "  -d ms   the time a vocoder takes for each frame (0)\n");
+	::fprintf(stderr, "  -b ms   the p99 latency budget (the [Latency] Default, or 500)\n");
+	::fprintf(stderr, "  -m %%    the most loss allowed (1)\n");
+	::fprintf(stderr, "  -x path the MMDVM-CrossMode binary (./MMDVM-CrossMode)\n");
+}
+
+int main(int argc, char** argv)
+{
+	CLoadOptions options;
+	options.m_repeaters   = 1U;
+	options.m_step        = 1U;
+	options.m_stepTime    = 30U;
+	options.m_callTime    = 10U;
+	options.m_gapTime     = 2U;
+	options.m_zipf        = 0.0;
+	options.m_loss        = 0.0;
+	options.m_reorder     = 0.0;
+	options.m_jitter      = 0U;
+	options.m_vocoders    = 0U;
+	options.m_vocoderTime = 0.0;
+	options.m_budget      = 0U;
+	options.m_maxLoss     = 1.0;
+	options.m_binary      = "./MMDVM-CrossMode";
+
+	int c;
+	while ((c = ::getopt(argc, argv, "r:s:t:c:g:z:l:o:j:v:d:b:m:x:")) != -1) {
+		switch (c) {
+		case 'r':
+			options.m_repeaters = (unsigned int)::atoi(optarg);
+			break;
+		case 's':
+			options.m_step = (unsigned int)::atoi(optarg);
+			break;
+		case 't':
+			options.m_stepTime = (unsigned int)::atoi(optarg);
+			break;
+		case 'c':
+			options.m_callTime = (unsigned int)::atoi(optarg);
+			break;
+		case 'g':
+			options.m_gapTime = (unsigned int)::atoi(optarg);
+			break;
+		case 'z':
+			options.m_zipf = ::atof(optarg);
+			break;
+		case 'l':
+			options.m_loss = ::atof(optarg);
+			break;
+		case 'o':
+			options.m_reorder = ::atof(optarg);
+			break;
+		case 'j':
+			options.m_jitter = (unsigned int)::atoi(optarg);
+			break;
+		case 'v':
+			options.m_vocoders = (unsigned int)::atoi(optarg);
+			break;
+		case 'd':
+			options.m_vocoderTime = ::atof(optarg);
+			break;
+		case 'b':
+			options.m_budget = (unsigned int)::atoi(optarg);
+			break;
+		case 'm':
+			options.m_maxLoss = ::atof(optarg);
+			break;
+		case 'x':
+			options.m_binary = optarg;
+			break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+
+	if ((optind >= argc) || (options.m_repeaters == 0U) || (options.m_step == 0U) || (options.m_stepTime == 0U) || (options.m_callTime == 0U)) {
+		usage();
+		return 1;
+	}
+
+	CLoadGen load(argv[optind], options);
+
+	return load.run();
+}
@@ -0,0 +1,880 @@
+/*
+ *	 Copyright (C) 2012 by Ian Wraith
+ *   Copyright (C) 2015,2016,2024,2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+// The bool array versions of CHamming and CBPTC19696, and the bit at a time
+// CRCs, that the table driven ones replaced. They are kept so that CodecBench
+// can check that the new code still agrees with them.
+
+#include "Reference.h"
+
+#include "Utils.h"
+
+#include <cassert>
+
+// Hamming (15,11,3) check a boolean data array
+bool CHammingReference::decode15113_1(bool* d)
+{
+	assert(d != nullptr);
+
+	// Calculate the parity it should have
+	bool c0 = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[4] ^ d[5] ^ d[6];
+	bool c1 = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[7] ^ d[8] ^ d[9];
+	bool c2 = d[0] ^ d[1] ^ d[4] ^ d[5] ^ d[7] ^ d[8] ^ d[10];
+	bool c3 = d[0] ^ d[2] ^ d[4] ^ d[6] ^ d[7] ^ d[9] ^ d[10];
+
+	unsigned char n = 0U;
+	n |= (c0 != d[11]) ? 0x01U : 0x00U;
+	n |= (c1 != d[12]) ? 0x02U : 0x00U;
+	n |= (c2 != d[13]) ? 0x04U : 0x00U;
+	n |= (c3 != d[14]) ? 0x08U : 0x00U;
+
+	switch (n)
+	{
+		// Parity bit errors
+		case 0x01U: d[11] = !d[11]; return true;
+		case 0x02U: d[12] = !d[12]; return true;
+		case 0x04U: d[13] = !d[13]; return true;
+		case 0x08U: d[14] = !d[14]; return true;
+
+		// Data bit errors
+		case 0x0FU: d[0]  = !d[0];  return true;
+		case 0x07U: d[1]  = !d[1];  return true;
+		case 0x0BU: d[2]  = !d[2];  return true;
+		case 0x03U: d[3]  = !d[3];  return true;
+		case 0x0DU: d[4]  = !d[4];  return true;
+		case 0x05U: d[5]  = !d[5];  return true;
+		case 0x09U: d[6]  = !d[6];  return true;
+		case 0x0EU: d[7]  = !d[7];  return true;
+		case 0x06U: d[8]  = !d[8];  return true;
+		case 0x0AU: d[9]  = !d[9];  return true;
+		case 0x0CU: d[10] = !d[10]; return true;
+
+		// No bit errors
+		default: return false;
+	}
+}
+
+void CHammingReference::encode15113_1(bool* d)
+{
+	assert(d != nullptr);
+
+	// Calculate the checksum this row should have
+	d[11] = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[4] ^ d[5] ^ d[6];
+	d[12] = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[7] ^ d[8] ^ d[9];
+	d[13] = d[0] ^ d[1] ^ d[4] ^ d[5] ^ d[7] ^ d[8] ^ d[10];
+	d[14] = d[0] ^ d[2] ^ d[4] ^ d[6] ^ d[7] ^ d[9] ^ d[10];
+}
+
+// Hamming (15,11,3) check a boolean data array
+bool CHammingReference::decode15113_2(bool* d)
+{
+	assert(d != nullptr);
+
+	// Calculate the checksum this row should have
+	bool c0 = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[5] ^ d[7] ^ d[8];
+	bool c1 = d[1] ^ d[2] ^ d[3] ^ d[4] ^ d[6] ^ d[8] ^ d[9];
+	bool c2 = d[2] ^ d[3] ^ d[4] ^ d[5] ^ d[7] ^ d[9] ^ d[10];
+	bool c3 = d[0] ^ d[1] ^ d[2] ^ d[4] ^ d[6] ^ d[7] ^ d[10];
+
+	unsigned char n = 0x00U;
+	n |= (c0 != d[11]) ? 0x01U : 0x00U;
+	n |= (c1 != d[12]) ? 0x02U : 0x00U;
+	n |= (c2 != d[13]) ? 0x04U : 0x00U;
+	n |= (c3 != d[14]) ? 0x08U : 0x00U;
+
+	switch (n) {
+		// Parity bit errors
+		case 0x01U: d[11] = !d[11]; return true;
+		case 0x02U: d[12] = !d[12]; return true;
+		case 0x04U: d[13] = !d[13]; return true;
+		case 0x08U: d[14] = !d[14]; return true;
+
+		// Data bit errors
+		case 0x09U: d[0]  = !d[0];  return true;
+		case 0x0BU: d[1]  = !d[1];  return true;
+		case 0x0FU: d[2]  = !d[2];  return true;
+		case 0x07U: d[3]  = !d[3];  return true;
+		case 0x0EU: d[4]  = !d[4];  return true;
+		case 0x05U: d[5]  = !d[5];  return true;
+		case 0x0AU: d[6]  = !d[6];  return true;
+		case 0x0DU: d[7]  = !d[7];  return true;
+		case 0x03U: d[8]  = !d[8];  return true;
+		case 0x06U: d[9]  = !d[9];  return true;
+		case 0x0CU: d[10] = !d[10]; return true;
+
+		// No bit errors
+		default: return false;
+	}
+}
+
+void CHammingReference::encode15113_2(bool* d)
+{
+	assert(d != nullptr);
+
+	// Calculate the checksum this row should have
+	d[11] = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[5] ^ d[7] ^ d[8];
+	d[12] = d[1] ^ d[2] ^ d[3] ^ d[4] ^ d[6] ^ d[8] ^ d[9];
+	d[13] = d[2] ^ d[3] ^ d[4] ^ d[5] ^ d[7] ^ d[9] ^ d[10];
+	d[14] = d[0] ^ d[1] ^ d[2] ^ d[4] ^ d[6] ^ d[7] ^ d[10];
+}
+
+// Hamming (13,9,3) check a boolean data array
+bool CHammingReference::decode1393(bool* d)
+{
+	assert(d != nullptr);
+
+	// Calculate the checksum this column should have
+	bool c0 = d[0] ^ d[1] ^ d[3] ^ d[5] ^ d[6];
+	bool c1 = d[0] ^ d[1] ^ d[2] ^ d[4] ^ d[6] ^ d[7];
+	bool c2 = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[5] ^ d[7] ^ d[8];
+	bool c3 = d[0] ^ d[2] ^ d[4] ^ d[5] ^ d[8];
+	
+	unsigned char n = 0x00U;
+	n |= (c0 != d[9])  ? 0x01U : 0x00U;
+	n |= (c1 != d[10]) ? 0x02U : 0x00U;
+	n |= (c2 != d[11]) ? 0x04U : 0x00U;
+	n |= (c3 != d[12]) ? 0x08U : 0x00U;
+
+	switch (n) {
+		// Parity bit errors
+		case 0x01U: d[9]  = !d[9];  return true;
+		case 0x02U: d[10] = !d[10]; return true;
+		case 0x04U: d[11] = !d[11]; return true;
+		case 0x08U: d[12] = !d[12]; return true;
+
+		// Data bit erros
+		case 0x0FU: d[0] = !d[0]; return true;
+		case 0x07U: d[1] = !d[1]; return true;
+		case 0x0EU: d[2] = !d[2]; return true;
+		case 0x05U: d[3] = !d[3]; return true;
+		case 0x0AU: d[4] = !d[4]; return true;
+		case 0x0DU: d[5] = !d[5]; return true;
+		case 0x03U: d[6] = !d[6]; return true;
+		case 0x06U: d[7] = !d[7]; return true;
+		case 0x0CU: d[8] = !d[8]; return true;
+
+		// No bit errors
+		default: return false;
+	}
+}
+
+void CHammingReference::encode1393(bool* d)
+{
+	assert(d != nullptr);
+
+	// Calculate the checksum this column should have
+	d[9]  = d[0] ^ d[1] ^ d[3] ^ d[5] ^ d[6];
+	d[10] = d[0] ^ d[1] ^ d[2] ^ d[4] ^ d[6] ^ d[7];
+	d[11] = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[5] ^ d[7] ^ d[8];
+	d[12] = d[0] ^ d[2] ^ d[4] ^ d[5] ^ d[8];
+}
+
+// Hamming (10,6,3) check a boolean data array
+bool CHammingReference::decode1063(bool* d)
+{
+	assert(d != nullptr);
+
+	// Calculate the checksum this column should have
+	bool c0 = d[0] ^ d[1] ^ d[2] ^ d[5];
+	bool c1 = d[0] ^ d[1] ^ d[3] ^ d[5];
+	bool c2 = d[0] ^ d[2] ^ d[3] ^ d[4];
+	bool c3 = d[1] ^ d[2] ^ d[3] ^ d[4];
+
+	unsigned char n = 0x00U;
+	n |= (c0 != d[6]) ? 0x01U : 0x00U;
+	n |= (c1 != d[7]) ? 0x02U : 0x00U;
+	n |= (c2 != d[8]) ? 0x04U : 0x00U;
+	n |= (c3 != d[9]) ? 0x08U : 0x00U;
+
+	switch (n) {
+		// Parity bit errors
+		case 0x01U: d[6] = !d[6]; return true;
+		case 0x02U: d[7] = !d[7]; return true;
+		case 0x04U: d[8] = !d[8]; return true;
+		case 0x08U: d[9] = !d[9]; return true;
+
+		// Data bit erros
+		case 0x07U: d[0] = !d[0]; return true;
+		case 0x0BU: d[1] = !d[1]; return true;
+		case 0x0DU: d[2] = !d[2]; return true;
+		case 0x0EU: d[3] = !d[3]; return true;
+		case 0x0CU: d[4] = !d[4]; return true;
+		case 0x03U: d[5] = !d[5]; return true;
+
+		// No bit errors
+		default: return false;
+	}
+}
+
+void CHammingReference::encode1063(bool* d)
+{
+	assert(d != nullptr);
+
+	// Calculate the checksum this column should have
+	d[6] = d[0] ^ d[1] ^ d[2] ^ d[5];
+	d[7] = d[0] ^ d[1] ^ d[3] ^ d[5];
+	d[8] = d[0] ^ d[2] ^ d[3] ^ d[4];
+	d[9] = d[1] ^ d[2] ^ d[3] ^ d[4];
+}
+
+// A Hamming (16,11,4) Check
+bool CHammingReference::decode16114(bool* d)
+{
+	assert(d != nullptr);
+
+	// Calculate the checksum this column should have
+	bool c0 = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[5] ^ d[7] ^ d[8];
+	bool c1 = d[1] ^ d[2] ^ d[3] ^ d[4] ^ d[6] ^ d[8] ^ d[9];
+	bool c2 = d[2] ^ d[3] ^ d[4] ^ d[5] ^ d[7] ^ d[9] ^ d[10];
+	bool c3 = d[0] ^ d[1] ^ d[2] ^ d[4] ^ d[6] ^ d[7] ^ d[10];
+	bool c4 = d[0] ^ d[2] ^ d[5] ^ d[6] ^ d[8] ^ d[9] ^ d[10];
+
+	// Compare these with the actual bits
+	unsigned char n = 0x00U;
+	n |= (c0 != d[11]) ? 0x01U : 0x00U;
+	n |= (c1 != d[12]) ? 0x02U : 0x00U;
+	n |= (c2 != d[13]) ? 0x04U : 0x00U;
+	n |= (c3 != d[14]) ? 0x08U : 0x00U;
+	n |= (c4 != d[15]) ? 0x10U : 0x00U;
+
+	switch (n) {
+		// Parity bit errors
+		case 0x01U: d[11] = !d[11]; return true;
+		case 0x02U: d[12] = !d[12]; return true;
+		case 0x04U: d[13] = !d[13]; return true;
+		case 0x08U: d[14] = !d[14]; return true;
+		case 0x10U: d[15] = !d[15]; return true;
+
+		// Data bit errors
+		case 0x19U: d[0]  = !d[0];  return true;
+		case 0x0BU: d[1]  = !d[1];  return true;
+		case 0x1FU: d[2]  = !d[2];  return true;
+		case 0x07U: d[3]  = !d[3];  return true;
+		case 0x0EU: d[4]  = !d[4];  return true;
+		case 0x15U: d[5]  = !d[5];  return true;
+		case 0x1AU: d[6]  = !d[6];  return true;
+		case 0x0DU: d[7]  = !d[7];  return true;
+		case 0x13U: d[8]  = !d[8];  return true;
+		case 0x16U: d[9]  = !d[9];  return true;
+		case 0x1CU: d[10] = !d[10]; return true;
+
+		// No bit errors
+		case 0x00U: return true;
+
+		// Unrecoverable errors
+		default: return false;
+	}
+}
+
+void CHammingReference::encode16114(bool* d)
+{
+	assert(d != nullptr);
+
+	d[11] = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[5] ^ d[7] ^ d[8];
+	d[12] = d[1] ^ d[2] ^ d[3] ^ d[4] ^ d[6] ^ d[8] ^ d[9];
+	d[13] = d[2] ^ d[3] ^ d[4] ^ d[5] ^ d[7] ^ d[9] ^ d[10];
+	d[14] = d[0] ^ d[1] ^ d[2] ^ d[4] ^ d[6] ^ d[7] ^ d[10];
+	d[15] = d[0] ^ d[2] ^ d[5] ^ d[6] ^ d[8] ^ d[9] ^ d[10];
+}
+
+// A Hamming (17,12,3) Check
+bool CHammingReference::decode17123(bool* d)
+{
+	assert(d != nullptr);
+
+	// Calculate the checksum this column should have
+	bool c0 = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[6] ^ d[7] ^ d[9];
+	bool c1 = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[4] ^ d[7] ^ d[8] ^ d[10];
+	bool c2 = d[1] ^ d[2] ^ d[3] ^ d[4] ^ d[5] ^ d[8] ^ d[9] ^ d[11];
+	bool c3 = d[0] ^ d[1] ^ d[4] ^ d[5] ^ d[7] ^ d[10];
+	bool c4 = d[0] ^ d[1] ^ d[2] ^ d[5] ^ d[6] ^ d[8] ^ d[11];
+
+	// Compare these with the actual bits
+	unsigned char n = 0x00U;
+	n |= (c0 != d[12]) ? 0x01U : 0x00U;
+	n |= (c1 != d[13]) ? 0x02U : 0x00U;
+	n |= (c2 != d[14]) ? 0x04U : 0x00U;
+	n |= (c3 != d[15]) ? 0x08U : 0x00U;
+	n |= (c4 != d[16]) ? 0x10U : 0x00U;
+
+	switch (n) {
+		// Parity bit errors
+		case 0x01U: d[12] = !d[12]; return true;
+		case 0x02U: d[13] = !d[13]; return true;
+		case 0x04U: d[14] = !d[14]; return true;
+		case 0x08U: d[15] = !d[15]; return true;
+		case 0x10U: d[16] = !d[16]; return true;
+
+		// Data bit errors
+		case 0x1BU: d[0]  = !d[0];  return true;
+		case 0x1FU: d[1]  = !d[1];  return true;
+		case 0x17U: d[2]  = !d[2];  return true;
+		case 0x07U: d[3]  = !d[3];  return true;
+		case 0x0EU: d[4]  = !d[4];  return true;
+		case 0x1CU: d[5]  = !d[5];  return true;
+		case 0x11U: d[6]  = !d[6];  return true;
+		case 0x0BU: d[7]  = !d[7];  return true;
+		case 0x16U: d[8]  = !d[8];  return true;
+		case 0x05U: d[9]  = !d[9];  return true;
+		case 0x0AU: d[10] = !d[10]; return true;
+		case 0x14U: d[11] = !d[11]; return true;
+
+		// No bit errors
+		case 0x00U: return true;
+
+		// Unrecoverable errors
+		default: return false;
+	}
+}
+
+void CHammingReference::encode17123(bool* d)
+{
+	assert(d != nullptr);
+
+	d[12] = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[6] ^ d[7] ^ d[9];
+	d[13] = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[4] ^ d[7] ^ d[8] ^ d[10];
+	d[14] = d[1] ^ d[2] ^ d[3] ^ d[4] ^ d[5] ^ d[8] ^ d[9] ^ d[11];
+	d[15] = d[0] ^ d[1] ^ d[4] ^ d[5] ^ d[7] ^ d[10];
+	d[16] = d[0] ^ d[1] ^ d[2] ^ d[5] ^ d[6] ^ d[8] ^ d[11];
+}
+
+CBPTC19696Reference::CBPTC19696Reference() :
+m_rawData(nullptr),
+m_deInterData(nullptr)
+{
+	m_rawData     = new bool[196];
+	m_deInterData = new bool[196];
+}
+
+CBPTC19696Reference::~CBPTC19696Reference()
+{
+	delete[] m_rawData;
+	delete[] m_deInterData;
+}
+
+// The main decode function
+void CBPTC19696Reference::decode(const uint8_t* in, uint8_t* out)
+{
+	assert(in != nullptr);
+	assert(out != nullptr);
+
+	//  Get the raw binary
+	decodeExtractBinary(in);
+
+	// Deinterleave
+	decodeDeInterleave();
+
+	// Error check
+	decodeErrorCheck();
+
+	// Extract Data
+	decodeExtractData(out);
+}
+
+// The main encode function
+void CBPTC19696Reference::encode(const uint8_t* in, uint8_t* out)
+{
+	assert(in != nullptr);
+	assert(out != nullptr);
+
+	// Extract Data
+	encodeExtractData(in);
+
+	// Error check
+	encodeErrorCheck();
+
+	// Deinterleave
+	encodeInterleave();
+
+	//  Get the raw binary
+	encodeExtractBinary(out);
+}
+
+void CBPTC19696Reference::decodeExtractBinary(const uint8_t* in)
+{
+	// First block
+	CUtils::byteToBitsBE(in[0U],  m_rawData + 0U);
+	CUtils::byteToBitsBE(in[1U],  m_rawData + 8U);
+	CUtils::byteToBitsBE(in[2U],  m_rawData + 16U);
+	CUtils::byteToBitsBE(in[3U],  m_rawData + 24U);
+	CUtils::byteToBitsBE(in[4U],  m_rawData + 32U);
+	CUtils::byteToBitsBE(in[5U],  m_rawData + 40U);
+	CUtils::byteToBitsBE(in[6U],  m_rawData + 48U);
+	CUtils::byteToBitsBE(in[7U],  m_rawData + 56U);
+	CUtils::byteToBitsBE(in[8U],  m_rawData + 64U);
+	CUtils::byteToBitsBE(in[9U],  m_rawData + 72U);
+	CUtils::byteToBitsBE(in[10U], m_rawData + 80U);
+	CUtils::byteToBitsBE(in[11U], m_rawData + 88U);
+	CUtils::byteToBitsBE(in[12U], m_rawData + 96U);
+
+	// Handle the two bits
+	bool bits[8U];
+	CUtils::byteToBitsBE(in[20U], bits);
+	m_rawData[98U] = bits[6U];
+	m_rawData[99U] = bits[7U];
+
+	// Second block
+	CUtils::byteToBitsBE(in[21U], m_rawData + 100U);
+	CUtils::byteToBitsBE(in[22U], m_rawData + 108U);
+	CUtils::byteToBitsBE(in[23U], m_rawData + 116U);
+	CUtils::byteToBitsBE(in[24U], m_rawData + 124U);
+	CUtils::byteToBitsBE(in[25U], m_rawData + 132U);
+	CUtils::byteToBitsBE(in[26U], m_rawData + 140U);
+	CUtils::byteToBitsBE(in[27U], m_rawData + 148U);
+	CUtils::byteToBitsBE(in[28U], m_rawData + 156U);
+	CUtils::byteToBitsBE(in[29U], m_rawData + 164U);
+	CUtils::byteToBitsBE(in[30U], m_rawData + 172U);
+	CUtils::byteToBitsBE(in[31U], m_rawData + 180U);
+	CUtils::byteToBitsBE(in[32U], m_rawData + 188U);
+}
+
+// Deinterleave the raw data
+void CBPTC19696Reference::decodeDeInterleave()
+{
+	for (unsigned int i = 0U; i < 196U; i++)
+		m_deInterData[i] = false;
+
+	// The first bit is R(3) which is not used so can be ignored
+	for (unsigned int a = 0U; a < 196U; a++)	{
+		// Calculate the interleave sequence
+		unsigned int interleaveSequence = (a * 181U) % 196U;
+		// Shuffle the data
+		m_deInterData[a] = m_rawData[interleaveSequence];
+	}
+}
+	
+// Check each row with a Hamming (15,11,3) code and each column with a Hamming (13,9,3) code
+void CBPTC19696Reference::decodeErrorCheck()
+{
+	bool fixing;
+	unsigned int count = 0U;
+	do {
+		fixing = false;
+
+		// Run through each of the 15 columns
+		bool col[13U];
+		for (unsigned int c = 0U; c < 15U; c++) {
+			unsigned int pos = c + 1U;
+			for (unsigned int a = 0U; a < 13U; a++) {
+				col[a] = m_deInterData[pos];
+				pos = pos + 15U;
+			}
+
+			if (CHammingReference::decode1393(col)) {
+				unsigned int pos = c + 1U;
+				for (unsigned int a = 0U; a < 13U; a++) {
+					m_deInterData[pos] = col[a];
+					pos = pos + 15U;
+				}
+
+				fixing = true;
+			}
+		}
+		
+		// Run through each of the 9 rows containing data
+		for (unsigned int r = 0U; r < 9U; r++) {
+			unsigned int pos = (r * 15U) + 1U;
+			if (CHammingReference::decode15113_2(m_deInterData + pos))
+				fixing = true;
+		}
+
+		count++;
+	} while (fixing && count < 5U);
+}
+
+// Extract the 96 bits of payload
+void CBPTC19696Reference::decodeExtractData(uint8_t* data) const
+{
+	bool bData[96U];
+	unsigned int pos = 0U;
+	for (unsigned int a = 4U; a <= 11U; a++, pos++)
+		bData[pos] = m_deInterData[a];
+
+	for (unsigned int a = 16U; a <= 26U; a++, pos++)
+		bData[pos] = m_deInterData[a];
+
+	for (unsigned int a = 31U; a <= 41U; a++, pos++)
+		bData[pos] = m_deInterData[a];
+
+	for (unsigned int a = 46U; a <= 56U; a++, pos++)
+		bData[pos] = m_deInterData[a];
+
+	for (unsigned int a = 61U; a <= 71U; a++, pos++)
+		bData[pos] = m_deInterData[a];
+
+	for (unsigned int a = 76U; a <= 86U; a++, pos++)
+		bData[pos] = m_deInterData[a];
+
+	for (unsigned int a = 91U; a <= 101U; a++, pos++)
+		bData[pos] = m_deInterData[a];
+
+	for (unsigned int a = 106U; a <= 116U; a++, pos++)
+		bData[pos] = m_deInterData[a];
+
+	for (unsigned int a = 121U; a <= 131U; a++, pos++)
+		bData[pos] = m_deInterData[a];
+
+	CUtils::bitsToByteBE(bData + 0U,  data[0U]);
+	CUtils::bitsToByteBE(bData + 8U,  data[1U]);
+	CUtils::bitsToByteBE(bData + 16U, data[2U]);
+	CUtils::bitsToByteBE(bData + 24U, data[3U]);
+	CUtils::bitsToByteBE(bData + 32U, data[4U]);
+	CUtils::bitsToByteBE(bData + 40U, data[5U]);
+	CUtils::bitsToByteBE(bData + 48U, data[6U]);
+	CUtils::bitsToByteBE(bData + 56U, data[7U]);
+	CUtils::bitsToByteBE(bData + 64U, data[8U]);
+	CUtils::bitsToByteBE(bData + 72U, data[9U]);
+	CUtils::bitsToByteBE(bData + 80U, data[10U]);
+	CUtils::bitsToByteBE(bData + 88U, data[11U]);
+}
+
+// Extract the 96 bits of payload
+void CBPTC19696Reference::encodeExtractData(const uint8_t* in) const
+{
+	bool bData[96U];
+	CUtils::byteToBitsBE(in[0U],  bData + 0U);
+	CUtils::byteToBitsBE(in[1U],  bData + 8U);
+	CUtils::byteToBitsBE(in[2U],  bData + 16U);
+	CUtils::byteToBitsBE(in[3U],  bData + 24U);
+	CUtils::byteToBitsBE(in[4U],  bData + 32U);
+	CUtils::byteToBitsBE(in[5U],  bData + 40U);
+	CUtils::byteToBitsBE(in[6U],  bData + 48U);
+	CUtils::byteToBitsBE(in[7U],  bData + 56U);
+	CUtils::byteToBitsBE(in[8U],  bData + 64U);
+	CUtils::byteToBitsBE(in[9U],  bData + 72U);
+	CUtils::byteToBitsBE(in[10U], bData + 80U);
+	CUtils::byteToBitsBE(in[11U], bData + 88U);
+
+	for (unsigned int i = 0U; i < 196U; i++)
+		m_deInterData[i] = false;
+
+	unsigned int pos = 0U;
+	for (unsigned int a = 4U; a <= 11U; a++, pos++)
+		m_deInterData[a] = bData[pos];
+
+	for (unsigned int a = 16U; a <= 26U; a++, pos++)
+		m_deInterData[a] = bData[pos];
+
+	for (unsigned int a = 31U; a <= 41U; a++, pos++)
+		m_deInterData[a] = bData[pos];
+
+	for (unsigned int a = 46U; a <= 56U; a++, pos++)
+		m_deInterData[a] = bData[pos];
+
+	for (unsigned int a = 61U; a <= 71U; a++, pos++)
+		m_deInterData[a] = bData[pos];
+
+	for (unsigned int a = 76U; a <= 86U; a++, pos++)
+		m_deInterData[a] = bData[pos];
+
+	for (unsigned int a = 91U; a <= 101U; a++, pos++)
+		m_deInterData[a] = bData[pos];
+
+	for (unsigned int a = 106U; a <= 116U; a++, pos++)
+		m_deInterData[a] = bData[pos];
+
+	for (unsigned int a = 121U; a <= 131U; a++, pos++)
+		m_deInterData[a] = bData[pos];
+}
+
+// Check each row with a Hamming (15,11,3) code and each column with a Hamming (13,9,3) code
+void CBPTC19696Reference::encodeErrorCheck()
+{
+	
+	// Run through each of the 9 rows containing data
+	for (unsigned int r = 0U; r < 9U; r++) {
+		unsigned int pos = (r * 15U) + 1U;
+		CHammingReference::encode15113_2(m_deInterData + pos);
+	}
+	
+	// Run through each of the 15 columns
+	bool col[13U];
+	for (unsigned int c = 0U; c < 15U; c++) {
+		unsigned int pos = c + 1U;
+		for (unsigned int a = 0U; a < 13U; a++) {
+			col[a] = m_deInterData[pos];
+			pos = pos + 15U;
+		}
+
+		CHammingReference::encode1393(col);
+
+		pos = c + 1U;
+		for (unsigned int a = 0U; a < 13U; a++) {
+			m_deInterData[pos] = col[a];
+			pos = pos + 15U;
+		}
+	}
+}
+
+// Interleave the raw data
+void CBPTC19696Reference::encodeInterleave()
+{
+	for (unsigned int i = 0U; i < 196U; i++)
+		m_rawData[i] = false;
+
+	// The first bit is R(3) which is not used so can be ignored
+	for (unsigned int a = 0U; a < 196U; a++)	{
+		// Calculate the interleave sequence
+		unsigned int interleaveSequence = (a * 181U) % 196U;
+		// Unshuffle the data
+		m_rawData[interleaveSequence] = m_deInterData[a];
+	}
+}
+
+void CBPTC19696Reference::encodeExtractBinary(uint8_t* data)
+{
+	// First block
+	CUtils::bitsToByteBE(m_rawData + 0U,  data[0U]);
+	CUtils::bitsToByteBE(m_rawData + 8U,  data[1U]);
+	CUtils::bitsToByteBE(m_rawData + 16U, data[2U]);
+	CUtils::bitsToByteBE(m_rawData + 24U, data[3U]);
+	CUtils::bitsToByteBE(m_rawData + 32U, data[4U]);
+	CUtils::bitsToByteBE(m_rawData + 40U, data[5U]);
+	CUtils::bitsToByteBE(m_rawData + 48U, data[6U]);
+	CUtils::bitsToByteBE(m_rawData + 56U, data[7U]);
+	CUtils::bitsToByteBE(m_rawData + 64U, data[8U]);
+	CUtils::bitsToByteBE(m_rawData + 72U, data[9U]);
+	CUtils::bitsToByteBE(m_rawData + 80U, data[10U]);
+	CUtils::bitsToByteBE(m_rawData + 88U, data[11U]);
+
+	// Handle the two bits
+	uint8_t byte;
+	CUtils::bitsToByteBE(m_rawData + 96U, byte);
+	data[12U] = (data[12U] & 0x3FU) | ((byte >> 0) & 0xC0U);
+	data[20U] = (data[20U] & 0xFCU) | ((byte >> 4) & 0x03U);
+
+	// Second block
+	CUtils::bitsToByteBE(m_rawData + 100U,  data[21U]);
+	CUtils::bitsToByteBE(m_rawData + 108U,  data[22U]);
+	CUtils::bitsToByteBE(m_rawData + 116U,  data[23U]);
+	CUtils::bitsToByteBE(m_rawData + 124U,  data[24U]);
+	CUtils::bitsToByteBE(m_rawData + 132U,  data[25U]);
+	CUtils::bitsToByteBE(m_rawData + 140U,  data[26U]);
+	CUtils::bitsToByteBE(m_rawData + 148U,  data[27U]);
+	CUtils::bitsToByteBE(m_rawData + 156U,  data[28U]);
+	CUtils::bitsToByteBE(m_rawData + 164U,  data[29U]);
+	CUtils::bitsToByteBE(m_rawData + 172U,  data[30U]);
+	CUtils::bitsToByteBE(m_rawData + 180U,  data[31U]);
+	CUtils::bitsToByteBE(m_rawData + 188U,  data[32U]);
+}
+
+// Reflected CRC-CCITT as used by D-Star, the low bit of each byte first
+uint16_t CCRCReference::createCCITT161(const uint8_t* in, unsigned int length)
+{
+	assert(in != nullptr);
+
+	uint16_t crc16 = 0xFFFFU;
+
+	for (unsigned int i = 0U; i < length; i++) {
+		for (unsigned int j = 0U; j < 8U; j++) {
+			bool bit = (((crc16 ^ (in[i] >> j)) & 0x01U) == 0x01U);
+
+			crc16 >>= 1;
+
+			if (bit)
+				crc16 ^= 0x8408U;
+		}
+	}
+
+	return uint16_t(~crc16);
+}
+
+// CRC-CCITT as used by YSF, the high bit of each byte first
+uint16_t CCRCReference::createCCITT162(const uint8_t* in, unsigned int length)
+{
+	assert(in != nullptr);
+
+	uint16_t crc16 = 0x0000U;
+
+	for (unsigned int i = 0U; i < length; i++) {
+		for (unsigned int j = 0U; j < 8U; j++) {
+			bool bit = ((((crc16 >> 8) ^ (in[i] << j)) & 0x80U) == 0x80U);
+
+			crc16 <<= 1;
+
+			if (bit)
+				crc16 ^= 0x1021U;
+		}
+	}
+
+	return uint16_t(~crc16);
+}
+
+const uint8_t BIT_MASK_TABLE1[] = { 0x80U, 0x40U, 0x20U, 0x10U, 0x08U, 0x04U, 0x02U, 0x01U };
+
+#define WRITE_BIT1(p,i,b) p[(i)>>3] = (b) ? (p[(i)>>3] | BIT_MASK_TABLE1[(i)&7]) : (p[(i)>>3] & ~BIT_MASK_TABLE1[(i)&7])
+#define READ_BIT1(p,i)    (p[(i)>>3] & BIT_MASK_TABLE1[(i)&7])
+
+bool CNXDNCRCReference::checkCRC6(const uint8_t* in, unsigned int length)
+{
+	assert(in != nullptr);
+
+	uint8_t crc = createCRC6(in, length);
+
+	uint8_t temp[1U];
+	temp[0U] = 0x00U;
+	unsigned int j = length;
+	for (unsigned int i = 2U; i < 8U; i++, j++) {
+		bool b = READ_BIT1(in, j);
+		WRITE_BIT1(temp, i, b);
+	}
+
+	return crc == temp[0U];
+}
+
+void CNXDNCRCReference::encodeCRC6(uint8_t* in, unsigned int length)
+{
+	assert(in != nullptr);
+
+	uint8_t crc[1U];
+	crc[0U] = createCRC6(in, length);
+
+	unsigned int n = length;
+	for (unsigned int i = 2U; i < 8U; i++, n++) {
+		bool b = READ_BIT1(crc, i);
+		WRITE_BIT1(in, n, b);
+	}
+}
+
+bool CNXDNCRCReference::checkCRC12(const uint8_t* in, unsigned int length)
+{
+	assert(in != nullptr);
+
+	uint16_t crc = createCRC12(in, length);
+	uint8_t temp1[2U];
+	temp1[0U] = (crc >> 8) & 0xFFU;
+	temp1[1U] = (crc >> 0) & 0xFFU;
+
+	uint8_t temp2[2U];
+	temp2[0U] = 0x00U;
+	temp2[1U] = 0x00U;
+	unsigned int j = length;
+	for (unsigned int i = 4U; i < 16U; i++, j++) {
+		bool b = READ_BIT1(in, j);
+		WRITE_BIT1(temp2, i, b);
+	}
+
+	return temp1[0U] == temp2[0U] && temp1[1U] == temp2[1U];
+}
+
+void CNXDNCRCReference::encodeCRC12(uint8_t* in, unsigned int length)
+{
+	assert(in != nullptr);
+
+	uint16_t crc = createCRC12(in, length);
+
+	uint8_t temp[2U];
+	temp[0U] = (crc >> 8) & 0xFFU;
+	temp[1U] = (crc >> 0) & 0xFFU;
+
+	unsigned int n = length;
+	for (unsigned int i = 4U; i < 16U; i++, n++) {
+		bool b = READ_BIT1(temp, i);
+		WRITE_BIT1(in, n, b);
+	}
+}
+
+bool CNXDNCRCReference::checkCRC15(const uint8_t* in, unsigned int length)
+{
+	assert(in != nullptr);
+
+	uint16_t crc = createCRC15(in, length);
+	uint8_t temp1[2U];
+	temp1[0U] = (crc >> 8) & 0xFFU;
+	temp1[1U] = (crc >> 0) & 0xFFU;
+
+	uint8_t temp2[2U];
+	temp2[0U] = 0x00U;
+	temp2[1U] = 0x00U;
+	unsigned int j = length;
+	for (unsigned int i = 1U; i < 16U; i++, j++) {
+		bool b = READ_BIT1(in, j);
+		WRITE_BIT1(temp2, i, b);
+	}
+
+	return temp1[0U] == temp2[0U] && temp1[1U] == temp2[1U];
+}
+
+void CNXDNCRCReference::encodeCRC15(uint8_t* in, unsigned int length)
+{
+	assert(in != nullptr);
+
+	uint16_t crc = createCRC15(in, length);
+
+	uint8_t temp[2U];
+	temp[0U] = (crc >> 8) & 0xFFU;
+	temp[1U] = (crc >> 0) & 0xFFU;
+
+	unsigned int n = length;
+	for (unsigned int i = 1U; i < 16U; i++, n++) {
+		bool b = READ_BIT1(temp, i);
+		WRITE_BIT1(in, n, b);
+	}
+}
+
+uint8_t CNXDNCRCReference::createCRC6(const uint8_t* in, unsigned int length)
+{
+	uint8_t crc = 0x3FU;
+
+	for (unsigned int i = 0U; i < length; i++) {
+		bool bit1 = READ_BIT1(in, i) != 0x00U;
+		bool bit2 = (crc & 0x20U) == 0x20U;
+
+		crc <<= 1;
+
+		if (bit1 ^ bit2)
+			crc ^= 0x27U;
+	}
+
+	return crc & 0x3FU;
+}
+
+uint16_t CNXDNCRCReference::createCRC12(const uint8_t* in, unsigned int length)
+{
+	uint16_t crc = 0x0FFFU;
+
+	for (unsigned int i = 0U; i < length; i++) {
+		bool bit1 = READ_BIT1(in, i) != 0x00U;
+		bool bit2 = (crc & 0x0800U) == 0x0800U;
+
+		crc <<= 1;
+
+		if (bit1 ^ bit2)
+			crc ^= 0x080FU;
+	}
+
+	return crc & 0x0FFFU;
+}
+
+uint16_t CNXDNCRCReference::createCRC15(const uint8_t* in, unsigned int length)
+{
+	uint16_t crc = 0x7FFFU;
+
+	for (unsigned int i = 0U; i < length; i++) {
+		bool bit1 = READ_BIT1(in, i) != 0x00U;
+		bool bit2 = (crc & 0x4000U) == 0x4000U;
+
+		crc <<= 1;
+
+		if (bit1 ^ bit2)
+			crc ^= 0x4CC5U;
+	}
+
+	return crc & 0x7FFFU;
+}
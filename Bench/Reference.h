@@ -0,0 +1,98 @@
+/*
+ *	 Copyright (C) 2012 by Ian Wraith
+ *   Copyright (C) 2015,2016,2024,2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(REFERENCE_H)
+#define	REFERENCE_H
+
+#include <cstdint>
+
+// The FEC code as it was before it was rewritten for speed, so that the new
+// code can be checked against it.
+
+class CHammingReference {
+public:
+	static void encode15113_1(bool* d);
+	static bool decode15113_1(bool* d);
+
+	static void encode15113_2(bool* d);
+	static bool decode15113_2(bool* d);
+
+	static void encode1393(bool* d);
+	static bool decode1393(bool* d);
+
+	static void encode1063(bool* d);
+	static bool decode1063(bool* d);
+
+	static void encode16114(bool* d);
+	static bool decode16114(bool* d);
+
+	static void encode17123(bool* d);
+	static bool decode17123(bool* d);
+};
+
+class CBPTC19696Reference {
+public:
+	CBPTC19696Reference();
+	~CBPTC19696Reference();
+
+	void decode(const uint8_t* in, uint8_t* out);
+
+	void encode(const uint8_t* in, uint8_t* out);
+
+private:
+	bool* m_rawData;
+	bool* m_deInterData;
+
+	void decodeExtractBinary(const uint8_t* in);
+	void decodeErrorCheck();
+	void decodeDeInterleave();
+	void decodeExtractData(uint8_t* data) const;
+
+	void encodeExtractData(const uint8_t* in) const;
+	void encodeInterleave();
+	void encodeErrorCheck();
+	void encodeExtractBinary(uint8_t* data);
+};
+
+// Bit at a time, straight from the polynomials
+class CCRCReference {
+public:
+	static uint16_t createCCITT161(const uint8_t* in, unsigned int length);
+	static uint16_t createCCITT162(const uint8_t* in, unsigned int length);
+};
+
+class CNXDNCRCReference
+{
+public:
+	static bool checkCRC6(const uint8_t* in, unsigned int length);
+	static void encodeCRC6(uint8_t* in, unsigned int length);
+
+	static bool checkCRC12(const uint8_t* in, unsigned int length);
+	static void encodeCRC12(uint8_t* in, unsigned int length);
+
+	static bool checkCRC15(const uint8_t* in, unsigned int length);
+	static void encodeCRC15(uint8_t* in, unsigned int length);
+
+private:
+	static uint8_t  createCRC6(const uint8_t* in, unsigned int length);
+	static uint16_t createCRC12(const uint8_t* in, unsigned int length);
+	static uint16_t createCRC15(const uint8_t* in, unsigned int length);
+};
+
+#endif
@@ -0,0 +1,795 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Traffic.h"
+
+#include "TranscoderDefines.h"
+#include "DStarDefines.h"
+#include "NXDNDefines.h"
+#include "DMRDefines.h"
+#include "YSFDefines.h"
+#include "P25Defines.h"
+#include "NXDNFACCH1.h"
+#include "YSFPayload.h"
+#include "NXDNLICH.h"
+#include "YSFFICH.h"
+#include "Utils.h"
+#include "CRC.h"
+
+#include <cstring>
+#include <set>
+
+// Each voice frame carries the marker and a 24-bit index at this offset
+const unsigned int  TAG_POS      = 4U;
+const uint8_t       FRAME_MARKER = 0x5AU;
+
+const int16_t PCM_LEVEL = 8000;
+
+const char* DSTAR_THROUGH_DEST = "BENCH";
+
+struct CP25Record {
+	const uint8_t* m_data;
+	uint16_t       m_length;
+	uint16_t       m_offset;
+};
+
+// Where the audio sits in each of the voice records, 0x62 to 0x73
+const CP25Record P25_RECORDS[] = {
+	{REC62, sizeof(REC62), 10U}, {REC63, sizeof(REC63), 1U}, {REC64, sizeof(REC64), 5U},
+	{REC65, sizeof(REC65), 5U},  {REC66, sizeof(REC66), 5U}, {REC67, sizeof(REC67), 5U},
+	{REC68, sizeof(REC68), 5U},  {REC69, sizeof(REC69), 5U}, {REC6A, sizeof(REC6A), 4U},
+	{REC6B, sizeof(REC6B), 10U}, {REC6C, sizeof(REC6C), 1U}, {REC6D, sizeof(REC6D), 5U},
+	{REC6E, sizeof(REC6E), 5U},  {REC6F, sizeof(REC6F), 5U}, {REC70, sizeof(REC70), 5U},
+	{REC71, sizeof(REC71), 5U},  {REC72, sizeof(REC72), 5U}, {REC73, sizeof(REC73), 4U}};
+
+const unsigned int P25_RECORD_COUNT = sizeof(P25_RECORDS) / sizeof(P25_RECORDS[0U]);
+
+CTraffic::CTraffic(const std::string& callsign, uint32_t dmrId, uint16_t nxdnId) :
+m_callsign(callsign),
+m_dmrId(dmrId),
+m_nxdnId(nxdnId),
+m_seqNo(0U),
+m_streamId(0U)
+{
+}
+
+CTraffic::~CTraffic()
+{
+}
+
+void CTraffic::start(uint32_t streamId)
+{
+	m_seqNo    = 0U;
+	m_streamId = streamId;
+}
+
+unsigned int CTraffic::write(const CPair& pair, const uint8_t* frames, unsigned int index, bool start, bool end, uint8_t* buffer)
+{
+	unsigned int length = 0U;
+
+	switch (pair.m_from) {
+	case DATA_MODE::DSTAR:
+		length = writeDStar(pair, frames, start, end, buffer);
+		break;
+	case DATA_MODE::DMR:
+		length = writeDMR(pair, frames, start, end, buffer);
+		break;
+	case DATA_MODE::YSF:
+		length = writeYSF(pair, frames, start, end, buffer);
+		break;
+	case DATA_MODE::P25:
+		if (!start)
+			length = writeP25(pair, frames, index, end, buffer);
+		break;
+	case DATA_MODE::NXDN:
+		length = writeNXDN(pair, frames, start, end, buffer);
+		break;
+	default:
+		length = writeFM(frames, start, end, buffer);
+		break;
+	}
+
+	// The header and the voice packets each take a sequence number
+	if (!end && (length > 0U))
+		m_seqNo++;
+
+	return length;
+}
+
+void CTraffic::getCadence(DATA_MODE mode, unsigned int& frames, unsigned int& period)
+{
+	switch (mode) {
+	case DATA_MODE::DMR:
+		frames = 3U;
+		period = 60U;
+		break;
+	case DATA_MODE::YSF:
+		frames = 5U;
+		period = 100U;
+		break;
+	case DATA_MODE::NXDN:
+		frames = 4U;
+		period = 80U;
+		break;
+	default:
+		frames = 1U;
+		period = 20U;
+		break;
+	}
+}
+
+uint16_t CTraffic::getFrameLength(DATA_MODE mode)
+{
+	switch (mode) {
+	case DATA_MODE::DSTAR:
+		return DSTAR_DATA_LENGTH;
+	case DATA_MODE::DMR:
+	case DATA_MODE::NXDN:
+		return DMR_NXDN_DATA_LENGTH;
+	case DATA_MODE::YSF:
+		return YSFDN_DATA_LENGTH;
+	case DATA_MODE::P25:
+		return IMBE_DATA_LENGTH;
+	default:
+		return PCM_DATA_LENGTH;
+	}
+}
+
+void CTraffic::createPCM(uint8_t* data)
+{
+	for (unsigned int i = 0U; i < (PCM_DATA_LENGTH / 2U); i++) {
+		int16_t sample = ((i / 10U) % 2U) == 0U ? PCM_LEVEL : -PCM_LEVEL;
+		data[i * 2U + 0U] = uint8_t(uint16_t(sample) >> 8);
+		data[i * 2U + 1U] = uint8_t(uint16_t(sample) >> 0);
+	}
+}
+
+void CTraffic::createFrame(DATA_MODE mode, uint8_t* frame, unsigned int index)
+{
+	uint16_t length = getFrameLength(mode);
+
+	if (mode == DATA_MODE::FM) {
+		createPCM(frame);
+	} else {
+		for (uint16_t i = 0U; i < length; i++)
+			frame[i] = uint8_t(index * 31U + i * 7U + 0x21U);
+	}
+
+	frame[TAG_POS + 0U] = FRAME_MARKER;
+	frame[TAG_POS + 1U] = (index >> 16) & 0xFFU;
+	frame[TAG_POS + 2U] = (index >> 8)  & 0xFFU;
+	frame[TAG_POS + 3U] = (index >> 0)  & 0xFFU;
+}
+
+bool CTraffic::getIndex(const uint8_t* frame, unsigned int& index)
+{
+	if (frame[TAG_POS] != FRAME_MARKER)
+		return false;
+
+	index = (frame[TAG_POS + 1U] << 16) | (frame[TAG_POS + 2U] << 8) | (frame[TAG_POS + 3U] << 0);
+
+	return true;
+}
+
+void CTraffic::setCallsign(uint8_t* out, const std::string& callsign, unsigned int length)
+{
+	for (unsigned int i = 0U; i < length; i++)
+		out[i] = (i < callsign.length()) ? callsign.at(i) : ' ';
+}
+
+unsigned int CTraffic::writeDStar(const CPair& pair, const uint8_t* frames, bool start, bool end, uint8_t* buffer)
+{
+	::memset(buffer, 0x00U, 50U);
+
+	::memcpy(buffer, "DSRP", 4U);
+
+	buffer[5U] = (m_streamId >> 8) & 0xFFU;
+	buffer[6U] = (m_streamId >> 0) & 0xFFU;
+
+	if (start) {
+		buffer[4U] = 0x20U;
+
+		uint8_t* header = buffer + 8U;
+		setCallsign(header + 3U,  "DIRECT",        DSTAR_LONG_CALLSIGN_LENGTH);
+		setCallsign(header + 11U, "DIRECT",        DSTAR_LONG_CALLSIGN_LENGTH);
+		setCallsign(header + 19U, pair.m_callsign, DSTAR_LONG_CALLSIGN_LENGTH);
+		setCallsign(header + 27U, m_callsign,      DSTAR_LONG_CALLSIGN_LENGTH);
+		setCallsign(header + 35U, "",              DSTAR_SHORT_CALLSIGN_LENGTH);
+		CCRC::addCCITT161(header, DSTAR_HEADER_LENGTH_BYTES);
+
+		return 8U + DSTAR_HEADER_LENGTH_BYTES;
+	}
+
+	buffer[4U] = 0x21U;
+	buffer[7U] = m_seqNo % 21U;
+
+	if (end) {
+		buffer[7U] |= 0x40U;
+		::memcpy(buffer + 9U, DSTAR_END_PATTERN_BYTES, DSTAR_END_PATTERN_LENGTH_BYTES);
+		return 9U + DSTAR_END_PATTERN_LENGTH_BYTES;
+	}
+
+	::memcpy(buffer + 9U, frames, DSTAR_DATA_LENGTH);
+
+	return 9U + DSTAR_VOICE_FRAME_LENGTH_BYTES + DSTAR_DATA_FRAME_LENGTH_BYTES;
+}
+
+unsigned int CTraffic::writeDMR(const CPair& pair, const uint8_t* frames, bool start, bool end, uint8_t* buffer)
+{
+	::memset(buffer, 0x00U, 55U);
+
+	::memcpy(buffer, "DMRD", 4U);
+
+	uint32_t srcId = m_dmrId;
+
+	buffer[4U]  = m_seqNo & 0xFFU;
+
+	buffer[5U]  = (srcId >> 16) & 0xFFU;
+	buffer[6U]  = (srcId >> 8)  & 0xFFU;
+	buffer[7U]  = (srcId >> 0)  & 0xFFU;
+
+	buffer[8U]  = (pair.m_id >> 16) & 0xFFU;
+	buffer[9U]  = (pair.m_id >> 8)  & 0xFFU;
+	buffer[10U] = (pair.m_id >> 0)  & 0xFFU;
+
+	buffer[11U] = (srcId >> 24) & 0xFFU;
+	buffer[12U] = (srcId >> 16) & 0xFFU;
+	buffer[13U] = (srcId >> 8)  & 0xFFU;
+	buffer[14U] = (srcId >> 0)  & 0xFFU;
+
+	buffer[15U] = pair.m_slot == 2U ? 0x80U : 0x00U;
+
+	::memcpy(buffer + 16U, &m_streamId, 4U);
+
+	if (start) {
+		buffer[15U] |= 0x20U | DT_VOICE_LC_HEADER;
+	} else if (end) {
+		buffer[15U] |= 0x20U | DT_TERMINATOR_WITH_LC;
+	} else {
+		// The bursts after the header count from one
+		unsigned int n = (m_seqNo - 1U) % 6U;
+		buffer[15U] |= (n == 0U) ? 0x10U : n;
+
+		CUtils::copyBits(frames, 0U,   buffer, (20U * 8U) + 0U,   108U);
+		CUtils::copyBits(frames, 108U, buffer, (20U * 8U) + 156U, 108U);
+	}
+
+	return 55U;
+}
+
+unsigned int CTraffic::writeYSF(const CPair& pair, const uint8_t* frames, bool start, bool end, uint8_t* buffer)
+{
+	::memset(buffer, 0x00U, 155U);
+
+	::memcpy(buffer, "YSFD", 4U);
+
+	// The gateway tag has to be the same for every packet
+	setCallsign(buffer + 4U,  m_callsign, YSF_CALLSIGN_LENGTH);
+	setCallsign(buffer + 14U, m_callsign, YSF_CALLSIGN_LENGTH);
+	setCallsign(buffer + 24U, "ALL",      YSF_CALLSIGN_LENGTH);
+
+	buffer[34U] = (m_seqNo & 0x7FU) << 1;
+	if (end)
+		buffer[34U] |= 0x01U;
+
+	::memcpy(buffer + 35U, YSF_SYNC_BYTES, YSF_SYNC_LENGTH_BYTES);
+
+	CYSFFICH fich;
+	fich.setFI(start ? YSF_FI_HEADER : (end ? YSF_FI_TERMINATOR : YSF_FI_COMMUNICATIONS));
+	fich.setCS(YSF_CS_ASSIGN);
+	fich.setCM(YSF_CM_GROUP_CQ);
+	fich.setBN(0U);
+	fich.setBT(0U);
+	fich.setFN((start || end) ? 0U : ((m_seqNo - 1U) % 7U));
+	fich.setFT(6U);
+	fich.setDev(false);
+	fich.setMR(YSF_MR_DIRECT);
+	fich.setVoIP(false);
+	fich.setDT(YSF_DT_VD_MODE2);
+	fich.setDGId(pair.m_id);
+	fich.encode(buffer + 35U);
+
+	uint8_t source[YSF_CALLSIGN_LENGTH];
+	setCallsign(source, m_callsign, YSF_CALLSIGN_LENGTH);
+
+	CYSFPayload payload;
+	if (start || end)
+		payload.createHeaderData(buffer + 35U, source, YSF_NULL_CALLSIGN2, YSF_NULL_CALLSIGN1, YSF_NULL_CALLSIGN1);
+	else
+		payload.createVDMode2Audio(buffer + 35U, frames);
+
+	return 155U;
+}
+
+unsigned int CTraffic::writeP25(const CPair& pair, const uint8_t* frames, unsigned int index, bool end, uint8_t* buffer)
+{
+	if (end) {
+		::memcpy(buffer, REC80, sizeof(REC80));
+		return sizeof(REC80);
+	}
+
+	const CP25Record& record = P25_RECORDS[index % P25_RECORD_COUNT];
+
+	::memcpy(buffer, record.m_data, record.m_length);
+
+	uint32_t srcId = m_dmrId;
+
+	switch (buffer[0U]) {
+	case 0x65U:
+		buffer[1U] = (pair.m_id >> 16) & 0xFFU;
+		buffer[2U] = (pair.m_id >> 8)  & 0xFFU;
+		buffer[3U] = (pair.m_id >> 0)  & 0xFFU;
+		break;
+	case 0x66U:
+		buffer[1U] = (srcId >> 16) & 0xFFU;
+		buffer[2U] = (srcId >> 8)  & 0xFFU;
+		buffer[3U] = (srcId >> 0)  & 0xFFU;
+		break;
+	default:
+		break;
+	}
+
+	::memcpy(buffer + record.m_offset, frames, IMBE_DATA_LENGTH);
+
+	return record.m_length;
+}
+
+unsigned int CTraffic::writeNXDN(const CPair& pair, const uint8_t* frames, bool start, bool end, uint8_t* buffer)
+{
+	::memset(buffer, 0x00U, 102U);
+
+	::memcpy(buffer, "ICOM", 4U);
+
+	buffer[4U]  = 0x01U;
+	buffer[5U]  = 0x01U;
+	buffer[6U]  = 0x08U;
+	buffer[7U]  = 0xE0U;
+
+	buffer[37U] = 0x23U;
+	buffer[38U] = (start || end) ? 0x1CU : 0x10U;
+	buffer[39U] = 0x21U;
+
+	uint8_t* frame = buffer + 42U;
+	::memcpy(frame, NXDN_FSW_BYTES, NXDN_FSW_BYTES_LENGTH);
+
+	CNXDNLICH lich;
+	lich.setRFCT(NXDN_LICH_RFCT_RTCH);
+	lich.setDirection(NXDN_LICH_DIRECTION_INBOUND);
+
+	if (start || end) {
+		uint16_t srcId = m_nxdnId;
+
+		// A group call, with the layout the getters of CNXDNLayer3 read
+		uint8_t data[10U];
+		::memset(data, 0x00U, 10U);
+		data[0U] = start ? NXDN_MESSAGE_TYPE_VCALL : NXDN_MESSAGE_TYPE_TX_REL;
+		data[3U] = (srcId >> 8) & 0xFFU;
+		data[4U] = (srcId >> 0) & 0xFFU;
+		data[5U] = (pair.m_id >> 8) & 0xFFU;
+		data[6U] = (pair.m_id >> 0) & 0xFFU;
+
+		CNXDNFACCH1 facch;
+		facch.setData(data);
+		facch.encode(frame, NXDN_FSW_LICH_SACCH_LENGTH_BITS);
+		facch.encode(frame, NXDN_FSW_LICH_SACCH_LENGTH_BITS + NXDN_FACCH1_LENGTH_BITS);
+
+		lich.setFCT(NXDN_LICH_USC_SACCH_NS);
+		lich.setOption(NXDN_LICH_STEAL_FACCH);
+	} else {
+		::memcpy(buffer + 45U + 0U,  frames + 0U,                        DMR_NXDN_DATA_LENGTH);
+		::memcpy(buffer + 45U + 9U,  frames + DMR_NXDN_DATA_LENGTH,      DMR_NXDN_DATA_LENGTH);
+		::memcpy(buffer + 45U + 18U, frames + DMR_NXDN_DATA_LENGTH * 2U, DMR_NXDN_DATA_LENGTH);
+		::memcpy(buffer + 45U + 27U, frames + DMR_NXDN_DATA_LENGTH * 3U, DMR_NXDN_DATA_LENGTH);
+
+		lich.setFCT(NXDN_LICH_USC_SACCH_SS);
+		lich.setOption(NXDN_LICH_STEAL_NONE);
+	}
+
+	// The LICH overlays the start of the first audio frame, but not its tag
+	lich.encode(frame);
+
+	return 102U;
+}
+
+unsigned int CTraffic::writeFM(const uint8_t* frames, bool start, bool end, uint8_t* buffer)
+{
+	::memset(buffer, 0x00U, 3U + PCM_DATA_LENGTH);
+
+	if (start) {
+		::memcpy(buffer, "FMS", 3U);
+		::memcpy(buffer + 3U, m_callsign.c_str(), m_callsign.length());
+		return 3U + m_callsign.length() + 1U;
+	} else if (end) {
+		::memcpy(buffer, "FME", 3U);
+		return 3U;
+	} else {
+		::memcpy(buffer, "FMD", 3U);
+		::memcpy(buffer + 3U, frames, PCM_DATA_LENGTH);
+		return 3U + PCM_DATA_LENGTH;
+	}
+}
+
+unsigned int CTraffic::getFrames(DATA_MODE mode, const uint8_t* buffer, int length, uint8_t* frames)
+{
+	switch (mode) {
+	case DATA_MODE::DSTAR:
+		if ((length < 18) || (::memcmp(buffer, "DSRP", 4U) != 0) || (buffer[4U] != 0x21U) || ((buffer[7U] & 0x40U) == 0x40U))
+			return 0U;
+		::memcpy(frames, buffer + 9U, DSTAR_DATA_LENGTH);
+		return 1U;
+
+	case DATA_MODE::DMR:
+		if ((length < 53) || (::memcmp(buffer, "DMRD", 4U) != 0) || ((buffer[15U] & 0x20U) == 0x20U))
+			return 0U;
+		CUtils::copyBits(buffer, (20U * 8U) + 0U,   frames, 0U,   108U);
+		CUtils::copyBits(buffer, (20U * 8U) + 156U, frames, 108U, 108U);
+		return 3U;
+
+	case DATA_MODE::YSF: {
+			if ((length < 155) || (::memcmp(buffer, "YSFD", 4U) != 0))
+				return 0U;
+
+			unsigned int errors;
+			CYSFFICH fich;
+			if (!fich.decode(buffer + 35U, errors) || (fich.getFI() != YSF_FI_COMMUNICATIONS))
+				return 0U;
+
+			CYSFPayload payload;
+			payload.processVDMode2Audio(buffer + 35U, frames);
+			return 5U;
+		}
+
+	case DATA_MODE::P25: {
+			if ((length < 1) || (buffer[0U] < 0x62U) || (buffer[0U] > 0x73U))
+				return 0U;
+
+			const CP25Record& record = P25_RECORDS[buffer[0U] - 0x62U];
+			if (length < int(record.m_offset + IMBE_DATA_LENGTH))
+				return 0U;
+
+			::memcpy(frames, buffer + record.m_offset, IMBE_DATA_LENGTH);
+			return 1U;
+		}
+
+	case DATA_MODE::NXDN:
+		if ((length < 68) || (::memcmp(buffer, "ICOM", 4U) != 0) || (buffer[38U] != 0x10U))
+			return 0U;
+		::memcpy(frames + 0U,                   buffer + 45U, DMR_NXDN_DATA_LENGTH);
+		::memcpy(frames + DMR_NXDN_DATA_LENGTH, buffer + 59U, DMR_NXDN_DATA_LENGTH);
+		return 2U;
+
+	default:
+		if ((length < int(3U + PCM_DATA_LENGTH)) || (::memcmp(buffer, "FMD", 3U) != 0))
+			return 0U;
+		::memcpy(frames, buffer + 3U, PCM_DATA_LENGTH);
+		return 1U;
+	}
+}
+
+static void addPair(std::vector<CPair>& pairs, DATA_MODE from, DATA_MODE to, const std::string& callsign, uint8_t slot, uint32_t id)
+{
+	CPair pair;
+	pair.m_from     = from;
+	pair.m_to       = to;
+	pair.m_callsign = callsign;
+	pair.m_slot     = slot;
+	pair.m_id       = id;
+
+	pairs.push_back(pair);
+}
+
+// An id that no rule maps, for the straight through pairs
+static uint32_t getUnusedId(const std::set<uint32_t>& used)
+{
+	uint32_t id = 1U;
+	while (used.count(id) > 0U)
+		id++;
+
+	return id;
+}
+
+std::vector<CPair> CTraffic::getPairs(const CConf& conf)
+{
+	std::vector<CPair> pairs;
+
+	const auto dstarDMR  = conf.getDStarDMRDests();
+	const auto dstarYSF  = conf.getDStarYSFDests();
+	const auto dstarP25  = conf.getDStarP25Dests();
+	const auto dstarNXDN = conf.getDStarNXDNDests();
+
+	if (conf.getDStarDStarEnable())
+		addPair(pairs, DATA_MODE::DSTAR, DATA_MODE::DSTAR, DSTAR_THROUGH_DEST, 0U, 0U);
+	if (conf.getDStarDMREnable() && !dstarDMR.empty())
+		addPair(pairs, DATA_MODE::DSTAR, DATA_MODE::DMR, std::get<0>(dstarDMR.front()), 0U, 0U);
+	if (conf.getDStarYSFEnable() && !dstarYSF.empty())
+		addPair(pairs, DATA_MODE::DSTAR, DATA_MODE::YSF, dstarYSF.front().first, 0U, 0U);
+	if (conf.getDStarP25Enable() && !dstarP25.empty())
+		addPair(pairs, DATA_MODE::DSTAR, DATA_MODE::P25, dstarP25.front().first, 0U, 0U);
+	if (conf.getDStarNXDNEnable() && !dstarNXDN.empty())
+		addPair(pairs, DATA_MODE::DSTAR, DATA_MODE::NXDN, dstarNXDN.front().first, 0U, 0U);
+	if (conf.getDStarFMEnable())
+		addPair(pairs, DATA_MODE::DSTAR, DATA_MODE::FM, conf.getDStarFMDest(), 0U, 0U);
+
+	const auto dmrDStar = conf.getDMRDStarTGs();
+	const auto dmrYSF   = conf.getDMRYSFTGs();
+	const auto dmrP25   = conf.getDMRP25TGs();
+	const auto dmrNXDN  = conf.getDMRNXDNTGs();
+	const auto dmrFM    = conf.getDMRFMTG();
+
+	std::set<uint32_t> used;
+	for (const auto& it : dmrDStar)
+		used.insert(std::get<1>(it));
+	for (const auto& it : dmrYSF)
+		used.insert(std::get<1>(it));
+	for (const auto& it : dmrP25)
+		used.insert(std::get<1>(it));
+	for (const auto& it : dmrNXDN)
+		used.insert(std::get<1>(it));
+	used.insert(dmrFM.second);
+
+	if (conf.getDMRDMREnable1())
+		addPair(pairs, DATA_MODE::DMR, DATA_MODE::DMR, "", 1U, getUnusedId(used));
+	if (conf.getDMRDMREnable2())
+		addPair(pairs, DATA_MODE::DMR, DATA_MODE::DMR, "", 2U, getUnusedId(used));
+	if (conf.getDMRDStarEnable() && !dmrDStar.empty())
+		addPair(pairs, DATA_MODE::DMR, DATA_MODE::DSTAR, "", std::get<0>(dmrDStar.front()), std::get<1>(dmrDStar.front()));
+	if (conf.getDMRYSFEnable() && !dmrYSF.empty())
+		addPair(pairs, DATA_MODE::DMR, DATA_MODE::YSF, "", std::get<0>(dmrYSF.front()), std::get<1>(dmrYSF.front()));
+	if (conf.getDMRP25Enable() && !dmrP25.empty())
+		addPair(pairs, DATA_MODE::DMR, DATA_MODE::P25, "", std::get<0>(dmrP25.front()), std::get<1>(dmrP25.front()));
+	if (conf.getDMRNXDNEnable() && !dmrNXDN.empty())
+		addPair(pairs, DATA_MODE::DMR, DATA_MODE::NXDN, "", std::get<0>(dmrNXDN.front()), std::get<1>(dmrNXDN.front()));
+	if (conf.getDMRFMEnable())
+		addPair(pairs, DATA_MODE::DMR, DATA_MODE::FM, "", dmrFM.first, dmrFM.second);
+
+	const auto ysfDStar = conf.getYSFDStarDGIds();
+	const auto ysfDMR   = conf.getYSFDMRDGIds();
+	const auto ysfP25   = conf.getYSFP25DGIds();
+	const auto ysfNXDN  = conf.getYSFNXDNDGIds();
+	const auto ysfFM    = conf.getYSFFMDGId();
+
+	used.clear();
+	for (const auto& it : ysfDStar)
+		used.insert(it.first);
+	for (const auto& it : ysfDMR)
+		used.insert(std::get<0>(it));
+	for (const auto& it : ysfP25)
+		used.insert(it.first);
+	for (const auto& it : ysfNXDN)
+		used.insert(it.first);
+	used.insert(ysfFM);
+
+	if (conf.getYSFYSFEnable())
+		addPair(pairs, DATA_MODE::YSF, DATA_MODE::YSF, "", 0U, getUnusedId(used));
+	if (conf.getYSFDStarEnable() && !ysfDStar.empty())
+		addPair(pairs, DATA_MODE::YSF, DATA_MODE::DSTAR, "", 0U, ysfDStar.front().first);
+	if (conf.getYSFDMREnable() && !ysfDMR.empty())
+		addPair(pairs, DATA_MODE::YSF, DATA_MODE::DMR, "", 0U, std::get<0>(ysfDMR.front()));
+	if (conf.getYSFP25Enable() && !ysfP25.empty())
+		addPair(pairs, DATA_MODE::YSF, DATA_MODE::P25, "", 0U, ysfP25.front().first);
+	if (conf.getYSFNXDNEnable() && !ysfNXDN.empty())
+		addPair(pairs, DATA_MODE::YSF, DATA_MODE::NXDN, "", 0U, ysfNXDN.front().first);
+	if (conf.getYSFFMEnable())
+		addPair(pairs, DATA_MODE::YSF, DATA_MODE::FM, "", 0U, ysfFM);
+
+	const auto p25DStar = conf.getP25DStarTGs();
+	const auto p25DMR   = conf.getP25DMRTGs();
+	const auto p25YSF   = conf.getP25YSFTGs();
+	const auto p25NXDN  = conf.getP25NXDNTGs();
+	const auto p25FM    = conf.getP25FMTG();
+
+	used.clear();
+	for (const auto& it : p25DStar)
+		used.insert(it.first);
+	for (const auto& it : p25DMR)
+		used.insert(std::get<0>(it));
+	for (const auto& it : p25YSF)
+		used.insert(it.first);
+	for (const auto& it : p25NXDN)
+		used.insert(it.first);
+	used.insert(p25FM);
+
+	if (conf.getP25P25Enable())
+		addPair(pairs, DATA_MODE::P25, DATA_MODE::P25, "", 0U, getUnusedId(used));
+	if (conf.getP25DStarEnable() && !p25DStar.empty())
+		addPair(pairs, DATA_MODE::P25, DATA_MODE::DSTAR, "", 0U, p25DStar.front().first);
+	if (conf.getP25DMREnable() && !p25DMR.empty())
+		addPair(pairs, DATA_MODE::P25, DATA_MODE::DMR, "", 0U, std::get<0>(p25DMR.front()));
+	if (conf.getP25YSFEnable() && !p25YSF.empty())
+		addPair(pairs, DATA_MODE::P25, DATA_MODE::YSF, "", 0U, p25YSF.front().first);
+	if (conf.getP25NXDNEnable() && !p25NXDN.empty())
+		addPair(pairs, DATA_MODE::P25, DATA_MODE::NXDN, "", 0U, p25NXDN.front().first);
+	if (conf.getP25FMEnable())
+		addPair(pairs, DATA_MODE::P25, DATA_MODE::FM, "", 0U, p25FM);
+
+	const auto nxdnDStar = conf.getNXDNDStarTGs();
+	const auto nxdnDMR   = conf.getNXDNDMRTGs();
+	const auto nxdnYSF   = conf.getNXDNYSFTGs();
+	const auto nxdnP25   = conf.getNXDNP25TGs();
+	const auto nxdnFM    = conf.getNXDNFMTG();
+
+	used.clear();
+	for (const auto& it : nxdnDStar)
+		used.insert(it.first);
+	for (const auto& it : nxdnDMR)
+		used.insert(std::get<0>(it));
+	for (const auto& it : nxdnYSF)
+		used.insert(it.first);
+	for (const auto& it : nxdnP25)
+		used.insert(it.first);
+	used.insert(nxdnFM);
+
+	if (conf.getNXDNNXDNEnable())
+		addPair(pairs, DATA_MODE::NXDN, DATA_MODE::NXDN, "", 0U, getUnusedId(used));
+	if (conf.getNXDNDStarEnable() && !nxdnDStar.empty())
+		addPair(pairs, DATA_MODE::NXDN, DATA_MODE::DSTAR, "", 0U, nxdnDStar.front().first);
+	if (conf.getNXDNDMREnable() && !nxdnDMR.empty())
+		addPair(pairs, DATA_MODE::NXDN, DATA_MODE::DMR, "", 0U, std::get<0>(nxdnDMR.front()));
+	if (conf.getNXDNYSFEnable() && !nxdnYSF.empty())
+		addPair(pairs, DATA_MODE::NXDN, DATA_MODE::YSF, "", 0U, nxdnYSF.front().first);
+	if (conf.getNXDNP25Enable() && !nxdnP25.empty())
+		addPair(pairs, DATA_MODE::NXDN, DATA_MODE::P25, "", 0U, nxdnP25.front().first);
+	if (conf.getNXDNFMEnable())
+		addPair(pairs, DATA_MODE::NXDN, DATA_MODE::FM, "", 0U, nxdnFM);
+
+	// An FM call from RF only goes to FM, the other FM sections apply from Net to RF
+	if (conf.getFMFMEnable())
+		addPair(pairs, DATA_MODE::FM, DATA_MODE::FM, "", 0U, 0U);
+
+	return pairs;
+}
+
+void CTraffic::getAddresses(const CConf& conf, DATA_MODE mode, NETWORK network, std::string& bindAddress, uint16_t& bindPort, std::string& sendAddress, uint16_t& sendPort)
+{
+	bool rf = network == NETWORK::RF;
+
+	switch (mode) {
+	case DATA_MODE::DSTAR:
+		bindAddress = rf ? conf.getDStarRFRemoteAddress() : conf.getDStarNetRemoteAddress();
+		bindPort    = rf ? conf.getDStarRFRemotePort()    : conf.getDStarNetRemotePort();
+		sendAddress = rf ? conf.getDStarRFLocalAddress()  : conf.getDStarNetLocalAddress();
+		sendPort    = rf ? conf.getDStarRFLocalPort()     : conf.getDStarNetLocalPort();
+		break;
+	case DATA_MODE::DMR:
+		bindAddress = rf ? conf.getDMRRFRemoteAddress() : conf.getDMRNetRemoteAddress();
+		bindPort    = rf ? conf.getDMRRFRemotePort()    : conf.getDMRNetRemotePort();
+		sendAddress = rf ? conf.getDMRRFLocalAddress()  : conf.getDMRNetLocalAddress();
+		sendPort    = rf ? conf.getDMRRFLocalPort()     : conf.getDMRNetLocalPort();
+		break;
+	case DATA_MODE::YSF:
+		bindAddress = rf ? conf.getYSFRFRemoteAddress() : conf.getYSFNetRemoteAddress();
+		bindPort    = rf ? conf.getYSFRFRemotePort()    : conf.getYSFNetRemotePort();
+		sendAddress = rf ? conf.getYSFRFLocalAddress()  : conf.getYSFNetLocalAddress();
+		sendPort    = rf ? conf.getYSFRFLocalPort()     : conf.getYSFNetLocalPort();
+		break;
+	case DATA_MODE::P25:
+		bindAddress = rf ? conf.getP25RFRemoteAddress() : conf.getP25NetRemoteAddress();
+		bindPort    = rf ? conf.getP25RFRemotePort()    : conf.getP25NetRemotePort();
+		sendAddress = rf ? conf.getP25RFLocalAddress()  : conf.getP25NetLocalAddress();
+		sendPort    = rf ? conf.getP25RFLocalPort()     : conf.getP25NetLocalPort();
+		break;
+	case DATA_MODE::NXDN:
+		bindAddress = rf ? conf.getNXDNRFRemoteAddress() : conf.getNXDNNetRemoteAddress();
+		bindPort    = rf ? conf.getNXDNRFRemotePort()    : conf.getNXDNNetRemotePort();
+		sendAddress = rf ? conf.getNXDNRFLocalAddress()  : conf.getNXDNNetLocalAddress();
+		sendPort    = rf ? conf.getNXDNRFLocalPort()     : conf.getNXDNNetLocalPort();
+		break;
+	default:
+		bindAddress = rf ? conf.getFMRFRemoteAddress() : conf.getFMNetRemoteAddress();
+		bindPort    = rf ? conf.getFMRFRemotePort()    : conf.getFMNetRemotePort();
+		sendAddress = rf ? conf.getFMRFLocalAddress()  : conf.getFMNetLocalAddress();
+		sendPort    = rf ? conf.getFMRFLocalPort()     : conf.getFMNetLocalPort();
+		break;
+	}
+}
+
+static uint16_t getBlockLength(uint8_t mode)
+{
+	switch (mode) {
+	case MODE_DSTAR:
+		return DSTAR_DATA_LENGTH;
+	case MODE_DMR_NXDN:
+		return DMR_NXDN_DATA_LENGTH;
+	case MODE_YSFDN:
+		return YSFDN_DATA_LENGTH;
+	case MODE_IMBE:
+		return IMBE_DATA_LENGTH;
+	case MODE_IMBE_FEC:
+		return IMBE_FEC_DATA_LENGTH;
+	case MODE_CODEC2_3200:
+		return CODEC2_3200_DATA_LENGTH;
+	case MODE_PCM:
+		return PCM_DATA_LENGTH;
+	default:
+		return 0U;
+	}
+}
+
+CTranscoderStandIn::CTranscoderStandIn(const std::string& name) :
+m_name(name),
+m_inMode(MODE_PASS_THROUGH),
+m_outMode(MODE_PASS_THROUGH)
+{
+}
+
+CTranscoderStandIn::~CTranscoderStandIn()
+{
+}
+
+uint16_t CTranscoderStandIn::reply(const uint8_t* in, int length, uint8_t* out, uint16_t& outLength)
+{
+	if (length < int(DATA_HEADER_LEN))
+		return 0U;
+
+	uint16_t len = in[LENGTH_LSB_POS] | (in[LENGTH_MSB_POS] << 8);
+	if ((in[MARKER_POS] != MARKER) || (len < DATA_HEADER_LEN) || (len > length))
+		return 0U;
+
+	outLength = DATA_HEADER_LEN;
+
+	switch (in[TYPE_POS]) {
+	case TYPE_GET_VERSION:
+		out[TYPE_POS] = TYPE_GET_VERSION;
+		out[GET_VERSION_PROTOCOL_POS] = PROTOCOL_VERSION;
+		::memcpy(out + GET_VERSION_HARWARE_POS, m_name.c_str(), m_name.length());
+		outLength = GET_VERSION_HARWARE_POS + m_name.length();
+		break;
+
+	case TYPE_GET_CAPABILITIES:
+		out[TYPE_POS] = TYPE_GET_CAPABILITIES;
+		out[GET_CAPABILITIES_AMBE_TYPE_POS] = HAS_2AMBE_CHIPS;
+		outLength = GET_CAPABILITIES_AMBE_TYPE_POS + 1U;
+		break;
+
+	case TYPE_SET_MODE:
+		m_inMode  = in[INPUT_MODE_POS];
+		m_outMode = in[OUTPUT_MODE_POS];
+		out[TYPE_POS] = TYPE_ACK;
+		break;
+
+	case TYPE_DATA: {
+			uint16_t blockLen = getBlockLength(m_outMode);
+
+			out[TYPE_POS] = TYPE_DATA;
+
+			if (m_outMode == MODE_PCM)
+				CTraffic::createPCM(out + DATA_START_POS);
+			else
+				::memset(out + DATA_START_POS, 0x55U, blockLen);
+
+			// Carry the tag of the input frame over to the output
+			if (len >= (DATA_HEADER_LEN + TAG_POS + 4U))
+				::memcpy(out + DATA_START_POS + TAG_POS, in + DATA_START_POS + TAG_POS, 4U);
+
+			outLength = DATA_HEADER_LEN + blockLen;
+		}
+		break;
+
+	default:
+		out[TYPE_POS] = TYPE_NAK;
+		out[NAK_ERROR_POS] = 0U;
+		outLength = NAK_ERROR_POS + 1U;
+		break;
+	}
+
+	out[MARKER_POS]     = MARKER;
+	out[LENGTH_LSB_POS] = (outLength >> 0) & 0xFFU;
+	out[LENGTH_MSB_POS] = (outLength >> 8) & 0xFFU;
+
+	return len;
+}
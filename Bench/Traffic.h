@@ -0,0 +1,111 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(TRAFFIC_H)
+#define	TRAFFIC_H
+
+// The packets the benches send in place of the gateways, in the wire format
+// of each network, and the stand-in for the transcoder. Each voice frame
+// carries a marker and a 24-bit index, which the stand-in transcoder copies
+// into its output, so the frames can be matched on the way out.
+
+#include "Defines.h"
+#include "Conf.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct CPair {
+	DATA_MODE   m_from;
+	DATA_MODE   m_to;
+	std::string m_callsign;		// The D-Star destination
+	uint8_t     m_slot;		// The DMR slot
+	uint32_t    m_id;		// The talk group or the DGId
+};
+
+class CTraffic {
+public:
+	CTraffic(const std::string& callsign, uint32_t dmrId, uint16_t nxdnId);
+	~CTraffic();
+
+	// Start a new call with the sequence numbers from zero
+	void start(uint32_t streamId);
+
+	// Builds the header (start), a packet of voice frames, or the end of the
+	// call, and returns its length. The index is that of the first frame of
+	// the packet within the call. P25 has no header, the ids arrive with the
+	// voice, so that is 0.
+	unsigned int write(const CPair& pair, const uint8_t* frames, unsigned int index, bool start, bool end, uint8_t* buffer);
+
+	// The number of frames in each packet and the time between packets
+	static void getCadence(DATA_MODE mode, unsigned int& frames, unsigned int& period);
+
+	static uint16_t getFrameLength(DATA_MODE mode);
+
+	static void createFrame(DATA_MODE mode, uint8_t* frame, unsigned int index);
+
+	// A silent PCM frame is ignored, so the audio is a loud square wave
+	static void createPCM(uint8_t* data);
+
+	// Returns the number of voice frames in a packet from MMDVM-CrossMode
+	static unsigned int getFrames(DATA_MODE mode, const uint8_t* buffer, int length, uint8_t* frames);
+
+	// Concealment and silence carry no tag
+	static bool getIndex(const uint8_t* frame, unsigned int& index);
+
+	// Uses the first mapping of every enabled section
+	static std::vector<CPair> getPairs(const CConf& conf);
+
+	// The stand-in takes the place of the remote end of the network
+	static void getAddresses(const CConf& conf, DATA_MODE mode, NETWORK network, std::string& bindAddress, uint16_t& bindPort, std::string& sendAddress, uint16_t& sendPort);
+
+private:
+	std::string  m_callsign;
+	uint32_t     m_dmrId;
+	uint16_t     m_nxdnId;
+	unsigned int m_seqNo;
+	uint32_t     m_streamId;
+
+	unsigned int writeDStar(const CPair& pair, const uint8_t* frames, bool start, bool end, uint8_t* buffer);
+	unsigned int writeDMR(const CPair& pair, const uint8_t* frames, bool start, bool end, uint8_t* buffer);
+	unsigned int writeYSF(const CPair& pair, const uint8_t* frames, bool start, bool end, uint8_t* buffer);
+	unsigned int writeP25(const CPair& pair, const uint8_t* frames, unsigned int index, bool end, uint8_t* buffer);
+	unsigned int writeNXDN(const CPair& pair, const uint8_t* frames, bool start, bool end, uint8_t* buffer);
+	unsigned int writeFM(const uint8_t* frames, bool start, bool end, uint8_t* buffer);
+
+	static void setCallsign(uint8_t* out, const std::string& callsign, unsigned int length);
+};
+
+// Answers the messages to the transcoder at once, as one with two AMBE chips
+class CTranscoderStandIn {
+public:
+	CTranscoderStandIn(const std::string& name);
+	~CTranscoderStandIn();
+
+	// Answers the message at the start of the buffer, and returns its length,
+	// or 0 if there is no complete message there
+	uint16_t reply(const uint8_t* in, int length, uint8_t* out, uint16_t& outLength);
+
+private:
+	std::string m_name;
+	uint8_t     m_inMode;
+	uint8_t     m_outMode;
+};
+
+#endif
@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2015,2016 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2015,2016,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -18,7 +18,6 @@
 
 #include "CRC.h"
 
-#include "Utils.h"
 #include "Log.h"
 
 #include <cstdint>
@@ -50,76 +49,91 @@ const uint8_t CRC8_TABLE[] = {
 	0xDE, 0xD9, 0xD0, 0xD7, 0xC2, 0xC5, 0xCC, 0xCB, 0xE6, 0xE1, 0xE8, 0xEF,
 	0xFA, 0xFD, 0xF4, 0xF3, 0x01 };
 
-const uint16_t CCITT16_TABLE1[] = {
-	0x0000U, 0x1189U, 0x2312U, 0x329bU, 0x4624U, 0x57adU, 0x6536U, 0x74bfU,
-	0x8c48U, 0x9dc1U, 0xaf5aU, 0xbed3U, 0xca6cU, 0xdbe5U, 0xe97eU, 0xf8f7U,
-	0x1081U, 0x0108U, 0x3393U, 0x221aU, 0x56a5U, 0x472cU, 0x75b7U, 0x643eU,
-	0x9cc9U, 0x8d40U, 0xbfdbU, 0xae52U, 0xdaedU, 0xcb64U, 0xf9ffU, 0xe876U,
-	0x2102U, 0x308bU, 0x0210U, 0x1399U, 0x6726U, 0x76afU, 0x4434U, 0x55bdU,
-	0xad4aU, 0xbcc3U, 0x8e58U, 0x9fd1U, 0xeb6eU, 0xfae7U, 0xc87cU, 0xd9f5U,
-	0x3183U, 0x200aU, 0x1291U, 0x0318U, 0x77a7U, 0x662eU, 0x54b5U, 0x453cU,
-	0xbdcbU, 0xac42U, 0x9ed9U, 0x8f50U, 0xfbefU, 0xea66U, 0xd8fdU, 0xc974U,
-	0x4204U, 0x538dU, 0x6116U, 0x709fU, 0x0420U, 0x15a9U, 0x2732U, 0x36bbU,
-	0xce4cU, 0xdfc5U, 0xed5eU, 0xfcd7U, 0x8868U, 0x99e1U, 0xab7aU, 0xbaf3U,
-	0x5285U, 0x430cU, 0x7197U, 0x601eU, 0x14a1U, 0x0528U, 0x37b3U, 0x263aU,
-	0xdecdU, 0xcf44U, 0xfddfU, 0xec56U, 0x98e9U, 0x8960U, 0xbbfbU, 0xaa72U,
-	0x6306U, 0x728fU, 0x4014U, 0x519dU, 0x2522U, 0x34abU, 0x0630U, 0x17b9U,
-	0xef4eU, 0xfec7U, 0xcc5cU, 0xddd5U, 0xa96aU, 0xb8e3U, 0x8a78U, 0x9bf1U,
-	0x7387U, 0x620eU, 0x5095U, 0x411cU, 0x35a3U, 0x242aU, 0x16b1U, 0x0738U,
-	0xffcfU, 0xee46U, 0xdcddU, 0xcd54U, 0xb9ebU, 0xa862U, 0x9af9U, 0x8b70U,
-	0x8408U, 0x9581U, 0xa71aU, 0xb693U, 0xc22cU, 0xd3a5U, 0xe13eU, 0xf0b7U,
-	0x0840U, 0x19c9U, 0x2b52U, 0x3adbU, 0x4e64U, 0x5fedU, 0x6d76U, 0x7cffU,
-	0x9489U, 0x8500U, 0xb79bU, 0xa612U, 0xd2adU, 0xc324U, 0xf1bfU, 0xe036U,
-	0x18c1U, 0x0948U, 0x3bd3U, 0x2a5aU, 0x5ee5U, 0x4f6cU, 0x7df7U, 0x6c7eU,
-	0xa50aU, 0xb483U, 0x8618U, 0x9791U, 0xe32eU, 0xf2a7U, 0xc03cU, 0xd1b5U,
-	0x2942U, 0x38cbU, 0x0a50U, 0x1bd9U, 0x6f66U, 0x7eefU, 0x4c74U, 0x5dfdU,
-	0xb58bU, 0xa402U, 0x9699U, 0x8710U, 0xf3afU, 0xe226U, 0xd0bdU, 0xc134U,
-	0x39c3U, 0x284aU, 0x1ad1U, 0x0b58U, 0x7fe7U, 0x6e6eU, 0x5cf5U, 0x4d7cU,
-	0xc60cU, 0xd785U, 0xe51eU, 0xf497U, 0x8028U, 0x91a1U, 0xa33aU, 0xb2b3U,
-	0x4a44U, 0x5bcdU, 0x6956U, 0x78dfU, 0x0c60U, 0x1de9U, 0x2f72U, 0x3efbU,
-	0xd68dU, 0xc704U, 0xf59fU, 0xe416U, 0x90a9U, 0x8120U, 0xb3bbU, 0xa232U,
-	0x5ac5U, 0x4b4cU, 0x79d7U, 0x685eU, 0x1ce1U, 0x0d68U, 0x3ff3U, 0x2e7aU,
-	0xe70eU, 0xf687U, 0xc41cU, 0xd595U, 0xa12aU, 0xb0a3U, 0x8238U, 0x93b1U,
-	0x6b46U, 0x7acfU, 0x4854U, 0x59ddU, 0x2d62U, 0x3cebU, 0x0e70U, 0x1ff9U,
-	0xf78fU, 0xe606U, 0xd49dU, 0xc514U, 0xb1abU, 0xa022U, 0x92b9U, 0x8330U,
-	0x7bc7U, 0x6a4eU, 0x58d5U, 0x495cU, 0x3de3U, 0x2c6aU, 0x1ef1U, 0x0f78U };
-
-const uint16_t CCITT16_TABLE2[] = {
-	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
-	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
-	0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
-	0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
-	0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
-	0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
-	0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
-	0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
-	0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
-	0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
-	0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
-	0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
-	0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
-	0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
-	0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
-	0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
-	0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
-	0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
-	0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
-	0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
-	0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
-	0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
-	0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
-	0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
-	0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
-	0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
-	0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
-	0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
-	0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
-	0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
-	0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
-	0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0 };
-
-
-bool CCRC::checkFiveBit(bool* in, unsigned int tcrc)
+// The CRC-CCITT tables for slicing by eight, entry k of a slice being the CRC of
+// the byte followed by k zero bytes. TABLE1 is the reflected form used by D-Star,
+// TABLE2 the normal form used by YSF.
+struct CCCITT16Tables {
+	uint16_t table1[8U][256U];
+	uint16_t table2[8U][256U];
+
+	constexpr CCCITT16Tables() :
+	table1(),
+	table2()
+	{
+		for (unsigned int i = 0U; i < 256U; i++) {
+			uint16_t crc1 = uint16_t(i);
+			uint16_t crc2 = uint16_t(i << 8);
+
+			for (unsigned int j = 0U; j < 8U; j++) {
+				crc1 = (crc1 & 0x0001U) ? ((crc1 >> 1) ^ 0x8408U) : (crc1 >> 1);
+				crc2 = (crc2 & 0x8000U) ? uint16_t((crc2 << 1) ^ 0x1021U) : uint16_t(crc2 << 1);
+			}
+
+			table1[0U][i] = crc1;
+			table2[0U][i] = crc2;
+		}
+
+		for (unsigned int k = 1U; k < 8U; k++) {
+			for (unsigned int i = 0U; i < 256U; i++) {
+				uint16_t crc1 = table1[k - 1U][i];
+				uint16_t crc2 = table2[k - 1U][i];
+
+				table1[k][i] = (crc1 >> 8) ^ table1[0U][crc1 & 0xFFU];
+				table2[k][i] = uint16_t(crc2 << 8) ^ table2[0U][crc2 >> 8];
+			}
+		}
+	}
+};
+
+static constexpr CCCITT16Tables CCITT16_TABLES;
+
+static uint16_t createCCITT161(const unsigned char* in, unsigned int length)
+{
+	const uint16_t (*t)[256U] = CCITT16_TABLES.table1;
+
+	uint16_t crc16 = 0xFFFFU;
+
+	// Slicing by eight, then a byte at a time for the rest
+	while (length >= 8U) {
+		crc16 = t[7U][in[0U] ^ (crc16 & 0xFFU)] ^ t[6U][in[1U] ^ (crc16 >> 8)] ^
+			t[5U][in[2U]] ^ t[4U][in[3U]] ^ t[3U][in[4U]] ^ t[2U][in[5U]] ^
+			t[1U][in[6U]] ^ t[0U][in[7U]];
+		in     += 8U;
+		length -= 8U;
+	}
+
+	while (length > 0U) {
+		crc16 = (crc16 >> 8) ^ t[0U][(crc16 ^ *in++) & 0xFFU];
+		length--;
+	}
+
+	return ~crc16;
+}
+
+static uint16_t createCCITT162(const unsigned char* in, unsigned int length)
+{
+	const uint16_t (*t)[256U] = CCITT16_TABLES.table2;
+
+	uint16_t crc16 = 0x0000U;
+
+	// Slicing by eight, then a byte at a time for the rest
+	while (length >= 8U) {
+		crc16 = t[7U][in[0U] ^ (crc16 >> 8)] ^ t[6U][in[1U] ^ (crc16 & 0xFFU)] ^
+			t[5U][in[2U]] ^ t[4U][in[3U]] ^ t[3U][in[4U]] ^ t[2U][in[5U]] ^
+			t[1U][in[6U]] ^ t[0U][in[7U]];
+		in     += 8U;
+		length -= 8U;
+	}
+
+	while (length > 0U) {
+		crc16 = uint16_t(crc16 << 8) ^ t[0U][(crc16 >> 8) ^ *in++];
+		length--;
+	}
+
+	return ~crc16;
+}
+
+bool CCRC::checkFiveBit(const unsigned char* in, unsigned int tcrc)
 {
 	assert(in != NULL);
 
@@ -129,16 +143,13 @@ bool CCRC::checkFiveBit(bool* in, unsigned int tcrc)
 	return crc == tcrc;
 }
 
-void CCRC::encodeFiveBit(const bool* in, unsigned int& tcrc)
+void CCRC::encodeFiveBit(const unsigned char* in, unsigned int& tcrc)
 {
 	assert(in != NULL);
 
 	unsigned short total = 0U;
-	for (unsigned int i = 0U; i < 72U; i += 8U) {
-		unsigned char c;
-		CUtils::bitsToByteBE(in + i, c);
-		total += c;
-	}
+	for (unsigned int i = 0U; i < 9U; i++)
+		total += in[i];
 
 	total %= 31U;
 
@@ -150,20 +161,10 @@ void CCRC::addCCITT162(unsigned char *in, unsigned int length)
 	assert(in != NULL);
 	assert(length > 2U);
 
-	union {
-		uint16_t crc16;
-		uint8_t  crc8[2U];
-	};
+	uint16_t crc16 = createCCITT162(in, length - 2U);
 
-	crc16 = 0U;
-
-	for (unsigned i = 0U; i < (length - 2U); i++)
-		crc16 = (uint16_t(crc8[0U]) << 8) ^ CCITT16_TABLE2[crc8[1U] ^ in[i]];
-
-	crc16 = ~crc16;
-
-	in[length - 1U] = crc8[0U];
-	in[length - 2U] = crc8[1U];
+	in[length - 2U] = crc16 >> 8;
+	in[length - 1U] = crc16 >> 0;
 }
 
 bool CCRC::checkCCITT162(const unsigned char *in, unsigned int length)
@@ -171,19 +172,9 @@ bool CCRC::checkCCITT162(const unsigned char *in, unsigned int length)
 	assert(in != NULL);
 	assert(length > 2U);
 
-	union {
-		uint16_t crc16;
-		uint8_t  crc8[2U];
-	};
-
-	crc16 = 0U;
+	uint16_t crc16 = createCCITT162(in, length - 2U);
 
-	for (unsigned i = 0U; i < (length - 2U); i++)
-		crc16 = (uint16_t(crc8[0U]) << 8) ^ CCITT16_TABLE2[crc8[1U] ^ in[i]];
-
-	crc16 = ~crc16;
-
-	return crc8[0U] == in[length - 1U] && crc8[1U] == in[length - 2U];
+	return uint8_t(crc16 >> 8) == in[length - 2U] && uint8_t(crc16 >> 0) == in[length - 1U];
 }
 
 void CCRC::addCCITT161(unsigned char *in, unsigned int length)
@@ -191,20 +182,10 @@ void CCRC::addCCITT161(unsigned char *in, unsigned int length)
 	assert(in != NULL);
 	assert(length > 2U);
 
-	union {
-		uint16_t crc16;
-		uint8_t  crc8[2U];
-	};
-
-	crc16 = 0xFFFFU;
-
-	for (unsigned int i = 0U; i < (length - 2U); i++)
-		crc16 = uint16_t(crc8[1U]) ^ CCITT16_TABLE1[crc8[0U] ^ in[i]];
+	uint16_t crc16 = createCCITT161(in, length - 2U);
 
-	crc16 = ~crc16;
-
-	in[length - 2U] = crc8[0U];
-	in[length - 1U] = crc8[1U];
+	in[length - 2U] = crc16 >> 0;
+	in[length - 1U] = crc16 >> 8;
 }
 
 bool CCRC::checkCCITT161(const unsigned char *in, unsigned int length)
@@ -212,19 +193,9 @@ bool CCRC::checkCCITT161(const unsigned char *in, unsigned int length)
 	assert(in != NULL);
 	assert(length > 2U);
 
-	union {
-		uint16_t crc16;
-		uint8_t  crc8[2U];
-	};
-
-	crc16 = 0xFFFFU;
-
-	for (unsigned int i = 0U; i < (length - 2U); i++)
-		crc16 = uint16_t(crc8[1U]) ^ CCITT16_TABLE1[crc8[0U] ^ in[i]];
-
-	crc16 = ~crc16;
+	uint16_t crc16 = createCCITT161(in, length - 2U);
 
-	return crc8[0U] == in[length - 2U] && crc8[1U] == in[length - 1U];
+	return uint8_t(crc16 >> 0) == in[length - 2U] && uint8_t(crc16 >> 8) == in[length - 1U];
 }
 
 unsigned char CCRC::crc8(const unsigned char *in, unsigned int length)
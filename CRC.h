@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2015,2016 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2015,2016,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -22,8 +22,8 @@
 class CCRC
 {
 public:
-	static bool checkFiveBit(bool* in, unsigned int tcrc);
-	static void encodeFiveBit(const bool* in, unsigned int& tcrc);
+	static bool checkFiveBit(const unsigned char* in, unsigned int tcrc);
+	static void encodeFiveBit(const unsigned char* in, unsigned int& tcrc);
 
 	static void addCCITT161(unsigned char* in, unsigned int length);
 	static void addCCITT162(unsigned char* in, unsigned int length);
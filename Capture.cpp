@@ -0,0 +1,262 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Capture.h"
+#include "Replay.h"
+#include "Clock.h"
+#include "Utils.h"
+#include "Log.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <Windows.h>
+#else
+#include <ctime>
+#endif
+
+#include <vector>
+
+#include <cstdio>
+#include <cassert>
+#include <cstring>
+
+// The pcapng blocks and options used
+const uint32_t SECTION_HEADER_BLOCK   = 0x0A0D0D0AU;
+const uint32_t INTERFACE_DESC_BLOCK   = 0x00000001U;
+const uint32_t ENHANCED_PACKET_BLOCK  = 0x00000006U;
+
+const uint32_t BYTE_ORDER_MAGIC       = 0x1A2B3C4DU;
+
+const uint16_t OPT_ENDOFOPT           = 0U;
+const uint16_t OPT_IF_NAME            = 2U;
+const uint16_t OPT_IF_TSRESOL         = 9U;
+const uint16_t OPT_EPB_FLAGS          = 2U;
+
+const uint16_t LINKTYPE_USER0         = 147U;
+
+const uint32_t EPB_FLAGS_INBOUND      = 0x00000001U;
+const uint32_t EPB_FLAGS_OUTBOUND     = 0x00000002U;
+
+// Buffer the writes so that most packets cost a memcpy
+const size_t FILE_BUFFER_LENGTH       = 65536U;
+
+const unsigned int FLUSH_TIME         = 1000U;
+
+static FILE*                    m_fp = nullptr;
+static std::vector<std::string> m_interfaces;
+static unsigned int             m_elapsed = 0U;
+
+static void writeUInt16(uint16_t value)
+{
+	::fwrite(&value, sizeof(uint16_t), 1U, m_fp);
+}
+
+static void writeUInt32(uint32_t value)
+{
+	::fwrite(&value, sizeof(uint32_t), 1U, m_fp);
+}
+
+static void writePadded(const uint8_t* data, unsigned int length)
+{
+	static const uint8_t PADDING[4U] = {0x00U, 0x00U, 0x00U, 0x00U};
+
+	::fwrite(data, 1U, length, m_fp);
+
+	unsigned int padding = (4U - (length % 4U)) % 4U;
+	if (padding > 0U)
+		::fwrite(PADDING, 1U, padding, m_fp);
+}
+
+static unsigned int getPadded(unsigned int length)
+{
+	return (length + 3U) & ~3U;
+}
+
+static uint64_t getTime()
+{
+	// A capture made during a replay must be the same every time
+	if (ReplayActive())
+		return ClockNow();
+
+#if defined(_WIN32) || defined(_WIN64)
+	FILETIME ft;
+	::GetSystemTimePreciseAsFileTime(&ft);
+
+	// From 100ns units since 1601 to ns since 1970
+	uint64_t time = (uint64_t(ft.dwHighDateTime) << 32) | uint64_t(ft.dwLowDateTime);
+
+	return (time - 116444736000000000ULL) * 100ULL;
+#else
+	struct timespec now;
+	::clock_gettime(CLOCK_REALTIME, &now);
+
+	return uint64_t(now.tv_sec) * 1000000000ULL + uint64_t(now.tv_nsec);
+#endif
+}
+
+static void writeSectionHeader()
+{
+	const uint32_t length = 28U;
+
+	writeUInt32(SECTION_HEADER_BLOCK);
+	writeUInt32(length);
+	writeUInt32(BYTE_ORDER_MAGIC);
+	writeUInt16(1U);		// Major version
+	writeUInt16(0U);		// Minor version
+	writeUInt32(0xFFFFFFFFU);	// Section length, unknown
+	writeUInt32(0xFFFFFFFFU);
+	writeUInt32(length);
+}
+
+static void writeInterfaceDescription(const std::string& name)
+{
+	unsigned int nameLength = (unsigned int)name.size();
+
+	// The header, if_name, if_tsresol, the end of the options, and the trailing length
+	uint32_t length = 16U + 4U + getPadded(nameLength) + 4U + 4U + 4U + 4U;
+
+	writeUInt32(INTERFACE_DESC_BLOCK);
+	writeUInt32(length);
+	writeUInt16(LINKTYPE_USER0);
+	writeUInt16(0U);		// Reserved
+	writeUInt32(0U);		// No snap length
+
+	writeUInt16(OPT_IF_NAME);
+	writeUInt16(nameLength);
+	writePadded((const uint8_t*)name.c_str(), nameLength);
+
+	// Timestamps are in nanoseconds
+	const uint8_t resolution = 9U;
+	writeUInt16(OPT_IF_TSRESOL);
+	writeUInt16(1U);
+	writePadded(&resolution, 1U);
+
+	writeUInt16(OPT_ENDOFOPT);
+	writeUInt16(0U);
+
+	writeUInt32(length);
+}
+
+bool CaptureOpen(const std::string& fileName)
+{
+	assert(!fileName.empty());
+
+	CaptureClose();
+
+	m_fp = ::fopen(fileName.c_str(), "wb");
+	if (m_fp == nullptr) {
+		LogError("Unable to open the capture file %s", fileName.c_str());
+		return false;
+	}
+
+	::setvbuf(m_fp, nullptr, _IOFBF, FILE_BUFFER_LENGTH);
+
+	writeSectionHeader();
+
+	for (const auto& name : m_interfaces)
+		writeInterfaceDescription(name);
+
+	m_elapsed = 0U;
+
+	LogMessage("Capturing the network and transcoder traffic to %s", fileName.c_str());
+
+	return true;
+}
+
+int CaptureInterface(NETWORK network, DATA_MODE mode)
+{
+	std::string name = CUtils::getModeName(mode);
+	name += (network == NETWORK::RF) ? " RF" : " Net";
+
+	return CaptureInterface(name);
+}
+
+int CaptureInterface(const std::string& name)
+{
+	for (unsigned int i = 0U; i < m_interfaces.size(); i++) {
+		if (m_interfaces[i] == name)
+			return int(i);
+	}
+
+	if (m_fp != nullptr)
+		writeInterfaceDescription(name);
+
+	m_interfaces.push_back(name);
+
+	return int(m_interfaces.size() - 1U);
+}
+
+std::string CaptureName(int id)
+{
+	assert((id >= 0) && ((unsigned int)id < m_interfaces.size()));
+
+	return m_interfaces[id];
+}
+
+void CaptureWrite(int id, bool inbound, const uint8_t* data, unsigned int length)
+{
+	assert(data != nullptr);
+
+	if ((m_fp == nullptr) || (id < 0))
+		return;
+
+	uint64_t time = getTime();
+
+	// The header, the data, epb_flags, the end of the options, and the trailing length
+	uint32_t blockLength = 28U + getPadded(length) + 8U + 4U + 4U;
+
+	writeUInt32(ENHANCED_PACKET_BLOCK);
+	writeUInt32(blockLength);
+	writeUInt32(uint32_t(id));
+	writeUInt32(uint32_t(time >> 32));
+	writeUInt32(uint32_t(time));
+	writeUInt32(length);		// Captured length
+	writeUInt32(length);		// Original length
+	writePadded(data, length);
+
+	writeUInt16(OPT_EPB_FLAGS);
+	writeUInt16(4U);
+	writeUInt32(inbound ? EPB_FLAGS_INBOUND : EPB_FLAGS_OUTBOUND);
+
+	writeUInt16(OPT_ENDOFOPT);
+	writeUInt16(0U);
+
+	writeUInt32(blockLength);
+}
+
+void CaptureClock(unsigned int ms)
+{
+	if (m_fp == nullptr)
+		return;
+
+	m_elapsed += ms;
+	if (m_elapsed < FLUSH_TIME)
+		return;
+
+	m_elapsed = 0U;
+
+	::fflush(m_fp);
+}
+
+void CaptureClose()
+{
+	if (m_fp == nullptr)
+		return;
+
+	::fclose(m_fp);
+	m_fp = nullptr;
+}
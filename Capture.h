@@ -0,0 +1,48 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(CAPTURE_H)
+#define	CAPTURE_H
+
+#include "Defines.h"
+
+#include <string>
+
+#include <cstdint>
+
+// Writes every network datagram and transcoder message to a pcapng file,
+// each network and the transcoder having their own interface in it. The
+// packets have the link type USER0, so Wireshark shows them as raw data.
+
+extern bool CaptureOpen(const std::string& fileName);
+
+// The interface to use for a network or the transcoder. These are handed out
+// even when there is no capture, as a replay also uses them.
+extern int CaptureInterface(NETWORK network, DATA_MODE mode);
+extern int CaptureInterface(const std::string& name);
+
+extern std::string CaptureName(int id);
+
+extern void CaptureWrite(int id, bool inbound, const uint8_t* data, unsigned int length);
+
+// Flushes the file once a second so that it can be read while running
+extern void CaptureClock(unsigned int ms);
+
+extern void CaptureClose();
+
+#endif
@@ -0,0 +1,120 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Clock.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <Windows.h>
+#else
+#include <ctime>
+#include <cerrno>
+#endif
+
+static CSystemClock m_system;
+static IClock*      m_clock = &m_system;
+
+IClock::~IClock()
+{
+}
+
+CSystemClock::CSystemClock()
+{
+}
+
+CSystemClock::~CSystemClock()
+{
+}
+
+uint64_t CSystemClock::now()
+{
+#if defined(_WIN32) || defined(_WIN64)
+	LARGE_INTEGER frequency;
+	::QueryPerformanceFrequency(&frequency);
+
+	LARGE_INTEGER now;
+	::QueryPerformanceCounter(&now);
+
+	// In two parts so as not to overflow
+	uint64_t count = uint64_t(now.QuadPart);
+	uint64_t freq  = uint64_t(frequency.QuadPart);
+
+	return (count / freq) * 1000000000ULL + ((count % freq) * 1000000000ULL) / freq;
+#else
+	struct timespec now;
+	::clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return uint64_t(now.tv_sec) * 1000000000ULL + uint64_t(now.tv_nsec);
+#endif
+}
+
+void CSystemClock::sleepUntil(uint64_t time)
+{
+#if defined(_WIN32) || defined(_WIN64)
+	uint64_t current = now();
+	if (time > current)
+		::Sleep(DWORD((time - current + 999999ULL) / 1000000ULL));
+#else
+	struct timespec deadline;
+	deadline.tv_sec  = time_t(time / 1000000000ULL);
+	deadline.tv_nsec = long(time % 1000000000ULL);
+
+	while (::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR)
+		;
+#endif
+}
+
+CVirtualClock::CVirtualClock(uint64_t start, bool paced) :
+m_now(start),
+m_paced(paced)
+{
+}
+
+CVirtualClock::~CVirtualClock()
+{
+}
+
+uint64_t CVirtualClock::now()
+{
+	return m_now;
+}
+
+void CVirtualClock::sleepUntil(uint64_t time)
+{
+	if (time <= m_now)
+		return;
+
+	if (m_paced)
+		m_system.sleepUntil(m_system.now() + (time - m_now));
+
+	m_now = time;
+}
+
+uint64_t ClockNow()
+{
+	return m_clock->now();
+}
+
+void ClockSleepUntil(uint64_t time)
+{
+	m_clock->sleepUntil(time);
+}
+
+void ClockSet(IClock* clock)
+{
+	m_clock = (clock != nullptr) ? clock : &m_system;
+}
@@ -0,0 +1,74 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(CLOCK_H)
+#define	CLOCK_H
+
+#include <cstdint>
+
+// A monotonic time source in nanoseconds. The timers, stopwatches, and main
+// loop all take their time from the clock set here, so that a virtual clock
+// can stand in for the real one.
+class IClock {
+public:
+	virtual ~IClock() = 0;
+
+	virtual uint64_t now() = 0;
+
+	// Return once the time has been reached
+	virtual void sleepUntil(uint64_t time) = 0;
+
+private:
+};
+
+class CSystemClock : public IClock {
+public:
+	CSystemClock();
+	virtual ~CSystemClock();
+
+	virtual uint64_t now();
+
+	virtual void sleepUntil(uint64_t time);
+
+private:
+};
+
+// Time that only moves when it is slept upon, at once or, when paced, after
+// waiting for as long in real time
+class CVirtualClock : public IClock {
+public:
+	CVirtualClock(uint64_t start = 0U, bool paced = false);
+	virtual ~CVirtualClock();
+
+	virtual uint64_t now();
+
+	virtual void sleepUntil(uint64_t time);
+
+private:
+	uint64_t m_now;
+	bool     m_paced;
+};
+
+// The clock in use, the system clock until another is set
+extern uint64_t ClockNow();
+extern void     ClockSleepUntil(uint64_t time);
+
+// Use a different clock, or the system clock again with nullptr
+extern void     ClockSet(IClock* clock);
+
+#endif
@@ -40,6 +40,11 @@ enum class SECTION {
 	LOG,
 	MQTT,
 	TRANSCODER,
+	PACING,
+	LATENCY,
+	METRICS,
+	CAPTURE,
+	REPLAY,
 	INFO,
 	LOOKUP,
 	DSTAR,
@@ -103,6 +108,7 @@ m_netModeHang(3U),
 m_daemon(false),
 m_logDisplayLevel(0U),
 m_logMQTTLevel(0U),
+m_logRateLimit(0U),
 m_mqttAddress("127.0.0.1"),
 m_mqttPort(1883U),
 m_mqttKeepalive(60U),
@@ -118,6 +124,16 @@ m_transcoderRemotePort(0U),
 m_transcoderLocalAddress(),
 m_transcoderLocalPort(0U),
 m_transcoderDebug(false),
+m_pacingEnabled(false),
+m_pacingLead(0U),
+m_latencyDefault(0U),
+m_latencyBudgets(),
+m_latencyReportInterval(0U),
+m_metricsInterval(0U),
+m_metricsTextFile(),
+m_captureFile(),
+m_replayFile(),
+m_replayPaced(false),
 m_dmrLookupFile(),
 m_nxdnLookupFile(),
 m_reloadTime(24U),
@@ -199,6 +215,7 @@ m_dStarNetRemotePort(20011U),
 m_dStarNetLocalAddress("127.0.0.1"),
 m_dStarNetLocalPort(20010U),
 m_dStarNetDebug(false),
+m_dStarNetJitterBuffer(0U),
 m_dmrRFRemoteAddress("127.0.0.1"),
 m_dmrRFRemotePort(62031U),
 m_dmrRFLocalAddress("127.0.0.1"),
@@ -209,6 +226,7 @@ m_dmrNetRemotePort(62032U),
 m_dmrNetLocalAddress("127.0.0.1"),
 m_dmrNetLocalPort(62031U),
 m_dmrNetDebug(false),
+m_dmrNetJitterBuffer(0U),
 m_ysfRFRemoteAddress("127.0.0.1"),
 m_ysfRFRemotePort(20011U),
 m_ysfRFLocalAddress("127.0.0.1"),
@@ -219,6 +237,7 @@ m_ysfNetRemotePort(20011U),
 m_ysfNetLocalAddress("127.0.0.1"),
 m_ysfNetLocalPort(20010U),
 m_ysfNetDebug(false),
+m_ysfNetJitterBuffer(0U),
 m_p25RFRemoteAddress("127.0.0.1"),
 m_p25RFRemotePort(32010U),
 m_p25RFLocalAddress("127.0.0.1"),
@@ -229,6 +248,7 @@ m_p25NetRemotePort(42020U),
 m_p25NetLocalAddress("127.0.0.1"),
 m_p25NetLocalPort(32010U),
 m_p25NetDebug(false),
+m_p25NetJitterBuffer(0U),
 m_nxdnRFRemoteAddress("127.0.0.1"),
 m_nxdnRFRemotePort(42021U),
 m_nxdnRFLocalAddress("127.0.0.1"),
@@ -280,6 +300,16 @@ bool CConf::read()
 				section = SECTION::MQTT;
 			else if (::strncmp(buffer, "[Transcoder]", 12U) == 0)
 				section = SECTION::TRANSCODER;
+			else if (::strncmp(buffer, "[Pacing]", 8U) == 0)
+				section = SECTION::PACING;
+			else if (::strncmp(buffer, "[Latency]", 9U) == 0)
+				section = SECTION::LATENCY;
+			else if (::strncmp(buffer, "[Metrics]", 9U) == 0)
+				section = SECTION::METRICS;
+			else if (::strncmp(buffer, "[Capture]", 9U) == 0)
+				section = SECTION::CAPTURE;
+			else if (::strncmp(buffer, "[Replay]", 8U) == 0)
+				section = SECTION::REPLAY;
 			else if (::strncmp(buffer, "[Lookup]", 8U) == 0)
 				section = SECTION::LOOKUP;
 			else if (::strncmp(buffer, "[Info]", 6U) == 0)
@@ -421,6 +451,8 @@ bool CConf::read()
 				m_logDisplayLevel = (unsigned int)::atoi(value);
 			else if (::strcmp(key, "MQTTLevel") == 0)
 				m_logMQTTLevel = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "RateLimit") == 0)
+				m_logRateLimit = (unsigned int)::atoi(value);
 		} else if (section == SECTION::MQTT) {
 			if (::strcmp(key, "Address") == 0)
 				m_mqttAddress = value;
@@ -453,6 +485,49 @@ bool CConf::read()
 				m_transcoderLocalPort = uint16_t(::atoi(value));
 			else if (::strcmp(key, "Debug") == 0)
 				m_transcoderDebug = ::atoi(value) == 1;
+		} else if (section == SECTION::PACING) {
+			if (::strcmp(key, "Enable") == 0)
+				m_pacingEnabled = ::atoi(value) == 1;
+			else if (::strcmp(key, "Lead") == 0)
+				m_pacingLead = (unsigned int)::atoi(value);
+		} else if (section == SECTION::LATENCY) {
+			if (::strcmp(key, "Default") == 0) {
+				m_latencyDefault = (unsigned int)::atoi(value);
+			} else if (::strcmp(key, "Budget") == 0) {
+				char* p1 = ::strchr(value, ',');
+				if (p1 == nullptr)
+					continue;
+				*p1 = '\0';
+
+				char* p2 = ::strchr(p1 + 1U, '=');
+				if (p2 == nullptr)
+					continue;
+				*p2 = '\0';
+
+				std::string src = value;
+				std::string dst = p1 + 1U;
+				unsigned int budget = (unsigned int)::atoi(p2 + 1U);
+
+#if defined(TRACE_CONFIG)
+				::fprintf(stdout, "%s => %s, latency budget %ums\n", src.c_str(), dst.c_str(), budget);
+#endif
+				m_latencyBudgets.push_back(std::tuple<std::string, std::string, unsigned int>(src, dst, budget));
+			} else if (::strcmp(key, "ReportInterval") == 0) {
+				m_latencyReportInterval = (unsigned int)::atoi(value);
+			}
+		} else if (section == SECTION::METRICS) {
+			if (::strcmp(key, "Interval") == 0)
+				m_metricsInterval = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "TextFile") == 0)
+				m_metricsTextFile = value;
+		} else if (section == SECTION::CAPTURE) {
+			if (::strcmp(key, "File") == 0)
+				m_captureFile = value;
+		} else if (section == SECTION::REPLAY) {
+			if (::strcmp(key, "File") == 0)
+				m_replayFile = value;
+			else if (::strcmp(key, "Paced") == 0)
+				m_replayPaced = ::atoi(value) == 1;
 		} else if (section == SECTION::LOOKUP) {
 			if (::strcmp(key, "DMRLookup") == 0)
 				m_dmrLookupFile = value;
@@ -1034,6 +1109,8 @@ bool CConf::read()
 				m_dStarNetLocalPort = uint16_t(::atoi(value));
 			else if (::strcmp(key, "Debug") == 0)
 				m_dStarNetDebug = ::atoi(value) == 1;
+			else if (::strcmp(key, "JitterBuffer") == 0)
+				m_dStarNetJitterBuffer = (unsigned int)::atoi(value);
 		} else if (section == SECTION::DMR_NETWORK_RF) {
 			if (::strcmp(key, "RemoteAddress") == 0)
 				m_dmrRFRemoteAddress = value;
@@ -1056,6 +1133,8 @@ bool CConf::read()
 				m_dmrNetLocalPort = uint16_t(::atoi(value));
 			else if (::strcmp(key, "Debug") == 0)
 				m_dmrNetDebug = ::atoi(value) == 1;
+			else if (::strcmp(key, "JitterBuffer") == 0)
+				m_dmrNetJitterBuffer = (unsigned int)::atoi(value);
 		} else if (section == SECTION::YSF_NETWORK_RF) {
 			if (::strcmp(key, "RemoteAddress") == 0)
 				m_ysfRFRemoteAddress = value;
@@ -1078,6 +1157,8 @@ bool CConf::read()
 				m_ysfNetLocalPort = uint16_t(::atoi(value));
 			else if (::strcmp(key, "Debug") == 0)
 				m_ysfNetDebug = ::atoi(value) == 1;
+			else if (::strcmp(key, "JitterBuffer") == 0)
+				m_ysfNetJitterBuffer = (unsigned int)::atoi(value);
 		} else if (section == SECTION::P25_NETWORK_RF) {
 			if (::strcmp(key, "RemoteAddress") == 0)
 				m_p25RFRemoteAddress = value;
@@ -1100,6 +1181,8 @@ bool CConf::read()
 				m_p25NetLocalPort = uint16_t(::atoi(value));
 			else if (::strcmp(key, "Debug") == 0)
 				m_p25NetDebug = ::atoi(value) == 1;
+			else if (::strcmp(key, "JitterBuffer") == 0)
+				m_p25NetJitterBuffer = (unsigned int)::atoi(value);
 		} else if (section == SECTION::NXDN_NETWORK_RF) {
 			if (::strcmp(key, "RemoteAddress") == 0)
 				m_nxdnRFRemoteAddress = value;
@@ -1182,6 +1265,11 @@ unsigned int CConf::getLogMQTTLevel() const
 	return m_logMQTTLevel;
 }
 
+unsigned int CConf::getLogRateLimit() const
+{
+	return m_logRateLimit;
+}
+
 std::string CConf::getMQTTAddress() const
 {
 	return m_mqttAddress;
@@ -1257,6 +1345,56 @@ bool CConf::getTranscoderDebug() const
 	return m_transcoderDebug;
 }
 
+bool CConf::getPacingEnabled() const
+{
+	return m_pacingEnabled;
+}
+
+unsigned int CConf::getPacingLead() const
+{
+	return m_pacingLead;
+}
+
+unsigned int CConf::getLatencyDefault() const
+{
+	return m_latencyDefault;
+}
+
+std::vector<std::tuple<std::string, std::string, unsigned int>> CConf::getLatencyBudgets() const
+{
+	return m_latencyBudgets;
+}
+
+unsigned int CConf::getLatencyReportInterval() const
+{
+	return m_latencyReportInterval;
+}
+
+unsigned int CConf::getMetricsInterval() const
+{
+	return m_metricsInterval;
+}
+
+std::string CConf::getMetricsTextFile() const
+{
+	return m_metricsTextFile;
+}
+
+std::string CConf::getCaptureFile() const
+{
+	return m_captureFile;
+}
+
+std::string CConf::getReplayFile() const
+{
+	return m_replayFile;
+}
+
+bool CConf::getReplayPaced() const
+{
+	return m_replayPaced;
+}
+
 std::string CConf::getDMRLookupFile() const
 {
 	return m_dmrLookupFile;
@@ -1667,6 +1805,11 @@ bool CConf::getDStarNetDebug() const
 	return m_dStarNetDebug;
 }
 
+unsigned int CConf::getDStarNetJitterBuffer() const
+{
+	return m_dStarNetJitterBuffer;
+}
+
 std::string CConf::getDMRRFRemoteAddress() const
 {
 	return m_dmrRFRemoteAddress;
@@ -1717,6 +1860,11 @@ bool CConf::getDMRNetDebug() const
 	return m_dmrNetDebug;
 }
 
+unsigned int CConf::getDMRNetJitterBuffer() const
+{
+	return m_dmrNetJitterBuffer;
+}
+
 std::string CConf::getYSFRFRemoteAddress() const
 {
 	return m_ysfRFRemoteAddress;
@@ -1767,6 +1915,11 @@ bool CConf::getYSFNetDebug() const
 	return m_ysfNetDebug;
 }
 
+unsigned int CConf::getYSFNetJitterBuffer() const
+{
+	return m_ysfNetJitterBuffer;
+}
+
 std::string CConf::getP25RFRemoteAddress() const
 {
 	return m_p25RFRemoteAddress;
@@ -1817,6 +1970,11 @@ bool CConf::getP25NetDebug() const
 	return m_p25NetDebug;
 }
 
+unsigned int CConf::getP25NetJitterBuffer() const
+{
+	return m_p25NetJitterBuffer;
+}
+
 std::string CConf::getNXDNRFRemoteAddress() const
 {
 	return m_nxdnRFRemoteAddress;
@@ -42,6 +42,7 @@ public:
 	// The Log section
 	unsigned int getLogDisplayLevel() const;
 	unsigned int getLogMQTTLevel() const;
+	unsigned int getLogRateLimit() const;
 
 	// The MQTT section
 	std::string  getMQTTAddress() const;
@@ -62,6 +63,26 @@ public:
 	uint16_t     getTranscoderLocalPort() const;
 	bool         getTranscoderDebug() const;
 
+	// The Pacing section
+	bool         getPacingEnabled() const;
+	unsigned int getPacingLead() const;
+
+	// The Latency section
+	unsigned int getLatencyDefault() const;
+	std::vector<std::tuple<std::string, std::string, unsigned int>> getLatencyBudgets() const;
+	unsigned int getLatencyReportInterval() const;
+
+	// The Metrics section
+	unsigned int getMetricsInterval() const;
+	std::string  getMetricsTextFile() const;
+
+	// The Capture section
+	std::string  getCaptureFile() const;
+
+	// The Replay section
+	std::string  getReplayFile() const;
+	bool         getReplayPaced() const;
+
 	// The Lookup section
 	std::string  getDMRLookupFile() const;
 	std::string  getNXDNLookupFile() const;
@@ -229,6 +250,7 @@ public:
 	std::string  getDStarNetLocalAddress() const;
 	uint16_t     getDStarNetLocalPort() const;
 	bool         getDStarNetDebug() const;
+	unsigned int getDStarNetJitterBuffer() const;
 
 	// The DMR RF Network section
 	std::string  getDMRRFRemoteAddress() const;
@@ -243,6 +265,7 @@ public:
 	std::string  getDMRNetLocalAddress() const;
 	uint16_t     getDMRNetLocalPort() const;
 	bool         getDMRNetDebug() const;
+	unsigned int getDMRNetJitterBuffer() const;
 
 	// The YSF RF Network section
 	std::string  getYSFRFRemoteAddress() const;
@@ -257,6 +280,7 @@ public:
 	std::string  getYSFNetLocalAddress() const;
 	uint16_t     getYSFNetLocalPort() const;
 	bool         getYSFNetDebug() const;
+	unsigned int getYSFNetJitterBuffer() const;
 
 	// The P25 RF Network section
 	std::string  getP25RFRemoteAddress() const;
@@ -271,6 +295,7 @@ public:
 	std::string  getP25NetLocalAddress() const;
 	uint16_t     getP25NetLocalPort() const;
 	bool         getP25NetDebug() const;
+	unsigned int getP25NetJitterBuffer() const;
 
 	// The NXDN RF Network section
 	std::string  getNXDNRFRemoteAddress() const;
@@ -310,6 +335,7 @@ private:
 
 	unsigned int m_logDisplayLevel;
 	unsigned int m_logMQTTLevel;
+	unsigned int m_logRateLimit;
 
 	std::string  m_mqttAddress;
 	uint16_t     m_mqttPort;
@@ -328,6 +354,21 @@ private:
 	uint16_t     m_transcoderLocalPort;
 	bool         m_transcoderDebug;
 
+	bool         m_pacingEnabled;
+	unsigned int m_pacingLead;
+
+	unsigned int m_latencyDefault;
+	std::vector<std::tuple<std::string, std::string, unsigned int>> m_latencyBudgets;
+	unsigned int m_latencyReportInterval;
+
+	unsigned int m_metricsInterval;
+	std::string  m_metricsTextFile;
+
+	std::string  m_captureFile;
+
+	std::string  m_replayFile;
+	bool         m_replayPaced;
+
 	std::string  m_dmrLookupFile;
 	std::string  m_nxdnLookupFile;
 	unsigned int m_reloadTime;
@@ -452,6 +493,7 @@ private:
 	std::string  m_dStarNetLocalAddress;
 	uint16_t     m_dStarNetLocalPort;
 	bool         m_dStarNetDebug;
+	unsigned int m_dStarNetJitterBuffer;
 
 	std::string  m_dmrRFRemoteAddress;
 	uint16_t     m_dmrRFRemotePort;
@@ -464,6 +506,7 @@ private:
 	std::string  m_dmrNetLocalAddress;
 	uint16_t     m_dmrNetLocalPort;
 	bool         m_dmrNetDebug;
+	unsigned int m_dmrNetJitterBuffer;
 
 	std::string  m_ysfRFRemoteAddress;
 	uint16_t     m_ysfRFRemotePort;
@@ -476,6 +519,7 @@ private:
 	std::string  m_ysfNetLocalAddress;
 	uint16_t     m_ysfNetLocalPort;
 	bool         m_ysfNetDebug;
+	unsigned int m_ysfNetJitterBuffer;
 
 	std::string  m_p25RFRemoteAddress;
 	uint16_t     m_p25RFRemotePort;
@@ -488,6 +532,7 @@ private:
 	std::string  m_p25NetLocalAddress;
 	uint16_t     m_p25NetLocalPort;
 	bool         m_p25NetDebug;
+	unsigned int m_p25NetJitterBuffer;
 
 	std::string  m_nxdnRFRemoteAddress;
 	uint16_t     m_nxdnRFRemotePort;
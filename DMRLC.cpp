@@ -38,14 +38,12 @@ m_options(0U),
 m_srcId(0U),
 m_dstId(0U),
 m_bptc(),
-m_raw(nullptr)
+m_raw()
 {
-	m_raw = new bool[128U];
 }
 
 CDMRLC::~CDMRLC()
 {
-	delete[] m_raw;
 }
 
 void CDMRLC::setParameters(FLCO flco, uint32_t srcId, uint32_t dstId)
@@ -82,24 +80,6 @@ void CDMRLC::getData(uint8_t* bytes) const
 	bytes[8U] = m_srcId >> 0;
 }
 
-void CDMRLC::getData(bool* bits) const
-{
-	assert(bits != nullptr);
-
-	uint8_t bytes[9U];
-	getData(bytes);
-
-	CUtils::byteToBitsBE(bytes[0U], bits + 0U);
-	CUtils::byteToBitsBE(bytes[1U], bits + 8U);
-	CUtils::byteToBitsBE(bytes[2U], bits + 16U);
-	CUtils::byteToBitsBE(bytes[3U], bits + 24U);
-	CUtils::byteToBitsBE(bytes[4U], bits + 32U);
-	CUtils::byteToBitsBE(bytes[5U], bits + 40U);
-	CUtils::byteToBitsBE(bytes[6U], bits + 48U);
-	CUtils::byteToBitsBE(bytes[7U], bits + 56U);
-	CUtils::byteToBitsBE(bytes[8U], bits + 64U);
-}
-
 void CDMRLC::encode(uint8_t* data, uint8_t type)
 {
 	assert(data != nullptr);
@@ -136,71 +116,52 @@ void CDMRLC::getData(uint8_t* data, uint8_t n) const
 	assert(data != nullptr);
 	assert(n < 4U);
 
-	bool bits[40U];
-	::memset(bits, 0x00U, 40U * sizeof(bool));
-	::memcpy(bits + 4U, m_raw + n * 32U, 32U * sizeof(bool));
-
-	unsigned char bytes[5U];
-	CUtils::bitsToByteBE(bits + 0U, bytes[0U]);
-	CUtils::bitsToByteBE(bits + 8U, bytes[1U]);
-	CUtils::bitsToByteBE(bits + 16U, bytes[2U]);
-	CUtils::bitsToByteBE(bits + 24U, bytes[3U]);
-	CUtils::bitsToByteBE(bits + 32U, bytes[4U]);
-
-	data[14U] = (data[14U] & 0xF0U) | (bytes[0U] & 0x0FU);
-	data[15U] = bytes[1U];
-	data[16U] = bytes[2U];
-	data[17U] = bytes[3U];
-	data[18U] = (data[18U] & 0x0FU) | (bytes[4U] & 0xF0U);
+	// Each fragment is four columns of the embedded matrix
+	const uint8_t* raw = m_raw + n * 4U;
+
+	data[14U] = (data[14U] & 0xF0U) | (raw[0U] >> 4);
+	data[15U] = (raw[0U] << 4) | (raw[1U] >> 4);
+	data[16U] = (raw[1U] << 4) | (raw[2U] >> 4);
+	data[17U] = (raw[2U] << 4) | (raw[3U] >> 4);
+	data[18U] = (data[18U] & 0x0FU) | (raw[3U] << 4);
 }
 
 void CDMRLC::encodeEmbeddedData()
 {
-	bool lcData[72U];
+	uint8_t lcData[9U];
 	getData(lcData);
 
 	unsigned int crc;
 	CCRC::encodeFiveBit(lcData, crc);
 
-	bool data[128U];
-	::memset(data, 0x00U, 128U * sizeof(bool));
-
-	data[106U] = (crc & 0x01U) == 0x01U;
-	data[90U]  = (crc & 0x02U) == 0x02U;
-	data[74U]  = (crc & 0x04U) == 0x04U;
-	data[58U]  = (crc & 0x08U) == 0x08U;
-	data[42U]  = (crc & 0x10U) == 0x10U;
-
-	unsigned int b = 0U;
-	for (unsigned int a = 0U; a < 11U; a++, b++)
-		data[a] = lcData[b];
-	for (unsigned int a = 16U; a < 27U; a++, b++)
-		data[a] = lcData[b];
-	for (unsigned int a = 32U; a < 42U; a++, b++)
-		data[a] = lcData[b];
-	for (unsigned int a = 48U; a < 58U; a++, b++)
-		data[a] = lcData[b];
-	for (unsigned int a = 64U; a < 74U; a++, b++)
-		data[a] = lcData[b];
-	for (unsigned int a = 80U; a < 90U; a++, b++)
-		data[a] = lcData[b];
-	for (unsigned int a = 96U; a < 106U; a++, b++)
-		data[a] = lcData[b];
-
-	// Hamming (16,11,4) check each row except the last one
-	for (unsigned int a = 0U; a < 112U; a += 16U)
-		CHamming::encode16114(data + a);
-
-	// Add the parity bits for each column
-	for (unsigned int a = 0U; a < 16U; a++)
-		data[a + 112U] = data[a + 0U] ^ data[a + 16U] ^ data[a + 32U] ^ data[a + 48U] ^ data[a + 64U] ^ data[a + 80U] ^ data[a + 96U];
-
-	// The data is packed downwards in columns
-	b = 0U;
-	for (unsigned int a = 0U; a < 128U; a++) {
-		m_raw[a] = data[b];
-		b += 16U;
-		if (b > 127U)
-			b -= 127U;
+	// The 72 LC bits, left justified
+	uint64_t lc = 0U;
+	for (unsigned int i = 0U; i < 8U; i++)
+		lc = (lc << 8) | lcData[i];
+
+	// Each row holds its data bits from bit 15 down, the CRC bit of rows 2 to 6
+	// sits at bit 5, and the Hamming parity fills the bottom five bits
+	uint16_t rows[8U];
+	rows[0U] = uint16_t(lc >> 53) << 5;
+	rows[1U] = uint16_t((lc >> 42) & 0x07FFU) << 5;
+	rows[2U] = (uint16_t((lc >> 32) & 0x03FFU) << 6) | (((crc >> 4) & 0x01U) << 5);
+	rows[3U] = (uint16_t((lc >> 22) & 0x03FFU) << 6) | (((crc >> 3) & 0x01U) << 5);
+	rows[4U] = (uint16_t((lc >> 12) & 0x03FFU) << 6) | (((crc >> 2) & 0x01U) << 5);
+	rows[5U] = (uint16_t((lc >> 2) & 0x03FFU) << 6)  | (((crc >> 1) & 0x01U) << 5);
+	rows[6U] = (uint16_t(((lc & 0x03U) << 8) | lcData[8U]) << 6) | ((crc & 0x01U) << 5);
+
+	// Hamming (16,11,4) check each row except the last one, which holds the column parity
+	rows[7U] = 0U;
+	for (unsigned int r = 0U; r < 7U; r++) {
+		CHamming::encode16114(rows[r]);
+		rows[7U] ^= rows[r];
+	}
+
+	// The data is packed downwards in columns, one byte per column
+	for (unsigned int c = 0U; c < 16U; c++) {
+		uint8_t column = 0U;
+		for (unsigned int r = 0U; r < 8U; r++)
+			column |= ((rows[r] >> (15U - c)) & 0x01U) << (7U - r);
+		m_raw[c] = column;
 	}
 }
@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2015,2016,2019,2021,2022,2024 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2015,2016,2019,2021,2022,2024,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -45,10 +45,9 @@ private:
 	uint32_t   m_srcId;
 	uint32_t   m_dstId;
 	CBPTC19696 m_bptc;
-	bool*      m_raw;
+	uint8_t    m_raw[16U];
 
 	void getData(uint8_t* bytes) const;
-	void getData(bool* bits) const;
 
 	void encodeEmbeddedData();
 };
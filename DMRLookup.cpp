@@ -31,8 +31,9 @@ const unsigned int BUFFER_SIZE = 200U;
 CDMRLookup::CDMRLookup() :
 m_filename(),
 m_data(),
-m_timer(1000U)
+m_timer()
 {
+	m_timer.setCallback(onReload, this);
 }
 
 CDMRLookup::~CDMRLookup()
@@ -110,11 +111,13 @@ uint32_t CDMRLookup::lookup(const std::string& callsign) const
 	return NULL_ID;
 }
 
-void CDMRLookup::clock(unsigned int ms)
+void CDMRLookup::onReload(void* obj)
 {
-	m_timer.clock(ms);
-	if (m_timer.isRunning() && m_timer.hasExpired()) {
-		load();
-		m_timer.start();
-	}
+	assert(obj != nullptr);
+
+	CDMRLookup* p = static_cast<CDMRLookup*>(obj);
+
+	p->load();
+
+	p->m_timer.start();
 }
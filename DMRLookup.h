@@ -36,14 +36,14 @@ public:
 	std::string lookup(uint32_t id) const;
 	uint32_t lookup(const std::string& callsign) const;
 
-	void clock(unsigned int ms);
-
 private:
 	std::string                                   m_filename;
 	std::vector<std::pair<uint32_t, std::string>> m_data;
 	CTimer                                        m_timer;
 
 	bool load();
+
+	static void onReload(void* obj);
 };
 
 #endif
@@ -19,6 +19,9 @@
 #include "DMRNetwork.h"
 
 #include "DMRDefines.h"
+#include "Capture.h"
+#include "Replay.h"
+#include "Latency.h"
 #include "Utils.h"
 #include "Log.h"
 
@@ -31,14 +34,10 @@ const unsigned int BUFFER_LENGTH = 500U;
 
 const unsigned int HOMEBREW_DATA_PACKET_LENGTH = 55U;
 
-const uint8_t BIT_MASK_TABLE[] = { 0x80U, 0x40U, 0x20U, 0x10U, 0x08U, 0x04U, 0x02U, 0x01U };
-
-#define WRITE_BIT8(p,i,b) p[(i)>>3] = (b) ? (p[(i)>>3] | BIT_MASK_TABLE[(i)&7]) : (p[(i)>>3] & ~BIT_MASK_TABLE[(i)&7])
-#define READ_BIT8(p,i)    (p[(i)>>3] & BIT_MASK_TABLE[(i)&7])
-
 
 CDMRNetwork::CDMRNetwork(NETWORK network, uint32_t id, const std::string& localAddress, uint16_t localPort, const std::string& remoteAddress, uint16_t remotePort, bool debug) :
 m_network(network),
+m_metrics(nullptr),
 m_socket(localAddress, localPort),
 m_addr(),
 m_addrLen(0U),
@@ -52,14 +51,21 @@ m_colorCode(0U),
 m_power(0U),
 m_buffer(nullptr),
 m_streamId(0U),
+m_rxStreamId(0U),
 m_rxData(1000U, "DMR Network"),
+m_jitterBuffer(nullptr),
+m_pacer(nullptr),
 m_random(),
-m_pingTimer(1000U, 10U),
+m_pingTimer(10U),
 m_audio(nullptr),
 m_audioCount(0U),
-m_lc(),
+m_header(nullptr),
+m_voice(nullptr),
+m_trailer(nullptr),
 m_seqNo(0U),
-m_N(0U)
+m_N(0U),
+m_rxSeqNo(0U),
+m_rxSeqValid(false)
 {
 	assert(remotePort > 0U);
 	assert(id > 0U);
@@ -70,15 +76,27 @@ m_N(0U)
 	m_buffer   = new uint8_t[BUFFER_LENGTH];
 	m_id       = new uint8_t[sizeof(uint32_t)];
 	m_audio    = new uint8_t[DMR_NXDN_DATA_LENGTH * 3U];
+	m_header   = new uint8_t[DMR_FRAME_LENGTH_BYTES];
+	m_voice    = new uint8_t[DMR_FRAME_LENGTH_BYTES * 6U];
+	m_trailer  = new uint8_t[DMR_FRAME_LENGTH_BYTES];
 
 	m_id[0U] = id >> 24;
 	m_id[1U] = id >> 16;
 	m_id[2U] = id >> 8;
 	m_id[3U] = id >> 0;
 
+	// A replay has to produce the same stream ids every time
 	std::random_device rd;
-	std::mt19937 mt(rd());
+	std::mt19937 mt(ReplayActive() ? std::mt19937::default_seed : rd());
 	m_random = mt;
+
+	m_metrics = MetricsNetwork(network, DATA_MODE::DMR);
+
+	m_pingTimer.setCallback(onPing, this);
+
+	m_socket.setMetrics(m_metrics);
+	m_socket.setCapture(CaptureInterface(network, DATA_MODE::DMR), m_addr, m_addrLen);
+	m_rxData.setCounters(&m_metrics->m_overflows, &m_metrics->m_underflows);
 }
 
 CDMRNetwork::~CDMRNetwork()
@@ -86,6 +104,11 @@ CDMRNetwork::~CDMRNetwork()
 	delete[] m_buffer;
 	delete[] m_id;
 	delete[] m_audio;
+	delete[] m_header;
+	delete[] m_voice;
+	delete[] m_trailer;
+	delete m_jitterBuffer;
+	delete m_pacer;
 }
 
 void CDMRNetwork::setConfig(const std::string& callsign, const char* version, uint32_t txFrequency, uint32_t rxFrequency, uint8_t colorCode, uint16_t power)
@@ -100,6 +123,22 @@ void CDMRNetwork::setConfig(const std::string& callsign, const char* version, ui
 	m_power       = power;
 }
 
+void CDMRNetwork::setJitterBuffer(unsigned int maxDelay)
+{
+	if (maxDelay == 0U)
+		return;
+
+	// One DMRD packet carries a 60ms burst, with an eight bit sequence number
+	delete m_jitterBuffer;
+	m_jitterBuffer = new CJitterBuffer(m_network == NETWORK::RF ? "DMR RF Network" : "DMR Net Network", HOMEBREW_DATA_PACKET_LENGTH, 256U, 60U, maxDelay);
+}
+
+void CDMRNetwork::setPacing(unsigned int lead)
+{
+	delete m_pacer;
+	m_pacer = new CPacer(m_network == NETWORK::RF ? "DMR RF Network" : "DMR Net Network", HOMEBREW_DATA_PACKET_LENGTH, 60U, lead);
+}
+
 bool CDMRNetwork::open()
 {
 	if (m_addrLen == 0U) {
@@ -142,7 +181,11 @@ bool CDMRNetwork::writeRaw(CMetaData& data)
 			CUtils::dump(1U, "DMR Net Network Raw Sent", buffer, length);
 	}
 
-	return m_socket.write(buffer, length, m_addr, m_addrLen);
+	bool ret = m_socket.write(buffer, length, m_addr, m_addrLen);
+
+	LatencyAdd(STAGE::SEND, data.getSendTime());
+
+	return ret;
 }
 
 bool CDMRNetwork::read(CMetaData& data)
@@ -163,10 +206,13 @@ bool CDMRNetwork::read(CMetaData& data)
 	if (m_rxData.empty())
 		return false;
 
-	uint8_t length = 0U;
+	uint8_t  length  = 0U;
+	uint64_t arrival = 0U;
 	m_rxData.get(&length, 1U);
+	m_rxData.get((uint8_t*)&arrival, sizeof(uint64_t));
 	m_rxData.get(m_buffer, length);
 
+	data.setReceiveTime(arrival);
 	data.setRaw(m_buffer, length);
 
 	// Is this a data packet?
@@ -183,32 +229,40 @@ bool CDMRNetwork::read(CMetaData& data)
 				uint8_t slot   = (m_buffer[15U] & 0x80U) == 0x80U ? 2U : 1U;
 				bool grp       = (m_buffer[15U] & 0x40U) == 0x40U;
 				data.setDMR(m_network, slot, srcId, dstId, grp);
+
+				m_rxSeqNo    = m_buffer[4U];
+				m_rxSeqValid = true;
 			}
 			break;
 
 		case DT_TERMINATOR_WITH_LC:
 			data.setEnd();
+			m_rxSeqValid = false;
 			break;
 
 		default:
+			// A PI header, CSBK or data burst in the stream still takes up a sequence number
+			if (m_rxSeqValid)
+				m_rxSeqNo = m_buffer[4U];
 			break;
 		}
 
 		return true;
 	}
 
-	uint16_t inOffset = (20U * 8U) + 0U;
-	uint16_t outOffset = 0U;
-	for (unsigned int i = 0U; i < 108U; i++, inOffset++, outOffset++) {
-		bool b = READ_BIT8(m_buffer, inOffset) != 0U;
-		WRITE_BIT8(m_audio, outOffset, b);
+	// Replace any lost bursts, three frames each, before this one
+	if (m_rxSeqValid) {
+		uint8_t missing = uint8_t(m_buffer[4U] - m_rxSeqNo - 1U);
+		if (missing < 128U)
+			data.setMissingData(missing * 3U);
 	}
 
-	inOffset += 48U;
-	for (unsigned int i = 0U; i < 108U; i++, inOffset++, outOffset++) {
-		bool b = READ_BIT8(m_buffer, inOffset) != 0U;
-		WRITE_BIT8(m_audio, outOffset, b);
-	}
+	m_rxSeqNo    = m_buffer[4U];
+	m_rxSeqValid = true;
+
+	// The audio is either side of the 48 bit sync or EMB
+	CUtils::copyBits(m_buffer, (20U * 8U) + 0U,   m_audio, 0U,   108U);
+	CUtils::copyBits(m_buffer, (20U * 8U) + 156U, m_audio, 108U, 108U);
 
 	data.setData(m_audio + 0U);
 
@@ -222,8 +276,10 @@ bool CDMRNetwork::read()
 	if (m_rxData.empty())
 		return false;
 
-	uint8_t length = 0U;
+	uint8_t  length  = 0U;
+	uint64_t arrival = 0U;
 	m_rxData.get(&length, 1U);
+	m_rxData.get((uint8_t*)&arrival, sizeof(uint64_t));
 	m_rxData.get(m_buffer, length);
 
 	return true;
@@ -234,58 +290,73 @@ bool CDMRNetwork::writeData(CMetaData& data)
 	if (m_addrLen == 0U)
 		return false;
 
-	switch (m_audioCount) {
-	case 0U:
-		for (uint16_t i = 0U; i < 3U; i++)
-			::memcpy(m_audio + (i * DMR_NXDN_DATA_LENGTH), DMR_SILENCE, DMR_NXDN_DATA_LENGTH);
-
-		if (data.hasData()) {
-			data.getData(m_audio + 0U);
-			m_audioCount = 1U;
+	// Pack everything the transcoder has ready, three frames per burst
+	while (data.hasData()) {
+		if (m_audioCount == 0U) {
+			for (uint16_t i = 0U; i < 3U; i++)
+				::memcpy(m_audio + (i * DMR_NXDN_DATA_LENGTH), DMR_SILENCE, DMR_NXDN_DATA_LENGTH);
 		}
 
-		if (!data.isEnd())
-			return true;
-		break;
+		data.getData(m_audio + (m_audioCount * DMR_NXDN_DATA_LENGTH), DMR_NXDN_DATA_LENGTH);
+		m_audioCount++;
 
-	case 1U:
-		if (data.hasData()) {
-			data.getData(m_audio + DMR_NXDN_DATA_LENGTH);
-			m_audioCount = 2U;
-		}
-
-		if (!data.isEnd())
-			return true;
-		break;
-
-	case 2U:
-		if (data.hasData()) {
-			data.getData(m_audio + DMR_NXDN_DATA_LENGTH + DMR_NXDN_DATA_LENGTH);
+		if (m_audioCount == 3U) {
 			m_audioCount = 0U;
-		}
 
-		break;
+			if (m_seqNo == 0U) {
+				bool ret = writeHeader(data);
+				if (!ret)
+					return false;
+			}
 
-	default:
-		// This shouldn't happen
-		assert(false);
+			bool ret = writeAudio(data);
+			if (!ret)
+				return false;
+		}
 	}
 
+	if (!data.isEnd())
+		return true;
+
 	if (m_seqNo == 0U) {
 		bool ret = writeHeader(data);
 		if (!ret)
 			return false;
-		return writeAudio(data);
-	} else if (data.isEnd()) {
-		if (m_audioCount > 0U) {
-			bool ret = writeAudio(data);
-			if (!ret)
-				return false;
-		}
-		return writeTrailer(data);
-	} else {
-		return writeAudio(data);
 	}
+
+	// Send any partial burst, padded with silence
+	if (m_audioCount > 0U) {
+		m_audioCount = 0U;
+
+		bool ret = writeAudio(data);
+		if (!ret)
+			return false;
+	}
+
+	return writeTrailer(data);
+}
+
+void CDMRNetwork::encodeLC(FLCO flco, uint32_t srcId, uint32_t dstId)
+{
+	// The LC does not change during a call, so every frame carrying it is built once here
+	CDMRLC lc;
+	lc.setParameters(flco, srcId, dstId);
+
+	::memcpy(m_header, HEADER_SYNC_SLOT_TYPE, DMR_FRAME_LENGTH_BYTES);
+	lc.encode(m_header, DT_VOICE_LC_HEADER);
+
+	::memcpy(m_voice + (0U * DMR_FRAME_LENGTH_BYTES), VOICE_SYNC,   DMR_FRAME_LENGTH_BYTES);
+	::memcpy(m_voice + (1U * DMR_FRAME_LENGTH_BYTES), FIRST_LC_EMB, DMR_FRAME_LENGTH_BYTES);
+	::memcpy(m_voice + (2U * DMR_FRAME_LENGTH_BYTES), CONT_LC_EMB,  DMR_FRAME_LENGTH_BYTES);
+	::memcpy(m_voice + (3U * DMR_FRAME_LENGTH_BYTES), CONT_LC_EMB,  DMR_FRAME_LENGTH_BYTES);
+	::memcpy(m_voice + (4U * DMR_FRAME_LENGTH_BYTES), LAST_LC_EMB,  DMR_FRAME_LENGTH_BYTES);
+	::memcpy(m_voice + (5U * DMR_FRAME_LENGTH_BYTES), NULL_LC_EMB,  DMR_FRAME_LENGTH_BYTES);
+
+	for (uint8_t n = 0U; n < 4U; n++)
+		lc.getData(m_voice + ((n + 1U) * DMR_FRAME_LENGTH_BYTES), n);
+
+	::memcpy(m_trailer, TRAILER_SYNC_SLOT_TYPE, DMR_FRAME_LENGTH_BYTES);
+	lc.encode(m_trailer, DT_TERMINATOR_WITH_LC);
 }
 
 bool CDMRNetwork::writeHeader(CMetaData& data)
@@ -295,9 +366,7 @@ bool CDMRNetwork::writeHeader(CMetaData& data)
 	bool grp = true;
 	data.getDMR(m_network, slot, srcId, dstId, grp);
 
-	FLCO flco = grp ? FLCO::GROUP : FLCO::USER_USER;
-
-	m_lc.setParameters(flco, srcId, dstId);
+	encodeLC(grp ? FLCO::GROUP : FLCO::USER_USER, srcId, dstId);
 
 	uint8_t buffer[HOMEBREW_DATA_PACKET_LENGTH];
 	::memset(buffer, 0x00U, HOMEBREW_DATA_PACKET_LENGTH);
@@ -330,9 +399,7 @@ bool CDMRNetwork::writeHeader(CMetaData& data)
 
 	::memcpy(buffer + 16U, &m_streamId, 4U);
 
-	::memcpy(buffer + 20U, HEADER_SYNC_SLOT_TYPE, DMR_FRAME_LENGTH_BYTES);
-
-	m_lc.encode(buffer + 20U, DT_VOICE_LC_HEADER);
+	::memcpy(buffer + 20U, m_header, DMR_FRAME_LENGTH_BYTES);
 
 	buffer[53U] = 0U;
 	buffer[54U] = 0U;
@@ -347,7 +414,7 @@ bool CDMRNetwork::writeHeader(CMetaData& data)
 			CUtils::dump(1U, "DMR Net Network Header Sent", buffer, HOMEBREW_DATA_PACKET_LENGTH);
 	}
 
-	return m_socket.write(buffer, HOMEBREW_DATA_PACKET_LENGTH, m_addr, m_addrLen);
+	return writePacket(buffer, HOMEBREW_DATA_PACKET_LENGTH);
 }
 
 bool CDMRNetwork::writeAudio(CMetaData& data)
@@ -357,10 +424,6 @@ bool CDMRNetwork::writeAudio(CMetaData& data)
 	bool grp = true;
 	data.getDMR(m_network, slot, srcId, dstId, grp);
 
-	FLCO flco = grp ? FLCO::GROUP : FLCO::USER_USER;
-
-	m_lc.setParameters(flco, srcId, dstId);
-
 	uint8_t buffer[HOMEBREW_DATA_PACKET_LENGTH];
 	::memset(buffer, 0x00U, HOMEBREW_DATA_PACKET_LENGTH);
 
@@ -387,58 +450,19 @@ bool CDMRNetwork::writeAudio(CMetaData& data)
 
 	::memcpy(buffer + 16U, &m_streamId, 4U);
 
-	switch (m_N) {
-	case 0U:
-		::memcpy(buffer + 20U, VOICE_SYNC, DMR_FRAME_LENGTH_BYTES);
+	// The sync or embedded signalling for this burst was built with the header
+	::memcpy(buffer + 20U, m_voice + (m_N * DMR_FRAME_LENGTH_BYTES), DMR_FRAME_LENGTH_BYTES);
+
+	if (m_N == 0U)
 		buffer[15U] |= 0x10U;
-		m_N++;
-		break;
-	case 1U:
-		::memcpy(buffer + 20U, FIRST_LC_EMB, DMR_FRAME_LENGTH_BYTES);
-		m_lc.getData(buffer + 20U, 0U);
-		buffer[15U] |= 1U;
-		m_N++;
-		break;
-	case 2U:
-		::memcpy(buffer + 20U, CONT_LC_EMB, DMR_FRAME_LENGTH_BYTES);
-		m_lc.getData(buffer + 20U, 1U);
-		buffer[15U] |= 2U;
-		m_N++;
-		break;
-	case 3U:
-		::memcpy(buffer + 20U, CONT_LC_EMB, DMR_FRAME_LENGTH_BYTES);
-		m_lc.getData(buffer + 20U, 2U);
-		buffer[15U] |= 3U;
-		m_N++;
-		break;
-	case 4U:
-		::memcpy(buffer + 20U, LAST_LC_EMB, DMR_FRAME_LENGTH_BYTES);
-		m_lc.getData(buffer + 20U, 3U);
-		buffer[15U] |= 4U;
-		m_N++;
-		break;
-	case 5U:
-		::memcpy(buffer + 20U, NULL_LC_EMB, DMR_FRAME_LENGTH_BYTES);
-		buffer[15U] |= 5U;
-		m_N = 0U;
-		break;
-	default:
-		assert(false);
-	}
+	else
+		buffer[15U] |= m_N;
 
-	// Add the audio
-	uint16_t inOffset = 0U;
-	uint16_t outOffset = (20U * 8U) + 0U;
-	for (unsigned int i = 0U; i < 108U; i++, inOffset++, outOffset++) {
-		bool b = READ_BIT8(m_audio, inOffset) != 0U;
-		WRITE_BIT8(buffer, outOffset, b);
-	}
+	m_N = (m_N + 1U) % 6U;
 
-	outOffset += 48U;
-	for (unsigned int i = 0U; i < 108U; i++, inOffset++, outOffset++) {
-		bool b = READ_BIT8(m_audio, inOffset) != 0U;
-		WRITE_BIT8(buffer, outOffset, b);
-	}
+	// Add the audio
+	CUtils::copyBits(m_audio, 0U,   buffer, (20U * 8U) + 0U,   108U);
+	CUtils::copyBits(m_audio, 108U, buffer, (20U * 8U) + 156U, 108U);
 
 	buffer[53U] = 0U;
 	buffer[54U] = 0U;
@@ -452,7 +476,7 @@ bool CDMRNetwork::writeAudio(CMetaData& data)
 			CUtils::dump(1U, "DMR Net Network Audio Sent", buffer, HOMEBREW_DATA_PACKET_LENGTH);
 	}
 	
-	return m_socket.write(buffer, HOMEBREW_DATA_PACKET_LENGTH, m_addr, m_addrLen);
+	return writePacket(buffer, HOMEBREW_DATA_PACKET_LENGTH, data.getSendTime());
 }
 
 bool CDMRNetwork::writeTrailer(CMetaData& data)
@@ -462,10 +486,6 @@ bool CDMRNetwork::writeTrailer(CMetaData& data)
 	bool grp = true;
 	data.getDMR(m_network, slot, srcId, dstId, grp);
 
-	FLCO flco = grp ? FLCO::GROUP : FLCO::USER_USER;
-
-	m_lc.setParameters(flco, srcId, dstId);
-
 	uint8_t buffer[HOMEBREW_DATA_PACKET_LENGTH];
 	::memset(buffer, 0x00U, HOMEBREW_DATA_PACKET_LENGTH);
 
@@ -494,9 +514,7 @@ bool CDMRNetwork::writeTrailer(CMetaData& data)
 
 	::memcpy(buffer + 16U, &m_streamId, 4U);
 
-	::memcpy(buffer + 20U, TRAILER_SYNC_SLOT_TYPE, DMR_FRAME_LENGTH_BYTES);
-
-	m_lc.encode(buffer + 20U, DT_TERMINATOR_WITH_LC);
+	::memcpy(buffer + 20U, m_trailer, DMR_FRAME_LENGTH_BYTES);
 
 	buffer[53U] = 0U;
 	buffer[54U] = 0U;
@@ -508,15 +526,48 @@ bool CDMRNetwork::writeTrailer(CMetaData& data)
 			CUtils::dump(1U, "DMR Net Network Trailer Sent", buffer, HOMEBREW_DATA_PACKET_LENGTH);
 	}
 
-	return m_socket.write(buffer, HOMEBREW_DATA_PACKET_LENGTH, m_addr, m_addrLen);
+	return writePacket(buffer, HOMEBREW_DATA_PACKET_LENGTH);
+}
+
+bool CDMRNetwork::writePacket(const uint8_t* data, uint16_t length, uint64_t start)
+{
+	assert(data != nullptr);
+
+	if (m_pacer == nullptr) {
+		bool ret = m_socket.write(data, length, m_addr, m_addrLen);
+		LatencyAdd(STAGE::SEND, start);
+		return ret;
+	}
+
+	if (!m_pacer->add(data, length, start))
+		return false;
+
+	writePaced();
+
+	return true;
+}
+
+void CDMRNetwork::writePaced()
+{
+	uint8_t buffer[HOMEBREW_DATA_PACKET_LENGTH];
+	uint16_t length = 0U;
+	uint64_t start  = 0U;
+
+	while (m_pacer->get(buffer, length, start)) {
+		m_socket.write(buffer, length, m_addr, m_addrLen);
+		LatencyAdd(STAGE::SEND, start);
+	}
 }
 
 void CDMRNetwork::reset()
 {
 	m_rxData.clear();
+	if (m_jitterBuffer != nullptr)
+		m_jitterBuffer->reset();
 	m_audioCount = 0U;
 	m_seqNo      = 0U;
 	m_N          = 0U;
+	m_rxSeqValid = false;
 }
 
 bool CDMRNetwork::hasData()
@@ -531,18 +582,44 @@ void CDMRNetwork::close()
 	else
 		LogMessage("Closing the DMR Net network");
 
+	m_pingTimer.stop();
+
 	m_socket.close();
 }
 
+void CDMRNetwork::onPing(void* obj)
+{
+	assert(obj != nullptr);
+
+	CDMRNetwork* p = static_cast<CDMRNetwork*>(obj);
+
+	if (p->m_network == NETWORK::RF)
+		p->writePing();
+	else
+		p->writeConfig();
+
+	p->m_pingTimer.start();
+}
+
 void CDMRNetwork::clock(unsigned int ms)
 {
-	m_pingTimer.clock(ms);
-	if (m_pingTimer.isRunning() && m_pingTimer.hasExpired()) {
-		if (m_network == NETWORK::RF)
-			writePing();
-		else
-			writeConfig();
-		m_pingTimer.start();
+	if (m_pacer != nullptr) {
+		m_pacer->clock(ms);
+		writePaced();
+	}
+
+	if (m_jitterBuffer != nullptr) {
+		m_jitterBuffer->clock(ms);
+
+		uint8_t buffer[HOMEBREW_DATA_PACKET_LENGTH];
+		uint16_t length  = 0U;
+		uint64_t arrival = 0U;
+		while (m_jitterBuffer->get(buffer, length, arrival)) {
+			uint8_t len = length;
+			m_rxData.add(&len, 1U);
+			m_rxData.add((uint8_t*)&arrival, sizeof(uint64_t));
+			m_rxData.add(buffer, len);
+		}
 	}
 
 	sockaddr_storage address;
@@ -552,6 +629,8 @@ void CDMRNetwork::clock(unsigned int ms)
 		return;
 
 	if (!CUDPSocket::match(m_addr, address)) {
+		m_metrics->m_invalidSource.add();
+
 		if (m_network == NETWORK::RF)
 			LogMessage("DMR RF packet received from an invalid source");
 		else
@@ -559,6 +638,8 @@ void CDMRNetwork::clock(unsigned int ms)
 		return;
 	}
 
+	uint64_t arrival = LatencyTime();
+
 	if (m_debug) {
 		if (m_network == NETWORK::RF)
 			CUtils::dump(1U, "DMR RF Network Received", m_buffer, length);
@@ -570,11 +651,42 @@ void CDMRNetwork::clock(unsigned int ms)
 	if (::memcmp(m_buffer, "DMRD", 4U) != 0)
 		return;
 
+	if (m_jitterBuffer != nullptr) {
+		uint32_t streamId = 0U;
+		::memcpy(&streamId, m_buffer + 16U, 4U);
+
+		// A new stream starts at sequence zero, even if the end of the last one was lost
+		bool header = ((m_buffer[15U] & 0x20U) == 0x20U) && ((m_buffer[15U] & DT_MASK) == DT_VOICE_LC_HEADER);
+		if (header || (streamId != m_rxStreamId)) {
+			flushJitterBuffer();
+			m_rxStreamId = streamId;
+		}
+
+		bool end = ((m_buffer[15U] & 0x20U) == 0x20U) && ((m_buffer[15U] & DT_MASK) == DT_TERMINATOR_WITH_LC);
+		m_jitterBuffer->add(m_buffer, length, m_buffer[4U], arrival, end);
+		return;
+	}
+
 	uint8_t len = length;
 	m_rxData.add(&len, 1U);
+	m_rxData.add((uint8_t*)&arrival, sizeof(uint64_t));
 	m_rxData.add(m_buffer, len);
 }
 
+// Passes on what is left of the previous stream, and leaves the jitter buffer ready for the next
+void CDMRNetwork::flushJitterBuffer()
+{
+	uint8_t buffer[HOMEBREW_DATA_PACKET_LENGTH];
+	uint16_t length  = 0U;
+	uint64_t arrival = 0U;
+	while (m_jitterBuffer->flush(buffer, length, arrival)) {
+		uint8_t len = length;
+		m_rxData.add(&len, 1U);
+		m_rxData.add((uint8_t*)&arrival, sizeof(uint64_t));
+		m_rxData.add(buffer, len);
+	}
+}
+
 bool CDMRNetwork::writeConfig()
 {
 	const char* software = "MMDVM_CrossMode";
@@ -23,6 +23,8 @@
 #include "Defines.h"
 #include "UDPSocket.h"
 #include "Timer.h"
+#include "JitterBuffer.h"
+#include "Pacer.h"
 #include "RingBuffer.h"
 #include "DMRLC.h"
 #include "MetaData.h"
@@ -39,6 +41,9 @@ public:
 
 	void setConfig(const std::string& callsign, const char* version, uint32_t txFrequency, uint32_t rxFrequency, uint8_t colorCode, uint16_t power);
 
+	void setJitterBuffer(unsigned int maxDelay);
+	void setPacing(unsigned int lead);
+
 	virtual bool open();
 
 	virtual bool writeRaw(CMetaData& data);
@@ -57,6 +62,7 @@ public:
 
 private:
 	NETWORK          m_network;
+	CNetworkMetrics* m_metrics;
 	CUDPSocket       m_socket;
 	sockaddr_storage m_addr;
 	size_t           m_addrLen;
@@ -70,20 +76,33 @@ private:
 	uint16_t         m_power;
 	uint8_t*         m_buffer;
 	uint32_t         m_streamId;
+	uint32_t         m_rxStreamId;
 	CRingBuffer<uint8_t> m_rxData;
+	CJitterBuffer*   m_jitterBuffer;
+	CPacer*          m_pacer;
 	std::mt19937     m_random;
 	CTimer           m_pingTimer;
 	uint8_t*         m_audio;
 	uint8_t          m_audioCount;
-	CDMRLC           m_lc;
+	uint8_t*         m_header;
+	uint8_t*         m_voice;
+	uint8_t*         m_trailer;
 	uint16_t         m_seqNo;
 	uint8_t          m_N;
+	uint8_t          m_rxSeqNo;
+	bool             m_rxSeqValid;
 
+	void encodeLC(FLCO flco, uint32_t srcId, uint32_t dstId);
 	bool writeHeader(CMetaData& data);
 	bool writeAudio(CMetaData& data);
 	bool writeTrailer(CMetaData& data);
+	bool writePacket(const uint8_t* data, uint16_t length, uint64_t start = 0U);
+	void writePaced();
+	void flushJitterBuffer();
 	bool writeConfig();
 	bool writePing();
+
+	static void onPing(void* obj);
 };
 
 #endif
@@ -27,6 +27,8 @@ const unsigned int DSTAR_FRAME_LENGTH_BYTES  = 12U;
 const uint8_t DSTAR_END_PATTERN_BYTES[] = { 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0xC8, 0x7A };
 const unsigned int  DSTAR_END_PATTERN_LENGTH_BYTES = 12U;
 
+const uint8_t DSTAR_NULL_AMBE_DATA_BYTES[] = { 0x9EU, 0x8DU, 0x32U, 0x88U, 0x26U, 0x1AU, 0x3FU, 0x61U, 0xE8U };
+
 const uint8_t DSTAR_NULL_SLOW_SYNC_BYTES[] = { 0x55, 0x2D, 0x16 };
 // Note that these are already scrambled, 0x66 0x66 0x66 otherwise
 const uint8_t DSTAR_NULL_SLOW_DATA_BYTES[] = { 0x16, 0x29, 0xF5 };
@@ -19,6 +19,10 @@
 #include "DStarDefines.h"
 #include "DStarNetwork.h"
 #include "StopWatch.h"
+#include "Capture.h"
+#include "Replay.h"
+#include "Latency.h"
+#include "CRC.h"
 #include "Defines.h"
 #include "Utils.h"
 #include "Log.h"
@@ -28,44 +32,11 @@
 #include <cstring>
 #include <cstdlib>
 
-const uint16_t CCITT16_TABLE[] = {
-	0x0000U, 0x1189U, 0x2312U, 0x329bU, 0x4624U, 0x57adU, 0x6536U, 0x74bfU,
-	0x8c48U, 0x9dc1U, 0xaf5aU, 0xbed3U, 0xca6cU, 0xdbe5U, 0xe97eU, 0xf8f7U,
-	0x1081U, 0x0108U, 0x3393U, 0x221aU, 0x56a5U, 0x472cU, 0x75b7U, 0x643eU,
-	0x9cc9U, 0x8d40U, 0xbfdbU, 0xae52U, 0xdaedU, 0xcb64U, 0xf9ffU, 0xe876U,
-	0x2102U, 0x308bU, 0x0210U, 0x1399U, 0x6726U, 0x76afU, 0x4434U, 0x55bdU,
-	0xad4aU, 0xbcc3U, 0x8e58U, 0x9fd1U, 0xeb6eU, 0xfae7U, 0xc87cU, 0xd9f5U,
-	0x3183U, 0x200aU, 0x1291U, 0x0318U, 0x77a7U, 0x662eU, 0x54b5U, 0x453cU,
-	0xbdcbU, 0xac42U, 0x9ed9U, 0x8f50U, 0xfbefU, 0xea66U, 0xd8fdU, 0xc974U,
-	0x4204U, 0x538dU, 0x6116U, 0x709fU, 0x0420U, 0x15a9U, 0x2732U, 0x36bbU,
-	0xce4cU, 0xdfc5U, 0xed5eU, 0xfcd7U, 0x8868U, 0x99e1U, 0xab7aU, 0xbaf3U,
-	0x5285U, 0x430cU, 0x7197U, 0x601eU, 0x14a1U, 0x0528U, 0x37b3U, 0x263aU,
-	0xdecdU, 0xcf44U, 0xfddfU, 0xec56U, 0x98e9U, 0x8960U, 0xbbfbU, 0xaa72U,
-	0x6306U, 0x728fU, 0x4014U, 0x519dU, 0x2522U, 0x34abU, 0x0630U, 0x17b9U,
-	0xef4eU, 0xfec7U, 0xcc5cU, 0xddd5U, 0xa96aU, 0xb8e3U, 0x8a78U, 0x9bf1U,
-	0x7387U, 0x620eU, 0x5095U, 0x411cU, 0x35a3U, 0x242aU, 0x16b1U, 0x0738U,
-	0xffcfU, 0xee46U, 0xdcddU, 0xcd54U, 0xb9ebU, 0xa862U, 0x9af9U, 0x8b70U,
-	0x8408U, 0x9581U, 0xa71aU, 0xb693U, 0xc22cU, 0xd3a5U, 0xe13eU, 0xf0b7U,
-	0x0840U, 0x19c9U, 0x2b52U, 0x3adbU, 0x4e64U, 0x5fedU, 0x6d76U, 0x7cffU,
-	0x9489U, 0x8500U, 0xb79bU, 0xa612U, 0xd2adU, 0xc324U, 0xf1bfU, 0xe036U,
-	0x18c1U, 0x0948U, 0x3bd3U, 0x2a5aU, 0x5ee5U, 0x4f6cU, 0x7df7U, 0x6c7eU,
-	0xa50aU, 0xb483U, 0x8618U, 0x9791U, 0xe32eU, 0xf2a7U, 0xc03cU, 0xd1b5U,
-	0x2942U, 0x38cbU, 0x0a50U, 0x1bd9U, 0x6f66U, 0x7eefU, 0x4c74U, 0x5dfdU,
-	0xb58bU, 0xa402U, 0x9699U, 0x8710U, 0xf3afU, 0xe226U, 0xd0bdU, 0xc134U,
-	0x39c3U, 0x284aU, 0x1ad1U, 0x0b58U, 0x7fe7U, 0x6e6eU, 0x5cf5U, 0x4d7cU,
-	0xc60cU, 0xd785U, 0xe51eU, 0xf497U, 0x8028U, 0x91a1U, 0xa33aU, 0xb2b3U,
-	0x4a44U, 0x5bcdU, 0x6956U, 0x78dfU, 0x0c60U, 0x1de9U, 0x2f72U, 0x3efbU,
-	0xd68dU, 0xc704U, 0xf59fU, 0xe416U, 0x90a9U, 0x8120U, 0xb3bbU, 0xa232U,
-	0x5ac5U, 0x4b4cU, 0x79d7U, 0x685eU, 0x1ce1U, 0x0d68U, 0x3ff3U, 0x2e7aU,
-	0xe70eU, 0xf687U, 0xc41cU, 0xd595U, 0xa12aU, 0xb0a3U, 0x8238U, 0x93b1U,
-	0x6b46U, 0x7acfU, 0x4854U, 0x59ddU, 0x2d62U, 0x3cebU, 0x0e70U, 0x1ff9U,
-	0xf78fU, 0xe606U, 0xd49dU, 0xc514U, 0xb1abU, 0xa022U, 0x92b9U, 0x8330U,
-	0x7bc7U, 0x6a4eU, 0x58d5U, 0x495cU, 0x3de3U, 0x2c6aU, 0x1ef1U, 0x0f78U };
-
 const unsigned int BUFFER_LENGTH = 100U;
 
 CDStarNetwork::CDStarNetwork(NETWORK network, const std::string& callsign, const std::string& localAddress, uint16_t localPort, const std::string& remoteAddress, uint16_t remotePort, bool debug) :
 m_network(network),
+m_metrics(nullptr),
 m_callsign(callsign),
 m_socket(localAddress, localPort),
 m_addr(),
@@ -74,8 +45,12 @@ m_debug(debug),
 m_outId(0U),
 m_outSeq(0U),
 m_inId(0U),
+m_inSeq(0U),
+m_rxId(0U),
 m_buffer(1000U, "D-Star Network"),
-m_pollTimer(1000U, 60U),
+m_jitterBuffer(nullptr),
+m_pacer(nullptr),
+m_pollTimer(60U),
 m_random(),
 m_header(nullptr)
 {
@@ -87,14 +62,41 @@ m_header(nullptr)
 
 	m_header = new uint8_t[DSTAR_HEADER_LENGTH_BYTES];
 
+	// A replay has to produce the same stream ids every time
 	std::random_device rd;
-	std::mt19937 mt(rd());
+	std::mt19937 mt(ReplayActive() ? std::mt19937::default_seed : rd());
 	m_random = mt;
+
+	m_metrics = MetricsNetwork(network, DATA_MODE::DSTAR);
+
+	m_pollTimer.setCallback(onPoll, this);
+
+	m_socket.setMetrics(m_metrics);
+	m_socket.setCapture(CaptureInterface(network, DATA_MODE::DSTAR), m_addr, m_addrLen);
+	m_buffer.setCounters(&m_metrics->m_overflows, &m_metrics->m_underflows);
 }
 
 CDStarNetwork::~CDStarNetwork()
 {
 	delete[] m_header;
+	delete m_jitterBuffer;
+	delete m_pacer;
+}
+
+void CDStarNetwork::setJitterBuffer(unsigned int maxDelay)
+{
+	if (maxDelay == 0U)
+		return;
+
+	// One DSRP data packet carries a 20ms frame, with a sequence number from 0 to 20
+	delete m_jitterBuffer;
+	m_jitterBuffer = new CJitterBuffer(m_network == NETWORK::RF ? "D-Star RF Network" : "D-Star Net Network", BUFFER_LENGTH, 21U, 20U, maxDelay);
+}
+
+void CDStarNetwork::setPacing(unsigned int lead)
+{
+	delete m_pacer;
+	m_pacer = new CPacer(m_network == NETWORK::RF ? "D-Star RF Network" : "D-Star Net Network", BUFFER_LENGTH, 20U, lead);
 }
 
 bool CDStarNetwork::open()
@@ -135,7 +137,11 @@ bool CDStarNetwork::writeRaw(CMetaData& data)
 			CUtils::dump(1U, "D-Star Net Network Raw Sent", buffer, length);
 	}
 
-	return m_socket.write(buffer, length, m_addr, m_addrLen);
+	bool ret = m_socket.write(buffer, length, m_addr, m_addrLen);
+
+	LatencyAdd(STAGE::SEND, data.getSendTime());
+
+	return ret;
 }
 
 bool CDStarNetwork::writeData(CMetaData& data)
@@ -149,7 +155,7 @@ bool CDStarNetwork::writeData(CMetaData& data)
 			return false;
 	}
 
-	if (data.hasData()) {
+	while (data.hasData()) {
 		bool ret = writeBody(data);
 		if (!ret)
 			return false;
@@ -197,7 +203,7 @@ bool CDStarNetwork::writeHeader(const CMetaData& data)
 			CUtils::dump(1U, "D-Star Net Network Header Sent", buffer, 49U);		
 	}
 
-	return m_socket.write(buffer, 49U, m_addr, m_addrLen);
+	return writePacket(buffer, 49U);
 }
 
 bool CDStarNetwork::writeBody(CMetaData& data)
@@ -217,7 +223,11 @@ bool CDStarNetwork::writeBody(CMetaData& data)
 	buffer[7] = m_outSeq;
 	buffer[8] = 0U;
 
-	data.getData(buffer + 9U);
+	// A frame that getData() skips goes out as silence rather than whatever was on the stack
+	::memcpy(buffer + 9U, DSTAR_NULL_AMBE_DATA_BYTES, DSTAR_DATA_LENGTH);
+	data.getData(buffer + 9U, DSTAR_DATA_LENGTH);
+
+	uint64_t start = data.getSendTime();
 
 	addSlowData(buffer + 18U);
 
@@ -230,7 +240,7 @@ bool CDStarNetwork::writeBody(CMetaData& data)
 			CUtils::dump(1U, "D-Star Net Network Header Sent", buffer, length);
 	}
 
-	return m_socket.write(buffer, length, m_addr, m_addrLen);
+	return writePacket(buffer, length, start);
 }
 
 bool CDStarNetwork::writeTrailer(CMetaData& data)
@@ -261,7 +271,7 @@ bool CDStarNetwork::writeTrailer(CMetaData& data)
 			CUtils::dump(1U, "D-Star Net Network Header Sent", buffer, length);
 	}
 
-	return m_socket.write(buffer, length, m_addr, m_addrLen);
+	return writePacket(buffer, length);
 }
 
 bool CDStarNetwork::writePoll(const char* text)
@@ -292,16 +302,68 @@ bool CDStarNetwork::writePoll(const char* text)
 	return m_socket.write(buffer, 6U + length, m_addr, m_addrLen);
 }
 
+bool CDStarNetwork::writePacket(const uint8_t* data, uint16_t length, uint64_t start)
+{
+	assert(data != nullptr);
+
+	if (m_pacer == nullptr) {
+		bool ret = m_socket.write(data, length, m_addr, m_addrLen);
+		LatencyAdd(STAGE::SEND, start);
+		return ret;
+	}
+
+	if (!m_pacer->add(data, length, start))
+		return false;
+
+	writePaced();
+
+	return true;
+}
+
+void CDStarNetwork::writePaced()
+{
+	uint8_t buffer[BUFFER_LENGTH];
+	uint16_t length = 0U;
+	uint64_t start  = 0U;
+
+	while (m_pacer->get(buffer, length, start)) {
+		m_socket.write(buffer, length, m_addr, m_addrLen);
+		LatencyAdd(STAGE::SEND, start);
+	}
+}
+
+void CDStarNetwork::onPoll(void* obj)
+{
+	assert(obj != nullptr);
+
+	CDStarNetwork* p = static_cast<CDStarNetwork*>(obj);
+
+	p->writePoll("cross-mode");
+
+	p->m_pollTimer.start();
+}
+
 void CDStarNetwork::clock(unsigned int ms)
 {
-	m_pollTimer.clock(ms);
-	if (m_pollTimer.hasExpired()) {
-		writePoll("cross-mode");
-		m_pollTimer.start();
+	if (m_pacer != nullptr) {
+		m_pacer->clock(ms);
+		writePaced();
 	}
 
 	uint8_t buffer[BUFFER_LENGTH];
 
+	if (m_jitterBuffer != nullptr) {
+		m_jitterBuffer->clock(ms);
+
+		uint16_t len = 0U;
+		uint64_t arrival = 0U;
+		while (m_jitterBuffer->get(buffer, len, arrival)) {
+			m_buffer.add((uint8_t*)&len, sizeof(uint16_t));
+			m_buffer.add((uint8_t*)&arrival, sizeof(uint64_t));
+			m_buffer.add(buffer, len);
+		}
+	}
+
 	sockaddr_storage address;
 	size_t addrLen;
 	int length = m_socket.read(buffer, BUFFER_LENGTH, address, addrLen);
@@ -309,6 +371,8 @@ void CDStarNetwork::clock(unsigned int ms)
 		return;
 
 	if (!CUDPSocket::match(m_addr, address)) {
+		m_metrics->m_invalidSource.add();
+
 		if (m_network == NETWORK::RF)
 			LogMessage("D-Star RF packet received from an invalid source");
 		else
@@ -316,6 +380,8 @@ void CDStarNetwork::clock(unsigned int ms)
 		return;
 	}
 
+	uint64_t arrival = LatencyTime();
+
 	// Invalid packet type?
 	if (::memcmp(buffer, "DSRP", 4U) != 0)
 		return;
@@ -337,23 +403,55 @@ void CDStarNetwork::clock(unsigned int ms)
 			return;
 	}
 
+	if (m_jitterBuffer != nullptr) {
+		uint16_t id = buffer[5U] * 256U + buffer[6U];
+
+		// The header starts a new stream, and so does a new session id when the header was lost
+		if ((buffer[4U] == 0x20U) || (id != m_rxId)) {
+			flushJitterBuffer();
+			m_rxId = id;
+		}
+
+		if (buffer[4U] == 0x21U) {
+			m_jitterBuffer->add(buffer, length, buffer[7U] & 0x1FU, arrival, (buffer[7U] & 0x40U) == 0x40U);
+			return;
+		}
+	}
+
 	uint16_t len = length;
 	m_buffer.add((uint8_t*)&len, sizeof(uint16_t));
+	m_buffer.add((uint8_t*)&arrival, sizeof(uint64_t));
 
 	m_buffer.add(buffer, len);
 }
 
+// Passes on what is left of the previous stream, and leaves the jitter buffer ready for the next
+void CDStarNetwork::flushJitterBuffer()
+{
+	uint8_t buffer[BUFFER_LENGTH];
+	uint16_t len  = 0U;
+	uint64_t time = 0U;
+	while (m_jitterBuffer->flush(buffer, len, time)) {
+		m_buffer.add((uint8_t*)&len, sizeof(uint16_t));
+		m_buffer.add((uint8_t*)&time, sizeof(uint64_t));
+		m_buffer.add(buffer, len);
+	}
+}
+
 bool CDStarNetwork::read(CMetaData& data)
 {
 	if (m_buffer.empty())
 		return false;
 
-	uint16_t length = 0U;
+	uint16_t length  = 0U;
+	uint64_t arrival = 0U;
 	m_buffer.get((uint8_t*)&length, sizeof(uint16_t));
+	m_buffer.get((uint8_t*)&arrival, sizeof(uint64_t));
 
 	uint8_t buffer[100U];
 	m_buffer.get(buffer, length);
 
+	data.setReceiveTime(arrival);
 	data.setRaw(buffer, length);
 
 	switch (buffer[4]) {
@@ -373,7 +471,8 @@ bool CDStarNetwork::read(CMetaData& data)
 					CUtils::dump(1U, "D-Star Net Network Header Received", buffer, length);
 			}
 
-			m_inId = buffer[5] * 256U + buffer[6];
+			m_inId  = buffer[5] * 256U + buffer[6];
+			m_inSeq = 20U;
 
 			data.setDStar(m_network, buffer + 35U, buffer + 27U);
 
@@ -398,6 +497,13 @@ bool CDStarNetwork::read(CMetaData& data)
 					m_inId = 0U;
 					data.setEnd();
 				} else {
+					// Replace any lost frames before this one
+					uint8_t seq = buffer[7] & 0x1FU;
+					uint8_t missing = (seq + 21U - m_inSeq - 1U) % 21U;
+					if (missing < 10U)
+						data.setMissingData(missing);
+					m_inSeq = seq;
+
 					data.setData(buffer + 9U);
 				}
 
@@ -418,8 +524,10 @@ bool CDStarNetwork::read()
 	if (m_buffer.empty())
 		return false;
 
-	uint16_t length = 0U;
-	m_buffer.add((uint8_t*)&length, sizeof(uint16_t));
+	uint16_t length  = 0U;
+	uint64_t arrival = 0U;
+	m_buffer.get((uint8_t*)&length, sizeof(uint16_t));
+	m_buffer.get((uint8_t*)&arrival, sizeof(uint64_t));
 
 	uint8_t buffer[100U];
 	m_buffer.get(buffer, length);
@@ -437,10 +545,14 @@ void CDStarNetwork::reset()
 	m_inId  = 0U;
 	m_outId = 0U;
 	m_buffer.clear();
+	if (m_jitterBuffer != nullptr)
+		m_jitterBuffer->reset();
 }
 
 void CDStarNetwork::close()
 {
+	m_pollTimer.stop();
+
 	m_socket.close();
 
 	if (m_network == NETWORK::RF)
@@ -475,7 +587,7 @@ void CDStarNetwork::createHeader(const CMetaData& data)
 	rpt[DSTAR_LONG_CALLSIGN_LENGTH - 1U] = 'G';
 	::memcpy(m_header + 3U, rpt, DSTAR_LONG_CALLSIGN_LENGTH);
 
-	addHeaderCRC();
+	CCRC::addCCITT161(m_header, DSTAR_HEADER_LENGTH_BYTES);
 }
 
 void CDStarNetwork::addSlowData(uint8_t* buffer)
@@ -619,21 +731,3 @@ void CDStarNetwork::stringToBytes(uint8_t* str, const std::string& callsign) con
 	for (size_t i = 0U; i < len; i++)
 		str[i] = callsign[i];
 }
-
-void CDStarNetwork::addHeaderCRC()
-{
-	union {
-		uint16_t crc16;
-		uint8_t  crc8[2U];
-	};
-
-	crc16 = 0xFFFFU;
-
-	for (unsigned int i = 0U; i < (DSTAR_HEADER_LENGTH_BYTES - 2U); i++)
-		crc16 = uint16_t(crc8[1U]) ^ CCITT16_TABLE[crc8[0U] ^ m_header[i]];
-
-	crc16 = ~crc16;
-
-	m_header[DSTAR_HEADER_LENGTH_BYTES - 2U] = crc8[0U];
-	m_header[DSTAR_HEADER_LENGTH_BYTES - 1U] = crc8[1U];
-}
@@ -19,6 +19,8 @@
 #if !defined(DStarNetwork_H)
 #define	DStarNetwork_H
 
+#include "JitterBuffer.h"
+#include "Pacer.h"
 #include "DStarDefines.h"
 #include "RingBuffer.h"
 #include "UDPSocket.h"
@@ -36,6 +38,9 @@ public:
 	CDStarNetwork(NETWORK network, const std::string& callsign, const std::string& localAddress, uint16_t localPort, const std::string& remoteAddress, uint16_t remotePort, bool debug);
 	virtual ~CDStarNetwork();
 
+	void setJitterBuffer(unsigned int maxDelay);
+	void setPacing(unsigned int lead);
+
 	virtual bool open();
 
 	virtual bool writeRaw(CMetaData& data);
@@ -54,6 +59,7 @@ public:
 
 private:
 	NETWORK          m_network;
+	CNetworkMetrics* m_metrics;
 	std::string      m_callsign;
 	CUDPSocket       m_socket;
 	sockaddr_storage m_addr;
@@ -62,7 +68,11 @@ private:
 	uint16_t         m_outId;
 	uint8_t          m_outSeq;
 	uint16_t         m_inId;
+	uint8_t          m_inSeq;
+	uint16_t         m_rxId;
 	CRingBuffer<uint8_t> m_buffer;
+	CJitterBuffer*   m_jitterBuffer;
+	CPacer*          m_pacer;
 	CTimer           m_pollTimer;
 	std::mt19937     m_random;
 	uint8_t*         m_header;
@@ -70,12 +80,16 @@ private:
 	bool writeHeader(const CMetaData& data);
 	bool writeBody(CMetaData& data);
 	bool writeTrailer(CMetaData& data);
+	bool writePacket(const uint8_t* data, uint16_t length, uint64_t start = 0U);
+	void writePaced();
+	void flushJitterBuffer();
 	bool writePoll(const char* text);
 
+	static void onPoll(void* obj);
+
 	void createHeader(const CMetaData& data);
 	void addSlowData(uint8_t* buffer);
 	void stringToBytes(uint8_t* str, const std::string& callsign) const;
-	void addHeaderCRC();
 };
 
 #endif
@@ -17,6 +17,8 @@
  */
 
 #include "FMNetwork.h"
+#include "Capture.h"
+#include "Latency.h"
 #include "Utils.h"
 #include "Log.h"
 
@@ -30,25 +32,46 @@
 
 const unsigned int BUFFER_LENGTH = 1500U;
 
+// Each FMD packet holds 20ms of audio, a gap longer than this means some have been lost
+const unsigned int FRAME_TIME = 20U;
+const unsigned int GAP_TIME   = 100U;
+
 CFMNetwork::CFMNetwork(NETWORK network, const std::string& callsign, const std::string& localAddress, unsigned short localPort, const std::string& gatewayAddress, unsigned short gatewayPort, bool debug) :
 m_network(network),
+m_metrics(nullptr),
 m_callsign(callsign),
 m_socket(localAddress, localPort),
 m_addr(),
 m_addrLen(0U),
+m_pacer(nullptr),
 m_debug(debug),
 m_buffer(3000U, "FM Network"),
-m_seqNo(0U)
+m_seqNo(0U),
+m_inActive(false),
+m_lastArrival(0U)
 {
 	assert(gatewayPort > 0U);
 	assert(!gatewayAddress.empty());
 
 	if (CUDPSocket::lookup(gatewayAddress, gatewayPort, m_addr, m_addrLen) != 0)
 		m_addrLen = 0U;
+
+	m_metrics = MetricsNetwork(network, DATA_MODE::FM);
+
+	m_socket.setMetrics(m_metrics);
+	m_socket.setCapture(CaptureInterface(network, DATA_MODE::FM), m_addr, m_addrLen);
+	m_buffer.setCounters(&m_metrics->m_overflows, &m_metrics->m_underflows);
 }
 
 CFMNetwork::~CFMNetwork()
 {
+	delete m_pacer;
+}
+
+void CFMNetwork::setPacing(unsigned int lead)
+{
+	delete m_pacer;
+	m_pacer = new CPacer(m_network == NETWORK::RF ? "FM RF Network" : "FM Net Network", 3U + PCM_DATA_LENGTH, 20U, lead);
 }
 
 bool CFMNetwork::open()
@@ -87,7 +110,11 @@ bool CFMNetwork::writeRaw(CMetaData& data)
 			CUtils::dump(1U, "FM Net Network Raw Sent", buffer, length);
 	}
 
-	return m_socket.write(buffer, length, m_addr, m_addrLen);
+	bool ret = m_socket.write(buffer, length, m_addr, m_addrLen);
+
+	LatencyAdd(STAGE::SEND, data.getSendTime());
+
+	return ret;
 }
 
 bool CFMNetwork::writeData(CMetaData& data)
@@ -95,38 +122,79 @@ bool CFMNetwork::writeData(CMetaData& data)
 	if (m_addrLen == 0U)
 		return false;
 
-	if (data.isEnd())
-		return writeEnd();
+	while (data.hasData()) {
+		if (m_seqNo == 0U) {
+			bool ret = writeStart(data);
+			if (!ret)
+				return false;
+		}
+
+		uint8_t buffer[500U];
+		::memset(buffer, 0x00U, 500U);
 
-	if (m_seqNo == 0U) {
-		bool ret = writeStart(data);
+		buffer[0U] = 'F';
+		buffer[1U] = 'M';
+		buffer[2U] = 'D';
+
+		data.getData(buffer + 3U, PCM_DATA_LENGTH);
+
+		if (m_debug) {
+			if (m_network == NETWORK::RF)
+				CUtils::dump(1U, "FM RF Network Data Sent", buffer, 3U + PCM_DATA_LENGTH);
+			else
+				CUtils::dump(1U, "FM Net Network Data Sent", buffer, 3U + PCM_DATA_LENGTH);
+		}
+
+		m_seqNo++;
+
+		bool ret = writePacket(buffer, 3U + PCM_DATA_LENGTH, data.getSendTime());
 		if (!ret)
 			return false;
 	}
 
-	uint8_t buffer[500U];
-	::memset(buffer, 0x00U, 500U);
+	if (data.isEnd())
+		return writeEnd();
 
-	buffer[0U] = 'F';
-	buffer[1U] = 'M';
-	buffer[2U] = 'D';
+	return true;
+}
 
-	data.getData(buffer + 3U);
+bool CFMNetwork::writePacket(const uint8_t* data, uint16_t length, uint64_t start, bool timed)
+{
+	assert(data != nullptr);
 
-	if (m_debug) {
-		if (m_network == NETWORK::RF)
-			CUtils::dump(1U, "FM RF Network Data Sent", buffer, 3U + PCM_DATA_LENGTH);
-		else
-			CUtils::dump(1U, "FM Net Network Data Sent", buffer, 3U + PCM_DATA_LENGTH);
+	if (m_pacer == nullptr) {
+		bool ret = m_socket.write(data, length, m_addr, m_addrLen);
+		LatencyAdd(STAGE::SEND, start);
+		return ret;
 	}
 
-	m_seqNo++;
+	if (!m_pacer->add(data, length, start, timed))
+		return false;
+
+	writePaced();
+
+	return true;
+}
+
+void CFMNetwork::writePaced()
+{
+	uint8_t buffer[3U + PCM_DATA_LENGTH];
+	uint16_t length = 0U;
+	uint64_t start  = 0U;
 
-	return m_socket.write(buffer, 3U + PCM_DATA_LENGTH, m_addr, m_addrLen);
+	while (m_pacer->get(buffer, length, start)) {
+		m_socket.write(buffer, length, m_addr, m_addrLen);
+		LatencyAdd(STAGE::SEND, start);
+	}
 }
 
 void CFMNetwork::clock(unsigned int ms)
 {
+	if (m_pacer != nullptr) {
+		m_pacer->clock(ms);
+		writePaced();
+	}
+
 	uint8_t buffer[BUFFER_LENGTH];
 
 	sockaddr_storage addr;
@@ -137,6 +205,8 @@ void CFMNetwork::clock(unsigned int ms)
 
 	// Check if the data is for us
 	if (!CUDPSocket::match(addr, m_addr, IPMATCHTYPE::ADDRESS_AND_PORT)) {
+		m_metrics->m_invalidSource.add();
+
 		if (m_network == NETWORK::RF)
 			LogMessage("FM RF packet received from an invalid source");
 		else
@@ -155,8 +225,11 @@ void CFMNetwork::clock(unsigned int ms)
 	if (::memcmp(buffer, "FM", 2U) != 0)
 		return;
 
+	uint64_t arrival = LatencyTime();
+
 	uint16_t len = length;
 	m_buffer.add((uint8_t*)&len, sizeof(uint16_t));
+	m_buffer.add((uint8_t*)&arrival, sizeof(uint64_t));
 	m_buffer.add(buffer, len);
 }
 
@@ -168,17 +241,36 @@ bool CFMNetwork::read(CMetaData& data)
 	uint16_t length = 0U;
 	m_buffer.get((uint8_t*)&length, sizeof(uint16_t));
 
+	uint64_t arrival = 0U;
+	m_buffer.get((uint8_t*)&arrival, sizeof(uint64_t));
+
 	uint8_t buffer[BUFFER_LENGTH];
 	m_buffer.get(buffer, length);
 
+	data.setReceiveTime(arrival);
 	data.setRaw(buffer, length);
 
-	if (::memcmp(buffer + 0U, "FMD", 3U) == 0)
+	if (::memcmp(buffer + 0U, "FMD", 3U) == 0) {
+		// There are no sequence numbers, so use the time between the arrivals to find a gap,
+		// as frames held up in the buffer by a stall in the main loop are read back to back
+		if (m_inActive) {
+			unsigned int gap = (unsigned int)((arrival - m_lastArrival) / 1000U);
+			if (gap >= GAP_TIME)
+				data.setMissingData(gap / FRAME_TIME - 1U);
+		}
+
 		data.setData(buffer + 3U);
-	else if (::memcmp(buffer + 0U, "FME", 3U) == 0)
+
+		m_inActive    = true;
+		m_lastArrival = arrival;
+	} else if (::memcmp(buffer + 0U, "FME", 3U) == 0) {
 		data.setEnd();
-	else if (::memcmp(buffer + 0U, "FMS", 3U) == 0)
+		m_inActive = false;
+	} else if (::memcmp(buffer + 0U, "FMS", 3U) == 0) {
 		data.setFM(m_network, buffer + 3U);
+		m_inActive    = true;
+		m_lastArrival = arrival;
+	}
 
 	return true;
 }
@@ -191,6 +283,9 @@ bool CFMNetwork::read()
 	uint16_t length = 0U;
 	m_buffer.get((uint8_t*)&length, sizeof(uint16_t));
 
+	uint64_t arrival = 0U;
+	m_buffer.get((uint8_t*)&arrival, sizeof(uint64_t));
+
 	uint8_t buffer[BUFFER_LENGTH];
 	m_buffer.get(buffer, length);
 
@@ -204,7 +299,8 @@ bool CFMNetwork::hasData()
 
 void CFMNetwork::reset()
 {
-	m_seqNo = 0U;
+	m_seqNo    = 0U;
+	m_inActive = false;
 	m_buffer.clear();
 }
 
@@ -238,7 +334,7 @@ bool CFMNetwork::writeStart(CMetaData& data)
 			CUtils::dump(1U, "FM Net Network Data Sent", buffer, length + 1U);
 	}
 
-	return m_socket.write(buffer, length + 1U, m_addr, m_addrLen);
+	return writePacket(buffer, length + 1U, 0U, false);
 }
 
 bool CFMNetwork::writeEnd()
@@ -256,5 +352,5 @@ bool CFMNetwork::writeEnd()
 			CUtils::dump(1U, "FM Net Network Data Sent", buffer, 3U);
 	}
 
-	return m_socket.write(buffer, 3U, m_addr, m_addrLen);
+	return writePacket(buffer, 3U, 0U, false);
 }
@@ -21,6 +21,7 @@
 
 #include "RingBuffer.h"
 #include "UDPSocket.h"
+#include "Pacer.h"
 #include "Network.h"
 
 #include <cstdint>
@@ -32,6 +33,8 @@ public:
 	CFMNetwork(NETWORK network, const std::string& callsign, const std::string& localAddress, uint16_t localPort, const std::string& remoteAddress, uint16_t remotePort, bool debug);
 	virtual ~CFMNetwork();
 
+	void setPacing(unsigned int lead);
+
 	virtual bool open();
 
 	virtual bool writeRaw(CMetaData& data);
@@ -50,15 +53,21 @@ public:
 
 private:
 	NETWORK          m_network;
+	CNetworkMetrics* m_metrics;
 	std::string      m_callsign;
 	CUDPSocket       m_socket;
 	sockaddr_storage m_addr;
 	size_t           m_addrLen;
+	CPacer*          m_pacer;
 	bool             m_debug;
 	CRingBuffer<uint8_t> m_buffer;
 	unsigned int     m_seqNo;
+	bool             m_inActive;
+	uint64_t         m_lastArrival;
 
 	bool writeStart(CMetaData& data);
+	bool writePacket(const uint8_t* data, uint16_t length, uint64_t start = 0U, bool timed = true);
+	void writePaced();
 	bool writeEnd();
 };
 
@@ -0,0 +1 @@
+const char *gitversion = "65f08cb0179cef1381d2beee02f76275e6566611";
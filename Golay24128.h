@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2010,2016,2021 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2010,2016,2021,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -28,6 +28,10 @@ public:
 
 	static bool decode24128(unsigned int in, unsigned int& out);
 	static bool decode24128(unsigned char* in, unsigned int& out);
+
+	// Work on count codewords of three bytes each, errors is the number of bits corrected
+	static void encode24128(const unsigned int* in, unsigned char* out, unsigned int count);
+	static bool decode24128(const unsigned char* in, unsigned int* out, unsigned int count, unsigned int& errors);
 };
 
 #endif
@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2015,2016 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2015,2016,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -21,329 +21,269 @@
 #include <cstdio>
 #include <cassert>
 
- // Hamming (15,11,3) check a boolean data array
-bool CHamming::decode15113_1(bool* d)
-{
-	assert(d != nullptr);
-
-	// Calculate the parity it should have
-	bool c0 = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[4] ^ d[5] ^ d[6];
-	bool c1 = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[7] ^ d[8] ^ d[9];
-	bool c2 = d[0] ^ d[1] ^ d[4] ^ d[5] ^ d[7] ^ d[8] ^ d[10];
-	bool c3 = d[0] ^ d[2] ^ d[4] ^ d[6] ^ d[7] ^ d[9] ^ d[10];
+// Each check covers the data bits of its parity equation and its own parity
+// bit, so the parity of the codeword under the mask is that syndrome bit. The
+// syndrome tables, built from the checks when compiling, give the bit to flip
+// and are zero where nothing can be corrected.
+struct CSyndromeTable {
+	uint32_t bit[32U];
 
-	unsigned char n = 0U;
-	n |= (c0 != d[11]) ? 0x01U : 0x00U;
-	n |= (c1 != d[12]) ? 0x02U : 0x00U;
-	n |= (c2 != d[13]) ? 0x04U : 0x00U;
-	n |= (c3 != d[14]) ? 0x08U : 0x00U;
+	constexpr CSyndromeTable(const uint32_t* checks, unsigned int n, unsigned int length) :
+	bit()
+	{
+		for (unsigned int b = 0U; b < length; b++) {
+			unsigned int s = 0U;
+			for (unsigned int i = 0U; i < n; i++) {
+				if ((checks[i] & (1U << b)) != 0U)
+					s |= 1U << i;
+			}
+
+			bit[s] = 1U << b;
+		}
+	}
 
-	switch (n)
+	// Every single bit error must give its own non-zero syndrome
+	constexpr bool isValid(unsigned int length) const
 	{
-		// Parity bit errors
-		case 0x01U: d[11] = !d[11]; return true;
-		case 0x02U: d[12] = !d[12]; return true;
-		case 0x04U: d[13] = !d[13]; return true;
-		case 0x08U: d[14] = !d[14]; return true;
-
-		// Data bit errors
-		case 0x0FU: d[0]  = !d[0];  return true;
-		case 0x07U: d[1]  = !d[1];  return true;
-		case 0x0BU: d[2]  = !d[2];  return true;
-		case 0x03U: d[3]  = !d[3];  return true;
-		case 0x0DU: d[4]  = !d[4];  return true;
-		case 0x05U: d[5]  = !d[5];  return true;
-		case 0x09U: d[6]  = !d[6];  return true;
-		case 0x0EU: d[7]  = !d[7];  return true;
-		case 0x06U: d[8]  = !d[8];  return true;
-		case 0x0AU: d[9]  = !d[9];  return true;
-		case 0x0CU: d[10] = !d[10]; return true;
-
-		// No bit errors
-		default: return false;
+		unsigned int count = 0U;
+		for (unsigned int s = 1U; s < 32U; s++) {
+			if (bit[s] != 0U)
+				count++;
+		}
+
+		return (bit[0U] == 0U) && (count == length);
 	}
+};
+
+// Hamming (15,11,3)
+constexpr uint32_t CHECKS_15113_1[] = {0x7F08U, 0x78E4U, 0x66D2U, 0x55B1U};
+constexpr CSyndromeTable SYNDROMES_15113_1(CHECKS_15113_1, 4U, 15U);
+static_assert(SYNDROMES_15113_1.isValid(15U), "Invalid Hamming (15,11,3) checks");
+
+// Hamming (15,11,3)
+constexpr uint32_t CHECKS_15113_2[] = {0x7AC8U, 0x3D64U, 0x1EB2U, 0x7591U};
+constexpr CSyndromeTable SYNDROMES_15113_2(CHECKS_15113_2, 4U, 15U);
+static_assert(SYNDROMES_15113_2.isValid(15U), "Invalid Hamming (15,11,3) checks");
+
+// Hamming (13,9,3)
+constexpr uint32_t CHECKS_1393[] = {0x1AC8U, 0x1D64U, 0x1EB2U, 0x1591U};
+constexpr CSyndromeTable SYNDROMES_1393(CHECKS_1393, 4U, 13U);
+static_assert(SYNDROMES_1393.isValid(13U), "Invalid Hamming (13,9,3) checks");
+
+// Hamming (10,6,3)
+constexpr uint32_t CHECKS_1063[] = {0x0398U, 0x0354U, 0x02E2U, 0x01E1U};
+constexpr CSyndromeTable SYNDROMES_1063(CHECKS_1063, 4U, 10U);
+static_assert(SYNDROMES_1063.isValid(10U), "Invalid Hamming (10,6,3) checks");
+
+// Hamming (16,11,4)
+constexpr uint32_t CHECKS_16114[] = {0xF590U, 0x7AC8U, 0x3D64U, 0xEB22U, 0xA6E1U};
+constexpr CSyndromeTable SYNDROMES_16114(CHECKS_16114, 5U, 16U);
+static_assert(SYNDROMES_16114.isValid(16U), "Invalid Hamming (16,11,4) checks");
+
+// Hamming (17,12,3)
+constexpr uint32_t CHECKS_17123[] = {0x1E690U, 0x1F348U, 0x0F9A4U, 0x19A42U, 0x1CD21U};
+constexpr CSyndromeTable SYNDROMES_17123(CHECKS_17123, 5U, 17U);
+static_assert(SYNDROMES_17123.isValid(17U), "Invalid Hamming (17,12,3) checks");
+
+static bool parity(uint32_t v)
+{
+#if defined(__GNUC__)
+	return __builtin_parity(v) != 0;
+#else
+	v ^= v >> 16;
+	v ^= v >> 8;
+	v ^= v >> 4;
+	return ((0x6996U >> (v & 0x0FU)) & 0x01U) == 0x01U;
+#endif
 }
 
-void CHamming::encode15113_1(bool* d)
+static uint32_t syndrome(uint32_t d, const uint32_t* checks, unsigned int n)
 {
-	assert(d != nullptr);
+	uint32_t s = 0U;
 
-	// Calculate the checksum this row should have
-	d[11] = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[4] ^ d[5] ^ d[6];
-	d[12] = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[7] ^ d[8] ^ d[9];
-	d[13] = d[0] ^ d[1] ^ d[4] ^ d[5] ^ d[7] ^ d[8] ^ d[10];
-	d[14] = d[0] ^ d[2] ^ d[4] ^ d[6] ^ d[7] ^ d[9] ^ d[10];
+	for (unsigned int i = 0U; i < n; i++) {
+		if (parity(d & checks[i]))
+			s |= 1U << i;
+	}
+
+	return s;
 }
 
-// Hamming (15,11,3) check a boolean data array
-bool CHamming::decode15113_2(bool* d)
+static uint32_t encode(uint32_t d, const uint32_t* checks, unsigned int n)
 {
-	assert(d != nullptr);
-
-	// Calculate the checksum this row should have
-	bool c0 = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[5] ^ d[7] ^ d[8];
-	bool c1 = d[1] ^ d[2] ^ d[3] ^ d[4] ^ d[6] ^ d[8] ^ d[9];
-	bool c2 = d[2] ^ d[3] ^ d[4] ^ d[5] ^ d[7] ^ d[9] ^ d[10];
-	bool c3 = d[0] ^ d[1] ^ d[2] ^ d[4] ^ d[6] ^ d[7] ^ d[10];
-
-	unsigned char n = 0x00U;
-	n |= (c0 != d[11]) ? 0x01U : 0x00U;
-	n |= (c1 != d[12]) ? 0x02U : 0x00U;
-	n |= (c2 != d[13]) ? 0x04U : 0x00U;
-	n |= (c3 != d[14]) ? 0x08U : 0x00U;
-
-	switch (n) {
-		// Parity bit errors
-		case 0x01U: d[11] = !d[11]; return true;
-		case 0x02U: d[12] = !d[12]; return true;
-		case 0x04U: d[13] = !d[13]; return true;
-		case 0x08U: d[14] = !d[14]; return true;
-
-		// Data bit errors
-		case 0x09U: d[0]  = !d[0];  return true;
-		case 0x0BU: d[1]  = !d[1];  return true;
-		case 0x0FU: d[2]  = !d[2];  return true;
-		case 0x07U: d[3]  = !d[3];  return true;
-		case 0x0EU: d[4]  = !d[4];  return true;
-		case 0x05U: d[5]  = !d[5];  return true;
-		case 0x0AU: d[6]  = !d[6];  return true;
-		case 0x0DU: d[7]  = !d[7];  return true;
-		case 0x03U: d[8]  = !d[8];  return true;
-		case 0x06U: d[9]  = !d[9];  return true;
-		case 0x0CU: d[10] = !d[10]; return true;
-
-		// No bit errors
-		default: return false;
+	// The parity bits are the lowest n bits, with the first one highest
+	d &= ~((1U << n) - 1U);
+
+	for (unsigned int i = 0U; i < n; i++) {
+		if (parity(d & checks[i]))
+			d |= 1U << (n - 1U - i);
 	}
+
+	return d;
 }
 
-void CHamming::encode15113_2(bool* d)
+bool CHamming::decode15113_1(uint16_t& d)
 {
-	assert(d != nullptr);
+	uint32_t bit = SYNDROMES_15113_1.bit[syndrome(d, CHECKS_15113_1, 4U)];
+	if (bit == 0U)
+		return false;
+
+	d ^= bit;
 
-	// Calculate the checksum this row should have
-	d[11] = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[5] ^ d[7] ^ d[8];
-	d[12] = d[1] ^ d[2] ^ d[3] ^ d[4] ^ d[6] ^ d[8] ^ d[9];
-	d[13] = d[2] ^ d[3] ^ d[4] ^ d[5] ^ d[7] ^ d[9] ^ d[10];
-	d[14] = d[0] ^ d[1] ^ d[2] ^ d[4] ^ d[6] ^ d[7] ^ d[10];
+	return true;
 }
 
-// Hamming (13,9,3) check a boolean data array
-bool CHamming::decode1393(bool* d)
+void CHamming::encode15113_1(uint16_t& d)
 {
-	assert(d != nullptr);
-
-	// Calculate the checksum this column should have
-	bool c0 = d[0] ^ d[1] ^ d[3] ^ d[5] ^ d[6];
-	bool c1 = d[0] ^ d[1] ^ d[2] ^ d[4] ^ d[6] ^ d[7];
-	bool c2 = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[5] ^ d[7] ^ d[8];
-	bool c3 = d[0] ^ d[2] ^ d[4] ^ d[5] ^ d[8];
-	
-	unsigned char n = 0x00U;
-	n |= (c0 != d[9])  ? 0x01U : 0x00U;
-	n |= (c1 != d[10]) ? 0x02U : 0x00U;
-	n |= (c2 != d[11]) ? 0x04U : 0x00U;
-	n |= (c3 != d[12]) ? 0x08U : 0x00U;
-
-	switch (n) {
-		// Parity bit errors
-		case 0x01U: d[9]  = !d[9];  return true;
-		case 0x02U: d[10] = !d[10]; return true;
-		case 0x04U: d[11] = !d[11]; return true;
-		case 0x08U: d[12] = !d[12]; return true;
-
-		// Data bit erros
-		case 0x0FU: d[0] = !d[0]; return true;
-		case 0x07U: d[1] = !d[1]; return true;
-		case 0x0EU: d[2] = !d[2]; return true;
-		case 0x05U: d[3] = !d[3]; return true;
-		case 0x0AU: d[4] = !d[4]; return true;
-		case 0x0DU: d[5] = !d[5]; return true;
-		case 0x03U: d[6] = !d[6]; return true;
-		case 0x06U: d[7] = !d[7]; return true;
-		case 0x0CU: d[8] = !d[8]; return true;
-
-		// No bit errors
-		default: return false;
-	}
+	d = uint16_t(encode(d, CHECKS_15113_1, 4U));
 }
 
-void CHamming::encode1393(bool* d)
+bool CHamming::decode15113_2(uint16_t& d)
 {
-	assert(d != nullptr);
+	uint32_t bit = SYNDROMES_15113_2.bit[syndrome(d, CHECKS_15113_2, 4U)];
+	if (bit == 0U)
+		return false;
 
-	// Calculate the checksum this column should have
-	d[9]  = d[0] ^ d[1] ^ d[3] ^ d[5] ^ d[6];
-	d[10] = d[0] ^ d[1] ^ d[2] ^ d[4] ^ d[6] ^ d[7];
-	d[11] = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[5] ^ d[7] ^ d[8];
-	d[12] = d[0] ^ d[2] ^ d[4] ^ d[5] ^ d[8];
+	d ^= bit;
+
+	return true;
 }
 
-// Hamming (10,6,3) check a boolean data array
-bool CHamming::decode1063(bool* d)
+void CHamming::encode15113_2(uint16_t& d)
 {
-	assert(d != nullptr);
-
-	// Calculate the checksum this column should have
-	bool c0 = d[0] ^ d[1] ^ d[2] ^ d[5];
-	bool c1 = d[0] ^ d[1] ^ d[3] ^ d[5];
-	bool c2 = d[0] ^ d[2] ^ d[3] ^ d[4];
-	bool c3 = d[1] ^ d[2] ^ d[3] ^ d[4];
-
-	unsigned char n = 0x00U;
-	n |= (c0 != d[6]) ? 0x01U : 0x00U;
-	n |= (c1 != d[7]) ? 0x02U : 0x00U;
-	n |= (c2 != d[8]) ? 0x04U : 0x00U;
-	n |= (c3 != d[9]) ? 0x08U : 0x00U;
-
-	switch (n) {
-		// Parity bit errors
-		case 0x01U: d[6] = !d[6]; return true;
-		case 0x02U: d[7] = !d[7]; return true;
-		case 0x04U: d[8] = !d[8]; return true;
-		case 0x08U: d[9] = !d[9]; return true;
-
-		// Data bit erros
-		case 0x07U: d[0] = !d[0]; return true;
-		case 0x0BU: d[1] = !d[1]; return true;
-		case 0x0DU: d[2] = !d[2]; return true;
-		case 0x0EU: d[3] = !d[3]; return true;
-		case 0x0CU: d[4] = !d[4]; return true;
-		case 0x03U: d[5] = !d[5]; return true;
-
-		// No bit errors
-		default: return false;
-	}
+	d = uint16_t(encode(d, CHECKS_15113_2, 4U));
 }
 
-void CHamming::encode1063(bool* d)
+bool CHamming::decode1393(uint16_t& d)
 {
-	assert(d != nullptr);
+	uint32_t bit = SYNDROMES_1393.bit[syndrome(d, CHECKS_1393, 4U)];
+	if (bit == 0U)
+		return false;
+
+	d ^= bit;
 
-	// Calculate the checksum this column should have
-	d[6] = d[0] ^ d[1] ^ d[2] ^ d[5];
-	d[7] = d[0] ^ d[1] ^ d[3] ^ d[5];
-	d[8] = d[0] ^ d[2] ^ d[3] ^ d[4];
-	d[9] = d[1] ^ d[2] ^ d[3] ^ d[4];
+	return true;
 }
 
-// A Hamming (16,11,4) Check
-bool CHamming::decode16114(bool* d)
+void CHamming::encode1393(uint16_t& d)
 {
-	assert(d != nullptr);
-
-	// Calculate the checksum this column should have
-	bool c0 = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[5] ^ d[7] ^ d[8];
-	bool c1 = d[1] ^ d[2] ^ d[3] ^ d[4] ^ d[6] ^ d[8] ^ d[9];
-	bool c2 = d[2] ^ d[3] ^ d[4] ^ d[5] ^ d[7] ^ d[9] ^ d[10];
-	bool c3 = d[0] ^ d[1] ^ d[2] ^ d[4] ^ d[6] ^ d[7] ^ d[10];
-	bool c4 = d[0] ^ d[2] ^ d[5] ^ d[6] ^ d[8] ^ d[9] ^ d[10];
-
-	// Compare these with the actual bits
-	unsigned char n = 0x00U;
-	n |= (c0 != d[11]) ? 0x01U : 0x00U;
-	n |= (c1 != d[12]) ? 0x02U : 0x00U;
-	n |= (c2 != d[13]) ? 0x04U : 0x00U;
-	n |= (c3 != d[14]) ? 0x08U : 0x00U;
-	n |= (c4 != d[15]) ? 0x10U : 0x00U;
-
-	switch (n) {
-		// Parity bit errors
-		case 0x01U: d[11] = !d[11]; return true;
-		case 0x02U: d[12] = !d[12]; return true;
-		case 0x04U: d[13] = !d[13]; return true;
-		case 0x08U: d[14] = !d[14]; return true;
-		case 0x10U: d[15] = !d[15]; return true;
-
-		// Data bit errors
-		case 0x19U: d[0]  = !d[0];  return true;
-		case 0x0BU: d[1]  = !d[1];  return true;
-		case 0x1FU: d[2]  = !d[2];  return true;
-		case 0x07U: d[3]  = !d[3];  return true;
-		case 0x0EU: d[4]  = !d[4];  return true;
-		case 0x15U: d[5]  = !d[5];  return true;
-		case 0x1AU: d[6]  = !d[6];  return true;
-		case 0x0DU: d[7]  = !d[7];  return true;
-		case 0x13U: d[8]  = !d[8];  return true;
-		case 0x16U: d[9]  = !d[9];  return true;
-		case 0x1CU: d[10] = !d[10]; return true;
-
-		// No bit errors
-		case 0x00U: return true;
-
-		// Unrecoverable errors
-		default: return false;
-	}
+	d = uint16_t(encode(d, CHECKS_1393, 4U));
 }
 
-void CHamming::encode16114(bool* d)
+void CHamming::encode1393Columns(uint16_t* rows)
 {
-	assert(d != nullptr);
+	assert(rows != nullptr);
+
+	// Codeword bit 12 - r is held in rows[r], the parity is in rows 9 to 12
+	for (unsigned int i = 0U; i < 4U; i++) {
+		uint16_t p = 0U;
+		for (unsigned int r = 0U; r < 9U; r++) {
+			if ((CHECKS_1393[i] & (0x1000U >> r)) != 0U)
+				p ^= rows[r];
+		}
 
-	d[11] = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[5] ^ d[7] ^ d[8];
-	d[12] = d[1] ^ d[2] ^ d[3] ^ d[4] ^ d[6] ^ d[8] ^ d[9];
-	d[13] = d[2] ^ d[3] ^ d[4] ^ d[5] ^ d[7] ^ d[9] ^ d[10];
-	d[14] = d[0] ^ d[1] ^ d[2] ^ d[4] ^ d[6] ^ d[7] ^ d[10];
-	d[15] = d[0] ^ d[2] ^ d[5] ^ d[6] ^ d[8] ^ d[9] ^ d[10];
+		rows[9U + i] = p;
+	}
 }
 
-// A Hamming (17,12,3) Check
-bool CHamming::decode17123(bool* d)
+uint16_t CHamming::decode1393Columns(uint16_t* rows)
 {
-	assert(d != nullptr);
-
-	// Calculate the checksum this column should have
-	bool c0 = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[6] ^ d[7] ^ d[9];
-	bool c1 = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[4] ^ d[7] ^ d[8] ^ d[10];
-	bool c2 = d[1] ^ d[2] ^ d[3] ^ d[4] ^ d[5] ^ d[8] ^ d[9] ^ d[11];
-	bool c3 = d[0] ^ d[1] ^ d[4] ^ d[5] ^ d[7] ^ d[10];
-	bool c4 = d[0] ^ d[1] ^ d[2] ^ d[5] ^ d[6] ^ d[8] ^ d[11];
-
-	// Compare these with the actual bits
-	unsigned char n = 0x00U;
-	n |= (c0 != d[12]) ? 0x01U : 0x00U;
-	n |= (c1 != d[13]) ? 0x02U : 0x00U;
-	n |= (c2 != d[14]) ? 0x04U : 0x00U;
-	n |= (c3 != d[15]) ? 0x08U : 0x00U;
-	n |= (c4 != d[16]) ? 0x10U : 0x00U;
-
-	switch (n) {
-		// Parity bit errors
-		case 0x01U: d[12] = !d[12]; return true;
-		case 0x02U: d[13] = !d[13]; return true;
-		case 0x04U: d[14] = !d[14]; return true;
-		case 0x08U: d[15] = !d[15]; return true;
-		case 0x10U: d[16] = !d[16]; return true;
-
-		// Data bit errors
-		case 0x1BU: d[0]  = !d[0];  return true;
-		case 0x1FU: d[1]  = !d[1];  return true;
-		case 0x17U: d[2]  = !d[2];  return true;
-		case 0x07U: d[3]  = !d[3];  return true;
-		case 0x0EU: d[4]  = !d[4];  return true;
-		case 0x1CU: d[5]  = !d[5];  return true;
-		case 0x11U: d[6]  = !d[6];  return true;
-		case 0x0BU: d[7]  = !d[7];  return true;
-		case 0x16U: d[8]  = !d[8];  return true;
-		case 0x05U: d[9]  = !d[9];  return true;
-		case 0x0AU: d[10] = !d[10]; return true;
-		case 0x14U: d[11] = !d[11]; return true;
-
-		// No bit errors
-		case 0x00U: return true;
-
-		// Unrecoverable errors
-		default: return false;
+	assert(rows != nullptr);
+
+	uint16_t s[4U];
+	for (unsigned int i = 0U; i < 4U; i++) {
+		s[i] = 0U;
+		for (unsigned int r = 0U; r < 13U; r++) {
+			if ((CHECKS_1393[i] & (0x1000U >> r)) != 0U)
+				s[i] ^= rows[r];
+		}
+	}
+
+	uint16_t corrected = 0U;
+
+	uint16_t errors = s[0U] | s[1U] | s[2U] | s[3U];
+	while (errors != 0U) {
+		uint16_t mask = errors & -errors;
+		errors &= ~mask;
+
+		unsigned int n = 0U;
+		for (unsigned int i = 0U; i < 4U; i++) {
+			if ((s[i] & mask) != 0U)
+				n |= 1U << i;
+		}
+
+		uint32_t bit = SYNDROMES_1393.bit[n];
+		if (bit == 0U)
+			continue;
+
+		// Find the row holding the codeword bit in error
+		unsigned int r = 12U;
+		while (bit > 1U) {
+			bit >>= 1;
+			r--;
+		}
+
+		rows[r] ^= mask;
+		corrected |= mask;
 	}
+
+	return corrected;
+}
+
+bool CHamming::decode1063(uint16_t& d)
+{
+	uint32_t bit = SYNDROMES_1063.bit[syndrome(d, CHECKS_1063, 4U)];
+	if (bit == 0U)
+		return false;
+
+	d ^= bit;
+
+	return true;
+}
+
+void CHamming::encode1063(uint16_t& d)
+{
+	d = uint16_t(encode(d, CHECKS_1063, 4U));
+}
+
+// Returns false only when the errors cannot be corrected
+bool CHamming::decode16114(uint16_t& d)
+{
+	uint32_t s = syndrome(d, CHECKS_16114, 5U);
+	if (s == 0U)
+		return true;
+
+	uint32_t bit = SYNDROMES_16114.bit[s];
+	if (bit == 0U)
+		return false;
+
+	d ^= bit;
+
+	return true;
+}
+
+void CHamming::encode16114(uint16_t& d)
+{
+	d = uint16_t(encode(d, CHECKS_16114, 5U));
 }
 
-void CHamming::encode17123(bool* d)
+// Returns false only when the errors cannot be corrected
+bool CHamming::decode17123(uint32_t& d)
 {
-	assert(d != nullptr);
+	uint32_t s = syndrome(d, CHECKS_17123, 5U);
+	if (s == 0U)
+		return true;
+
+	uint32_t bit = SYNDROMES_17123.bit[s];
+	if (bit == 0U)
+		return false;
+
+	d ^= bit;
 
-	d[12] = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[6] ^ d[7] ^ d[9];
-	d[13] = d[0] ^ d[1] ^ d[2] ^ d[3] ^ d[4] ^ d[7] ^ d[8] ^ d[10];
-	d[14] = d[1] ^ d[2] ^ d[3] ^ d[4] ^ d[5] ^ d[8] ^ d[9] ^ d[11];
-	d[15] = d[0] ^ d[1] ^ d[4] ^ d[5] ^ d[7] ^ d[10];
-	d[16] = d[0] ^ d[1] ^ d[2] ^ d[5] ^ d[6] ^ d[8] ^ d[11];
+	return true;
+}
+
+void CHamming::encode17123(uint32_t& d)
+{
+	d = encode(d, CHECKS_17123, 5U);
 }
@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2015,2016 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2015,2016,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -19,25 +19,35 @@
 #ifndef	Hamming_H
 #define	Hamming_H
 
+#include <cstdint>
+
+// The codewords are held most significant bit first, so for an n bit code
+// d[0] is bit n - 1 and the last parity bit is bit 0.
 class CHamming {
 public:
-	static void encode15113_1(bool* d);
-	static bool decode15113_1(bool* d);
+	static void encode15113_1(uint16_t& d);
+	static bool decode15113_1(uint16_t& d);
+
+	static void encode15113_2(uint16_t& d);
+	static bool decode15113_2(uint16_t& d);
 
-	static void encode15113_2(bool* d);
-	static bool decode15113_2(bool* d);
+	static void encode1393(uint16_t& d);
+	static bool decode1393(uint16_t& d);
 
-	static void encode1393(bool* d);
-	static bool decode1393(bool* d);
+	// Bit sliced versions over 13 words, each bit position being a separate
+	// codeword running from rows[0] to rows[12]. The decoder returns the mask
+	// of the positions where a bit was corrected.
+	static void encode1393Columns(uint16_t* rows);
+	static uint16_t decode1393Columns(uint16_t* rows);
 
-	static void encode1063(bool* d);
-	static bool decode1063(bool* d);
+	static void encode1063(uint16_t& d);
+	static bool decode1063(uint16_t& d);
 
-	static void encode16114(bool* d);
-	static bool decode16114(bool* d);
+	static void encode16114(uint16_t& d);
+	static bool decode16114(uint16_t& d);
 
-	static void encode17123(bool* d);
-	static bool decode17123(bool* d);
+	static void encode17123(uint32_t& d);
+	static bool decode17123(uint32_t& d);
 };
 
 #endif
@@ -0,0 +1,276 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "JitterBuffer.h"
+#include "Log.h"
+
+#include <cstdio>
+#include <cassert>
+#include <cstring>
+
+// How long without any packets before a stream is considered finished
+const unsigned int IDLE_TIME = 1000U;
+
+CJitterBuffer::CJitterBuffer(const std::string& name, uint16_t blockSize, uint16_t sequenceCount, unsigned int frameTime, unsigned int maxDelay) :
+m_name(name),
+m_blockSize(blockSize),
+m_sequenceCount(sequenceCount),
+m_frameTime(frameTime),
+m_maxDelay(maxDelay),
+m_blockCount(0U),
+m_window(0U),
+m_data(nullptr),
+m_lengths(nullptr),
+m_ends(nullptr),
+m_arrivals(nullptr),
+m_running(false),
+m_headSeqNo(0U),
+m_headBlock(0U),
+m_count(0U),
+m_time(0U),
+m_playoutTime(0U),
+m_underrun(false),
+m_haveArrival(false),
+m_lastArrival(0U),
+m_lastSeqNo(0U),
+m_jitter(0U),
+m_delay(frameTime)
+{
+	assert(blockSize > 0U);
+	assert(sequenceCount > 2U);
+	assert(frameTime > 0U);
+
+	if (m_maxDelay < m_frameTime)
+		m_maxDelay = m_frameTime;
+
+	// Anything further ahead than half the sequence space is ambiguous, so
+	// that is all that is ever held
+	m_blockCount = m_sequenceCount / 2U;
+
+	// Packets beyond the playout window are held, but release the ones at
+	// the head early
+	m_window = m_maxDelay / m_frameTime + 2U;
+	if (m_window > m_blockCount)
+		m_window = m_blockCount;
+
+	m_data     = new uint8_t[m_blockCount * m_blockSize];
+	m_lengths  = new uint16_t[m_blockCount];
+	m_ends     = new bool[m_blockCount];
+	m_arrivals = new uint64_t[m_blockCount];
+
+	reset();
+}
+
+CJitterBuffer::~CJitterBuffer()
+{
+	delete[] m_data;
+	delete[] m_lengths;
+	delete[] m_ends;
+	delete[] m_arrivals;
+}
+
+bool CJitterBuffer::add(const uint8_t* data, uint16_t length, uint16_t sequenceNo, uint64_t arrival, bool end)
+{
+	assert(data != nullptr);
+	assert(length > 0U);
+	assert(sequenceNo < m_sequenceCount);
+
+	if (length > m_blockSize) {
+		LogWarning("%s, packet too long for the jitter buffer, %u > %u", m_name.c_str(), length, m_blockSize);
+		return false;
+	}
+
+	if (!m_running)
+		start(sequenceNo);
+
+	uint16_t offset = (sequenceNo + m_sequenceCount - m_headSeqNo) % m_sequenceCount;
+
+	if (offset >= (m_sequenceCount / 2U)) {
+		LogDebug("%s, dropping a late packet, sequence %u", m_name.c_str(), sequenceNo);
+		return false;
+	}
+
+	uint16_t block = (m_headBlock + offset) % m_blockCount;
+	if (m_lengths[block] > 0U)
+		return false;
+
+	::memcpy(m_data + (block * m_blockSize), data, length);
+	m_lengths[block]  = length;
+	m_ends[block]     = end;
+	m_arrivals[block] = arrival;
+	m_count++;
+
+	updateJitter(sequenceNo);
+
+	// Build the buffer back up after running dry
+	if (m_underrun) {
+		m_playoutTime = m_time + m_delay;
+		m_underrun    = false;
+	}
+
+	// A burst after an outage can run past the playout window, and then the
+	// packets at the head are made due now instead of losing any of them
+	if (offset >= m_window) {
+		unsigned int due = m_time - (offset - m_window) * m_frameTime;
+		if (int(due - m_playoutTime) < 0)
+			m_playoutTime = due;
+	}
+
+	return true;
+}
+
+bool CJitterBuffer::get(uint8_t* data, uint16_t& length, uint64_t& arrival)
+{
+	assert(data != nullptr);
+
+	if (!m_running)
+		return false;
+
+	if (int(m_time - m_playoutTime) < 0)
+		return false;
+
+	while (m_count > 0U) {
+		if (m_lengths[m_headBlock] > 0U)
+			return output(data, length, arrival);
+
+		// The packet is missing but later ones are here, so move past it
+		LogDebug("%s, missing packet, sequence %u", m_name.c_str(), m_headSeqNo);
+		advance();
+		m_playoutTime += m_frameTime;
+
+		if (int(m_time - m_playoutTime) < 0)
+			return false;
+	}
+
+	m_underrun = true;
+
+	return false;
+}
+
+bool CJitterBuffer::flush(uint8_t* data, uint16_t& length, uint64_t& arrival)
+{
+	assert(data != nullptr);
+
+	if (!m_running)
+		return false;
+
+	while (m_count > 0U) {
+		if (m_lengths[m_headBlock] > 0U)
+			return output(data, length, arrival);
+
+		advance();
+	}
+
+	reset();
+
+	return false;
+}
+
+bool CJitterBuffer::hasData() const
+{
+	return m_count > 0U;
+}
+
+void CJitterBuffer::reset()
+{
+	m_running   = false;
+	m_headSeqNo = 0U;
+	m_headBlock = 0U;
+	m_count     = 0U;
+	m_underrun  = false;
+
+	for (uint16_t i = 0U; i < m_blockCount; i++) {
+		m_lengths[i] = 0U;
+		m_ends[i]    = false;
+	}
+}
+
+void CJitterBuffer::clock(unsigned int ms)
+{
+	m_time += ms;
+
+	if (m_running && (m_count == 0U) && ((m_time - m_lastArrival) >= IDLE_TIME))
+		reset();
+}
+
+void CJitterBuffer::start(uint16_t sequenceNo)
+{
+	reset();
+
+	m_running     = true;
+	m_headSeqNo   = sequenceNo;
+	m_playoutTime = m_time + m_delay;
+
+	// The gap since the previous stream says nothing about the jitter
+	m_haveArrival = false;
+}
+
+void CJitterBuffer::advance()
+{
+	m_lengths[m_headBlock] = 0U;
+	m_ends[m_headBlock]    = false;
+
+	m_headBlock = (m_headBlock + 1U) % m_blockCount;
+	m_headSeqNo = (m_headSeqNo + 1U) % m_sequenceCount;
+}
+
+bool CJitterBuffer::output(uint8_t* data, uint16_t& length, uint64_t& arrival)
+{
+	length  = m_lengths[m_headBlock];
+	arrival = m_arrivals[m_headBlock];
+	::memcpy(data, m_data + (m_headBlock * m_blockSize), length);
+
+	bool end = m_ends[m_headBlock];
+
+	m_count--;
+	advance();
+	m_playoutTime += m_frameTime;
+
+	// Anything left after the end of the stream is of no use
+	if (end)
+		reset();
+
+	return true;
+}
+
+void CJitterBuffer::updateJitter(uint16_t sequenceNo)
+{
+	if (m_haveArrival) {
+		int seqDiff = (sequenceNo + m_sequenceCount - m_lastSeqNo) % m_sequenceCount;
+		if (seqDiff >= (m_sequenceCount / 2))
+			seqDiff -= m_sequenceCount;
+
+		int expected = seqDiff * int(m_frameTime);
+		int actual   = int(m_time - m_lastArrival);
+
+		int diff = actual - expected;
+		if (diff < 0)
+			diff = -diff;
+
+		// The RFC 3550 estimator, J += (|D| - J) / 16, with J held in 1/16 ms
+		m_jitter = m_jitter + diff - ((m_jitter + 8U) >> 4);
+	}
+
+	m_haveArrival = true;
+	m_lastArrival = m_time;
+	m_lastSeqNo   = sequenceNo;
+
+	m_delay = m_frameTime + 3U * (m_jitter >> 4);
+	if (m_delay > m_maxDelay)
+		m_delay = m_maxDelay;
+}
@@ -0,0 +1,79 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(JitterBuffer_H)
+#define	JitterBuffer_H
+
+#include <string>
+#include <cstdint>
+
+// Reorders incoming packets by their sequence number and releases them at
+// the frame rate of the mode. The playout delay follows the measured
+// inter-arrival jitter, bounded by maxDelay.
+class CJitterBuffer {
+public:
+	CJitterBuffer(const std::string& name, uint16_t blockSize, uint16_t sequenceCount, unsigned int frameTime, unsigned int maxDelay);
+	~CJitterBuffer();
+
+	// The arrival time goes back out with the packet, for the latency figures
+	bool add(const uint8_t* data, uint16_t length, uint16_t sequenceNo, uint64_t arrival, bool end = false);
+
+	// Returns the next packet once it is due
+	bool get(uint8_t* data, uint16_t& length, uint64_t& arrival);
+
+	// Returns the remaining packets in order, ignoring their playout time
+	bool flush(uint8_t* data, uint16_t& length, uint64_t& arrival);
+
+	bool hasData() const;
+
+	void reset();
+
+	void clock(unsigned int ms);
+
+private:
+	std::string  m_name;
+	uint16_t     m_blockSize;
+	uint16_t     m_sequenceCount;
+	unsigned int m_frameTime;
+	unsigned int m_maxDelay;
+	uint16_t     m_blockCount;
+	uint16_t     m_window;
+	uint8_t*     m_data;
+	uint16_t*    m_lengths;
+	bool*        m_ends;
+	uint64_t*    m_arrivals;
+	bool         m_running;
+	uint16_t     m_headSeqNo;
+	uint16_t     m_headBlock;
+	uint16_t     m_count;
+	unsigned int m_time;
+	unsigned int m_playoutTime;
+	bool         m_underrun;
+	bool         m_haveArrival;
+	unsigned int m_lastArrival;
+	uint16_t     m_lastSeqNo;
+	unsigned int m_jitter;
+	unsigned int m_delay;
+
+	void start(uint16_t sequenceNo);
+	void advance();
+	bool output(uint8_t* data, uint16_t& length, uint64_t& arrival);
+	void updateJitter(uint16_t sequenceNo);
+};
+
+#endif
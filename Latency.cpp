@@ -0,0 +1,193 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Latency.h"
+#include "Clock.h"
+#include "Utils.h"
+#include "Log.h"
+
+#include <cstring>
+
+// The upper bounds of the buckets in microseconds, anything longer goes in a final overflow bucket
+const uint32_t BUCKET_BOUNDS[] = {100U, 200U, 500U, 1000U, 2000U, 5000U, 10000U, 20000U, 50000U, 100000U, 200000U, 500000U, 1000000U};
+
+const unsigned int BUCKET_COUNT = sizeof(BUCKET_BOUNDS) / sizeof(BUCKET_BOUNDS[0U]) + 1U;
+
+const unsigned int MODE_COUNT  = 7U;
+const unsigned int STAGE_COUNT = 3U;
+
+const char* STAGE_NAMES[] = {"receive", "transcode", "send"};
+
+struct CHistogram {
+	uint32_t m_buckets[BUCKET_COUNT];
+	uint32_t m_count;
+	uint64_t m_total;
+	uint32_t m_max;
+};
+
+static CHistogram m_histograms[MODE_COUNT][MODE_COUNT][STAGE_COUNT];
+
+static unsigned int m_src = 0U;
+static unsigned int m_dst = 0U;
+
+static unsigned int m_interval = 0U;
+static unsigned int m_elapsed  = 0U;
+
+static double getPercentile(const CHistogram& histogram, unsigned int percent)
+{
+	// The upper bound of the bucket holding the sample, but never beyond the maximum
+	uint32_t rank = (histogram.m_count * percent + 99U) / 100U;
+
+	uint32_t count = 0U;
+	for (unsigned int i = 0U; i < (BUCKET_COUNT - 1U); i++) {
+		count += histogram.m_buckets[i];
+		if (count >= rank) {
+			if (BUCKET_BOUNDS[i] > histogram.m_max)
+				break;
+
+			return double(BUCKET_BOUNDS[i]) / 1000.0;
+		}
+	}
+
+	return double(histogram.m_max) / 1000.0;
+}
+
+static nlohmann::json createStage(const CHistogram& histogram)
+{
+	nlohmann::json json;
+
+	json["count"]   = histogram.m_count;
+	json["mean_ms"] = double(histogram.m_total) / double(histogram.m_count) / 1000.0;
+	json["p50_ms"]  = getPercentile(histogram, 50U);
+	json["p99_ms"]  = getPercentile(histogram, 99U);
+	json["max_ms"]  = double(histogram.m_max) / 1000.0;
+
+	nlohmann::json buckets = nlohmann::json::array();
+	for (unsigned int i = 0U; i < BUCKET_COUNT; i++)
+		buckets.push_back(histogram.m_buckets[i]);
+
+	json["buckets"] = buckets;
+
+	return json;
+}
+
+static void writeJSONLatency()
+{
+	nlohmann::json pairs = nlohmann::json::array();
+
+	for (unsigned int src = 0U; src < MODE_COUNT; src++) {
+		for (unsigned int dst = 0U; dst < MODE_COUNT; dst++) {
+			nlohmann::json pair;
+
+			for (unsigned int stage = 0U; stage < STAGE_COUNT; stage++) {
+				const CHistogram& histogram = m_histograms[src][dst][stage];
+				if (histogram.m_count > 0U)
+					pair[STAGE_NAMES[stage]] = createStage(histogram);
+			}
+
+			if (!pair.empty()) {
+				pair["src"] = CUtils::getModeName(DATA_MODE(src));
+				pair["dst"] = CUtils::getModeName(DATA_MODE(dst));
+				pairs.push_back(pair);
+			}
+		}
+	}
+
+	if (pairs.empty())
+		return;
+
+	nlohmann::json bounds = nlohmann::json::array();
+	for (unsigned int i = 0U; i < (BUCKET_COUNT - 1U); i++)
+		bounds.push_back(double(BUCKET_BOUNDS[i]) / 1000.0);
+
+	nlohmann::json json;
+
+	json["timestamp"] = CUtils::createTimestamp();
+	json["bucket_ms"] = bounds;
+	json["pairs"]     = pairs;
+
+	WriteJSON("Latency", json);
+}
+
+uint64_t LatencyTime()
+{
+	return ClockNow() / 1000ULL;
+}
+
+void LatencyInitialise(unsigned int interval)
+{
+	m_interval = interval * 1000U;
+	m_elapsed  = 0U;
+
+	LatencyReset();
+}
+
+void LatencySetModes(DATA_MODE src, DATA_MODE dst)
+{
+	m_src = (unsigned int)src;
+	m_dst = (unsigned int)dst;
+}
+
+void LatencyAdd(STAGE stage, uint64_t start)
+{
+	if ((m_interval == 0U) || (start == 0U))
+		return;
+
+	if ((m_src == 0U) || (m_dst == 0U))
+		return;
+
+	uint64_t now = LatencyTime();
+	uint32_t us  = (now > start) ? uint32_t(now - start) : 0U;
+
+	unsigned int bucket = 0U;
+	while ((bucket < (BUCKET_COUNT - 1U)) && (us > BUCKET_BOUNDS[bucket]))
+		bucket++;
+
+	CHistogram& histogram = m_histograms[m_src][m_dst][(unsigned int)stage];
+
+	histogram.m_buckets[bucket]++;
+	histogram.m_count++;
+	histogram.m_total += us;
+
+	if (us > histogram.m_max)
+		histogram.m_max = us;
+}
+
+void LatencyReset()
+{
+	::memset(m_histograms, 0x00U, sizeof(m_histograms));
+}
+
+void LatencyClock(unsigned int ms)
+{
+	if (m_interval == 0U)
+		return;
+
+	m_elapsed += ms;
+	if (m_elapsed < m_interval)
+		return;
+
+	m_elapsed = 0U;
+
+	try {
+		writeJSONLatency();
+	}
+	catch (nlohmann::json::exception& ex) {
+		LogError("Error creating JSON - %s", ex.what());
+	}
+}
@@ -0,0 +1,55 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(LATENCY_H)
+#define	LATENCY_H
+
+#include "Defines.h"
+
+#include <cstdint>
+
+// The stages of the frame path, which between them cover a frame from the
+// socket it arrives on to the socket it leaves by:
+//   RECEIVE   - from the socket read in clock() until read() passes it to CMetaData
+//   TRANSCODE - from the write to the transcoder until the result is read back
+//   SEND      - from leaving the transcoder, through writeData(), to the socket write
+enum class STAGE {
+	RECEIVE,
+	TRANSCODE,
+	SEND
+};
+
+// The histograms are only touched from the main loop, so they need no locks.
+
+// A monotonic time in microseconds
+extern uint64_t LatencyTime();
+
+// Publish the histograms over MQTT every interval seconds, zero disables them
+extern void LatencyInitialise(unsigned int interval);
+
+// The mode pair that following samples belong to
+extern void LatencySetModes(DATA_MODE src, DATA_MODE dst);
+
+// Record the time since start, a start of zero is ignored
+extern void LatencyAdd(STAGE stage, uint64_t start);
+
+extern void LatencyReset();
+
+extern void LatencyClock(unsigned int ms);
+
+#endif
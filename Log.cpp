@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2015,2016,2020,2022,2023 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2015,2016,2020,2022,2023,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -18,6 +18,7 @@
 
 #include "Log.h"
 #include "MQTTConnection.h"
+#include "Thread.h"
 
 #if defined(_WIN32) || defined(_WIN64)
 #include <Windows.h>
@@ -26,6 +27,8 @@
 #include <unistd.h>
 #endif
 
+#include <atomic>
+
 #include <cstdio>
 #include <cstdlib>
 #include <cstdarg>
@@ -33,74 +36,338 @@
 #include <cassert>
 #include <cstring>
 
-CMQTTConnection* m_mqtt = nullptr;
+// Must be a power of two so that the sequence numbers wrap cleanly
+const uint32_t QUEUE_LENGTH = 1024U;
+
+const unsigned int TEXT_LENGTH = 500U;
+
+// How often the logging thread looks for new entries
+const unsigned int POLL_TIME = 10U;
+
+// Warnings and above are never rate limited
+const unsigned int RATE_LIMIT_LEVEL = 4U;
+
+// Read by the logging thread and any thread that logs, and only changed by LogSetMQTT()
+static std::atomic<CMQTTConnection*> m_mqtt(nullptr);
 
 static unsigned int m_mqttLevel = 2U;
 
 static unsigned int m_displayLevel = 2U;
 
+static unsigned int m_rateLimit = 0U;
+
 static char LEVELS[] = " DMIWEF";
 
-void LogInitialise(unsigned int displayLevel, unsigned int mqttLevel)
+// A log line as it is queued, the message is formatted by the caller but the
+// timestamp isn't formatted or anything written out until the logging thread
+// takes it
+struct CLogEntry {
+	std::atomic<uint32_t> m_sequence;
+	unsigned int          m_level;
+#if defined(_WIN32) || defined(_WIN64)
+	SYSTEMTIME            m_time;
+#else
+	struct timeval        m_time;
+#endif
+	char                  m_text[TEXT_LENGTH];
+};
+
+// A bounded multiple producer, single consumer queue. A slot is free for the
+// producer at position n when its sequence is n, and holds an entry for the
+// consumer at position n when it is n + 1.
+static CLogEntry             m_queue[QUEUE_LENGTH];
+static std::atomic<uint32_t> m_head(0U);
+static uint32_t              m_tail = 0U;
+static std::atomic<uint32_t> m_lost(0U);
+
+// Moved on by the logging thread after each entry and each pass over the queue
+static std::atomic<uint32_t> m_progress(0U);
+
+// The entries allowed through and suppressed in the current second
+static time_t       m_rateTime = 0;
+static unsigned int m_rateCount = 0U;
+static unsigned int m_rateSuppressed = 0U;
+
+class CLogThread : public CThread {
+public:
+	CLogThread() :
+	m_running(false)
+	{
+	}
+
+	virtual void entry();
+
+	std::atomic<bool> m_running;
+};
+
+static CLogThread* m_thread = nullptr;
+
+static void getTime(CLogEntry& entry)
+{
+#if defined(_WIN32) || defined(_WIN64)
+	::GetSystemTime(&entry.m_time);
+#else
+	::gettimeofday(&entry.m_time, nullptr);
+#endif
+}
+
+static time_t getSeconds(const CLogEntry& entry)
+{
+#if defined(_WIN32) || defined(_WIN64)
+	return time_t(entry.m_time.wHour) * 3600 + time_t(entry.m_time.wMinute) * 60 + time_t(entry.m_time.wSecond);
+#else
+	return entry.m_time.tv_sec;
+#endif
+}
+
+static void writeLine(unsigned int level, const char* text)
+{
+	CMQTTConnection* mqtt = m_mqtt.load();
+	if (mqtt != nullptr && level >= m_mqttLevel && m_mqttLevel != 0U)
+		mqtt->publish("log", text);
+
+	if (level >= m_displayLevel && m_displayLevel != 0U) {
+		::fprintf(stdout, "%s\n", text);
+		::fflush(stdout);
+	}
+}
+
+static void writeEntry(const CLogEntry& entry)
+{
+	char buffer[TEXT_LENGTH + 30U];
+#if defined(_WIN32) || defined(_WIN64)
+	::sprintf(buffer, "%c: %04u-%02u-%02u %02u:%02u:%02u.%03u ", LEVELS[entry.m_level], entry.m_time.wYear, entry.m_time.wMonth, entry.m_time.wDay, entry.m_time.wHour, entry.m_time.wMinute, entry.m_time.wSecond, entry.m_time.wMilliseconds);
+#else
+	// Not ::gmtime(), whose result is shared with the other threads
+	struct tm tm;
+	::gmtime_r(&entry.m_time.tv_sec, &tm);
+
+	::sprintf(buffer, "%c: %04d-%02d-%02d %02d:%02d:%02d.%03lld ", LEVELS[entry.m_level], tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, (long long)entry.m_time.tv_usec / 1000LL);
+#endif
+	::strcat(buffer, entry.m_text);
+
+	writeLine(entry.m_level, buffer);
+}
+
+static void writeNotice(const char* fmt, unsigned int count)
+{
+	CLogEntry notice;
+	notice.m_level = RATE_LIMIT_LEVEL;
+	getTime(notice);
+	::snprintf(notice.m_text, TEXT_LENGTH, fmt, count);
+
+	writeEntry(notice);
+}
+
+static bool isRateLimited(const CLogEntry& entry)
+{
+	if (m_rateLimit == 0U)
+		return false;
+
+	time_t seconds = getSeconds(entry);
+	if (seconds != m_rateTime) {
+		if (m_rateSuppressed > 0U)
+			writeNotice("%u log messages were suppressed by the rate limit", m_rateSuppressed);
+
+		m_rateTime       = seconds;
+		m_rateCount      = 0U;
+		m_rateSuppressed = 0U;
+	}
+
+	if (entry.m_level >= RATE_LIMIT_LEVEL)
+		return false;
+
+	if (m_rateCount >= m_rateLimit) {
+		m_rateSuppressed++;
+		return true;
+	}
+
+	m_rateCount++;
+
+	return false;
+}
+
+// Only ever called by one thread at a time, the logging thread while it runs
+static void drain()
+{
+	for (;;) {
+		CLogEntry& entry = m_queue[m_tail % QUEUE_LENGTH];
+
+		uint32_t sequence = entry.m_sequence.load(std::memory_order_acquire);
+		if (sequence != (m_tail + 1U))
+			break;
+
+		if (!isRateLimited(entry))
+			writeEntry(entry);
+
+		m_progress++;
+
+		// Hand the slot back to the producers for the next time round
+		entry.m_sequence.store(m_tail + QUEUE_LENGTH, std::memory_order_release);
+		m_tail++;
+
+		uint32_t lost = m_lost.exchange(0U);
+		if (lost > 0U)
+			writeNotice("%u log messages were lost because the queue was full", lost);
+	}
+}
+
+void CLogThread::entry()
+{
+	while (m_running.load()) {
+		drain();
+		m_progress++;
+
+		CThread::sleep(POLL_TIME);
+	}
+
+	drain();
+
+	if (m_rateSuppressed > 0U) {
+		writeNotice("%u log messages were suppressed by the rate limit", m_rateSuppressed);
+		m_rateSuppressed = 0U;
+	}
+}
+
+static CLogEntry* claim()
+{
+	uint32_t position = m_head.load(std::memory_order_relaxed);
+
+	for (;;) {
+		CLogEntry& entry = m_queue[position % QUEUE_LENGTH];
+
+		uint32_t sequence = entry.m_sequence.load(std::memory_order_acquire);
+		int32_t diff = int32_t(sequence - position);
+
+		if (diff == 0) {
+			if (m_head.compare_exchange_weak(position, position + 1U, std::memory_order_relaxed))
+				return &entry;
+		} else if (diff < 0) {
+			// Full, the logging thread hasn't caught up
+			m_lost++;
+			return nullptr;
+		} else {
+			position = m_head.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+static void stopThread()
+{
+	if (m_thread == nullptr)
+		return;
+
+	m_thread->m_running.store(false);
+	m_thread->wait();
+
+	delete m_thread;
+	m_thread = nullptr;
+}
+
+void LogInitialise(unsigned int displayLevel, unsigned int mqttLevel, unsigned int rateLimit)
 {
 	m_mqttLevel = mqttLevel;
 	m_displayLevel = displayLevel;
+	m_rateLimit = rateLimit;
+
+	// Called again on every restart, but the queue and thread carry on
+	if (m_thread != nullptr)
+		return;
+
+	for (uint32_t i = 0U; i < QUEUE_LENGTH; i++)
+		m_queue[i].m_sequence.store(i);
+
+	m_head.store(0U);
+	m_tail = 0U;
+
+	m_thread = new CLogThread;
+	m_thread->m_running.store(true);
+
+	if (!m_thread->run()) {
+		delete m_thread;
+		m_thread = nullptr;
+	}
 }
 
-void LogFinalise()
+void LogSetMQTT(CMQTTConnection* mqtt)
 {
-	if (m_mqtt != nullptr) {
-		m_mqtt->close();
-		delete m_mqtt;
-		m_mqtt = nullptr;
+	CMQTTConnection* old = m_mqtt.exchange(mqtt);
+	if (old == nullptr)
+		return;
+
+	// The logging thread may still be publishing an entry on the old
+	// connection, but not once it has moved on twice
+	if (m_thread != nullptr) {
+		uint32_t progress = m_progress.load();
+		while ((m_progress.load() - progress) < 2U)
+			CThread::sleep(POLL_TIME);
 	}
+
+	old->close();
+	delete old;
+}
+
+void LogFinalise()
+{
+	stopThread();
+
+	LogSetMQTT(nullptr);
 }
 
 void Log(unsigned int level, const char* fmt, ...)
 {
 	assert(fmt != nullptr);
 
-	char buffer[501U];
-#if defined(_WIN32) || defined(_WIN64)
-	SYSTEMTIME st;
-	::GetSystemTime(&st);
+	// Nothing is queued for levels that go nowhere
+	bool mqtt    = m_mqtt.load() != nullptr && level >= m_mqttLevel && m_mqttLevel != 0U;
+	bool display = level >= m_displayLevel && m_displayLevel != 0U;
+	if (!mqtt && !display && (level != 6U))
+		return;
 
-	::sprintf(buffer, "%c: %04u-%02u-%02u %02u:%02u:%02u.%03u ", LEVELS[level], st.wYear, st.wMonth, st.wDay, st.wHour, st.wMinute, st.wSecond, st.wMilliseconds);
-#else
-	struct timeval now;
-	::gettimeofday(&now, nullptr);
+	CLogEntry  local;
+	CLogEntry* entry = &local;
 
-	struct tm* tm = ::gmtime(&now.tv_sec);
+	bool queued = (m_thread != nullptr) && (level != 6U);
+	if (queued) {
+		entry = claim();
+		if (entry == nullptr)
+			return;
+	}
 
-	::sprintf(buffer, "%c: %04d-%02d-%02d %02d:%02d:%02d.%03lld ", LEVELS[level], tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday, tm->tm_hour, tm->tm_min, tm->tm_sec, now.tv_usec / 1000LL);
-#endif
+	entry->m_level = level;
+	getTime(*entry);
 
 	va_list vl;
 	va_start(vl, fmt);
 
-	::vsnprintf(buffer + ::strlen(buffer), 500, fmt, vl);
+	::vsnprintf(entry->m_text, TEXT_LENGTH, fmt, vl);
 
 	va_end(vl);
 
-	if (m_mqtt != nullptr && level >= m_mqttLevel && m_mqttLevel != 0U)
-		m_mqtt->publish("log", buffer);
-
-	if (level >= m_displayLevel && m_displayLevel != 0U) {
-		::fprintf(stdout, "%s\n", buffer);
-		::fflush(stdout);
+	if (queued) {
+		// Publish the entry to the logging thread
+		entry->m_sequence.fetch_add(1U, std::memory_order_release);
+		return;
 	}
 
-	if (level == 6U)		// Fatal
+	if (level == 6U) {		// Fatal
+		// Everything before it is written out first
+		stopThread();
+		writeEntry(local);
 		exit(1);
+	}
+
+	writeEntry(local);
 }
 
 void WriteJSON(const std::string& topLevel, nlohmann::json& json)
 {
-	if (m_mqtt != nullptr) {
+	CMQTTConnection* mqtt = m_mqtt.load();
+	if (mqtt != nullptr) {
 		nlohmann::json top;
 
 		top[topLevel] = json;
 
-		m_mqtt->publish("json", top.dump());
+		mqtt->publish("json", top.dump());
 	}
 }
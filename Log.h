@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2015,2016,2020,2022,2023 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2015,2016,2020,2022,2023,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -23,6 +23,8 @@
 
 #include <nlohmann/json.hpp>
 
+class CMQTTConnection;
+
 #define	LogDebug(fmt, ...)	Log(1U, fmt, ##__VA_ARGS__)
 #define	LogMessage(fmt, ...)	Log(2U, fmt, ##__VA_ARGS__)
 #define	LogInfo(fmt, ...)	Log(3U, fmt, ##__VA_ARGS__)
@@ -32,9 +34,14 @@
 
 extern void Log(unsigned int level, const char* fmt, ...);
 
-extern void LogInitialise(unsigned int displayLevel, unsigned int mqttLevel);
+// Lines are written out by a background thread, at most rateLimit per second
+// below warnings with zero for no limit
+extern void LogInitialise(unsigned int displayLevel, unsigned int mqttLevel, unsigned int rateLimit);
 extern void LogFinalise();
 
+// Takes ownership of the connection, and closes and deletes the one before it
+extern void LogSetMQTT(CMQTTConnection* mqtt);
+
 extern void WriteJSON(const std::string& topLevel, nlohmann::json& json);
 
 #endif
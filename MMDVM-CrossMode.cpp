@@ -25,10 +25,14 @@
 #include "YSFNetwork.h"
 #include "DMRNetwork.h"
 #include "FMNetwork.h"
-#include "StopWatch.h"
+#include "Capture.h"
+#include "Clock.h"
+#include "Replay.h"
+#include "Latency.h"
+#include "Metrics.h"
 #include "Version.h"
 #include "Defines.h"
-#include "Thread.h"
+#include "TimerWheel.h"
 #include "Timer.h"
 #include "Utils.h"
 #include "Log.h"
@@ -51,12 +55,13 @@ const char* DEFAULT_INI_FILE = "MMDVM-CrossMode.ini";
 const char* DEFAULT_INI_FILE = "/etc/MMDVM-CrossMode.ini";
 #endif
 
+// The time between the passes of the main loop, in ns
+const uint64_t PASS_TIME = 5000000ULL;
+
 static bool m_killed = false;
 static int  m_signal = 0;
 static bool m_reload = false;
-
-// In Log.cpp
-extern CMQTTConnection* m_mqtt;
+static bool m_latencyReset = false;
 
 #if !defined(_WIN32) && !defined(_WIN64)
 static void sigHandler1(int signum)
@@ -69,6 +74,11 @@ static void sigHandler2(int signum)
 {
 	m_reload = true;
 }
+
+static void sigHandler3(int signum)
+{
+	m_latencyReset = true;
+}
 #endif
 
 int main(int argc, char** argv)
@@ -92,6 +102,7 @@ int main(int argc, char** argv)
 	::signal(SIGTERM, sigHandler1);
 	::signal(SIGHUP, sigHandler1);
 	::signal(SIGUSR1, sigHandler2);
+	::signal(SIGUSR2, sigHandler3);
 #endif
 
 	int ret = 0;
@@ -203,14 +214,33 @@ int CMMDVMCrossMode::run()
 	}
 #endif
 
-	::LogInitialise(m_conf.getLogDisplayLevel(), m_conf.getLogMQTTLevel());
+	::LogInitialise(m_conf.getLogDisplayLevel(), m_conf.getLogMQTTLevel(), m_conf.getLogRateLimit());
+
+	::LatencyInitialise(m_conf.getLatencyReportInterval());
+	::MetricsInitialise(m_conf.getMetricsInterval(), m_conf.getMetricsTextFile());
+
+	std::string captureFile = m_conf.getCaptureFile();
+	if (!captureFile.empty())
+		::CaptureOpen(captureFile);
+
+	std::string replayFile = m_conf.getReplayFile();
+	if (!replayFile.empty()) {
+		ret = ::ReplayOpen(replayFile, m_conf.getReplayPaced());
+		if (!ret)
+			return 1;
+	}
 
 	std::vector<std::pair<std::string, void (*)(const unsigned char*, unsigned int)>> subscriptions;
 
-	m_mqtt = new CMQTTConnection(m_conf.getMQTTAddress(), m_conf.getMQTTPort(), m_conf.getMQTTName(), m_conf.getMQTTAuthEnabled(), m_conf.getMQTTUsername(), m_conf.getMQTTPassword(), subscriptions, m_conf.getMQTTKeepalive());
-	ret = m_mqtt->open();
-	if (!ret)
-		return 1; 
+	CMQTTConnection* mqtt = new CMQTTConnection(m_conf.getMQTTAddress(), m_conf.getMQTTPort(), m_conf.getMQTTName(), m_conf.getMQTTAuthEnabled(), m_conf.getMQTTUsername(), m_conf.getMQTTPassword(), subscriptions, m_conf.getMQTTKeepalive());
+	ret = mqtt->open();
+	if (!ret) {
+		delete mqtt;
+		return 1;
+	}
+
+	// Replaces the connection from before a restart
+	::LogSetMQTT(mqtt);
 
 #if !defined(_WIN32) && !defined(_WIN64)
 	if (m_daemon) {
@@ -256,6 +286,8 @@ int CMMDVMCrossMode::run()
 
 	loadModeTranslationTables(data);
 
+	data.setLatencyBudgets(m_conf.getLatencyDefault(), m_conf.getLatencyBudgets());
+
 	ret = loadIdLookupTables(data);
 	if (!ret) {
 		closeRFNetworks();
@@ -263,18 +295,18 @@ int CMMDVMCrossMode::run()
 		return 1;
 	}
 
-	CStopWatch stopwatch;
-	CTimer watchdog(1000U, 1U);
+	CTimer watchdog(1U);
 
-	CTimer rfTimer(1000U, m_conf.getRFModeHang());
-	CTimer netTimer(1000U, m_conf.getNetModeHang());
+	CTimer rfTimer(m_conf.getRFModeHang());
+	CTimer netTimer(m_conf.getNetModeHang());
 
 	LogMessage("MMDVM-CrossMode-%s is starting", VERSION);
 	LogMessage("Built %s %s (GitID #%.7s)", __TIME__, __DATE__, gitversion);
 
 	writeJSONMessage("MMDVM-CrossMode is starting");
 
-	stopwatch.start();
+	uint64_t last = ::ClockNow();
+	uint64_t next = last;
 
 	while (!m_killed) {
 		bool end = false;
@@ -409,16 +441,38 @@ int CMMDVMCrossMode::run()
 			watchdog.stop();
 		}
 
-		CThread::sleep(5U);
+		if (::ReplayFinished())
+			break;
+
+		// Sleep until the next pass is due, without trying to catch up after a stall
+		next += PASS_TIME;
+		::ClockSleepUntil(next);
 
-		unsigned int elapsed = stopwatch.elapsed();
-		stopwatch.start();
+		uint64_t now = ::ClockNow();
+		if (now > next)
+			next = now;
+
+		// Whole ms only, the remainder is carried over to the next pass
+		unsigned int elapsed = (unsigned int)((now - last) / 1000000ULL);
+		last += elapsed * 1000000ULL;
 
 		clockRFNetworks(elapsed);
 		clockNetNetworks(elapsed);
 		data.clock(elapsed);
 
-		rfTimer.clock(elapsed);
+		if (m_latencyReset) {
+			::LatencyReset();
+			m_latencyReset = false;
+			::LogMessage("The latency histograms have been reset");
+		}
+
+		::LatencyClock(elapsed);
+		::MetricsClock(elapsed);
+		::CaptureClock(elapsed);
+
+		// Runs the ping, poll, and reload callbacks, and marks the timers below if they have expired
+		::TimerWheelClock();
+
 		if (rfTimer.isRunning() && rfTimer.hasExpired()) {
 			resetRFNetworks();
 			resetNetNetworks();
@@ -431,7 +485,6 @@ int CMMDVMCrossMode::run()
 			::LogMessage("Switched back to Idle by the RF timer");
 		}
 
-		netTimer.clock(elapsed);
 		if (netTimer.isRunning() && netTimer.hasExpired()) {
 			resetRFNetworks();
 			resetNetNetworks();
@@ -443,7 +496,6 @@ int CMMDVMCrossMode::run()
 			::LogMessage("Switched back to Idle by the Net timer");
 		}
 
-		watchdog.clock(elapsed);
 		if (watchdog.isRunning() && watchdog.hasExpired()) {
 			resetRFNetworks();
 			resetNetNetworks();
@@ -465,9 +517,13 @@ int CMMDVMCrossMode::run()
 
 	closeNetNetworks();
 
+	ret = ::ReplayClose();
+
+	::CaptureClose();
+
 	CUDPSocket::shutdown();
 
-	return 0;
+	return ret ? 0 : 1;
 }
 
 bool CMMDVMCrossMode::createRFNetworks()
@@ -504,6 +560,8 @@ bool CMMDVMCrossMode::createRFNetworks()
 		bool debug                = m_conf.getDStarRFDebug();
 
 		CDStarNetwork* network = new CDStarNetwork(NETWORK::RF, dstarCallsign, localAddress, localPort, remoteAddress, remotePort, debug);
+		if (m_conf.getPacingEnabled())
+			network->setPacing(m_conf.getPacingLead());
 
 		bool ret = network->open();
 		if (!ret) {
@@ -535,6 +593,8 @@ bool CMMDVMCrossMode::createRFNetworks()
 		bool debug                = m_conf.getDMRRFDebug();
 
 		CDMRNetwork* network = new CDMRNetwork(NETWORK::RF, id, localAddress, localPort, remoteAddress, remotePort, debug);
+		if (m_conf.getPacingEnabled())
+			network->setPacing(m_conf.getPacingLead());
 
 		bool ret = network->open();
 		if (!ret) {
@@ -563,6 +623,8 @@ bool CMMDVMCrossMode::createRFNetworks()
 		bool debug                = m_conf.getYSFRFDebug();
 
 		CYSFNetwork* network = new CYSFNetwork(NETWORK::RF, callsign, localAddress, localPort, remoteAddress, remotePort, debug);
+		if (m_conf.getPacingEnabled())
+			network->setPacing(m_conf.getPacingLead());
 
 		bool ret = network->open();
 		if (!ret) {
@@ -591,6 +653,8 @@ bool CMMDVMCrossMode::createRFNetworks()
 		bool debug                = m_conf.getP25RFDebug();
 
 		CP25Network* network = new CP25Network(NETWORK::RF, localAddress, localPort, remoteAddress, remotePort, debug);
+		if (m_conf.getPacingEnabled())
+			network->setPacing(m_conf.getPacingLead());
 
 		bool ret = network->open();
 		if (!ret) {
@@ -619,6 +683,8 @@ bool CMMDVMCrossMode::createRFNetworks()
 		bool debug                = m_conf.getNXDNRFDebug();
 
 		CNXDNNetwork* network = new CNXDNNetwork(NETWORK::RF, localAddress, localPort, remoteAddress, remotePort, debug);
+		if (m_conf.getPacingEnabled())
+			network->setPacing(m_conf.getPacingLead());
 
 		bool ret = network->open();
 		if (!ret) {
@@ -647,6 +713,8 @@ bool CMMDVMCrossMode::createRFNetworks()
 		bool debug                = m_conf.getFMRFDebug();
 
 		CFMNetwork* network = new CFMNetwork(NETWORK::RF, callsign, localAddress, localPort, remoteAddress, remotePort, debug);
+		if (m_conf.getPacingEnabled())
+			network->setPacing(m_conf.getPacingLead());
 
 		bool ret = network->open();
 		if (!ret) {
@@ -695,6 +763,9 @@ bool CMMDVMCrossMode::createNetNetworks()
 		bool debug                = m_conf.getDStarNetDebug();
 
 		CDStarNetwork* network = new CDStarNetwork(NETWORK::NET, dstarCallsign, localAddress, localPort, remoteAddress, remotePort, debug);
+		network->setJitterBuffer(m_conf.getDStarNetJitterBuffer());
+		if (m_conf.getPacingEnabled())
+			network->setPacing(m_conf.getPacingLead());
 
 		bool ret = network->open();
 		if (!ret) {
@@ -732,6 +803,9 @@ bool CMMDVMCrossMode::createNetNetworks()
 
 		CDMRNetwork* network = new CDMRNetwork(NETWORK::NET, id, localAddress, localPort, remoteAddress, remotePort, debug);
 		network->setConfig(callsign, VERSION, txFrequency, rxFrequency, colorCode, power);
+		network->setJitterBuffer(m_conf.getDMRNetJitterBuffer());
+		if (m_conf.getPacingEnabled())
+			network->setPacing(m_conf.getPacingLead());
 
 		bool ret = network->open();
 		if (!ret) {
@@ -760,6 +834,9 @@ bool CMMDVMCrossMode::createNetNetworks()
 		bool debug                = m_conf.getYSFNetDebug();
 
 		CYSFNetwork* network = new CYSFNetwork(NETWORK::NET, callsign, localAddress, localPort, remoteAddress, remotePort, debug);
+		network->setJitterBuffer(m_conf.getYSFNetJitterBuffer());
+		if (m_conf.getPacingEnabled())
+			network->setPacing(m_conf.getPacingLead());
 
 		bool ret = network->open();
 		if (!ret) {
@@ -788,6 +865,9 @@ bool CMMDVMCrossMode::createNetNetworks()
 		bool debug                = m_conf.getP25NetDebug();
 
 		CP25Network* network = new CP25Network(NETWORK::NET, localAddress, localPort, remoteAddress, remotePort, debug);
+		network->setJitterBuffer(m_conf.getP25NetJitterBuffer());
+		if (m_conf.getPacingEnabled())
+			network->setPacing(m_conf.getPacingLead());
 
 		bool ret = network->open();
 		if (!ret) {
@@ -816,6 +896,8 @@ bool CMMDVMCrossMode::createNetNetworks()
 		bool debug                = m_conf.getNXDNNetDebug();
 
 		CNXDNNetwork* network = new CNXDNNetwork(NETWORK::NET, localAddress, localPort, remoteAddress, remotePort, debug);
+		if (m_conf.getPacingEnabled())
+			network->setPacing(m_conf.getPacingLead());
 
 		bool ret = network->open();
 		if (!ret) {
@@ -844,6 +926,8 @@ bool CMMDVMCrossMode::createNetNetworks()
 		bool debug                = m_conf.getFMNetDebug();
 
 		CFMNetwork* network = new CFMNetwork(NETWORK::NET, callsign, localAddress, localPort, remoteAddress, remotePort, debug);
+		if (m_conf.getPacingEnabled())
+			network->setPacing(m_conf.getPacingLead());
 
 		bool ret = network->open();
 		if (!ret) {
@@ -970,14 +1054,18 @@ void CMMDVMCrossMode::resetNetNetworks()
 
 void CMMDVMCrossMode::drainRFNetworks()
 {
-	for (auto& it : m_rfNetworks)
-		it.second->read();
+	for (auto& it : m_rfNetworks) {
+		if (it.second->read())
+			MetricsNetwork(NETWORK::RF, it.first)->m_drained.add();
+	}
 }
 
 void CMMDVMCrossMode::drainNetNetworks()
 {
-	for (auto& it : m_netNetworks)
-		it.second->read();
+	for (auto& it : m_netNetworks) {
+		if (it.second->read())
+			MetricsNetwork(NETWORK::NET, it.first)->m_drained.add();
+	}
 }
 
 void CMMDVMCrossMode::clockRFNetworks(unsigned int ms)
@@ -19,7 +19,11 @@
 #include "MetaData.h"
 
 #include "DStarDefines.h"
+#include "NXDNDefines.h"
+#include "DMRDefines.h"
+#include "P25Defines.h"
 #include "YSFDefines.h"
+#include "Latency.h"
 #include "Utils.h"
 #include "Log.h"
 
@@ -33,6 +37,24 @@ const uint8_t  NULL_SLOT = 0U;
 const uint16_t NULL_ID16 = 0xFFFFU;
 const uint32_t NULL_ID32 = 0xFFFFFFFFU;
 
+// Any more than this is a break in the stream rather than lost frames
+const unsigned int MAX_MISSING_FRAMES = 25U;
+
+// Every frame to and from the transcoder is 20ms of audio
+const unsigned int FRAME_TIME = 20U;
+
+// How far the arrival clock of a stream may drift from ours, in ms per frame
+const unsigned int MAX_DRIFT = 1U;
+
+// The longest the transcoder takes to answer a frame, in ms
+const unsigned int REPLY_TIMEOUT = 1000U;
+
+// Peak PCM sample value that still counts as silence
+const int PCM_SILENCE_LEVEL = 256;
+
+// Enough for one second of the longest frames, plus their lengths and times
+const uint16_t OUTPUT_BUFFER_LENGTH = 50U * (PCM_DATA_LENGTH + sizeof(uint16_t) + sizeof(uint64_t));
+
 CMetaData::CMetaData(const std::string& callsign, uint32_t dmrId, uint16_t nxdnId, bool debug) :
 m_transcoder(debug),
 m_defaultCallsign(callsign),
@@ -73,29 +95,44 @@ m_nxdnDMRTGs(),
 m_nxdnYSFTGs(),
 m_nxdnP25TGs(),
 m_nxdnFMTG(),
+m_defaultBudget(0U),
+m_budgets(),
 m_direction(DIRECTION::NONE),
 m_rf(),
 m_net(),
 m_end(false),
-m_data(nullptr),
-m_length(0U),
+m_output(OUTPUT_BUFFER_LENGTH, "Transcoder Output"),
 m_rawData(nullptr),
 m_rawLength(0U),
-m_count(0U)
+m_count(0U),
+m_lastData(nullptr),
+m_lastValid(false),
+m_concealed(0U),
+m_time(0U),
+m_budget(0U),
+m_inStarted(false),
+m_inNominal(0U),
+m_inFrames(),
+m_playout(0U),
+m_dropped(0U),
+m_fecErrors(0U),
+m_fecBits(0U),
+m_receiveTime(0U),
+m_rawTime(0U),
+m_sendTime(0U)
 {
 	assert(!callsign.empty());
 	assert(dmrId > 0U);
 	assert(nxdnId > 0U);
 
-	// The longest data possible
-	m_data    = new uint8_t[PCM_DATA_LENGTH];
-	m_rawData = new uint8_t[1000U];
+	m_rawData  = new uint8_t[1000U];
+	m_lastData = new uint8_t[PCM_DATA_LENGTH];
 }
 
 CMetaData::~CMetaData()
 {
-	delete[] m_data;
 	delete[] m_rawData;
+	delete[] m_lastData;
 }
 
 void CMetaData::setUARTConnection(const std::string& port, uint32_t speed)
@@ -162,6 +199,22 @@ bool CMetaData::setTranscoder()
 		return false;
 	}
 
+	DATA_MODE srcMode = (m_direction == DIRECTION::NET_TO_RF) ? m_net.m_mode : m_rf.m_mode;
+	DATA_MODE dstMode = (m_direction == DIRECTION::NET_TO_RF) ? m_rf.m_mode : m_net.m_mode;
+
+	m_budget = m_defaultBudget;
+	for (const auto& it : m_budgets) {
+		if ((std::get<0>(it) == CUtils::getModeName(srcMode)) && (std::get<1>(it) == CUtils::getModeName(dstMode))) {
+			m_budget = std::get<2>(it);
+			break;
+		}
+	}
+
+	LatencySetModes(srcMode, dstMode);
+
+	// Frames from the last call that came back after it ended are no use to this one
+	m_output.clear();
+
 	switch (m_direction) {
 	case DIRECTION::RF_TO_NET:
 		return m_transcoder.setConversion(transRFMode, transNetMode);
@@ -328,6 +381,12 @@ void CMetaData::setNXDNFMTG(uint16_t tg)
 	m_nxdnFMTG = tg;
 }
 
+void CMetaData::setLatencyBudgets(unsigned int defaultBudget, const std::vector<std::tuple<std::string, std::string, unsigned int>>& budgets)
+{
+	m_defaultBudget = defaultBudget;
+	m_budgets       = budgets;
+}
+
 bool CMetaData::open()
 {
 	return m_transcoder.open();
@@ -1608,6 +1667,11 @@ void CMetaData::setFM(NETWORK network, const uint8_t* source)
 	}
 }
 
+void CMetaData::setReceiveTime(uint64_t time)
+{
+	m_receiveTime = time;
+}
+
 void CMetaData::setRaw(const uint8_t* data, uint16_t length)
 {
 	assert(data != nullptr);
@@ -1615,6 +1679,11 @@ void CMetaData::setRaw(const uint8_t* data, uint16_t length)
 
 	::memcpy(m_rawData, data, length);
 	m_rawLength = length;
+	m_rawTime   = LatencyTime();
+
+	// Transcoded frames are timed as they reach setData()
+	if ((m_rf.m_mode != DATA_MODE::NONE) && (m_net.m_mode != DATA_MODE::NONE) && !isTranscode())
+		LatencyAdd(STAGE::RECEIVE, m_receiveTime);
 }
 
 bool CMetaData::setData(const uint8_t* data)
@@ -1630,9 +1699,56 @@ bool CMetaData::setData(const uint8_t* data)
 
 	m_count++;
 
+	if (isTranscode())
+		LatencyAdd(STAGE::RECEIVE, m_receiveTime);
+
+	::memcpy(m_lastData, data, m_transcoder.getInLength());
+	m_lastValid = true;
+
+	stampFrame(isSilence((m_direction == DIRECTION::NET_TO_RF) ? m_net.m_mode : m_rf.m_mode, data));
+
 	return true;
 }
 
+bool CMetaData::setMissingData(unsigned int count)
+{
+	if ((m_rf.m_mode == DATA_MODE::NONE) || (m_net.m_mode == DATA_MODE::NONE))
+		return false;
+
+	if (count == 0U)
+		return true;
+
+	if (count > MAX_MISSING_FRAMES)
+		count = MAX_MISSING_FRAMES;
+
+	uint8_t silence[PCM_DATA_LENGTH];
+	getSilence((m_direction == DIRECTION::NET_TO_RF) ? m_net.m_mode : m_rf.m_mode, silence);
+
+	for (unsigned int i = 0U; i < count; i++) {
+		// Repeat the last good frame once, then fill the rest of the gap with silence
+		bool ret = m_transcoder.write(((i == 0U) && m_lastValid) ? m_lastData : silence);
+		if (!ret)
+			return false;
+
+		m_count++;
+
+		stampFrame(i > 0U);
+	}
+
+	m_lastValid  = false;
+	m_concealed += count;
+
+	LogDebug("Concealed %u missing frame(s)", count);
+
+	return true;
+}
+
+void CMetaData::addFECErrors(unsigned int errors, unsigned int bits)
+{
+	m_fecErrors += errors;
+	m_fecBits   += bits;
+}
+
 void CMetaData::setEnd()
 {
 	if ((m_rf.m_mode != DATA_MODE::NONE) && (m_net.m_mode != DATA_MODE::NONE)) {
@@ -1809,7 +1925,7 @@ bool CMetaData::hasRaw() const
 
 bool CMetaData::hasData() const
 {
-	return m_length > 0U;
+	return m_output.hasData();
 }
 
 uint16_t CMetaData::getRaw(uint8_t* data)
@@ -1820,25 +1936,48 @@ uint16_t CMetaData::getRaw(uint8_t* data)
 		::memcpy(data, m_rawData, m_rawLength);
 		uint16_t length = m_rawLength;
 		m_rawLength     = 0U;
+		m_sendTime      = m_rawTime;
 		return length;
 	}
 
 	return 0U;
 }
 
-bool CMetaData::getData(uint8_t* data)
+bool CMetaData::getData(uint8_t* data, uint16_t length)
 {
 	assert(data != nullptr);
 
-	if (m_length > 0U) {
-		::memcpy(data, m_data, m_length);
-		m_length = 0U;
-		if (m_count > 0U)
-			m_count--;
-		return true;
+	if (m_output.empty())
+		return false;
+
+	uint16_t len  = 0U;
+	uint64_t time = 0U;
+	m_output.get((uint8_t*)&len, sizeof(uint16_t));
+	m_output.get((uint8_t*)&time, sizeof(uint64_t));
+
+	if (m_count > 0U)
+		m_count--;
+
+	if (len > length) {
+		LogError("Transcoder output frame of %u bytes is too long for %u, skipping it", len, length);
+		m_output.remove(len);
+		return false;
 	}
 
-	return false;
+	m_output.get(data, len);
+
+	if (m_sendTime == 0U)
+		m_sendTime = time;
+
+	return true;
+}
+
+uint64_t CMetaData::getSendTime()
+{
+	uint64_t time = m_sendTime;
+	m_sendTime = 0U;
+
+	return time;
 }
 
 bool CMetaData::isEnd() const
@@ -1860,19 +1999,107 @@ void CMetaData::reset()
 	m_net.reset();
 
 	m_end       = false;
-	m_length    = 0U;
 	m_count     = 0U;
 	m_rawLength = 0U;
+	m_lastValid = false;
+	m_concealed = 0U;
+	m_budget    = 0U;
+	m_inStarted = false;
+	m_dropped   = 0U;
+	m_fecErrors = 0U;
+	m_fecBits   = 0U;
+
+	m_receiveTime = 0U;
+	m_sendTime    = 0U;
+
+	m_inFrames.clear();
+	m_output.clear();
 
 	m_direction = DIRECTION::NONE;
 }
 
 void CMetaData::clock(unsigned int ms)
 {
-	m_length = m_transcoder.read(m_data);
+	m_time += ms;
+
+	// Take every complete frame the transcoder has ready, not just the first
+	uint8_t data[PCM_DATA_LENGTH];
+	for (;;) {
+		bool failed = false;
+		uint16_t length = m_transcoder.read(data, failed);
+
+		// The frame has been answered without its data, so it is forgotten
+		if (failed) {
+			if (!m_inFrames.empty())
+				m_inFrames.pop_front();
+
+			if (m_count > 0U)
+				m_count--;
+
+			m_dropped++;
+			continue;
+		}
+
+		if (length == 0U)
+			break;
+
+		bool silence = false;
+		if (!m_inFrames.empty()) {
+			silence = std::get<1>(m_inFrames.front());
+			LatencyAdd(STAGE::TRANSCODE, std::get<2>(m_inFrames.front()));
+		}
 
-	m_dmrLookup.clock(ms);
-	m_nxdnLookup.clock(ms);
+		if (isStale(silence)) {
+			if (!m_inFrames.empty())
+				m_inFrames.pop_front();
+
+			if (m_count > 0U)
+				m_count--;
+
+			m_dropped++;
+			continue;
+		}
+
+		if (!m_inFrames.empty())
+			m_inFrames.pop_front();
+
+		// Without a conversion it is the raw data that goes out, so these are only counted off
+		if (!isTranscode()) {
+			if (m_count > 0U)
+				m_count--;
+			continue;
+		}
+
+		// A record only partly added would leave those behind it out of step
+		if (!m_output.hasSpace(sizeof(uint16_t) + sizeof(uint64_t) + length)) {
+			LogWarning("Transcoder output is full, dropping a frame");
+
+			if (m_count > 0U)
+				m_count--;
+
+			m_dropped++;
+			continue;
+		}
+
+		uint64_t time = LatencyTime();
+
+		m_output.add((uint8_t*)&length, sizeof(uint16_t));
+		m_output.add((uint8_t*)&time, sizeof(uint64_t));
+		m_output.add(data, length);
+	}
+
+	// The transcoder answers every frame in order, so a frame that has waited
+	// this long has had its reply lost, and every later reply would be matched
+	// against the wrong frame
+	uint64_t now = LatencyTime();
+	while (!m_inFrames.empty() && ((now - std::get<2>(m_inFrames.front())) > (REPLY_TIMEOUT * 1000U))) {
+		m_inFrames.pop_front();
+
+		if (m_count > 0U)
+			m_count--;
+
+		m_dropped++;
+	}
 }
 
 void CMetaData::close()
@@ -1880,6 +2107,103 @@ void CMetaData::close()
 	m_transcoder.close();
 }
 
+void CMetaData::getSilence(DATA_MODE mode, uint8_t* data) const
+{
+	assert(data != nullptr);
+
+	switch (mode) {
+	case DATA_MODE::DSTAR:
+		::memcpy(data, DSTAR_NULL_AMBE_DATA_BYTES, DSTAR_DATA_LENGTH);
+		break;
+	case DATA_MODE::DMR:
+		::memcpy(data, DMR_SILENCE, DMR_NXDN_DATA_LENGTH);
+		break;
+	case DATA_MODE::NXDN:
+		::memcpy(data, NXDN_SILENCE, DMR_NXDN_DATA_LENGTH);
+		break;
+	case DATA_MODE::YSF:
+		::memcpy(data, YSFDN_SILENCE, YSFDN_DATA_LENGTH);
+		break;
+	case DATA_MODE::P25:
+		::memcpy(data, P25_NULL_IMBE, IMBE_DATA_LENGTH);
+		break;
+	default:
+		::memset(data, 0x00U, PCM_DATA_LENGTH);
+		break;
+	}
+}
+
+bool CMetaData::isSilence(DATA_MODE mode, const uint8_t* data) const
+{
+	assert(data != nullptr);
+
+	if (mode != DATA_MODE::FM) {
+		uint8_t silence[PCM_DATA_LENGTH];
+		getSilence(mode, silence);
+
+		return ::memcmp(data, silence, m_transcoder.getInLength()) == 0;
+	}
+
+	// The FM samples are 16-bit big endian
+	for (unsigned int i = 0U; i < PCM_DATA_LENGTH; i += 2U) {
+		int sample = int16_t((data[i + 0U] << 8) | (data[i + 1U] << 0));
+		if ((sample > PCM_SILENCE_LEVEL) || (sample < -PCM_SILENCE_LEVEL))
+			return false;
+	}
+
+	return true;
+}
+
+void CMetaData::stampFrame(bool silence)
+{
+	// Each frame is due FRAME_TIME after the one before it. A frame arriving
+	// early moves the schedule back, one arriving late only pulls it forward
+	// by MAX_DRIFT, so frames held up by a stall keep their true age. Frames
+	// are timed from when they reached the socket, not from when they were
+	// taken from the receive buffer.
+	uint64_t now = LatencyTime();
+	unsigned int arrival = m_time;
+	if ((m_receiveTime > 0U) && (m_receiveTime < now))
+		arrival -= (unsigned int)((now - m_receiveTime) / 1000U);
+
+	if (!m_inStarted) {
+		m_inNominal = arrival;
+		m_playout   = m_time;
+		m_inStarted = true;
+	} else {
+		m_inNominal += FRAME_TIME;
+
+		int late = int(arrival - m_inNominal);
+		if (late > int(MAX_DRIFT))
+			m_inNominal += MAX_DRIFT;
+		else
+			m_inNominal = arrival;
+	}
+
+	m_inFrames.push_back(std::make_tuple(m_inNominal, silence, LatencyTime()));
+}
+
+bool CMetaData::isStale(bool silence)
+{
+	// The destination plays one frame every FRAME_TIME, so anything queued
+	// ahead of this frame delays it further
+	unsigned int start = m_time;
+	if (int(m_playout - start) > 0)
+		start = m_playout;
+
+	if ((m_budget > 0U) && !m_inFrames.empty()) {
+		int latency = int(start - std::get<0>(m_inFrames.front()));
+
+		// Discard silence first, and speech only once the budget is used up
+		if ((latency > int(m_budget)) || (silence && (latency > int(m_budget / 2U))))
+			return true;
+	}
+
+	m_playout = start + FRAME_TIME;
+
+	return false;
+}
+
 // uint8_t <=> std::string
 uint8_t CMetaData::find(const std::vector<std::pair<std::string, uint8_t>>& mapping, const std::string& dest) const
 {
@@ -2357,6 +2681,18 @@ void CMetaData::writeJSONStatus(const std::string& action) const
 				json["Net"] = createAddress(m_net);
 		} else {
 			json["action"] = action;
+
+			if (m_concealed > 0U)
+				json["concealed_frames"] = m_concealed;
+
+			if (m_dropped > 0U)
+				json["dropped_frames"] = m_dropped;
+
+			if (m_fecBits > 0U) {
+				json["fec_errors"] = m_fecErrors;
+				json["fec_bits"]   = m_fecBits;
+				json["ber"]        = float(m_fecErrors * 100U) / float(m_fecBits);
+			}
 		}
 
 		WriteJSON("Status", json);
@@ -20,6 +20,7 @@
 #define	MetaData_H
 
 #include "TranscoderDefines.h"
+#include "RingBuffer.h"
 #include "Transcoder.h"
 #include "NXDNLookup.h"
 #include "DMRLookup.h"
@@ -28,6 +29,7 @@
 #include <string>
 #include <cstdint>
 #include <vector>
+#include <deque>
 #include <tuple>
 
 class CDestination {
@@ -128,6 +130,8 @@ public:
 	void setNXDNP25TGs(const std::vector<std::pair<uint16_t, uint32_t>>& tgs);
 	void setNXDNFMTG(uint16_t tg);
 
+	void setLatencyBudgets(unsigned int defaultBudget, const std::vector<std::tuple<std::string, std::string, unsigned int>>& budgets);
+
 	bool open();
 
 	void setDStar(NETWORK network, const uint8_t* source, const uint8_t* destination);
@@ -147,14 +151,26 @@ public:
 	void getP25(NETWORK network, uint32_t& source, uint32_t& destination, bool& group) const;
 	void getFM(NETWORK network, uint8_t* source) const;
 
+	// When the packet being read arrived on its socket
+	void     setReceiveTime(uint64_t time);
+
 	void     setRaw(const uint8_t* data, uint16_t length);
 	bool     setData(const uint8_t* data);
+	bool     setMissingData(unsigned int count);
+
+	// The bits corrected by the FEC in a received frame, and the number of bits covered
+	void     addFECErrors(unsigned int errors, unsigned int bits);
 
 	bool     hasRaw() const;
 	bool     hasData() const;
 
 	uint16_t getRaw(uint8_t* data);
-	bool     getData(uint8_t* data);
+
+	// A frame longer than the length the caller can hold is skipped
+	bool     getData(uint8_t* data, uint16_t length);
+
+	// When the oldest frame taken since the last call left the transcoder
+	uint64_t getSendTime();
 
 	bool isEnd() const;
 
@@ -213,15 +229,32 @@ private:
 	std::vector<std::pair<uint16_t, uint32_t>>              m_nxdnP25TGs;
 	uint16_t                                                m_nxdnFMTG;
 
+	unsigned int                                                    m_defaultBudget;
+	std::vector<std::tuple<std::string, std::string, unsigned int>> m_budgets;
+
 	DIRECTION    m_direction;
 	CDestination m_rf;
 	CDestination m_net;
 	bool         m_end;
-	uint8_t*     m_data;
-	uint16_t     m_length;
+	CRingBuffer<uint8_t> m_output;
 	uint8_t*     m_rawData;
 	uint16_t     m_rawLength;
 	uint16_t     m_count;
+	uint8_t*     m_lastData;
+	bool         m_lastValid;
+	unsigned int m_concealed;
+	unsigned int m_time;
+	unsigned int m_budget;
+	bool         m_inStarted;
+	unsigned int m_inNominal;
+	std::deque<std::tuple<unsigned int, bool, uint64_t>> m_inFrames;
+	unsigned int m_playout;
+	unsigned int m_dropped;
+	unsigned int m_fecErrors;
+	unsigned int m_fecBits;
+	uint64_t     m_receiveTime;
+	uint64_t     m_rawTime;
+	uint64_t     m_sendTime;
 
 	// uint8_t <=> std::string
 	uint8_t find(const std::vector<std::pair<std::string, uint8_t>>& mapping, const std::string& dest) const;
@@ -293,6 +326,12 @@ private:
 	std::pair<uint8_t, uint32_t> find(const std::vector<std::tuple<uint8_t, uint32_t, uint8_t>>& mapping, uint8_t dgId) const;
 	uint8_t find(const std::vector<std::tuple<uint8_t, uint32_t, uint8_t>>& mapping, uint8_t slot, uint32_t tgid) const;
 
+	void getSilence(DATA_MODE mode, uint8_t* data) const;
+	bool isSilence(DATA_MODE mode, const uint8_t* data) const;
+
+	void stampFrame(bool silence);
+	bool isStale(bool silence);
+
 	std::string bytesToString(const uint8_t* str, size_t length) const;
 	void stringToBytes(uint8_t* str, size_t length, const std::string& callsign) const;
 
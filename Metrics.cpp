@@ -0,0 +1,206 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Metrics.h"
+#include "Utils.h"
+#include "Log.h"
+
+#include <cstdio>
+#include <cassert>
+
+const unsigned int NETWORK_COUNT = 2U;
+const unsigned int MODE_COUNT    = 7U;
+
+struct CNetworkCounter {
+	const char* m_name;
+	const char* m_help;
+	CCounter CNetworkMetrics::* m_counter;
+};
+
+const CNetworkCounter NETWORK_COUNTERS[] = {
+	{"packets_in",     "Packets received from the network",       &CNetworkMetrics::m_packetsIn},
+	{"bytes_in",       "Bytes received from the network",         &CNetworkMetrics::m_bytesIn},
+	{"packets_out",    "Packets sent to the network",             &CNetworkMetrics::m_packetsOut},
+	{"bytes_out",      "Bytes sent to the network",               &CNetworkMetrics::m_bytesOut},
+	{"invalid_source", "Packets received from an invalid source", &CNetworkMetrics::m_invalidSource},
+	{"overflows",      "Receive ring buffer overflows",           &CNetworkMetrics::m_overflows},
+	{"underflows",     "Receive ring buffer underflows",          &CNetworkMetrics::m_underflows},
+	{"drained",        "Packets discarded while not in use",      &CNetworkMetrics::m_drained}
+};
+
+struct CTranscoderCounter {
+	const char* m_name;
+	const char* m_help;
+	CCounter CTranscoderMetrics::* m_counter;
+};
+
+const CTranscoderCounter TRANSCODER_COUNTERS[] = {
+	{"frames_sent",     "Frames sent to the transcoder",          &CTranscoderMetrics::m_framesSent},
+	{"frames_received", "Frames received from the transcoder",    &CTranscoderMetrics::m_framesReceived},
+	{"naks",            "NAKs returned by the transcoder",        &CTranscoderMetrics::m_naks},
+	{"timeouts",        "Transcoder replies that timed out",      &CTranscoderMetrics::m_timeouts},
+	{"resyncs",         "Times the message framing was regained", &CTranscoderMetrics::m_resyncs}
+};
+
+static CNetworkMetrics    m_networks[NETWORK_COUNT][MODE_COUNT];
+static CTranscoderMetrics m_transcoder;
+
+static unsigned int m_interval = 0U;
+static unsigned int m_elapsed  = 0U;
+static std::string  m_textFile;
+
+static const char* getNetworkName(unsigned int network)
+{
+	return (NETWORK(network) == NETWORK::RF) ? "RF" : "Net";
+}
+
+static void writeJSONMetrics()
+{
+	nlohmann::json networks = nlohmann::json::array();
+
+	for (unsigned int network = 0U; network < NETWORK_COUNT; network++) {
+		for (unsigned int mode = 0U; mode < MODE_COUNT; mode++) {
+			const CNetworkMetrics& metrics = m_networks[network][mode];
+			if (!metrics.m_used)
+				continue;
+
+			nlohmann::json json;
+
+			json["network"] = getNetworkName(network);
+			json["mode"]    = CUtils::getModeName(DATA_MODE(mode));
+
+			for (const auto& counter : NETWORK_COUNTERS)
+				json[counter.m_name] = (metrics.*counter.m_counter).get();
+
+			networks.push_back(json);
+		}
+	}
+
+	nlohmann::json transcoder;
+	for (const auto& counter : TRANSCODER_COUNTERS)
+		transcoder[counter.m_name] = (m_transcoder.*counter.m_counter).get();
+
+	nlohmann::json json;
+
+	json["timestamp"]  = CUtils::createTimestamp();
+	json["networks"]   = networks;
+	json["transcoder"] = transcoder;
+
+	WriteJSON("Metrics", json);
+}
+
+static bool writeTextFile()
+{
+	// Written to one side and then renamed, so node_exporter never sees half a file
+	std::string temp = m_textFile + ".tmp";
+
+	FILE* fp = ::fopen(temp.c_str(), "wt");
+	if (fp == nullptr) {
+		LogError("Unable to open the metrics file %s", temp.c_str());
+		return false;
+	}
+
+	for (const auto& counter : NETWORK_COUNTERS) {
+		::fprintf(fp, "# HELP mmdvm_crossmode_network_%s_total %s\n", counter.m_name, counter.m_help);
+		::fprintf(fp, "# TYPE mmdvm_crossmode_network_%s_total counter\n", counter.m_name);
+
+		for (unsigned int network = 0U; network < NETWORK_COUNT; network++) {
+			for (unsigned int mode = 0U; mode < MODE_COUNT; mode++) {
+				const CNetworkMetrics& metrics = m_networks[network][mode];
+				if (!metrics.m_used)
+					continue;
+
+				::fprintf(fp, "mmdvm_crossmode_network_%s_total{network=\"%s\",mode=\"%s\"} %llu\n", counter.m_name,
+					getNetworkName(network), CUtils::getModeName(DATA_MODE(mode)).c_str(), (unsigned long long)(metrics.*counter.m_counter).get());
+			}
+		}
+	}
+
+	for (const auto& counter : TRANSCODER_COUNTERS) {
+		::fprintf(fp, "# HELP mmdvm_crossmode_transcoder_%s_total %s\n", counter.m_name, counter.m_help);
+		::fprintf(fp, "# TYPE mmdvm_crossmode_transcoder_%s_total counter\n", counter.m_name);
+		::fprintf(fp, "mmdvm_crossmode_transcoder_%s_total %llu\n", counter.m_name, (unsigned long long)(m_transcoder.*counter.m_counter).get());
+	}
+
+	bool ok = ::ferror(fp) == 0;
+
+	if (::fclose(fp) != 0)
+		ok = false;
+
+	if (!ok) {
+		LogError("Unable to write the metrics file %s", temp.c_str());
+		::remove(temp.c_str());
+		return false;
+	}
+
+#if defined(_WIN32) || defined(_WIN64)
+	::remove(m_textFile.c_str());
+#endif
+
+	if (::rename(temp.c_str(), m_textFile.c_str()) != 0) {
+		LogError("Unable to rename the metrics file to %s", m_textFile.c_str());
+		::remove(temp.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+CNetworkMetrics* MetricsNetwork(NETWORK network, DATA_MODE mode)
+{
+	assert((unsigned int)mode < MODE_COUNT);
+
+	CNetworkMetrics* metrics = &m_networks[(unsigned int)network][(unsigned int)mode];
+	metrics->m_used = true;
+
+	return metrics;
+}
+
+CTranscoderMetrics* MetricsTranscoder()
+{
+	return &m_transcoder;
+}
+
+void MetricsInitialise(unsigned int interval, const std::string& textFile)
+{
+	m_interval = interval * 1000U;
+	m_elapsed  = 0U;
+	m_textFile = textFile;
+}
+
+void MetricsClock(unsigned int ms)
+{
+	if (m_interval == 0U)
+		return;
+
+	m_elapsed += ms;
+	if (m_elapsed < m_interval)
+		return;
+
+	m_elapsed = 0U;
+
+	try {
+		writeJSONMetrics();
+	}
+	catch (nlohmann::json::exception& ex) {
+		LogError("Error creating JSON - %s", ex.what());
+	}
+
+	if (!m_textFile.empty())
+		writeTextFile();
+}
@@ -0,0 +1,104 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(METRICS_H)
+#define	METRICS_H
+
+#include "Defines.h"
+
+#include <atomic>
+#include <string>
+
+#include <cstdint>
+
+// Each counter has a cache line to itself so that counters bumped by
+// different threads never contend for the same line.
+struct alignas(64) CCounter {
+	CCounter() :
+	m_value(0U)
+	{
+	}
+
+	void add(uint64_t n = 1U)
+	{
+		m_value.fetch_add(n, std::memory_order_relaxed);
+	}
+
+	uint64_t get() const
+	{
+		return m_value.load(std::memory_order_relaxed);
+	}
+
+	std::atomic<uint64_t> m_value;
+};
+
+struct CNetworkMetrics {
+	CNetworkMetrics() :
+	m_used(false),
+	m_packetsIn(),
+	m_bytesIn(),
+	m_packetsOut(),
+	m_bytesOut(),
+	m_invalidSource(),
+	m_overflows(),
+	m_underflows(),
+	m_drained()
+	{
+	}
+
+	bool     m_used;
+	CCounter m_packetsIn;
+	CCounter m_bytesIn;
+	CCounter m_packetsOut;
+	CCounter m_bytesOut;
+	CCounter m_invalidSource;
+	CCounter m_overflows;
+	CCounter m_underflows;
+	CCounter m_drained;
+};
+
+struct CTranscoderMetrics {
+	CTranscoderMetrics() :
+	m_framesSent(),
+	m_framesReceived(),
+	m_naks(),
+	m_timeouts(),
+	m_resyncs()
+	{
+	}
+
+	CCounter m_framesSent;
+	CCounter m_framesReceived;
+	CCounter m_naks;
+	CCounter m_timeouts;
+	CCounter m_resyncs;
+};
+
+// The counters for a network, which is then included in the reports
+extern CNetworkMetrics* MetricsNetwork(NETWORK network, DATA_MODE mode);
+
+extern CTranscoderMetrics* MetricsTranscoder();
+
+// Publish the counters over MQTT every interval seconds, and also write them
+// to textFile for the Prometheus node_exporter if it isn't empty. An interval
+// of zero disables both.
+extern void MetricsInitialise(unsigned int interval, const std::string& textFile);
+
+extern void MetricsClock(unsigned int ms);
+
+#endif
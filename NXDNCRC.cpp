@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2018,2024 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2018,2024,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -18,12 +18,46 @@
 
 #include "NXDNCRC.h"
 
+#include "Utils.h"
+
 #include <cstdio>
 #include <cassert>
 
+// Byte at a time tables for the NXDN CRCs, entry i being the register after
+// shifting in the eight bits of i. The CRC-6 table works with the register
+// held in the top six bits of a byte.
+struct CNXDNCRCTables {
+	uint8_t  crc6[256U];
+	uint16_t crc12[256U];
+	uint16_t crc15[256U];
+
+	constexpr CNXDNCRCTables() :
+	crc6(),
+	crc12(),
+	crc15()
+	{
+		for (unsigned int i = 0U; i < 256U; i++) {
+			uint8_t  c6  = uint8_t(i);
+			uint16_t c12 = uint16_t(i << 4);
+			uint16_t c15 = uint16_t(i << 7);
+
+			for (unsigned int j = 0U; j < 8U; j++) {
+				c6  = (c6 & 0x80U)    ? uint8_t((c6 << 1) ^ (0x27U << 2)) : uint8_t(c6 << 1);
+				c12 = (c12 & 0x0800U) ? uint16_t((c12 << 1) ^ 0x080FU)    : uint16_t(c12 << 1);
+				c15 = (c15 & 0x4000U) ? uint16_t((c15 << 1) ^ 0x4CC5U)    : uint16_t(c15 << 1);
+			}
+
+			crc6[i]  = c6;
+			crc12[i] = c12 & 0x0FFFU;
+			crc15[i] = c15 & 0x7FFFU;
+		}
+	}
+};
+
+static constexpr CNXDNCRCTables NXDN_CRC_TABLES;
+
 const uint8_t BIT_MASK_TABLE1[] = { 0x80U, 0x40U, 0x20U, 0x10U, 0x08U, 0x04U, 0x02U, 0x01U };
 
-#define WRITE_BIT1(p,i,b) p[(i)>>3] = (b) ? (p[(i)>>3] | BIT_MASK_TABLE1[(i)&7]) : (p[(i)>>3] & ~BIT_MASK_TABLE1[(i)&7])
 #define READ_BIT1(p,i)    (p[(i)>>3] & BIT_MASK_TABLE1[(i)&7])
 
 bool CNXDNCRC::checkCRC6(const uint8_t* in, unsigned int length)
@@ -34,11 +68,7 @@ bool CNXDNCRC::checkCRC6(const uint8_t* in, unsigned int length)
 
 	uint8_t temp[1U];
 	temp[0U] = 0x00U;
-	unsigned int j = length;
-	for (unsigned int i = 2U; i < 8U; i++, j++) {
-		bool b = READ_BIT1(in, j);
-		WRITE_BIT1(temp, i, b);
-	}
+	CUtils::copyBits(in, length, temp, 2U, 6U);
 
 	return crc == temp[0U];
 }
@@ -50,11 +80,7 @@ void CNXDNCRC::encodeCRC6(uint8_t* in, unsigned int length)
 	uint8_t crc[1U];
 	crc[0U] = createCRC6(in, length);
 
-	unsigned int n = length;
-	for (unsigned int i = 2U; i < 8U; i++, n++) {
-		bool b = READ_BIT1(crc, i);
-		WRITE_BIT1(in, n, b);
-	}
+	CUtils::copyBits(crc, 2U, in, length, 6U);
 }
 
 bool CNXDNCRC::checkCRC12(const uint8_t* in, unsigned int length)
@@ -62,20 +88,13 @@ bool CNXDNCRC::checkCRC12(const uint8_t* in, unsigned int length)
 	assert(in != nullptr);
 
 	uint16_t crc = createCRC12(in, length);
-	uint8_t temp1[2U];
-	temp1[0U] = (crc >> 8) & 0xFFU;
-	temp1[1U] = (crc >> 0) & 0xFFU;
-
-	uint8_t temp2[2U];
-	temp2[0U] = 0x00U;
-	temp2[1U] = 0x00U;
-	unsigned int j = length;
-	for (unsigned int i = 4U; i < 16U; i++, j++) {
-		bool b = READ_BIT1(in, j);
-		WRITE_BIT1(temp2, i, b);
-	}
 
-	return temp1[0U] == temp2[0U] && temp1[1U] == temp2[1U];
+	uint8_t temp[2U];
+	temp[0U] = 0x00U;
+	temp[1U] = 0x00U;
+	CUtils::copyBits(in, length, temp, 4U, 12U);
+
+	return crc == ((temp[0U] << 8) | temp[1U]);
 }
 
 void CNXDNCRC::encodeCRC12(uint8_t* in, unsigned int length)
@@ -88,11 +107,7 @@ void CNXDNCRC::encodeCRC12(uint8_t* in, unsigned int length)
 	temp[0U] = (crc >> 8) & 0xFFU;
 	temp[1U] = (crc >> 0) & 0xFFU;
 
-	unsigned int n = length;
-	for (unsigned int i = 4U; i < 16U; i++, n++) {
-		bool b = READ_BIT1(temp, i);
-		WRITE_BIT1(in, n, b);
-	}
+	CUtils::copyBits(temp, 4U, in, length, 12U);
 }
 
 bool CNXDNCRC::checkCRC15(const uint8_t* in, unsigned int length)
@@ -100,20 +115,13 @@ bool CNXDNCRC::checkCRC15(const uint8_t* in, unsigned int length)
 	assert(in != nullptr);
 
 	uint16_t crc = createCRC15(in, length);
-	uint8_t temp1[2U];
-	temp1[0U] = (crc >> 8) & 0xFFU;
-	temp1[1U] = (crc >> 0) & 0xFFU;
-
-	uint8_t temp2[2U];
-	temp2[0U] = 0x00U;
-	temp2[1U] = 0x00U;
-	unsigned int j = length;
-	for (unsigned int i = 1U; i < 16U; i++, j++) {
-		bool b = READ_BIT1(in, j);
-		WRITE_BIT1(temp2, i, b);
-	}
 
-	return temp1[0U] == temp2[0U] && temp1[1U] == temp2[1U];
+	uint8_t temp[2U];
+	temp[0U] = 0x00U;
+	temp[1U] = 0x00U;
+	CUtils::copyBits(in, length, temp, 1U, 15U);
+
+	return crc == ((temp[0U] << 8) | temp[1U]);
 }
 
 void CNXDNCRC::encodeCRC15(uint8_t* in, unsigned int length)
@@ -126,35 +134,42 @@ void CNXDNCRC::encodeCRC15(uint8_t* in, unsigned int length)
 	temp[0U] = (crc >> 8) & 0xFFU;
 	temp[1U] = (crc >> 0) & 0xFFU;
 
-	unsigned int n = length;
-	for (unsigned int i = 1U; i < 16U; i++, n++) {
-		bool b = READ_BIT1(temp, i);
-		WRITE_BIT1(in, n, b);
-	}
+	CUtils::copyBits(temp, 1U, in, length, 15U);
 }
 
 uint8_t CNXDNCRC::createCRC6(const uint8_t* in, unsigned int length)
 {
-	uint8_t crc = 0x3FU;
+	// The register is kept in the top six bits
+	uint8_t crc = 0x3FU << 2;
+
+	// Whole bytes through the table, then any remaining bits one at a time
+	unsigned int i = 0U;
+	for (; (i + 8U) <= length; i += 8U)
+		crc = NXDN_CRC_TABLES.crc6[crc ^ in[i >> 3]];
 
-	for (unsigned int i = 0U; i < length; i++) {
+	for (; i < length; i++) {
 		bool bit1 = READ_BIT1(in, i) != 0x00U;
-		bool bit2 = (crc & 0x20U) == 0x20U;
+		bool bit2 = (crc & 0x80U) == 0x80U;
 
 		crc <<= 1;
 
 		if (bit1 ^ bit2)
-			crc ^= 0x27U;
+			crc ^= 0x27U << 2;
 	}
 
-	return crc & 0x3FU;
+	return (crc >> 2) & 0x3FU;
 }
 
 uint16_t CNXDNCRC::createCRC12(const uint8_t* in, unsigned int length)
 {
 	uint16_t crc = 0x0FFFU;
 
-	for (unsigned int i = 0U; i < length; i++) {
+	// Whole bytes through the table, then any remaining bits one at a time
+	unsigned int i = 0U;
+	for (; (i + 8U) <= length; i += 8U)
+		crc = uint16_t(crc << 8) ^ NXDN_CRC_TABLES.crc12[((crc >> 4) ^ in[i >> 3]) & 0xFFU];
+
+	for (; i < length; i++) {
 		bool bit1 = READ_BIT1(in, i) != 0x00U;
 		bool bit2 = (crc & 0x0800U) == 0x0800U;
 
@@ -171,7 +186,12 @@ uint16_t CNXDNCRC::createCRC15(const uint8_t* in, unsigned int length)
 {
 	uint16_t crc = 0x7FFFU;
 
-	for (unsigned int i = 0U; i < length; i++) {
+	// Whole bytes through the table, then any remaining bits one at a time
+	unsigned int i = 0U;
+	for (; (i + 8U) <= length; i += 8U)
+		crc = uint16_t(crc << 8) ^ NXDN_CRC_TABLES.crc15[((crc >> 7) ^ in[i >> 3]) & 0xFFU];
+
+	for (; i < length; i++) {
 		bool bit1 = READ_BIT1(in, i) != 0x00U;
 		bool bit2 = (crc & 0x4000U) == 0x4000U;
 
@@ -17,6 +17,7 @@
  */
 
 #include "NXDNConvolution.h"
+#include "ViterbiACS.h"
 
 #include <cstdio>
 #include <cassert>
@@ -37,23 +38,17 @@ const uint32_t     M = 4U;
 const unsigned int K = 5U;
 
 CNXDNConvolution::CNXDNConvolution() :
-m_metrics1(nullptr),
-m_metrics2(nullptr),
-m_oldMetrics(nullptr),
-m_newMetrics(nullptr),
-m_decisions(nullptr),
-m_dp(nullptr)
+m_metrics1(),
+m_metrics2(),
+m_oldMetrics(m_metrics1),
+m_newMetrics(m_metrics2),
+m_decisions(),
+m_dp(m_decisions)
 {
-	m_metrics1  = new uint16_t[20U];
-	m_metrics2  = new uint16_t[20U];
-	m_decisions = new uint64_t[300U];
 }
 
 CNXDNConvolution::~CNXDNConvolution()
 {
-	delete[] m_metrics1;
-	delete[] m_metrics2;
-	delete[] m_decisions;
 }
 
 void CNXDNConvolution::start()
@@ -68,25 +63,11 @@ void CNXDNConvolution::start()
 
 void CNXDNConvolution::decode(uint8_t s0, uint8_t s1)
 {
-  *m_dp = 0U;
+  uint16_t metrics[NUM_OF_STATES_D2];
+  for (uint8_t i = 0U; i < NUM_OF_STATES_D2; i++)
+    metrics[i] = std::abs(BRANCH_TABLE1[i] - s0) + std::abs(BRANCH_TABLE2[i] - s1);
 
-  for (uint8_t i = 0U; i < NUM_OF_STATES_D2; i++) {
-    uint8_t j = i * 2U;
-
-    uint16_t metric = std::abs(BRANCH_TABLE1[i] - s0) + std::abs(BRANCH_TABLE2[i] - s1);
-
-    uint16_t m0 = m_oldMetrics[i] + metric;
-    uint16_t m1 = m_oldMetrics[i + NUM_OF_STATES_D2] + (M - metric);
-    uint8_t decision0 = (m0 >= m1) ? 1U : 0U;
-    m_newMetrics[j + 0U] = decision0 != 0U ? m1 : m0;
-
-    m0 = m_oldMetrics[i] + (M - metric);
-    m1 = m_oldMetrics[i + NUM_OF_STATES_D2] + metric;
-    uint8_t decision1 = (m0 >= m1) ? 1U : 0U;
-    m_newMetrics[j + 1U] = decision1 != 0U ? m1 : m0;
-
-    *m_dp |= (uint64_t(decision1) << (j + 1U)) | (uint64_t(decision0) << (j + 0U));
-  }
+  *m_dp = CViterbiACS::decode(m_oldMetrics, m_newMetrics, metrics, M);
 
   ++m_dp;
 
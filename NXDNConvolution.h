@@ -34,11 +34,11 @@ public:
 	void encode(const uint8_t* in, uint8_t* out, unsigned int nBits) const;
 
 private:
-	uint16_t* m_metrics1;
-	uint16_t* m_metrics2;
+	uint16_t  m_metrics1[16U];
+	uint16_t  m_metrics2[16U];
 	uint16_t* m_oldMetrics;
 	uint16_t* m_newMetrics;
-	uint64_t* m_decisions;
+	uint64_t  m_decisions[300U];
 	uint64_t* m_dp;
 };
 
@@ -1,5 +1,5 @@
 /*
-*   Copyright (C) 2018,2024 by Jonathan Naylor G4KLX
+*   Copyright (C) 2018,2024,2026 by Jonathan Naylor G4KLX
 *
 *   This program is free software; you can redistribute it and/or modify
 *   it under the terms of the GNU General Public License as published by
@@ -43,6 +43,8 @@ const unsigned int PUNCTURE_LIST[] = {  1U,   5U,   9U,  13U,  17U,  21U,  25U,
 									  121U, 125U, 129U, 133U, 137U, 141U, 145U, 149U, 153U, 157U,
 									  161U, 165U, 169U, 173U, 177U, 181U, 185U, 189U };
 
+const unsigned int PUNCTURE_COUNT = sizeof(PUNCTURE_LIST) / sizeof(PUNCTURE_LIST[0U]);
+
 const uint8_t BIT_MASK_TABLE[] = { 0x80U, 0x40U, 0x20U, 0x10U, 0x08U, 0x04U, 0x02U, 0x01U };
 
 #define WRITE_BIT1(p,i,b) p[(i)>>3] = (b) ? (p[(i)>>3] | BIT_MASK_TABLE[(i)&7]) : (p[(i)>>3] & ~BIT_MASK_TABLE[(i)&7])
@@ -66,7 +68,7 @@ CNXDNFACCH1::~CNXDNFACCH1()
 	delete[] m_data;
 }
 
-bool CNXDNFACCH1::decode(const uint8_t* data, unsigned int offset)
+bool CNXDNFACCH1::decode(const uint8_t* data, unsigned int offset, unsigned int& errors)
 {
 	assert(data != nullptr);
 
@@ -83,7 +85,7 @@ bool CNXDNFACCH1::decode(const uint8_t* data, unsigned int offset)
 	unsigned int n = 0U;
 	unsigned int index = 0U;
 	for (unsigned int i = 0U; i < NXDN_FACCH1_LENGTH_BITS; i++) {
-		if (n == PUNCTURE_LIST[index]) {
+		if ((index < PUNCTURE_COUNT) && (n == PUNCTURE_LIST[index])) {
 			temp2[n++] = 1U;
 			index++;
 		}
@@ -107,7 +109,8 @@ bool CNXDNFACCH1::decode(const uint8_t* data, unsigned int offset)
 		conv.decode(s0, s1);
 	}
 
-	conv.chainback(m_data, 96U);
+	// Each punctured bit adds half a bit error to every path
+	errors = conv.chainback(m_data, 96U) - (PUNCTURE_COUNT / 2U);
 
 	return CNXDNCRC::checkCRC12(m_data, 80U);
 }
@@ -132,7 +135,7 @@ void CNXDNFACCH1::encode(uint8_t* data, unsigned int offset) const
 	unsigned int n = 0U;
 	unsigned int index = 0U;
 	for (unsigned int i = 0U; i < 192U; i++) {
-		if (i != PUNCTURE_LIST[index]) {
+		if ((index >= PUNCTURE_COUNT) || (i != PUNCTURE_LIST[index])) {
 			bool b = READ_BIT1(temp2, i);
 			WRITE_BIT1(temp3, n, b);
 			n++;
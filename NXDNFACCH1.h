@@ -1,5 +1,5 @@
 /*
-*   Copyright (C) 2018,2024 by Jonathan Naylor G4KLX
+*   Copyright (C) 2018,2024,2026 by Jonathan Naylor G4KLX
 *
 *   This program is free software; you can redistribute it and/or modify
 *   it under the terms of the GNU General Public License as published by
@@ -27,7 +27,8 @@ public:
 	CNXDNFACCH1();
 	~CNXDNFACCH1();
 
-	bool decode(const uint8_t* data, unsigned int offset);
+	// errors is the number of bits corrected by the FEC out of the 144 sent
+	bool decode(const uint8_t* data, unsigned int offset, unsigned int& errors);
 
 	void encode(uint8_t* data, unsigned int offset) const;
 
@@ -31,8 +31,9 @@ const unsigned int BUFFER_SIZE = 200U;
 CNXDNLookup::CNXDNLookup() :
 m_filename(),
 m_data(),
-m_timer(1000U)
+m_timer()
 {
+	m_timer.setCallback(onReload, this);
 }
 
 CNXDNLookup::~CNXDNLookup()
@@ -110,11 +111,13 @@ uint16_t CNXDNLookup::lookup(const std::string& callsign) const
 	return NULL_ID;
 }
 
-void CNXDNLookup::clock(unsigned int ms)
+void CNXDNLookup::onReload(void* obj)
 {
-	m_timer.clock(ms);
-	if (m_timer.isRunning() && m_timer.hasExpired()) {
-		load();
-		m_timer.start();
-	}
+	assert(obj != nullptr);
+
+	CNXDNLookup* p = static_cast<CNXDNLookup*>(obj);
+
+	p->load();
+
+	p->m_timer.start();
 }
@@ -22,6 +22,8 @@
 #include "NXDNFACCH1.h"
 #include "NXDNLICH.h"
 #include "NXDNCRC.h"
+#include "Capture.h"
+#include "Latency.h"
 #include "Utils.h"
 #include "Log.h"
 
@@ -29,18 +31,15 @@
 #include <cassert>
 #include <cstring>
 
-const uint8_t BIT_MASK_TABLE[] = { 0x80U, 0x40U, 0x20U, 0x10U, 0x08U, 0x04U, 0x02U, 0x01U };
-
-#define WRITE_BIT(p,i,b) p[(i)>>3] = (b) ? (p[(i)>>3] | BIT_MASK_TABLE[(i)&7]) : (p[(i)>>3] & ~BIT_MASK_TABLE[(i)&7])
-#define READ_BIT(p,i)    (p[(i)>>3] & BIT_MASK_TABLE[(i)&7])
-
 const unsigned int BUFFER_LENGTH = 200U;
 
 CNXDNNetwork::CNXDNNetwork(NETWORK network, const std::string& localAddress, uint16_t localPort, const std::string& remoteAddress, uint16_t remotePort, bool debug) :
 m_network(network),
+m_metrics(nullptr),
 m_socket(localAddress, localPort),
 m_addr(),
 m_addrLen(0U),
+m_pacer(nullptr),
 m_debug(debug),
 m_buffer(1000U, "NXDN Network"),
 m_seqNo(0U),
@@ -55,12 +54,25 @@ m_maxAudio(0U)
 	if (CUDPSocket::lookup(remoteAddress, remotePort, m_addr, m_addrLen) != 0)
 		m_addrLen = 0U;
 
-	m_audio = new uint8_t[DMR_NXDN_DATA_LENGTH * 2U];
+	m_audio = new uint8_t[DMR_NXDN_DATA_LENGTH * 4U];
+
+	m_metrics = MetricsNetwork(network, DATA_MODE::NXDN);
+
+	m_socket.setMetrics(m_metrics);
+	m_socket.setCapture(CaptureInterface(network, DATA_MODE::NXDN), m_addr, m_addrLen);
+	m_buffer.setCounters(&m_metrics->m_overflows, &m_metrics->m_underflows);
 }
 
 CNXDNNetwork::~CNXDNNetwork()
 {
 	delete[] m_audio;
+	delete m_pacer;
+}
+
+void CNXDNNetwork::setPacing(unsigned int lead)
+{
+	delete m_pacer;
+	m_pacer = new CPacer(m_network == NETWORK::RF ? "NXDN RF Network" : "NXDN Net Network", 102U, 40U, lead);
 }
 
 bool CNXDNNetwork::open()
@@ -99,7 +111,11 @@ bool CNXDNNetwork::writeRaw(CMetaData& data)
 			CUtils::dump(1U, "NXDN Net Network Raw Sent", buffer, length);
 	}
 
-	return m_socket.write(buffer, length, m_addr, m_addrLen);
+	bool ret = m_socket.write(buffer, length, m_addr, m_addrLen);
+
+	LatencyAdd(STAGE::SEND, data.getSendTime());
+
+	return ret;
 }
 
 bool CNXDNNetwork::writeData(CMetaData& data)
@@ -107,47 +123,49 @@ bool CNXDNNetwork::writeData(CMetaData& data)
 	if (m_addrLen == 0U)
 		return false;
 
-	switch (m_audioCount) {
-	case 0U:
-		::memcpy(m_audio + 0U, NXDN_SILENCE, DMR_NXDN_DATA_LENGTH);
-		::memcpy(m_audio + DMR_NXDN_DATA_LENGTH, NXDN_SILENCE, DMR_NXDN_DATA_LENGTH);
-
-		if (data.hasData()) {
-			data.getData(m_audio + 0U);
-			m_audioCount = 1U;
+	// Pack everything the transcoder has ready, two frames per packet
+	while (data.hasData()) {
+		if (m_audioCount == 0U) {
+			::memcpy(m_audio + 0U, NXDN_SILENCE, DMR_NXDN_DATA_LENGTH);
+			::memcpy(m_audio + DMR_NXDN_DATA_LENGTH, NXDN_SILENCE, DMR_NXDN_DATA_LENGTH);
 		}
 
-		if (!data.isEnd())
-			return true;
-		break;
+		data.getData(m_audio + (m_audioCount * DMR_NXDN_DATA_LENGTH), DMR_NXDN_DATA_LENGTH);
+		m_audioCount++;
 
-	case 1U:
-		if (data.hasData()) {
-			data.getData(m_audio + DMR_NXDN_DATA_LENGTH + DMR_NXDN_DATA_LENGTH + DMR_NXDN_DATA_LENGTH);
-			m_audioCount = 2U;
-		}
-		break;
+		if (m_audioCount == 2U) {
+			// A failed header must not leave the packet full
+			m_audioCount = 0U;
 
-	default:
-		// This shouldn't happen
-		assert(false);
+			if (m_seqNo == 0U) {
+				bool ret = writeHeader(data);
+				if (!ret)
+					return false;
+			}
+
+			bool ret = writeBody(data);
+			if (!ret)
+				return false;
+		}
 	}
 
+	if (!data.isEnd())
+		return true;
+
 	if (m_seqNo == 0U) {
 		bool ret = writeHeader(data);
 		if (!ret)
 			return false;
-		return writeBody(data);
-	} else if (data.isEnd()) {
-		if (m_audioCount > 0U) {
-			bool ret = writeBody(data);
-			if (!ret)
-				return false;
-		}
-		return writeTrailer(data);
-	} else {
-		return writeBody(data);
 	}
+
+	// Send any partial packet, padded with silence
+	if (m_audioCount > 0U) {
+		bool ret = writeBody(data);
+		if (!ret)
+			return false;
+	}
+
+	return writeTrailer(data);
 }
 
 bool CNXDNNetwork::writeHeader(CMetaData& data)
@@ -197,7 +215,7 @@ bool CNXDNNetwork::writeHeader(CMetaData& data)
 			CUtils::dump(1U, "NXDN Net Network Header Sent", buffer, 102U);
 	}
 
-	return m_socket.write(buffer, 102U, m_addr, m_addrLen);
+	return writePacket(buffer, 102U);
 }
 
 bool CNXDNNetwork::writeBody(CMetaData& data)
@@ -256,12 +274,7 @@ bool CNXDNNetwork::writeBody(CMetaData& data)
 		break;
 	}
 
-	uint8_t* p = buffer + 40U;
-
-	for (unsigned int j = 0U; j < 18U; j++) {
-		bool b = READ_BIT(sacch, j + n * 18U);
-		WRITE_BIT(p, j + 16U, b);
-	}
+	CUtils::copyBits(sacch, n * 18U, buffer + 40U, 16U, 18U);
 
 	CNXDNCRC::encodeCRC6(buffer + 41U, 26U);
 
@@ -278,7 +291,7 @@ bool CNXDNNetwork::writeBody(CMetaData& data)
 			CUtils::dump(1U, "NXDN Net Network Audio Sent", buffer, 102U);
 	}
 
-	return m_socket.write(buffer, 102U, m_addr, m_addrLen);
+	return writePacket(buffer, 102U, data.getSendTime());
 }
 
 bool CNXDNNetwork::writeTrailer(CMetaData& data)
@@ -328,11 +341,46 @@ bool CNXDNNetwork::writeTrailer(CMetaData& data)
 			CUtils::dump(1U, "NXDN Net Network Trailer Sent", buffer, 102U);
 	}
 
-	return m_socket.write(buffer, 102U, m_addr, m_addrLen);
+	return writePacket(buffer, 102U);
+}
+
+bool CNXDNNetwork::writePacket(const uint8_t* data, uint16_t length, uint64_t start)
+{
+	assert(data != nullptr);
+
+	if (m_pacer == nullptr) {
+		bool ret = m_socket.write(data, length, m_addr, m_addrLen);
+		LatencyAdd(STAGE::SEND, start);
+		return ret;
+	}
+
+	if (!m_pacer->add(data, length, start))
+		return false;
+
+	writePaced();
+
+	return true;
+}
+
+void CNXDNNetwork::writePaced()
+{
+	uint8_t buffer[102U];
+	uint16_t length = 0U;
+	uint64_t start  = 0U;
+
+	while (m_pacer->get(buffer, length, start)) {
+		m_socket.write(buffer, length, m_addr, m_addrLen);
+		LatencyAdd(STAGE::SEND, start);
+	}
 }
 
 void CNXDNNetwork::clock(unsigned int ms)
 {
+	if (m_pacer != nullptr) {
+		m_pacer->clock(ms);
+		writePaced();
+	}
+
 	uint8_t buffer[BUFFER_LENGTH];
 	sockaddr_storage addr;
 	size_t addrlen;
@@ -342,6 +390,8 @@ void CNXDNNetwork::clock(unsigned int ms)
 		return;
 
 	if (!CUDPSocket::match(m_addr, addr, IPMATCHTYPE::ADDRESS_AND_PORT)) {
+		m_metrics->m_invalidSource.add();
+
 		if (m_network == NETWORK::RF)
 			LogWarning("NXDN RF packet received from an unknown address");
 		else
@@ -360,9 +410,12 @@ void CNXDNNetwork::clock(unsigned int ms)
 			CUtils::dump(1U, "NXDN Net Data Received", buffer, length);
 	}
 
+	uint64_t arrival = LatencyTime();
+
 	uint8_t c = length;
 	m_buffer.add(&c, 1U);
 
+	m_buffer.add((uint8_t*)&arrival, sizeof(uint64_t));
 	m_buffer.add(buffer, length);
 }
 
@@ -393,9 +446,13 @@ bool CNXDNNetwork::read(CMetaData& data)
 	uint8_t length = 0U;
 	m_buffer.get(&length, 1U);
 
+	uint64_t arrival = 0U;
+	m_buffer.get((uint8_t*)&arrival, sizeof(uint64_t));
+
 	uint8_t buffer[BUFFER_LENGTH];
 	m_buffer.get(buffer, length);
 
+	data.setReceiveTime(arrival);
 	data.setRaw(buffer, length);
 
 	// An NXDN repeater connect request
@@ -416,10 +473,14 @@ bool CNXDNNetwork::read(CMetaData& data)
 		return false;
 
 	if (usc == NXDN_LICH_USC_SACCH_NS) {
+		unsigned int errors;
 		CNXDNFACCH1 facch;
-		bool valid = facch.decode(buffer + 42U, NXDN_FSW_LENGTH_BITS + NXDN_LICH_LENGTH_BITS + NXDN_SACCH_LENGTH_BITS);
+		bool valid = facch.decode(buffer + 42U, NXDN_FSW_LENGTH_BITS + NXDN_LICH_LENGTH_BITS + NXDN_SACCH_LENGTH_BITS, errors);
 		if (!valid)
-			valid = facch.decode(buffer + 42U, NXDN_FSW_LENGTH_BITS + NXDN_LICH_LENGTH_BITS + NXDN_SACCH_LENGTH_BITS + NXDN_FACCH1_LENGTH_BITS);
+			valid = facch.decode(buffer + 42U, NXDN_FSW_LENGTH_BITS + NXDN_LICH_LENGTH_BITS + NXDN_SACCH_LENGTH_BITS + NXDN_FACCH1_LENGTH_BITS, errors);
+
+		data.addFECErrors(errors, NXDN_FACCH1_LENGTH_BITS);
+
 		if (!valid)
 			return false;
 
@@ -427,7 +488,7 @@ bool CNXDNNetwork::read(CMetaData& data)
 		facch.getData(buffer);
 
 		CNXDNLayer3 layer3;
-		layer3.decode(buffer, NXDN_FACCH1_LENGTH_BITS);
+		layer3.decode(buffer, 80U);		// The message, without the CRC
 
 		uint8_t type = layer3.getMessageType();
 		switch (type) {
@@ -489,6 +550,9 @@ bool CNXDNNetwork::read()
 	uint8_t length = 0U;
 	m_buffer.get(&length, 1U);
 
+	uint64_t arrival = 0U;
+	m_buffer.get((uint8_t*)&arrival, sizeof(uint64_t));
+
 	uint8_t buffer[BUFFER_LENGTH];
 	m_buffer.get(buffer, length);
 
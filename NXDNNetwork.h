@@ -23,6 +23,7 @@
 
 #include "RingBuffer.h"
 #include "UDPSocket.h"
+#include "Pacer.h"
 
 #include <cstdint>
 #include <string>
@@ -32,6 +33,8 @@ public:
 	CNXDNNetwork(NETWORK network, const std::string& localAddress, uint16_t localPort, const std::string& remoteAddress, uint16_t remotePort, bool debug);
 	virtual ~CNXDNNetwork();
 
+	void setPacing(unsigned int lead);
+
 	virtual bool open();
 
 	virtual bool writeRaw(CMetaData& data);
@@ -50,9 +53,11 @@ public:
 
 private:
 	NETWORK          m_network;
+	CNetworkMetrics* m_metrics;
 	CUDPSocket       m_socket;
 	sockaddr_storage m_addr;
 	size_t           m_addrLen;
+	CPacer*          m_pacer;
 	bool             m_debug;
 	CRingBuffer<uint8_t> m_buffer;
 	uint16_t         m_seqNo;
@@ -63,6 +68,8 @@ private:
 	bool writeHeader(CMetaData& data);
 	bool writeBody(CMetaData& data);
 	bool writeTrailer(CMetaData& data);
+	bool writePacket(const uint8_t* data, uint16_t length, uint64_t start = 0U);
+	void writePaced();
 };
 
 #endif
@@ -20,6 +20,8 @@
 
 #include "TranscoderDefines.h"
 #include "P25Defines.h"
+#include "Capture.h"
+#include "Latency.h"
 #include "Utils.h"
 #include "Log.h"
 
@@ -29,16 +31,23 @@
 
 const unsigned int BUFFER_LENGTH = 1500U;
 
+// The longest of the voice records
+const uint16_t VOICE_RECORD_LENGTH = 22U;
+
 CP25Network::CP25Network(NETWORK network, const std::string& localAddress, uint16_t localPort, const std::string& remoteAddress, uint16_t remotePort, bool debug) :
 m_network(network),
+m_metrics(nullptr),
 m_socket(localAddress, localPort),
 m_addr(),
 m_addrLen(0U),
 m_debug(debug),
 m_buffer(1000U, "P25 Network"),
+m_jitterBuffer(nullptr),
+m_pacer(nullptr),
 m_srcId(0U),
 m_dstId(0U),
-m_n(0x62U)
+m_n(0x62U),
+m_inRecord(0U)
 {
 	assert(localPort > 0U);
 	assert(!remoteAddress.empty());
@@ -46,10 +55,34 @@ m_n(0x62U)
 
 	if (CUDPSocket::lookup(remoteAddress, remotePort, m_addr, m_addrLen) != 0)
 		m_addrLen = 0U;
+
+	m_metrics = MetricsNetwork(network, DATA_MODE::P25);
+
+	m_socket.setMetrics(m_metrics);
+	m_socket.setCapture(CaptureInterface(network, DATA_MODE::P25), m_addr, m_addrLen);
+	m_buffer.setCounters(&m_metrics->m_overflows, &m_metrics->m_underflows);
 }
 
 CP25Network::~CP25Network()
 {
+	delete m_jitterBuffer;
+	delete m_pacer;
+}
+
+void CP25Network::setJitterBuffer(unsigned int maxDelay)
+{
+	if (maxDelay == 0U)
+		return;
+
+	// Each voice record carries a 20ms frame, the record ids 0x62 to 0x73 give the sequence
+	delete m_jitterBuffer;
+	m_jitterBuffer = new CJitterBuffer(m_network == NETWORK::RF ? "P25 RF Network" : "P25 Net Network", VOICE_RECORD_LENGTH, 18U, 20U, maxDelay);
+}
+
+void CP25Network::setPacing(unsigned int lead)
+{
+	delete m_pacer;
+	m_pacer = new CPacer(m_network == NETWORK::RF ? "P25 RF Network" : "P25 Net Network", VOICE_RECORD_LENGTH, 20U, lead);
 }
 
 bool CP25Network::open()
@@ -88,7 +121,11 @@ bool CP25Network::writeRaw(CMetaData& data)
 			CUtils::dump(1U, "P25 Net Network Raw Sent", buffer, length);
 	}
 	
-	return m_socket.write(buffer, length, m_addr, m_addrLen);
+	bool ret = m_socket.write(buffer, length, m_addr, m_addrLen);
+
+	LatencyAdd(STAGE::SEND, data.getSendTime());
+
+	return ret;
 }
 
 bool CP25Network::writeData(CMetaData& data)
@@ -99,25 +136,26 @@ bool CP25Network::writeData(CMetaData& data)
 	uint8_t buffer[50U];
 	uint16_t len = 0U;
 
-	if (data.hasData()) {
+	// Send a record for every frame the transcoder has ready
+	while (data.hasData()) {
 		switch (m_n) {
 		case 0x62U:
 			::memcpy(buffer, REC62, 22U);
-			data.getData(buffer + 10U);
+			data.getData(buffer + 10U, IMBE_DATA_LENGTH);
 			len = 22U;
 			m_n = 0x63U;
 			break;
 
 		case 0x63U:
 			::memcpy(buffer, REC63, 14U);
-			data.getData(buffer + 1U);
+			data.getData(buffer + 1U, IMBE_DATA_LENGTH);
 			len = 14U;
 			m_n = 0x64U;
 			break;
 
 		case 0x64U:
 			::memcpy(buffer, REC64, 17U);
-			data.getData(buffer + 5U);
+			data.getData(buffer + 5U, IMBE_DATA_LENGTH);
 			len = 17U;
 			m_n = 0x65U;
 			break;
@@ -134,7 +172,7 @@ bool CP25Network::writeData(CMetaData& data)
 				buffer[2U] = (dstId >> 8)  & 0xFFU;
 				buffer[3U] = (dstId >> 0)  & 0xFFU;
 
-				data.getData(buffer + 5U);
+				data.getData(buffer + 5U, IMBE_DATA_LENGTH);
 
 				len = 17U;
 				m_n = 0x66U;
@@ -153,7 +191,7 @@ bool CP25Network::writeData(CMetaData& data)
 				buffer[2U] = (srcId >> 8)  & 0xFFU;
 				buffer[3U] = (srcId >> 0)  & 0xFFU;
 
-				data.getData(buffer + 5U);
+				data.getData(buffer + 5U, IMBE_DATA_LENGTH);
 
 				len = 17U;
 				m_n = 0x67U;
@@ -162,91 +200,91 @@ bool CP25Network::writeData(CMetaData& data)
 
 		case 0x67U:
 			::memcpy(buffer, REC67, 17U);
-			data.getData(buffer + 5U);
+			data.getData(buffer + 5U, IMBE_DATA_LENGTH);
 			len = 17U;
 			m_n = 0x68U;
 			break;
 
 		case 0x68U:
 			::memcpy(buffer, REC68, 17U);
-			data.getData(buffer + 5U);
+			data.getData(buffer + 5U, IMBE_DATA_LENGTH);
 			len = 17U;
 			m_n = 0x69U;
 			break;
 
 		case 0x69U:
 			::memcpy(buffer, REC69, 17U);
-			data.getData(buffer + 5U);
+			data.getData(buffer + 5U, IMBE_DATA_LENGTH);
 			len = 17U;
 			m_n = 0x6AU;
 			break;
 
 		case 0x6AU:
 			::memcpy(buffer, REC6A, 16U);
-			data.getData(buffer + 4U);
+			data.getData(buffer + 4U, IMBE_DATA_LENGTH);
 			len = 16U;
 			m_n = 0x6BU;
 			break;
 
 		case 0x6BU:
 			::memcpy(buffer, REC6B, 22U);
-			data.getData(buffer + 10U);
+			data.getData(buffer + 10U, IMBE_DATA_LENGTH);
 			len = 22U;
 			m_n = 0x6CU;
 			break;
 
 		case 0x6CU:
 			::memcpy(buffer, REC6C, 14U);
-			data.getData(buffer + 1U);
+			data.getData(buffer + 1U, IMBE_DATA_LENGTH);
 			len = 14U;
 			m_n = 0x6DU;
 			break;
 
 		case 0x6DU:
 			::memcpy(buffer, REC6D, 17U);
-			data.getData(buffer + 5U);
+			data.getData(buffer + 5U, IMBE_DATA_LENGTH);
 			len = 17U;
 			m_n = 0x6EU;
 			break;
 
 		case 0x6EU:
 			::memcpy(buffer, REC6E, 17U);
-			data.getData(buffer + 5U);
+			data.getData(buffer + 5U, IMBE_DATA_LENGTH);
 			len = 17U;
 			m_n = 0x6FU;
 			break;
 
 		case 0x6FU:
 			::memcpy(buffer, REC6F, 17U);
-			data.getData(buffer + 5U);
+			data.getData(buffer + 5U, IMBE_DATA_LENGTH);
 			len = 17U;
 			m_n = 0x70U;
 			break;
 
 		case 0x70U:
 			::memcpy(buffer, REC70, 17U);
-			data.getData(buffer + 5U);
+			data.getData(buffer + 5U, IMBE_DATA_LENGTH);
 			len = 17U;
 			m_n = 0x71U;
 			break;
 
 		case 0x71U:
 			::memcpy(buffer, REC71, 17U);
-			data.getData(buffer + 5U);
+			data.getData(buffer + 5U, IMBE_DATA_LENGTH);
 			len = 17U;
 			m_n = 0x72U;
 			break;
 
 		case 0x72U:
 			::memcpy(buffer, REC72, 17U);
-			data.getData(buffer + 5U);
+			data.getData(buffer + 5U, IMBE_DATA_LENGTH);
 			len = 17U;
 			m_n = 0x73U;
 			break;
 
 		case 0x73U:
 			::memcpy(buffer, REC73, 16U);
-			data.getData(buffer + 4U);
+			data.getData(buffer + 4U, IMBE_DATA_LENGTH);
 			len = 16U;
 			m_n = 0x62U;
 			break;
@@ -262,7 +300,7 @@ bool CP25Network::writeData(CMetaData& data)
 				CUtils::dump(1U, "P25 Net Network Data Sent", buffer, len);
 		}
 
-		bool ret = m_socket.write(buffer, len, m_addr, m_addrLen);
+		bool ret = writePacket(buffer, len, data.getSendTime());
 		if (!ret)
 			return false;
 	}
@@ -277,7 +315,7 @@ bool CP25Network::writeData(CMetaData& data)
 				CUtils::dump(1U, "P25 Net Network Data Sent", buffer, 17U);
 		}
 
-		bool ret = m_socket.write(buffer, 17U, m_addr, m_addrLen);
+		bool ret = writePacket(buffer, 17U, 0U, false);
 		if (!ret)
 			return false;
 	}
@@ -285,10 +323,58 @@ bool CP25Network::writeData(CMetaData& data)
 	return true;
 }
 
+bool CP25Network::writePacket(const uint8_t* data, uint16_t length, uint64_t start, bool timed)
+{
+	assert(data != nullptr);
+
+	if (m_pacer == nullptr) {
+		bool ret = m_socket.write(data, length, m_addr, m_addrLen);
+		LatencyAdd(STAGE::SEND, start);
+		return ret;
+	}
+
+	if (!m_pacer->add(data, length, start, timed))
+		return false;
+
+	writePaced();
+
+	return true;
+}
+
+void CP25Network::writePaced()
+{
+	uint8_t buffer[VOICE_RECORD_LENGTH];
+	uint16_t length = 0U;
+	uint64_t start  = 0U;
+
+	while (m_pacer->get(buffer, length, start)) {
+		m_socket.write(buffer, length, m_addr, m_addrLen);
+		LatencyAdd(STAGE::SEND, start);
+	}
+}
+
 void CP25Network::clock(unsigned int ms)
 {
+	if (m_pacer != nullptr) {
+		m_pacer->clock(ms);
+		writePaced();
+	}
+
 	uint8_t buffer[BUFFER_LENGTH];
 
+	if (m_jitterBuffer != nullptr) {
+		m_jitterBuffer->clock(ms);
+
+		uint16_t len     = 0U;
+		uint64_t arrival = 0U;
+		while (m_jitterBuffer->get(buffer, len, arrival)) {
+			uint8_t c = len;
+			m_buffer.add(&c, 1U);
+			m_buffer.add((uint8_t*)&arrival, sizeof(uint64_t));
+			m_buffer.add(buffer, len);
+		}
+	}
+
 	sockaddr_storage address;
 	size_t addrLen;
 	int length = m_socket.read(buffer, BUFFER_LENGTH, address, addrLen);
@@ -296,6 +382,8 @@ void CP25Network::clock(unsigned int ms)
 		return;
 
 	if (!CUDPSocket::match(m_addr, address, IPMATCHTYPE::ADDRESS_AND_PORT)) {
+		m_metrics->m_invalidSource.add();
+
 		if (m_network == NETWORK::RF)
 			LogMessage("P25 RF packet received from an invalid source");
 		else
@@ -303,6 +391,8 @@ void CP25Network::clock(unsigned int ms)
 		return;
 	}
 
+	uint64_t arrival = LatencyTime();
+
 	if (m_debug) {
 		if (m_network == NETWORK::RF)
 			CUtils::dump(1U, "P25 RF Network Data Received", buffer, length);
@@ -310,9 +400,28 @@ void CP25Network::clock(unsigned int ms)
 			CUtils::dump(1U, "P25 Net Network Data Received", buffer, length);
 	}
 
+	if (m_jitterBuffer != nullptr) {
+		if ((buffer[0U] >= 0x62U) && (buffer[0U] <= 0x73U)) {
+			m_jitterBuffer->add(buffer, length, buffer[0U] - 0x62U, arrival);
+			return;
+		}
+
+		// Anything else, such as the end record, follows all of the queued voice
+		uint8_t data[VOICE_RECORD_LENGTH];
+		uint16_t len  = 0U;
+		uint64_t time = 0U;
+		while (m_jitterBuffer->flush(data, len, time)) {
+			uint8_t c = len;
+			m_buffer.add(&c, 1U);
+			m_buffer.add((uint8_t*)&time, sizeof(uint64_t));
+			m_buffer.add(data, len);
+		}
+	}
+
 	uint8_t c = length;
 	m_buffer.add(&c, 1U);
 
+	m_buffer.add((uint8_t*)&arrival, sizeof(uint64_t));
 	m_buffer.add(buffer, length);
 }
 
@@ -324,11 +433,26 @@ bool CP25Network::read(CMetaData& data)
 	uint8_t length = 0U;
 	m_buffer.get(&length, 1U);
 
+	uint64_t arrival = 0U;
+	m_buffer.get((uint8_t*)&arrival, sizeof(uint64_t));
+
 	uint8_t buffer[BUFFER_LENGTH];
 	m_buffer.get(buffer, length);
 
+	data.setReceiveTime(arrival);
 	data.setRaw(buffer, length);
 
+	// Replace any lost voice records before this one
+	if ((buffer[0U] >= 0x62U) && (buffer[0U] <= 0x73U)) {
+		if (m_inRecord != 0U) {
+			uint8_t missing = (buffer[0U] + 18U - m_inRecord - 1U) % 18U;
+			if (missing < 9U)
+				data.setMissingData(missing);
+		}
+
+		m_inRecord = buffer[0U];
+	}
+
 	switch (buffer[0U]) {
 	case 0x62U:
 		data.setData(buffer + 10U);
@@ -400,6 +524,7 @@ bool CP25Network::read(CMetaData& data)
 		break;
 	case 0x80U:
 		data.setEnd();
+		m_inRecord = 0U;
 		break;
 	default:
 		break;
@@ -416,6 +541,9 @@ bool CP25Network::read()
 	uint8_t length = 0U;
 	m_buffer.get(&length, 1U);
 
+	uint64_t arrival = 0U;
+	m_buffer.get((uint8_t*)&arrival, sizeof(uint64_t));
+
 	uint8_t buffer[BUFFER_LENGTH];
 	m_buffer.get(buffer, length);
 
@@ -427,7 +555,10 @@ void CP25Network::reset()
 	m_srcId = 0U;
 	m_dstId = 0U;
 	m_buffer.clear();
-	m_n = 0x62U;
+	if (m_jitterBuffer != nullptr)
+		m_jitterBuffer->reset();
+	m_n        = 0x62U;
+	m_inRecord = 0U;
 }
 
 bool CP25Network::hasData()
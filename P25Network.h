@@ -19,6 +19,8 @@
 #ifndef	P25Network_H
 #define	P25Network_H
 
+#include "JitterBuffer.h"
+#include "Pacer.h"
 #include "Network.h"
 #include "RingBuffer.h"
 #include "UDPSocket.h"
@@ -31,6 +33,9 @@ public:
 	CP25Network(NETWORK network, const std::string& localAddress, uint16_t localPort, const std::string& remoteAddress, uint16_t remotePort, bool debug);
 	virtual ~CP25Network();
 
+	void setJitterBuffer(unsigned int maxDelay);
+	void setPacing(unsigned int lead);
+
 	virtual bool open();
 
 	virtual bool writeRaw(CMetaData& data);
@@ -49,14 +54,21 @@ public:
 
 private:
 	NETWORK          m_network;
+	CNetworkMetrics* m_metrics;
 	CUDPSocket       m_socket;
 	sockaddr_storage m_addr;
 	size_t           m_addrLen;
 	bool             m_debug;
 	CRingBuffer<uint8_t> m_buffer;
+	CJitterBuffer*   m_jitterBuffer;
+	CPacer*          m_pacer;
 	uint32_t         m_srcId;
 	uint32_t         m_dstId;
 	uint8_t          m_n;
+	uint8_t          m_inRecord;
+
+	bool writePacket(const uint8_t* data, uint16_t length, uint64_t start = 0U, bool timed = true);
+	void writePaced();
 };
 
 #endif
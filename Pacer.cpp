@@ -0,0 +1,120 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Pacer.h"
+#include "Log.h"
+
+#include <cassert>
+#include <cstring>
+
+// Enough queued packets to ride out a stall of this many ms
+const unsigned int QUEUE_TIME = 3000U;
+
+// The per packet header is the length, the timed flag and the start time
+const uint16_t HEADER_LENGTH = sizeof(uint16_t) + 1U + sizeof(uint64_t);
+
+CPacer::CPacer(const std::string& name, uint16_t packetLength, unsigned int interval, unsigned int lead) :
+m_name(name),
+m_buffer(uint16_t((packetLength + HEADER_LENGTH) * (QUEUE_TIME / interval + 1U)), m_name.c_str()),
+m_interval(interval),
+m_lead(lead),
+m_time(0U),
+m_next(0U)
+{
+	assert(packetLength > 0U);
+	assert(interval > 0U);
+
+	if (m_lead > m_interval)
+		m_lead = m_interval;
+}
+
+CPacer::~CPacer()
+{
+}
+
+bool CPacer::add(const uint8_t* data, uint16_t length, uint64_t start, bool timed)
+{
+	assert(data != nullptr);
+	assert(length > 0U);
+
+	if (!m_buffer.hasSpace(length + HEADER_LENGTH)) {
+		LogWarning("%s, the pacing queue is full, dropping a packet", m_name.c_str());
+		return false;
+	}
+
+	uint8_t header[HEADER_LENGTH];
+	header[0U] = (length >> 8) & 0xFFU;
+	header[1U] = (length >> 0) & 0xFFU;
+	header[2U] = timed ? 0x01U : 0x00U;
+	::memcpy(header + 3U, &start, sizeof(uint64_t));
+
+	m_buffer.add(header, HEADER_LENGTH);
+	m_buffer.add(data, length);
+
+	return true;
+}
+
+bool CPacer::get(uint8_t* data, uint16_t& length, uint64_t& start)
+{
+	assert(data != nullptr);
+
+	if (m_buffer.empty())
+		return false;
+
+	uint8_t header[HEADER_LENGTH];
+	m_buffer.peek(header, HEADER_LENGTH);
+
+	bool timed = header[2U] == 0x01U;
+
+	if (timed) {
+		if (int(m_time + m_lead - m_next) < 0)
+			return false;
+
+		// Being a little late is made up over the following packets, after
+		// an idle period or a long stall the schedule starts again from now
+		if (int(m_time - m_next) >= int(m_interval))
+			m_next = m_time;
+
+		m_next += m_interval;
+	}
+
+	length = (header[0U] << 8) | (header[1U] << 0);
+	::memcpy(&start, header + 3U, sizeof(uint64_t));
+
+	m_buffer.remove(HEADER_LENGTH);
+	m_buffer.get(data, length);
+
+	return true;
+}
+
+bool CPacer::hasData() const
+{
+	return m_buffer.hasData();
+}
+
+void CPacer::reset()
+{
+	m_buffer.clear();
+
+	m_next = m_time;
+}
+
+void CPacer::clock(unsigned int ms)
+{
+	m_time += ms;
+}
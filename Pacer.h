@@ -0,0 +1,56 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(Pacer_H)
+#define	Pacer_H
+
+#include "RingBuffer.h"
+
+#include <string>
+#include <cstdint>
+
+// Holds outgoing packets and releases them no faster than the frame rate of
+// the mode. Timed packets are sent up to lead ms before their nominal time,
+// untimed packets go out as soon as everything in front of them has gone.
+class CPacer {
+public:
+	CPacer(const std::string& name, uint16_t packetLength, unsigned int interval, unsigned int lead);
+	~CPacer();
+
+	// The start time goes back out with the packet, for the latency figures
+	bool add(const uint8_t* data, uint16_t length, uint64_t start, bool timed = true);
+
+	// Returns the next packet once it is due
+	bool get(uint8_t* data, uint16_t& length, uint64_t& start);
+
+	bool hasData() const;
+
+	void reset();
+
+	void clock(unsigned int ms);
+
+private:
+	std::string          m_name;
+	CRingBuffer<uint8_t> m_buffer;
+	unsigned int         m_interval;
+	unsigned int         m_lead;
+	unsigned int         m_time;
+	unsigned int         m_next;
+};
+
+#endif
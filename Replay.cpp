@@ -0,0 +1,479 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Replay.h"
+#include "Capture.h"
+#include "Clock.h"
+#include "Utils.h"
+#include "Log.h"
+
+#include <vector>
+
+#include <cstdio>
+#include <cassert>
+#include <cstring>
+
+// The pcapng blocks and options understood
+const uint32_t SECTION_HEADER_BLOCK  = 0x0A0D0D0AU;
+const uint32_t INTERFACE_DESC_BLOCK  = 0x00000001U;
+const uint32_t ENHANCED_PACKET_BLOCK = 0x00000006U;
+
+const uint32_t BYTE_ORDER_MAGIC      = 0x1A2B3C4DU;
+
+const uint16_t OPT_ENDOFOPT          = 0U;
+const uint16_t OPT_IF_NAME           = 2U;
+const uint16_t OPT_IF_TSRESOL        = 9U;
+const uint16_t OPT_EPB_FLAGS         = 2U;
+
+const uint32_t EPB_FLAGS_DIRECTION   = 0x00000003U;
+const uint32_t EPB_FLAGS_OUTBOUND    = 0x00000002U;
+
+// Allow for the last packets to make their way through the jitter buffers and pacers
+const uint64_t FINISH_TIME           = 2000000000ULL;
+
+const uint64_t FNV_OFFSET_BASIS      = 0xCBF29CE484222325ULL;
+const uint64_t FNV_PRIME             = 0x00000100000001B3ULL;
+
+struct CReplayPacket {
+	uint64_t             m_time;
+	unsigned int         m_writes;	// The writes to the interface before it in the capture
+	std::vector<uint8_t> m_data;
+};
+
+struct CReplayInterface {
+	std::string                       m_name;
+	std::vector<CReplayPacket>        m_inbound;
+	std::vector<std::vector<uint8_t>> m_outbound;
+	size_t                            m_received;
+	size_t                            m_offset;
+	size_t                            m_written;
+	unsigned int                      m_matched;
+	unsigned int                      m_mismatched;
+};
+
+static bool                          m_active   = false;
+static CVirtualClock                 m_clock;
+static std::string                   m_fileName;
+static std::vector<CReplayInterface> m_interfaces;
+static std::vector<int>              m_lookup;		// Capture interface to replay interface
+static uint64_t                      m_start    = 0U;
+static uint64_t                      m_end      = 0U;
+static uint64_t                      m_digest   = FNV_OFFSET_BASIS;
+
+static uint16_t getUInt16(const uint8_t* data)
+{
+	uint16_t value;
+	::memcpy(&value, data, sizeof(uint16_t));
+	return value;
+}
+
+static uint32_t getUInt32(const uint8_t* data)
+{
+	uint32_t value;
+	::memcpy(&value, data, sizeof(uint32_t));
+	return value;
+}
+
+static void addDigest(const uint8_t* data, size_t length)
+{
+	for (size_t i = 0U; i < length; i++) {
+		m_digest ^= data[i];
+		m_digest *= FNV_PRIME;
+	}
+}
+
+static int findInterface(const std::string& name)
+{
+	for (unsigned int i = 0U; i < m_interfaces.size(); i++) {
+		if (m_interfaces[i].m_name == name)
+			return int(i);
+	}
+
+	CReplayInterface iface;
+	iface.m_name       = name;
+	iface.m_received   = 0U;
+	iface.m_offset     = 0U;
+	iface.m_written    = 0U;
+	iface.m_matched    = 0U;
+	iface.m_mismatched = 0U;
+
+	m_interfaces.push_back(iface);
+
+	return int(m_interfaces.size() - 1U);
+}
+
+// The replay interface for a capture interface, or nullptr when there is none
+static CReplayInterface* getInterface(int id)
+{
+	if (!m_active || (id < 0))
+		return nullptr;
+
+	while (m_lookup.size() <= (unsigned int)id)
+		m_lookup.push_back(-1);
+
+	if (m_lookup[id] == -1)
+		m_lookup[id] = findInterface(CaptureName(id));
+
+	return &m_interfaces[m_lookup[id]];
+}
+
+// Scales a timestamp to nanoseconds from the if_tsresol of its interface
+static uint64_t getNanoseconds(uint64_t time, uint8_t resolution)
+{
+	if (resolution <= 9U) {
+		for (uint8_t i = resolution; i < 9U; i++)
+			time *= 10ULL;
+	} else {
+		for (uint8_t i = 9U; i < resolution; i++)
+			time /= 10ULL;
+	}
+
+	return time;
+}
+
+static bool parse(const std::vector<uint8_t>& file)
+{
+	// The interfaces of the current section, and their timestamp resolutions
+	std::vector<std::pair<int, uint8_t>> section;
+
+	bool first = true;
+	size_t pos = 0U;
+
+	while ((pos + 12U) <= file.size()) {
+		const uint8_t* block = file.data() + pos;
+
+		uint32_t type   = getUInt32(block + 0U);
+		uint32_t length = getUInt32(block + 4U);
+
+		if ((length < 12U) || ((length % 4U) != 0U) || ((pos + length) > file.size())) {
+			LogError("Replay file %s has a corrupt block at offset %u", m_fileName.c_str(), (unsigned int)pos);
+			return false;
+		}
+
+		switch (type) {
+		case SECTION_HEADER_BLOCK:
+			if (getUInt32(block + 8U) != BYTE_ORDER_MAGIC) {
+				LogError("Replay file %s is not a little endian pcapng file", m_fileName.c_str());
+				return false;
+			}
+
+			section.clear();
+			first = false;
+			break;
+
+		case INTERFACE_DESC_BLOCK: {
+				std::string name = "Interface " + std::to_string(section.size());
+				uint8_t resolution = 6U;
+
+				size_t opt = 16U;
+				while ((opt + 4U) <= (length - 4U)) {
+					uint16_t code = getUInt16(block + opt + 0U);
+					uint16_t len  = getUInt16(block + opt + 2U);
+					if ((code == OPT_ENDOFOPT) || ((opt + 4U + len) > (length - 4U)))
+						break;
+
+					if (code == OPT_IF_NAME)
+						name = std::string((const char*)(block + opt + 4U), len);
+					else if ((code == OPT_IF_TSRESOL) && (len == 1U))
+						resolution = block[opt + 4U];
+
+					opt += 4U + ((len + 3U) & ~3U);
+				}
+
+				// Only the powers of ten are written by anything likely to be used
+				if ((resolution & 0x80U) != 0U) {
+					LogError("Replay file %s uses an unsupported timestamp resolution", m_fileName.c_str());
+					return false;
+				}
+
+				section.push_back(std::make_pair(findInterface(name), resolution));
+			}
+			break;
+
+		case ENHANCED_PACKET_BLOCK: {
+				if (length < 32U)
+					break;
+
+				uint32_t id      = getUInt32(block + 8U);
+				uint64_t time    = (uint64_t(getUInt32(block + 12U)) << 32) | uint64_t(getUInt32(block + 16U));
+				uint32_t dataLen = getUInt32(block + 20U);
+
+				if ((id >= section.size()) || ((28U + dataLen + 4U) > length)) {
+					LogError("Replay file %s has a corrupt packet at offset %u", m_fileName.c_str(), (unsigned int)pos);
+					return false;
+				}
+
+				uint32_t flags = 0U;
+
+				size_t opt = 28U + ((dataLen + 3U) & ~3U);
+				while ((opt + 4U) <= (length - 4U)) {
+					uint16_t code = getUInt16(block + opt + 0U);
+					uint16_t len  = getUInt16(block + opt + 2U);
+					if ((code == OPT_ENDOFOPT) || ((opt + 4U + len) > (length - 4U)))
+						break;
+
+					if ((code == OPT_EPB_FLAGS) && (len == 4U))
+						flags = getUInt32(block + opt + 4U);
+
+					opt += 4U + ((len + 3U) & ~3U);
+				}
+
+				time = getNanoseconds(time, section[id].second);
+
+				CReplayInterface& iface = m_interfaces[section[id].first];
+
+				const uint8_t* data = block + 28U;
+
+				if ((flags & EPB_FLAGS_DIRECTION) == EPB_FLAGS_OUTBOUND) {
+					iface.m_outbound.push_back(std::vector<uint8_t>(data, data + dataLen));
+				} else {
+					CReplayPacket packet;
+					packet.m_time   = time;
+					packet.m_writes = (unsigned int)iface.m_outbound.size();
+					packet.m_data.assign(data, data + dataLen);
+					iface.m_inbound.push_back(packet);
+				}
+
+				if ((m_start == 0U) || (time < m_start))
+					m_start = time;
+				if (time > m_end)
+					m_end = time;
+			}
+			break;
+
+		default:
+			break;
+		}
+
+		if (first) {
+			LogError("Replay file %s is not a pcapng file", m_fileName.c_str());
+			return false;
+		}
+
+		pos += length;
+	}
+
+	return true;
+}
+
+bool ReplayOpen(const std::string& fileName, bool paced)
+{
+	assert(!fileName.empty());
+
+	m_active   = false;
+	m_fileName = fileName;
+	m_interfaces.clear();
+	m_lookup.clear();
+	m_start    = 0U;
+	m_end      = 0U;
+	m_digest   = FNV_OFFSET_BASIS;
+
+	FILE* fp = ::fopen(fileName.c_str(), "rb");
+	if (fp == nullptr) {
+		LogError("Unable to open the replay file %s", fileName.c_str());
+		return false;
+	}
+
+	std::vector<uint8_t> file;
+
+	uint8_t buffer[4096U];
+	size_t n;
+	while ((n = ::fread(buffer, 1U, sizeof(buffer), fp)) > 0U)
+		file.insert(file.end(), buffer, buffer + n);
+
+	::fclose(fp);
+
+	if (!parse(file)) {
+		m_interfaces.clear();
+		return false;
+	}
+
+	// Time starts with the first packet
+	m_clock = CVirtualClock(m_start, paced);
+	ClockSet(&m_clock);
+
+	m_active = true;
+
+	size_t inbound = 0U, outbound = 0U;
+	for (const auto& iface : m_interfaces) {
+		inbound  += iface.m_inbound.size();
+		outbound += iface.m_outbound.size();
+	}
+
+	LogMessage("Replaying %s %s, %u packets in and %u out over %.1f seconds", fileName.c_str(), paced ? "at the original pace" : "as fast as possible",
+		(unsigned int)inbound, (unsigned int)outbound, double(m_end - m_start) / 1000000000.0);
+
+	return true;
+}
+
+bool ReplayActive()
+{
+	return m_active;
+}
+
+bool ReplayFinished()
+{
+	return m_active && (ClockNow() > (m_end + FINISH_TIME));
+}
+
+int ReplayReceive(int id, uint8_t* buffer, size_t length)
+{
+	assert(buffer != nullptr);
+	assert(length > 0U);
+
+	CReplayInterface* iface = getInterface(id);
+	if ((iface == nullptr) || (iface->m_received >= iface->m_inbound.size()))
+		return 0;
+
+	const CReplayPacket& packet = iface->m_inbound[iface->m_received];
+	if (packet.m_time > ClockNow())
+		return 0;
+
+	iface->m_received++;
+
+	size_t len = packet.m_data.size();
+	if (len > length)
+		len = length;
+
+	::memcpy(buffer, packet.m_data.data(), len);
+
+	return int(len);
+}
+
+uint16_t ReplayRead(int id, uint8_t* buffer, uint16_t length)
+{
+	assert(buffer != nullptr);
+	assert(length > 0U);
+
+	CReplayInterface* iface = getInterface(id);
+	if ((iface == nullptr) || (iface->m_received >= iface->m_inbound.size()))
+		return 0U;
+
+	// A reply is available once everything that went before it has been written,
+	// so the transcoder appears to answer at once
+	const CReplayPacket& packet = iface->m_inbound[iface->m_received];
+	if (packet.m_writes > iface->m_written)
+		return 0U;
+
+	size_t len = packet.m_data.size() - iface->m_offset;
+	if (len > length)
+		len = length;
+
+	::memcpy(buffer, packet.m_data.data() + iface->m_offset, len);
+
+	iface->m_offset += len;
+	if (iface->m_offset >= packet.m_data.size()) {
+		iface->m_offset = 0U;
+		iface->m_received++;
+	}
+
+	return uint16_t(len);
+}
+
+void ReplayWrite(int id, const uint8_t* buffer, size_t length)
+{
+	assert(buffer != nullptr);
+
+	CReplayInterface* iface = getInterface(id);
+	if (iface == nullptr)
+		return;
+
+	addDigest((const uint8_t*)iface->m_name.c_str(), iface->m_name.size());
+	addDigest(buffer, length);
+
+	size_t n = iface->m_written++;
+
+	if ((n < iface->m_outbound.size()) && (iface->m_outbound[n].size() == length) && (::memcmp(iface->m_outbound[n].data(), buffer, length) == 0)) {
+		iface->m_matched++;
+		return;
+	}
+
+	if (iface->m_mismatched++ == 0U) {
+		LogWarning("Replay %s packet %u differs from the capture", iface->m_name.c_str(), (unsigned int)n);
+
+		if (n < iface->m_outbound.size())
+			CUtils::dump(2U, "Replay captured", iface->m_outbound[n].data(), (unsigned int)iface->m_outbound[n].size());
+		CUtils::dump(2U, "Replay sent", buffer, (unsigned int)length);
+	}
+}
+
+bool ReplayClose()
+{
+	if (!m_active)
+		return true;
+
+	m_active = false;
+
+	ClockSet(nullptr);
+
+	bool ok = true;
+
+	nlohmann::json interfaces = nlohmann::json::array();
+
+	for (const auto& iface : m_interfaces) {
+		// Anything not sent that should have been is also a difference
+		unsigned int missing = 0U;
+		if (iface.m_written < iface.m_outbound.size())
+			missing = (unsigned int)(iface.m_outbound.size() - iface.m_written);
+
+		if ((iface.m_mismatched > 0U) || (missing > 0U))
+			ok = false;
+
+		LogMessage("Replay %s: %u/%u received, %u/%u sent matched, %u differed, %u missing", iface.m_name.c_str(),
+			(unsigned int)iface.m_received, (unsigned int)iface.m_inbound.size(), iface.m_matched, (unsigned int)iface.m_outbound.size(),
+			iface.m_mismatched, missing);
+
+		nlohmann::json json;
+
+		json["name"]       = iface.m_name;
+		json["received"]   = iface.m_received;
+		json["inbound"]    = iface.m_inbound.size();
+		json["sent"]       = iface.m_written;
+		json["outbound"]   = iface.m_outbound.size();
+		json["matched"]    = iface.m_matched;
+		json["mismatched"] = iface.m_mismatched;
+		json["missing"]    = missing;
+
+		interfaces.push_back(json);
+	}
+
+	char digest[20U];
+	::snprintf(digest, sizeof(digest), "%016llX", (unsigned long long)m_digest);
+
+	LogMessage("Replay of %s %s, digest %s", m_fileName.c_str(), ok ? "matched the capture" : "differed from the capture", digest);
+
+	try {
+		nlohmann::json json;
+
+		json["timestamp"]  = CUtils::createTimestamp();
+		json["file"]       = m_fileName;
+		json["matched"]    = ok;
+		json["digest"]     = digest;
+		json["interfaces"] = interfaces;
+
+		WriteJSON("Replay", json);
+	}
+	catch (nlohmann::json::exception& ex) {
+		LogError("Error creating JSON - %s", ex.what());
+	}
+
+	m_interfaces.clear();
+	m_lookup.clear();
+
+	return ok;
+}
@@ -0,0 +1,53 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(REPLAY_H)
+#define	REPLAY_H
+
+#include <string>
+
+#include <cstdint>
+#include <cstddef>
+
+// Feeds a file written by the capture back through the networks and the
+// transcoder in place of their sockets and serial port. The packets from the
+// networks are released by a virtual clock, which is set as the clock for
+// everything else while the replay runs, and the replies of the transcoder as
+// soon as the messages that preceded them have been written, so the same file
+// always gives the same result. What is written is compared against the
+// packets in the file.
+
+extern bool ReplayOpen(const std::string& fileName, bool paced);
+
+extern bool ReplayActive();
+
+// Once everything has been replayed and time allowed for the last of it to leave
+extern bool ReplayFinished();
+
+// The next datagram for a network, when it is due
+extern int  ReplayReceive(int id, uint8_t* buffer, size_t length);
+
+// The bytes of the transcoder replies that are due
+extern uint16_t ReplayRead(int id, uint8_t* buffer, uint16_t length);
+
+extern void ReplayWrite(int id, const uint8_t* buffer, size_t length);
+
+// Report the results, true if everything written matched the file
+extern bool ReplayClose();
+
+#endif
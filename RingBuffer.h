@@ -19,6 +19,7 @@
 #if !defined(RingBuffer_H)
 #define RingBuffer_H
 
+#include "Metrics.h"
 #include "Log.h"
 
 #include <cstdio>
@@ -33,7 +34,9 @@ public:
 	m_name(name),
 	m_buffer(nullptr),
 	m_iPtr(0U),
-	m_oPtr(0U)
+	m_oPtr(0U),
+	m_overflows(nullptr),
+	m_underflows(nullptr)
 	{
 		assert(length > 0U);
 		assert(name != nullptr);
@@ -48,6 +51,12 @@ public:
 		delete[] m_buffer;
 	}
 
+	void setCounters(CCounter* overflows, CCounter* underflows)
+	{
+		m_overflows  = overflows;
+		m_underflows = underflows;
+	}
+
 	bool add(const T* buffer, uint16_t nSamples)
 	{
 		assert(buffer != nullptr);
@@ -55,6 +64,8 @@ public:
 
 		if (nSamples >= free()) {
 			LogError("%s buffer overflow, clearing the buffer. (%u >= %u)", m_name, nSamples, free());
+			if (m_overflows != nullptr)
+				m_overflows->add();
 			clear();
 			return false;
 		}
@@ -76,6 +87,8 @@ public:
 
 		if (size() < nSamples) {
 			LogError("**** Underflow in %s ring buffer, %u < %u", m_name, size(), nSamples);
+			if (m_underflows != nullptr)
+				m_underflows->add();
 			return false;
 		}
 
@@ -95,6 +108,8 @@ public:
 
 		if (size() < nSamples) {
 			LogError("**** Underflow in %s ring buffer, %u < %u", m_name, size(), nSamples);
+			if (m_underflows != nullptr)
+				m_underflows->add();
 			return false;
 		}
 
@@ -114,6 +129,8 @@ public:
 
 		if (size() < nSamples) {
 			LogError("**** Underflow peek in %s ring buffer, %u < %u", m_name, size(), nSamples);
+			if (m_underflows != nullptr)
+				m_underflows->add();
 			return false;
 		}
 
@@ -177,6 +194,8 @@ private:
 	T*           m_buffer;
 	uint16_t     m_iPtr;
 	uint16_t     m_oPtr;
+	CCounter*    m_overflows;
+	CCounter*    m_underflows;
 };
 
 #endif
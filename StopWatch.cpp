@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2015,2016,2018,2025 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2015,2016,2018,2025,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -17,17 +17,17 @@
  */
 
 #include "StopWatch.h"
+#include "Clock.h"
 
 #if defined(_WIN32) || defined(_WIN64)
+#include <Windows.h>
+#else
+#include <sys/time.h>
+#endif
 
 CStopWatch::CStopWatch() :
-m_frequencyS(),
-m_frequencyMS(),
-m_start()
+m_start(0U)
 {
-	::QueryPerformanceFrequency(&m_frequencyS);
-
-	m_frequencyMS.QuadPart = m_frequencyS.QuadPart / 1000ULL;
 }
 
 CStopWatch::~CStopWatch()
@@ -36,70 +36,30 @@ CStopWatch::~CStopWatch()
 
 unsigned long long CStopWatch::time() const
 {
-	LARGE_INTEGER now;
-	::QueryPerformanceCounter(&now);
-
-	return (unsigned long long)(now.QuadPart / m_frequencyMS.QuadPart);
-}
-
-unsigned long long CStopWatch::start()
-{
-	::QueryPerformanceCounter(&m_start);
-
-	return (unsigned long long)(m_start.QuadPart / m_frequencyS.QuadPart);
-}
-
-unsigned int CStopWatch::elapsed()
-{
-	LARGE_INTEGER now;
-	::QueryPerformanceCounter(&now);
-
-	LARGE_INTEGER temp;
-	temp.QuadPart = (now.QuadPart - m_start.QuadPart) * 1000;
+#if defined(_WIN32) || defined(_WIN64)
+	FILETIME ft;
+	::GetSystemTimeAsFileTime(&ft);
 
-	return (unsigned int)(temp.QuadPart / m_frequencyS.QuadPart);
-}
+	// From 100ns units since 1601 to ms since 1970
+	unsigned long long time = ((unsigned long long)ft.dwHighDateTime << 32) | (unsigned long long)ft.dwLowDateTime;
 
+	return (time - 116444736000000000ULL) / 10000ULL;
 #else
-
-#include <cstdio>
-#include <ctime>
-
-CStopWatch::CStopWatch() :
-m_startMS(0ULL)
-{
-}
-
-CStopWatch::~CStopWatch()
-{
-}
-
-unsigned long long CStopWatch::time() const
-{
 	struct timeval now;
 	::gettimeofday(&now, nullptr);
 
 	return now.tv_sec * 1000ULL + now.tv_usec / 1000ULL;
+#endif
 }
 
 unsigned long long CStopWatch::start()
 {
-	struct timespec now;
-	::clock_gettime(CLOCK_MONOTONIC, &now);
-
-	m_startMS = now.tv_sec * 1000ULL + now.tv_nsec / 1000000ULL;
+	m_start = ClockNow();
 
-	return m_startMS;
+	return m_start / 1000000ULL;
 }
 
 unsigned int CStopWatch::elapsed()
 {
-	struct timespec now;
-	::clock_gettime(CLOCK_MONOTONIC, &now);
-
-	unsigned long long nowMS = now.tv_sec * 1000ULL + now.tv_nsec / 1000000ULL;
-
-	return nowMS - m_startMS;
+	return (unsigned int)((ClockNow() - m_start) / 1000000ULL);
 }
-
-#endif
@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2015,2016,2018 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2015,2016,2018,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -19,31 +19,23 @@
 #if !defined(STOPWATCH_H)
 #define	STOPWATCH_H
 
-#if defined(_WIN32) || defined(_WIN64)
-#include <windows.h>
-#else
-#include <sys/time.h>
-#endif
+#include <cstdint>
 
+// Measures against the clock, so that it follows a virtual one too
 class CStopWatch
 {
 public:
 	CStopWatch();
 	~CStopWatch();
 
+	// The wall clock time in ms
 	unsigned long long time() const;
 
 	unsigned long long start();
 	unsigned int       elapsed();
 
 private:
-#if defined(_WIN32) || defined(_WIN64)
-	LARGE_INTEGER  m_frequencyS;
-	LARGE_INTEGER  m_frequencyMS;
-	LARGE_INTEGER  m_start;
-#else
-	unsigned long long m_startMS;
-#endif
+	uint64_t m_start;
 };
 
 #endif
@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2009,2010,2015 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2009,2010,2015,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -17,52 +17,111 @@
  */
 
 #include "Timer.h"
+#include "Clock.h"
 
 #include <cstdio>
 #include <cassert>
 
-CTimer::CTimer(unsigned int ticksPerSec, unsigned int secs, unsigned int msecs) :
-m_ticksPerSec(ticksPerSec),
-m_timeout(0U),
-m_timer(0U)
+CTimer::CTimer(unsigned int secs, unsigned int msecs) :
+CTimerLink(),
+m_timeout((secs * 1000ULL + msecs) * 1000000ULL),
+m_start(0U),
+m_running(false),
+m_expired(false),
+m_callback(nullptr),
+m_obj(nullptr)
 {
-	assert(ticksPerSec > 0U);
-
-	if (secs > 0U || msecs > 0U) {
-		// m_timeout = ((secs * 1000U + msecs) * m_ticksPerSec) / 1000U + 1U;
-		unsigned long long temp = (secs * 1000ULL + msecs) * m_ticksPerSec;
-		m_timeout = (unsigned int)(temp / 1000ULL + 1ULL);
-	}
 }
 
 CTimer::~CTimer()
 {
+	stop();
 }
 
 void CTimer::setTimeout(unsigned int secs, unsigned int msecs)
 {
-	if (secs > 0U || msecs > 0U) {
-		// m_timeout = ((secs * 1000U + msecs) * m_ticksPerSec) / 1000U + 1U;
-		unsigned long long temp = (secs * 1000ULL + msecs) * m_ticksPerSec;
-		m_timeout = (unsigned int)(temp / 1000ULL + 1ULL);
-	} else {
-		m_timeout = 0U;
-		m_timer = 0U;
+	m_timeout = (secs * 1000ULL + msecs) * 1000000ULL;
+
+	if (m_timeout == 0U) {
+		stop();
+		return;
+	}
+
+	// Move a running timer to its new deadline
+	if (m_prev != nullptr) {
+		TimerWheelRemove(this);
+		TimerWheelAdd(this);
 	}
 }
 
+void CTimer::setCallback(void (*callback)(void* obj), void* obj)
+{
+	m_callback = callback;
+	m_obj      = obj;
+}
+
 unsigned int CTimer::getTimeout() const
 {
-	if (m_timeout == 0U)
+	return (unsigned int)(m_timeout / 1000000000ULL);
+}
+
+unsigned int CTimer::getTimer() const
+{
+	if (!m_running)
 		return 0U;
 
-	return (m_timeout - 1U) / m_ticksPerSec;
+	return (unsigned int)((ClockNow() - m_start) / 1000000000ULL);
 }
 
-unsigned int CTimer::getTimer() const
+unsigned int CTimer::getRemaining() const
+{
+	if (!m_running || m_expired)
+		return 0U;
+
+	uint64_t now = ClockNow();
+	uint64_t deadline = m_start + m_timeout;
+	if (now >= deadline)
+		return 0U;
+
+	return (unsigned int)((deadline - now) / 1000000000ULL);
+}
+
+void CTimer::start()
+{
+	if (m_timeout == 0U)
+		return;
+
+	if (m_prev != nullptr)
+		TimerWheelRemove(this);
+
+	m_start   = ClockNow();
+	m_running = true;
+	m_expired = false;
+
+	TimerWheelAdd(this);
+}
+
+void CTimer::stop()
+{
+	if (m_prev != nullptr)
+		TimerWheelRemove(this);
+
+	m_running = false;
+	m_expired = false;
+}
+
+uint64_t CTimer::getDeadline() const
 {
-	if (m_timer == 0U)
+	if (!m_running)
 		return 0U;
 
-	return (m_timer - 1U) / m_ticksPerSec;
+	return m_start + m_timeout;
+}
+
+void CTimer::expire()
+{
+	m_expired = true;
+
+	if (m_callback != nullptr)
+		m_callback(m_obj);
 }
@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2009,2010,2011,2014 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2009,2010,2011,2014,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -19,30 +19,34 @@
 #if !defined(Timer_H)
 #define	Timer_H
 
-class CTimer {
+#include "TimerWheel.h"
+
+#include <cstdint>
+
+// Runs from the timer wheel, so a timer is only looked at when it expires.
+// With a callback set, that is called from TimerWheelClock() on expiry,
+// otherwise hasExpired() is true from then until it is started or stopped.
+class CTimer : private CTimerLink {
 public:
-	CTimer(unsigned int ticksPerSec, unsigned int secs = 0U, unsigned int msecs = 0U);
+	CTimer(unsigned int secs = 0U, unsigned int msecs = 0U);
 	~CTimer();
 
+	// A copy would share the wheel links of the original
+	CTimer(const CTimer&) = delete;
+	CTimer& operator=(const CTimer&) = delete;
+
 	void setTimeout(unsigned int secs, unsigned int msecs = 0U);
 
+	void setCallback(void (*callback)(void* obj), void* obj);
+
 	unsigned int getTimeout() const;
 	unsigned int getTimer() const;
 
-	unsigned int getRemaining()
-	{
-		if (m_timeout == 0U || m_timer == 0U)
-			return 0U;
+	unsigned int getRemaining() const;
 
-		if (m_timer >= m_timeout)
-			return 0U;
-
-		return (m_timeout - m_timer) / m_ticksPerSec;
-	}
-
-	bool isRunning()
+	bool isRunning() const
 	{
-		return m_timer > 0U;
+		return m_running;
 	}
 
 	void start(unsigned int secs, unsigned int msecs = 0U)
@@ -52,38 +56,28 @@ public:
 		start();
 	}
 
-	void start()
-	{
-		if (m_timeout > 0U)
-			m_timer = 1U;
-	}
+	void start();
+	void stop();
 
-	void stop()
+	bool hasExpired() const
 	{
-		m_timer = 0U;
+		return m_expired;
 	}
 
-	bool hasExpired()
-	{
-		if (m_timeout == 0U || m_timer == 0U)
-			return false;
-
-		if (m_timer >= m_timeout)
-			return true;
+	// The clock time that it expires at, zero when it isn't running
+	uint64_t getDeadline() const;
 
-		return false;
-	}
+private:
+	friend class CTimerWheel;
 
-	void clock(unsigned int ticks = 1U)
-	{
-		if (m_timer > 0U && m_timeout > 0U)
-			m_timer += ticks;
-	}
+	uint64_t m_timeout;
+	uint64_t m_start;
+	bool     m_running;
+	bool     m_expired;
+	void   (*m_callback)(void* obj);
+	void*    m_obj;
 
-private:
-	unsigned int m_ticksPerSec;
-	unsigned int m_timeout;
-	unsigned int m_timer;
+	void expire();
 };
 
 #endif
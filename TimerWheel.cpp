@@ -0,0 +1,265 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "TimerWheel.h"
+#include "Clock.h"
+#include "Timer.h"
+
+#include <cassert>
+
+// Five levels of 64 slots cover 2^30 ms, about 12 days
+const unsigned int WHEEL_BITS   = 6U;
+const unsigned int WHEEL_SLOTS  = 1U << WHEEL_BITS;
+const unsigned int WHEEL_LEVELS = 5U;
+const uint64_t     WHEEL_MASK   = WHEEL_SLOTS - 1U;
+
+const uint64_t     TICK_TIME    = 1000000ULL;
+
+// Beyond a jump of this many ticks it is quicker to sort the timers out again than to step through them
+const uint64_t     REBUILD_TICKS = 1ULL << (2U * WHEEL_BITS);
+
+class CTimerWheel {
+public:
+	CTimerWheel();
+
+	void add(CTimer* timer);
+	void remove(CTimer* timer);
+
+	void clock(uint64_t now);
+
+private:
+	CTimerLink   m_slots[WHEEL_LEVELS][WHEEL_SLOTS];
+	CTimerLink   m_overflow;		// Those beyond the reach of the wheel
+	uint64_t     m_current;
+	unsigned int m_count;
+
+	void insert(CTimer* timer);
+	void expire(CTimerLink& slot, uint64_t now);
+	void cascade(CTimerLink& slot);
+	void rebuild(uint64_t tick);
+
+	static void init(CTimerLink& head);
+	static bool empty(const CTimerLink& head);
+	static void link(CTimerLink& head, CTimerLink* link);
+	static void unlink(CTimerLink* link);
+	static void splice(CTimerLink& from, CTimerLink& to);
+};
+
+static CTimerWheel m_wheel;
+
+CTimerWheel::CTimerWheel() :
+m_slots(),
+m_overflow(),
+m_current(0U),
+m_count(0U)
+{
+	for (unsigned int level = 0U; level < WHEEL_LEVELS; level++) {
+		for (unsigned int slot = 0U; slot < WHEEL_SLOTS; slot++)
+			init(m_slots[level][slot]);
+	}
+
+	init(m_overflow);
+}
+
+void CTimerWheel::add(CTimer* timer)
+{
+	assert(timer != nullptr);
+	assert(timer->m_prev == nullptr);
+
+	// An empty wheel starts from now, rather than stepping through the time since it was last used
+	if (m_count == 0U)
+		m_current = ClockNow() / TICK_TIME;
+
+	insert(timer);
+
+	m_count++;
+}
+
+void CTimerWheel::remove(CTimer* timer)
+{
+	assert(timer != nullptr);
+	assert(timer->m_prev != nullptr);
+
+	unlink(timer);
+
+	m_count--;
+}
+
+void CTimerWheel::clock(uint64_t now)
+{
+	uint64_t tick = now / TICK_TIME;
+
+	if (m_count == 0U) {
+		m_current = tick;
+		return;
+	}
+
+	if (tick > (m_current + REBUILD_TICKS))
+		rebuild(tick);
+
+	for (;;) {
+		expire(m_slots[0U][m_current & WHEEL_MASK], now);
+
+		if (m_current >= tick)
+			break;
+
+		m_current++;
+
+		// Move the timers in the next slot of each level that has come round down a level
+		unsigned int level;
+		for (level = 1U; level < WHEEL_LEVELS; level++) {
+			if ((m_current & ((1ULL << (level * WHEEL_BITS)) - 1U)) != 0U)
+				break;
+
+			cascade(m_slots[level][(m_current >> (level * WHEEL_BITS)) & WHEEL_MASK]);
+		}
+
+		if ((level == WHEEL_LEVELS) && ((m_current & ((1ULL << (WHEEL_LEVELS * WHEEL_BITS)) - 1U)) == 0U))
+			cascade(m_overflow);
+	}
+}
+
+void CTimerWheel::insert(CTimer* timer)
+{
+	uint64_t tick = timer->getDeadline() / TICK_TIME;
+	if (tick < m_current)
+		tick = m_current;
+
+	// The lowest level on which it shares the current slot of the level above
+	for (unsigned int level = 0U; level < WHEEL_LEVELS; level++) {
+		unsigned int shift = (level + 1U) * WHEEL_BITS;
+		if ((tick >> shift) == (m_current >> shift)) {
+			link(m_slots[level][(tick >> (level * WHEEL_BITS)) & WHEEL_MASK], timer);
+			return;
+		}
+	}
+
+	link(m_overflow, timer);
+}
+
+void CTimerWheel::expire(CTimerLink& slot, uint64_t now)
+{
+	if (empty(slot))
+		return;
+
+	// A callback may start or stop any timer, so work from a list of our own
+	CTimerLink due;
+	init(due);
+	splice(slot, due);
+
+	while (!empty(due)) {
+		CTimer* timer = static_cast<CTimer*>(due.m_next);
+		unlink(timer);
+
+		// Only possible in the current tick
+		if (timer->getDeadline() > now) {
+			insert(timer);
+			continue;
+		}
+
+		m_count--;
+
+		timer->expire();
+	}
+}
+
+void CTimerWheel::cascade(CTimerLink& slot)
+{
+	CTimerLink timers;
+	init(timers);
+	splice(slot, timers);
+
+	while (!empty(timers)) {
+		CTimer* timer = static_cast<CTimer*>(timers.m_next);
+		unlink(timer);
+		insert(timer);
+	}
+}
+
+void CTimerWheel::rebuild(uint64_t tick)
+{
+	CTimerLink timers;
+	init(timers);
+
+	for (unsigned int level = 0U; level < WHEEL_LEVELS; level++) {
+		for (unsigned int slot = 0U; slot < WHEEL_SLOTS; slot++)
+			splice(m_slots[level][slot], timers);
+	}
+
+	splice(m_overflow, timers);
+
+	m_current = tick;
+
+	cascade(timers);
+}
+
+void CTimerWheel::init(CTimerLink& head)
+{
+	head.m_prev = &head;
+	head.m_next = &head;
+}
+
+bool CTimerWheel::empty(const CTimerLink& head)
+{
+	return head.m_next == &head;
+}
+
+void CTimerWheel::link(CTimerLink& head, CTimerLink* link)
+{
+	link->m_prev = head.m_prev;
+	link->m_next = &head;
+	head.m_prev->m_next = link;
+	head.m_prev = link;
+}
+
+void CTimerWheel::unlink(CTimerLink* link)
+{
+	link->m_prev->m_next = link->m_next;
+	link->m_next->m_prev = link->m_prev;
+	link->m_prev = nullptr;
+	link->m_next = nullptr;
+}
+
+void CTimerWheel::splice(CTimerLink& from, CTimerLink& to)
+{
+	if (empty(from))
+		return;
+
+	// Append the whole of one list to the other
+	from.m_next->m_prev = to.m_prev;
+	to.m_prev->m_next   = from.m_next;
+	from.m_prev->m_next = &to;
+	to.m_prev           = from.m_prev;
+
+	init(from);
+}
+
+void TimerWheelAdd(CTimer* timer)
+{
+	m_wheel.add(timer);
+}
+
+void TimerWheelRemove(CTimer* timer)
+{
+	m_wheel.remove(timer);
+}
+
+void TimerWheelClock()
+{
+	m_wheel.clock(ClockNow());
+}
@@ -0,0 +1,46 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(TIMERWHEEL_H)
+#define	TIMERWHEEL_H
+
+// A hierarchical timer wheel with a resolution of 1 ms. Every running CTimer
+// is on one of its lists, so starting and stopping a timer is a constant time
+// link or unlink, and each pass only looks at the timers that are due.
+
+// The list links that every timer, and the head of every list, has
+struct CTimerLink {
+	CTimerLink() :
+	m_prev(nullptr),
+	m_next(nullptr)
+	{
+	}
+
+	CTimerLink* m_prev;
+	CTimerLink* m_next;
+};
+
+class CTimer;
+
+extern void TimerWheelAdd(CTimer* timer);
+extern void TimerWheelRemove(CTimer* timer);
+
+// Expire every timer that is due at the current clock time, calling their callbacks
+extern void TimerWheelClock();
+
+#endif
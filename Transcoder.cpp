@@ -20,6 +20,8 @@
 
 #include "TranscoderDefines.h"
 #include "StopWatch.h"
+#include "Capture.h"
+#include "Replay.h"
 #include "Utils.h"
 #include "Log.h"
 
@@ -34,8 +36,15 @@ m_inMode(MODE_PCM),
 m_outMode(MODE_PCM),
 m_inLength(0U),
 m_outLength(0U),
-m_hasAMBE(NO_AMBE_CHIP)
+m_hasAMBE(NO_AMBE_CHIP),
+m_metrics(nullptr),
+m_capture(-1),
+m_resync(false)
 {
+	m_metrics = MetricsTranscoder();
+	m_capture = CaptureInterface("Transcoder");
+
+	m_connection.setReplay(m_capture);
 }
 
 CTranscoder::~CTranscoder()
@@ -69,7 +78,7 @@ bool CTranscoder::open()
 	}
 
 	uint8_t buffer[400U];
-	uint16_t len = read(buffer, 200U);
+	uint16_t len = read(buffer, 400U, 200U);
 	if (len == 0U) {
 		LogError("Transcoder version read timeout (200 me)");
 		close();
@@ -81,6 +90,7 @@ bool CTranscoder::open()
 
 	switch (buffer[TYPE_POS]) {
 	case TYPE_NAK:
+		m_metrics->m_naks.add();
 		LogError("NAK returned for get version - %u", buffer[NAK_ERROR_POS]);
 		close();
 		return false;
@@ -107,7 +117,7 @@ bool CTranscoder::open()
 		return false;
 	}
 
-	len = read(buffer, 50U);
+	len = read(buffer, 400U, 50U);
 	if (len == 0U) {
 		LogError("Transcoder capabilities read timeout (200 me)");
 		close();
@@ -119,6 +129,7 @@ bool CTranscoder::open()
 
 	switch (buffer[TYPE_POS]) {
 	case TYPE_NAK:
+		m_metrics->m_naks.add();
 		LogError("NAK returned for get capabilities - %u", buffer[NAK_ERROR_POS]);
 		close();
 		return false;
@@ -161,8 +172,13 @@ bool CTranscoder::setConversion(uint8_t inMode, uint8_t outMode)
 		return false;
 	}
 
-	uint8_t buffer[50U];
-	uint16_t len = read(buffer, 200U);
+	// Replies to data sent before the change may still be on their way
+	uint8_t buffer[400U];
+	uint16_t len;
+	do {
+		len = read(buffer, 400U, 200U);
+	} while ((len > 0U) && (buffer[TYPE_POS] == TYPE_DATA));
+
 	if (len == 0U) {
 		LogError("Transcoder set mode read timeout (200 me)");
 		return false;
@@ -179,6 +195,7 @@ bool CTranscoder::setConversion(uint8_t inMode, uint8_t outMode)
 
 	switch (buffer[TYPE_POS]) {
 	case TYPE_NAK:
+		m_metrics->m_naks.add();
 		LogError("NAK returned for set mode - %u", buffer[NAK_ERROR_POS]);
 		return false;
 
@@ -197,7 +214,7 @@ void CTranscoder::close()
 	m_connection.close();
 }
 
-uint16_t CTranscoder::read(uint8_t* buffer, uint16_t timeout)
+uint16_t CTranscoder::read(uint8_t* buffer, uint16_t length, uint16_t timeout)
 {
 	assert(buffer != nullptr);
 
@@ -216,9 +233,16 @@ uint16_t CTranscoder::read(uint8_t* buffer, uint16_t timeout)
 					buffer[0U] = c;
 					ptr = 1U;
 					len = 0U;
+
+					// Found again after skipping some bytes
+					if (m_resync) {
+						m_metrics->m_resyncs.add();
+						m_resync = false;
+					}
 				} else {
 					ptr = 0U;
 					len = 0U;
+					m_resync = true;
 				}
 			} else if (ptr == LENGTH_LSB_POS) {
 				// Handle the frame length LSB
@@ -230,19 +254,30 @@ uint16_t CTranscoder::read(uint8_t* buffer, uint16_t timeout)
 				uint8_t val = buffer[ptr] = c;
 				len |= (val << 8) & 0xFF00U;
 				ptr = 3U;
+
+				// Too short to be a message, or too long for the buffer
+				if ((len <= TYPE_POS) || (len > length)) {
+					ptr = 0U;
+					len = 0U;
+					m_resync = true;
+				}
 			} else {
 				// Any other bytes are added to the buffer
 				buffer[ptr] = c;
 				ptr++;
 
 				// The full packet has been received, process it
-				if (ptr == len)
+				if (ptr == len) {
+					CaptureWrite(m_capture, true, buffer, len);
 					return len;
+				}
 			}
 		} else {
 			if (timeout > 0U) {
+				// When replaying, a reply that isn't there already never will be
 				unsigned long elapsed = stopwatch.elapsed();
-				if (elapsed > timeout) {
+				if ((elapsed > timeout) || ReplayActive()) {
+					m_metrics->m_timeouts.add();
 					LogError("Transcoder read has timed out after %u ms", timeout);
 					return len;
 				}
@@ -262,15 +297,19 @@ int16_t CTranscoder::write(const uint8_t* buffer, uint16_t length)
 	if (m_debug)
 		CUtils::dump("Transcoder write", buffer, length);
 
+	CaptureWrite(m_capture, false, buffer, length);
+
 	return m_connection.write(buffer, length);
 }
 
-uint16_t CTranscoder::read(uint8_t* data)
+uint16_t CTranscoder::read(uint8_t* data, bool& failed)
 {
 	assert(data != nullptr);
 
+	failed = false;
+
 	uint8_t buffer[400U];
-	uint16_t len = read(buffer, 0U);
+	uint16_t len = read(buffer, 400U, 0U);
 	if (len == 0U)
 		return 0U;
 
@@ -279,19 +318,24 @@ uint16_t CTranscoder::read(uint8_t* data)
 
 	switch (buffer[TYPE_POS]) {
 	case TYPE_NAK:
+		m_metrics->m_naks.add();
 		LogError("NAK returned for transcoding - %u", buffer[NAK_ERROR_POS]);
-		return false;
+		failed = true;
+		return 0U;
 
 	case TYPE_DATA:
 		break;
 
 	default:
 		LogError("Unknown response from the transcoder to transcoding - 0x%02X", buffer[TYPE_POS]);
-		return false;
+		failed = true;
+		return 0U;
 	}
 
 	::memcpy(data, buffer + DATA_START_POS, m_outLength);
 
+	m_metrics->m_framesReceived.add();
+
 	return m_outLength;
 }
 
@@ -311,6 +355,8 @@ bool CTranscoder::write(const uint8_t* data)
 		return false;
 	}
 
+	m_metrics->m_framesSent.add();
+
 	return true;
 }
 
@@ -20,6 +20,7 @@
 #define Transcoder_H
 
 #include "TranscoderConnection.h"
+#include "Metrics.h"
 
 #include <string>
 
@@ -35,7 +36,8 @@ public:
 
 	bool setConversion(uint8_t inMode, uint8_t outMode);
 
-	uint16_t read(uint8_t* data);
+	// Failed is set when the transcoder answered a frame with anything but its data
+	uint16_t read(uint8_t* data, bool& failed);
 	bool     write(const uint8_t* data);
 
 	uint16_t getInLength() const;
@@ -51,10 +53,13 @@ private:
 	uint16_t              m_inLength;
 	uint16_t              m_outLength;
 	uint8_t               m_hasAMBE;
+	CTranscoderMetrics*   m_metrics;
+	int                   m_capture;
+	bool                  m_resync;
 
 	bool           validateOptions() const;
 	int16_t        write(const uint8_t* buffer, uint16_t length);
-	uint16_t       read(uint8_t* buffer, uint16_t timeout);
+	uint16_t       read(uint8_t* buffer, uint16_t length, uint16_t timeout);
 	uint16_t       getBlockLength(uint8_t mode) const;
 	const uint8_t* getDataHeader(uint8_t mode) const;
 };
@@ -18,6 +18,7 @@
 
 #include "TranscoderConnection.h"
 
+#include "Replay.h"
 #include "Log.h"
 
 #include <cassert>
@@ -31,7 +32,8 @@ m_socket(nullptr),
 m_debug(debug),
 m_address(),
 m_addressLength(0),
-m_buffer(2000U, "Transcoder UDP Buffer")
+m_buffer(2000U, "Transcoder UDP Buffer"),
+m_replay(-1)
 {
 }
 
@@ -63,8 +65,16 @@ void CTranscoderConnection::setUDPConnection(const std::string& remoteAddress, u
 	m_socket = new CUDPSocket(localAddress, localPort);
 }
 
+void CTranscoderConnection::setReplay(int id)
+{
+	m_replay = id;
+}
+
 bool CTranscoderConnection::open()
 {
+	if (ReplayActive())
+		return true;
+
 	if (m_serial != nullptr)
 		return m_serial->open();
 
@@ -81,6 +91,9 @@ uint16_t CTranscoderConnection::read(uint8_t* buffer, uint16_t length)
 	assert(buffer != nullptr);
 	assert(length > 0U);
 
+	if (ReplayActive())
+		return ReplayRead(m_replay, buffer, length);
+
 	if (m_serial != nullptr)
 		return m_serial->read(buffer, length);
 
@@ -119,6 +132,11 @@ int16_t CTranscoderConnection::write(const uint8_t* buffer, uint16_t length)
 	assert(buffer != nullptr);
 	assert(length > 0U);
 
+	if (ReplayActive()) {
+		ReplayWrite(m_replay, buffer, length);
+		return length;
+	}
+
 	if (m_serial != nullptr)
 		return m_serial->write(buffer, length);
 
@@ -136,6 +154,9 @@ void CTranscoderConnection::close()
 {
 	m_buffer.clear();
 
+	if (ReplayActive())
+		return;
+
 	if (m_serial != nullptr) {
 		m_serial->close();
 		return;
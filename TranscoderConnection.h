@@ -35,6 +35,9 @@ public:
 	void setUARTConnection(const std::string& port, uint32_t speed);
 	void setUDPConnection(const std::string& remoteAddress, uint16_t remotePort, const std::string& localAddress, uint16_t localPort);
 
+	// The capture interface that a replay takes the place of the transcoder with
+	void setReplay(int id);
+
 	bool open();
 
 	uint16_t read(uint8_t* buffer, uint16_t length);
@@ -50,6 +53,7 @@ private:
 	sockaddr_storage     m_address;
 	size_t               m_addressLength;
 	CRingBuffer<uint8_t> m_buffer;
+	int                  m_replay;
 };
 
 #endif
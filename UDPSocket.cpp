@@ -17,6 +17,8 @@
  */
 
 #include "UDPSocket.h"
+#include "Capture.h"
+#include "Replay.h"
 #include "Log.h"
 
 #include <cassert>
@@ -29,6 +31,10 @@
 CUDPSocket::CUDPSocket(const std::string& address, uint16_t port) :
 m_localAddress(address),
 m_localPort(port),
+m_metrics(nullptr),
+m_capture(-1),
+m_peer(),
+m_peerLength(0U),
 m_fd(-1),
 m_af(AF_UNSPEC)
 {
@@ -37,6 +43,10 @@ m_af(AF_UNSPEC)
 CUDPSocket::CUDPSocket(uint16_t port) :
 m_localAddress(),
 m_localPort(port),
+m_metrics(nullptr),
+m_capture(-1),
+m_peer(),
+m_peerLength(0U),
 m_fd(-1),
 m_af(AF_UNSPEC)
 {
@@ -46,6 +56,18 @@ CUDPSocket::~CUDPSocket()
 {
 }
 
+void CUDPSocket::setMetrics(CNetworkMetrics* metrics)
+{
+	m_metrics = metrics;
+}
+
+void CUDPSocket::setCapture(int id, const sockaddr_storage& peer, size_t peerLength)
+{
+	m_capture    = id;
+	m_peer       = peer;
+	m_peerLength = peerLength;
+}
+
 void CUDPSocket::startup()
 {
 #if defined(_WIN32) || defined(_WIN64)
@@ -153,6 +175,10 @@ bool CUDPSocket::open(const sockaddr_storage& address)
 
 bool CUDPSocket::open()
 {
+	// The replay stands in for the socket
+	if (ReplayActive())
+		return true;
+
 	assert(m_fd == -1);
 
 	sockaddr_storage addr;
@@ -214,6 +240,20 @@ int CUDPSocket::read(uint8_t* buffer, size_t length, sockaddr_storage& address,
 {
 	assert(buffer != nullptr);
 	assert(length > 0U);
+
+	if (ReplayActive()) {
+		int len = ReplayReceive(m_capture, buffer, length);
+		if (len <= 0)
+			return len;
+
+		address       = m_peer;
+		addressLength = m_peerLength;
+
+		record(true, buffer, len);
+
+		return len;
+	}
+
 	assert(m_fd >= 0);
 
 	// Check that the readfrom() won't block
@@ -268,6 +308,8 @@ int CUDPSocket::read(uint8_t* buffer, size_t length, sockaddr_storage& address,
 
 	addressLength = size;
 
+	record(true, buffer, len);
+
 	return len;
 }
 
@@ -275,6 +317,13 @@ bool CUDPSocket::write(const uint8_t* buffer, size_t length, const sockaddr_stor
 {
 	assert(buffer != nullptr);
 	assert(length > 0U);
+
+	if (ReplayActive()) {
+		ReplayWrite(m_capture, buffer, length);
+		record(false, buffer, length);
+		return true;
+	}
+
 	assert(m_fd >= 0);
 
 	bool result = false;
@@ -301,6 +350,9 @@ bool CUDPSocket::write(const uint8_t* buffer, size_t length, const sockaddr_stor
 #endif
 	}
 
+	if (result)
+		record(false, buffer, length);
+
 	return result;
 }
 
@@ -316,3 +368,17 @@ void CUDPSocket::close()
 	}
 }
 
+void CUDPSocket::record(bool inbound, const uint8_t* buffer, size_t length)
+{
+	if (m_metrics != nullptr) {
+		if (inbound) {
+			m_metrics->m_packetsIn.add();
+			m_metrics->m_bytesIn.add(length);
+		} else {
+			m_metrics->m_packetsOut.add();
+			m_metrics->m_bytesOut.add(length);
+		}
+	}
+
+	CaptureWrite(m_capture, inbound, buffer, (unsigned int)length);
+}
@@ -19,6 +19,8 @@
 #if !defined(UDPSocket_H)
 #define UDPSocket_H
 
+#include "Metrics.h"
+
 #include <cstdint>
 #include <string>
 
@@ -55,6 +57,13 @@ public:
 
 	void close();
 
+	// Count the packets and bytes in and out against a network
+	void setMetrics(CNetworkMetrics* metrics);
+
+	// Copy the packets in and out to this capture interface. When replaying,
+	// the packets come from it and appear to be from the peer.
+	void setCapture(int id, const sockaddr_storage& peer, size_t peerLength);
+
 	static void startup();
 	static void shutdown();
 
@@ -68,6 +77,10 @@ public:
 private:
 	std::string    m_localAddress;
 	uint16_t       m_localPort;
+	CNetworkMetrics* m_metrics;
+	int            m_capture;
+	sockaddr_storage m_peer;
+	size_t         m_peerLength;
 #if defined(_WIN32) || defined(_WIN64)
 	SOCKET         m_fd;
 	int            m_af;
@@ -75,6 +88,8 @@ private:
 	int            m_fd;
 	sa_family_t    m_af;
 #endif
+
+	void record(bool inbound, const uint8_t* buffer, size_t length);
 };
 
 #endif
@@ -16,6 +16,7 @@
 
 #include <cstdio>
 #include <cassert>
+#include <cstring>
 
 #if defined(_WIN32) || defined(_WIN64)
 #include <Windows.h>
@@ -168,6 +169,50 @@ unsigned int CUtils::countBits(unsigned int v)
 	return count;
 }
 
+void CUtils::copyBits(const uint8_t* in, unsigned int inOffset, uint8_t* out, unsigned int outOffset, unsigned int length)
+{
+	assert(in != nullptr);
+	assert(out != nullptr);
+
+	// Each pass fills the rest of the current output byte
+	while (length > 0U) {
+		unsigned int outBit = outOffset & 7U;
+
+		// Once both sides are on a byte boundary whole bytes can be copied
+		if ((outBit == 0U) && ((inOffset & 7U) == 0U) && (length >= 8U)) {
+			unsigned int bytes = length >> 3;
+			::memcpy(out + (outOffset >> 3), in + (inOffset >> 3), bytes);
+
+			inOffset  += bytes * 8U;
+			outOffset += bytes * 8U;
+			length    -= bytes * 8U;
+			continue;
+		}
+
+		unsigned int n = 8U - outBit;
+		if (n > length)
+			n = length;
+
+		// Read the next n bits through a 16 bit window, only touching the second byte if needed
+		unsigned int inPos = inOffset >> 3;
+		unsigned int inBit = inOffset & 7U;
+
+		uint16_t window = in[inPos] << 8;
+		if ((inBit + n) > 8U)
+			window |= in[inPos + 1U];
+
+		uint8_t bits = uint8_t((window << inBit) >> 8);
+		uint8_t mask = uint8_t(0xFF00U >> n) >> outBit;
+
+		uint8_t& b = out[outOffset >> 3];
+		b = (b & ~mask) | ((bits >> outBit) & mask);
+
+		inOffset  += n;
+		outOffset += n;
+		length    -= n;
+	}
+}
+
 std::string CUtils::getModeName(DATA_MODE mode)
 {
 	switch (mode) {
@@ -203,9 +248,10 @@ std::string CUtils::createTimestamp()
 	struct timeval now;
 	::gettimeofday(&now, nullptr);
 
-	struct tm* tm = ::gmtime(&now.tv_sec);
+	struct tm tm;
+	::gmtime_r(&now.tv_sec, &tm);
 
-	::sprintf(buffer, "%04d-%02d-%02dT%02d:%02d:%02d.%03lldZ", tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday, tm->tm_hour, tm->tm_min, tm->tm_sec, now.tv_usec / 1000LL);
+	::sprintf(buffer, "%04d-%02d-%02dT%02d:%02d:%02d.%03lldZ", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, now.tv_usec / 1000LL);
 #endif
 
 	return buffer;
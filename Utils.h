@@ -35,6 +35,9 @@ public:
 
 	static unsigned int countBits(unsigned int v);
 
+	// Copies length bits, most significant bit first, leaving the other bits of out untouched
+	static void copyBits(const uint8_t* in, unsigned int inOffset, uint8_t* out, unsigned int outOffset, unsigned int length);
+
 	static std::string getModeName(DATA_MODE mode);
 
 	static std::string createTimestamp();
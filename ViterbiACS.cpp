@@ -0,0 +1,158 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "ViterbiACS.h"
+
+#include <cassert>
+
+// SSE2 is part of x86-64 and NEON of AArch64, so neither needs a run time
+// check. The metrics never get near 32768 over a frame, so the signed SSE2
+// comparisons give the same answers as the unsigned scalar ones.
+//
+// 32-bit ARM boards differ, the ARMv7 ones mostly have NEON and the ARMv6
+// ones don't. Unless the build already assumes NEON, GCC compiles the NEON
+// version for it anyway and the kernel says whether it can be used.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define	ACS_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64) || (defined(__arm__) && defined(__ARM_NEON))
+#include <arm_neon.h>
+#define	ACS_NEON
+#define	ACS_NEON_TARGET
+#elif defined(__arm__) && defined(__linux__) && defined(__ARM_FP) && defined(__GNUC__) && (__GNUC__ >= 8) && !defined(__clang__)
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#define	ACS_NEON
+#define	ACS_NEON_TARGET	__attribute__((target("fpu=neon")))
+#define	ACS_NEON_RUNTIME
+#endif
+
+const unsigned int NUM_OF_STATES_D2 = 8U;
+
+#if defined(ACS_NEON_RUNTIME)
+static const bool NEON_AVAILABLE = (::getauxval(AT_HWCAP) & HWCAP_NEON) != 0UL;
+#endif
+
+#if defined(ACS_NEON)
+ACS_NEON_TARGET static uint64_t decodeNEON(const uint16_t* oldMetrics, uint16_t* newMetrics, const uint16_t* branchMetrics, uint16_t m)
+{
+	static const uint8_t BIT_WEIGHTS[] = {0x01U, 0x02U, 0x04U, 0x08U, 0x10U, 0x20U, 0x40U, 0x80U};
+
+	uint16x8_t lower  = vld1q_u16(oldMetrics + 0U);
+	uint16x8_t upper  = vld1q_u16(oldMetrics + NUM_OF_STATES_D2);
+	uint16x8_t metric = vld1q_u16(branchMetrics);
+	uint16x8_t invert = vsubq_u16(vdupq_n_u16(m), metric);
+
+	uint16x8_t m0 = vaddq_u16(lower, metric);
+	uint16x8_t m1 = vaddq_u16(upper, invert);
+	uint16x8_t even = vminq_u16(m0, m1);
+	uint16x8_t decision0 = vcgeq_u16(m0, m1);
+
+	m0 = vaddq_u16(lower, invert);
+	m1 = vaddq_u16(upper, metric);
+	uint16x8_t odd = vminq_u16(m0, m1);
+	uint16x8_t decision1 = vcgeq_u16(m0, m1);
+
+	uint16x8x2_t states = vzipq_u16(even, odd);
+	vst1q_u16(newMetrics + 0U,                states.val[0]);
+	vst1q_u16(newMetrics + NUM_OF_STATES_D2, states.val[1]);
+
+	uint16x8x2_t decisions = vzipq_u16(decision0, decision1);
+	uint8x8_t weights = vld1_u8(BIT_WEIGHTS);
+	uint8x8_t lo = vand_u8(vmovn_u16(decisions.val[0]), weights);
+	uint8x8_t hi = vand_u8(vmovn_u16(decisions.val[1]), weights);
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+	return (uint64_t(vaddv_u8(hi)) << 8) | uint64_t(vaddv_u8(lo));
+#else
+	// ARMv7 has no across vector add, so three pairwise adds leave the sums
+	// of the low and high bytes in the first two lanes
+	uint8x8_t sums = vpadd_u8(lo, hi);
+	sums = vpadd_u8(sums, sums);
+	sums = vpadd_u8(sums, sums);
+
+	return (uint64_t(vget_lane_u8(sums, 1)) << 8) | uint64_t(vget_lane_u8(sums, 0));
+#endif
+}
+#endif
+
+uint64_t CViterbiACS::decode(const uint16_t* oldMetrics, uint16_t* newMetrics, const uint16_t* branchMetrics, uint16_t m)
+{
+	assert(oldMetrics != nullptr);
+	assert(newMetrics != nullptr);
+	assert(branchMetrics != nullptr);
+
+#if defined(ACS_SSE2)
+	__m128i lower  = _mm_loadu_si128((const __m128i*)(oldMetrics + 0U));
+	__m128i upper  = _mm_loadu_si128((const __m128i*)(oldMetrics + NUM_OF_STATES_D2));
+	__m128i metric = _mm_loadu_si128((const __m128i*)branchMetrics);
+	__m128i invert = _mm_sub_epi16(_mm_set1_epi16(int16_t(m)), metric);
+
+	__m128i m0 = _mm_add_epi16(lower, metric);
+	__m128i m1 = _mm_add_epi16(upper, invert);
+	__m128i even = _mm_min_epi16(m0, m1);
+	__m128i decision0 = _mm_cmpeq_epi16(_mm_cmpgt_epi16(m1, m0), _mm_setzero_si128());
+
+	m0 = _mm_add_epi16(lower, invert);
+	m1 = _mm_add_epi16(upper, metric);
+	__m128i odd = _mm_min_epi16(m0, m1);
+	__m128i decision1 = _mm_cmpeq_epi16(_mm_cmpgt_epi16(m1, m0), _mm_setzero_si128());
+
+	_mm_storeu_si128((__m128i*)(newMetrics + 0U),                _mm_unpacklo_epi16(even, odd));
+	_mm_storeu_si128((__m128i*)(newMetrics + NUM_OF_STATES_D2), _mm_unpackhi_epi16(even, odd));
+
+	__m128i decisions = _mm_packs_epi16(_mm_unpacklo_epi16(decision0, decision1), _mm_unpackhi_epi16(decision0, decision1));
+
+	return uint64_t(uint16_t(_mm_movemask_epi8(decisions)));
+#elif defined(ACS_NEON)
+#if defined(ACS_NEON_RUNTIME)
+	if (!NEON_AVAILABLE)
+		return decodeScalar(oldMetrics, newMetrics, branchMetrics, m);
+#endif
+
+	return decodeNEON(oldMetrics, newMetrics, branchMetrics, m);
+#else
+	return decodeScalar(oldMetrics, newMetrics, branchMetrics, m);
+#endif
+}
+
+uint64_t CViterbiACS::decodeScalar(const uint16_t* oldMetrics, uint16_t* newMetrics, const uint16_t* branchMetrics, uint16_t m)
+{
+	uint64_t decisions = 0U;
+
+	for (uint8_t i = 0U; i < NUM_OF_STATES_D2; i++) {
+		uint8_t j = i * 2U;
+
+		uint16_t metric = branchMetrics[i];
+
+		uint16_t m0 = oldMetrics[i] + metric;
+		uint16_t m1 = oldMetrics[i + NUM_OF_STATES_D2] + (m - metric);
+		uint8_t decision0 = (m0 >= m1) ? 1U : 0U;
+		newMetrics[j + 0U] = decision0 != 0U ? m1 : m0;
+
+		m0 = oldMetrics[i] + (m - metric);
+		m1 = oldMetrics[i + NUM_OF_STATES_D2] + metric;
+		uint8_t decision1 = (m0 >= m1) ? 1U : 0U;
+		newMetrics[j + 1U] = decision1 != 0U ? m1 : m0;
+
+		decisions |= (uint64_t(decision1) << (j + 1U)) | (uint64_t(decision0) << (j + 0U));
+	}
+
+	return decisions;
+}
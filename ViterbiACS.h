@@ -0,0 +1,35 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(ViterbiACS_H)
+#define	ViterbiACS_H
+
+#include <cstdint>
+
+// The add-compare-select step shared by the 16 state, rate 1/2 Viterbi
+// decoders. The branch metrics are for states 0 to 7, the decisions come
+// back with bit n set when state n took its path from the upper half.
+class CViterbiACS {
+public:
+	static uint64_t decode(const uint16_t* oldMetrics, uint16_t* newMetrics, const uint16_t* branchMetrics, uint16_t m);
+
+	// The portable version, which the SSE2 and NEON ones must always match
+	static uint64_t decodeScalar(const uint16_t* oldMetrics, uint16_t* newMetrics, const uint16_t* branchMetrics, uint16_t m);
+};
+
+#endif
@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2016,2017,2019,2020,2021,2024 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2016,2017,2019,2020,2021,2024,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -76,7 +76,7 @@ CYSFFICH::~CYSFFICH()
 	delete[] m_fich;
 }
 
-bool CYSFFICH::decode(const uint8_t* bytes)
+bool CYSFFICH::decode(const uint8_t* bytes, unsigned int& errors)
 {
 	assert(bytes != NULL);
 
@@ -97,24 +97,24 @@ bool CYSFFICH::decode(const uint8_t* bytes)
 		viterbi.decode(s0, s1);
 	}
 
+	// The path cost is the number of the 200 channel bits that disagree with the
+	// decoded data. The Golay corrections are on the 96 decoded bits that come
+	// out of the Viterbi decoder, so they aren't part of the channel error rate.
 	uint8_t output[13U];
-	viterbi.chainback(output, 96U);
+	errors = viterbi.chainback(output, 96U);
 
-	unsigned int b0, b1, b2, b3;
-	bool valid0 = CGolay24128::decode24128(output + 0U, b0);
-	bool valid1 = CGolay24128::decode24128(output + 3U, b1);
-	bool valid2 = CGolay24128::decode24128(output + 6U, b2);
-	bool valid3 = CGolay24128::decode24128(output + 9U, b3);
-
-	if (!valid0 || !valid1 || !valid2 || !valid3)
+	unsigned int golayErrors;
+	unsigned int b[4U];
+	bool valid = CGolay24128::decode24128(output, b, 4U, golayErrors);
+	if (!valid)
 		return false;
 
-	m_fich[0U] = (b0 >> 4) & 0xFFU;
-	m_fich[1U] = ((b0 << 4) & 0xF0U) | ((b1 >> 8) & 0x0FU);
-	m_fich[2U] = (b1 >> 0) & 0xFFU;
-	m_fich[3U] = (b2 >> 4) & 0xFFU;
-	m_fich[4U] = ((b2 << 4) & 0xF0U) | ((b3 >> 8) & 0x0FU);
-	m_fich[5U] = (b3 >> 0) & 0xFFU;
+	m_fich[0U] = (b[0U] >> 4) & 0xFFU;
+	m_fich[1U] = ((b[0U] << 4) & 0xF0U) | ((b[1U] >> 8) & 0x0FU);
+	m_fich[2U] = (b[1U] >> 0) & 0xFFU;
+	m_fich[3U] = (b[2U] >> 4) & 0xFFU;
+	m_fich[4U] = ((b[2U] << 4) & 0xF0U) | ((b[3U] >> 8) & 0x0FU);
+	m_fich[5U] = (b[3U] >> 0) & 0xFFU;
 
 	return CCRC::checkCCITT162(m_fich, 6U);
 }
@@ -128,29 +128,14 @@ void CYSFFICH::encode(uint8_t* bytes)
 
 	CCRC::addCCITT162(m_fich, 6U);
 
-	unsigned int b0 = ((m_fich[0U] << 4) & 0xFF0U) | ((m_fich[1U] >> 4) & 0x00FU);
-	unsigned int b1 = ((m_fich[1U] << 8) & 0xF00U) | ((m_fich[2U] >> 0) & 0x0FFU);
-	unsigned int b2 = ((m_fich[3U] << 4) & 0xFF0U) | ((m_fich[4U] >> 4) & 0x00FU);
-	unsigned int b3 = ((m_fich[4U] << 8) & 0xF00U) | ((m_fich[5U] >> 0) & 0x0FFU);
-
-	unsigned int c0 = CGolay24128::encode24128(b0);
-	unsigned int c1 = CGolay24128::encode24128(b1);
-	unsigned int c2 = CGolay24128::encode24128(b2);
-	unsigned int c3 = CGolay24128::encode24128(b3);
+	unsigned int b[4U];
+	b[0U] = ((m_fich[0U] << 4) & 0xFF0U) | ((m_fich[1U] >> 4) & 0x00FU);
+	b[1U] = ((m_fich[1U] << 8) & 0xF00U) | ((m_fich[2U] >> 0) & 0x0FFU);
+	b[2U] = ((m_fich[3U] << 4) & 0xFF0U) | ((m_fich[4U] >> 4) & 0x00FU);
+	b[3U] = ((m_fich[4U] << 8) & 0xF00U) | ((m_fich[5U] >> 0) & 0x0FFU);
 
 	uint8_t conv[13U];
-	conv[0U]  = (c0 >> 16) & 0xFFU;
-	conv[1U]  = (c0 >> 8) & 0xFFU;
-	conv[2U]  = (c0 >> 0) & 0xFFU;
-	conv[3U]  = (c1 >> 16) & 0xFFU;
-	conv[4U]  = (c1 >> 8) & 0xFFU;
-	conv[5U]  = (c1 >> 0) & 0xFFU;
-	conv[6U]  = (c2 >> 16) & 0xFFU;
-	conv[7U]  = (c2 >> 8) & 0xFFU;
-	conv[8U]  = (c2 >> 0) & 0xFFU;
-	conv[9U]  = (c3 >> 16) & 0xFFU;
-	conv[10U] = (c3 >> 8) & 0xFFU;
-	conv[11U] = (c3 >> 0) & 0xFFU;
+	CGolay24128::encode24128(b, conv, 4U);
 	conv[12U] = 0x00U;
 
 	CYSFConvolution convolution;
@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2016,2017,2019,2020,2024 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2016,2017,2019,2020,2024,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -27,7 +27,8 @@ public:
 	CYSFFICH();
 	~CYSFFICH();
 
-	bool decode(const uint8_t* bytes);
+	// errors is the number of the 200 channel bits that the Viterbi decoder corrected
+	bool decode(const uint8_t* bytes, unsigned int& errors);
 
 	void encode(uint8_t* bytes);
 
@@ -21,6 +21,8 @@
 #include "YSFDefines.h"
 #include "YSFNetwork.h"
 #include "YSFFICH.h"
+#include "Capture.h"
+#include "Latency.h"
 #include "Utils.h"
 #include "Log.h"
 
@@ -32,18 +34,24 @@ const unsigned int BUFFER_LENGTH = 200U;
 
 CYSFNetwork::CYSFNetwork(NETWORK network, const std::string& callsign, const std::string& localAddress, unsigned short localPort, const std::string& gatewayAddress, unsigned short gatewayPort, bool debug) :
 m_network(network),
+m_metrics(nullptr),
 m_socket(localAddress, localPort),
 m_addr(),
 m_addrLen(0U),
 m_callsign(),
 m_debug(debug),
 m_buffer(1000U, "YSF Network"),
-m_pollTimer(1000U, 5U),
+m_jitterBuffer(nullptr),
+m_pacer(nullptr),
+m_pollTimer(5U),
 m_tag(nullptr),
 m_seqNo(0U),
 m_audio(nullptr),
 m_audioCount(0U),
-m_fn(0U)
+m_fn(0U),
+m_templates(nullptr),
+m_rxSeqNo(0U),
+m_rxSeqValid(false)
 {
 	m_callsign = callsign;
 	m_callsign.resize(YSF_CALLSIGN_LENGTH, ' ');
@@ -53,14 +61,44 @@ m_fn(0U)
 
 	m_audio = new uint8_t[YSFDN_DATA_LENGTH * 5U];
 
+	// One communications frame for each value of FN
+	m_templates = new uint8_t[YSF_FRAME_LENGTH_BYTES * 7U];
+
 	m_tag = new uint8_t[YSF_CALLSIGN_LENGTH];
 	::memset(m_tag, ' ', YSF_CALLSIGN_LENGTH);
+
+	m_metrics = MetricsNetwork(network, DATA_MODE::YSF);
+
+	m_pollTimer.setCallback(onPoll, this);
+
+	m_socket.setMetrics(m_metrics);
+	m_socket.setCapture(CaptureInterface(network, DATA_MODE::YSF), m_addr, m_addrLen);
+	m_buffer.setCounters(&m_metrics->m_overflows, &m_metrics->m_underflows);
 }
 
 CYSFNetwork::~CYSFNetwork()
 {
 	delete[] m_audio;
+	delete[] m_templates;
 	delete[] m_tag;
+	delete m_jitterBuffer;
+	delete m_pacer;
+}
+
+void CYSFNetwork::setJitterBuffer(unsigned int maxDelay)
+{
+	if (maxDelay == 0U)
+		return;
+
+	// One YSFD packet carries a 100ms frame, with a seven bit sequence number
+	delete m_jitterBuffer;
+	m_jitterBuffer = new CJitterBuffer(m_network == NETWORK::RF ? "YSF RF Network" : "YSF Net Network", 155U, 128U, YSF_FRAME_TIME, maxDelay);
+}
+
+void CYSFNetwork::setPacing(unsigned int lead)
+{
+	delete m_pacer;
+	m_pacer = new CPacer(m_network == NETWORK::RF ? "YSF RF Network" : "YSF Net Network", 155U, YSF_FRAME_TIME, lead);
 }
 
 bool CYSFNetwork::open()
@@ -101,7 +139,11 @@ bool CYSFNetwork::writeRaw(CMetaData& data)
 			CUtils::dump(1U, "YSF Net Network Raw Sent", buffer, length);
 	}
 
-	return m_socket.write(buffer, length, m_addr, m_addrLen);
+	bool ret = m_socket.write(buffer, length, m_addr, m_addrLen);
+
+	LatencyAdd(STAGE::SEND, data.getSendTime());
+
+	return ret;
 }
 
 bool CYSFNetwork::writeData(CMetaData& data)
@@ -109,76 +151,97 @@ bool CYSFNetwork::writeData(CMetaData& data)
 	if (m_addrLen == 0U)
 		return false;
 
-	switch (m_audioCount) {
-	case 0U:
-		for (uint16_t i = 0U; i < 5U; i++)
-			::memcpy(m_audio + (i * YSFDN_DATA_LENGTH), YSFDN_SILENCE, YSFDN_DATA_LENGTH);
-
-		if (data.hasData()) {
-			data.getData(m_audio + 0U);
-			m_audioCount = 1U;
-		}
-
-		if (!data.isEnd())
-			return true;
-		break;
-
-	case 1U:
-		if (data.hasData()) {
-			data.getData(m_audio + YSFDN_DATA_LENGTH);
-			m_audioCount = 2U;
+	// Pack everything the transcoder has ready, five frames per frame
+	while (data.hasData()) {
+		if (m_audioCount == 0U) {
+			for (uint16_t i = 0U; i < 5U; i++)
+				::memcpy(m_audio + (i * YSFDN_DATA_LENGTH), YSFDN_SILENCE, YSFDN_DATA_LENGTH);
 		}
 
-		if (!data.isEnd())
-			return true;
-		break;
+		data.getData(m_audio + (m_audioCount * YSFDN_DATA_LENGTH), YSFDN_DATA_LENGTH);
+		m_audioCount++;
 
-	case 2U:
-		if (data.hasData()) {
-			data.getData(m_audio + YSFDN_DATA_LENGTH + YSFDN_DATA_LENGTH);
-			m_audioCount = 3U;
-		}
+		if (m_audioCount == 5U) {
+			// A failed header must not leave the packet full
+			m_audioCount = 0U;
 
-		if (!data.isEnd())
-			return true;
-		break;
+			if (m_seqNo == 0U) {
+				bool ret = writeHeader(data);
+				if (!ret)
+					return false;
+			}
 
-	case 3U:
-		if (data.hasData()) {
-			data.getData(m_audio + YSFDN_DATA_LENGTH + YSFDN_DATA_LENGTH + YSFDN_DATA_LENGTH);
-			m_audioCount = 4U;
-		}
-
-		if (!data.isEnd())
-			return true;
-		break;
-
-	case 4U:
-		if (data.hasData()) {
-			data.getData(m_audio + YSFDN_DATA_LENGTH + YSFDN_DATA_LENGTH + YSFDN_DATA_LENGTH + YSFDN_DATA_LENGTH);
-			m_audioCount = 5U;
+			bool ret = writeCommunication(data);
+			if (!ret)
+				return false;
 		}
-		break;
-
-	default:
-		// This shouldn't happen
-		assert(false);
 	}
 
+	if (!data.isEnd())
+		return true;
+
 	if (m_seqNo == 0U) {
 		bool ret = writeHeader(data);
 		if (!ret)
 			return false;
-		return writeCommunication(data);
-	} else if (data.isEnd()) {
-		if (m_audioCount > 0U) {
-			bool ret = writeCommunication(data);
-			if (!ret)
-				return false;
+	}
+
+	// Send any partial frame, padded with silence
+	if (m_audioCount > 0U) {
+		bool ret = writeCommunication(data);
+		if (!ret)
+			return false;
+	}
+
+	return writeTerminator(data);
+}
+
+void CYSFNetwork::encodeTemplates(uint8_t* templates, const uint8_t* source, uint8_t dgId)
+{
+	assert(templates != nullptr);
+	assert(source != nullptr);
+
+	CYSFFICH fich;
+	fich.setFI(YSF_FI_COMMUNICATIONS);
+	fich.setCS(YSF_CS_ASSIGN);
+	fich.setCM(YSF_CM_GROUP_CQ);
+	fich.setBN(0U);
+	fich.setBT(0U);
+	fich.setFT(6U);
+	fich.setDev(false);
+	fich.setMR(YSF_MR_DIRECT);
+	fich.setVoIP(false);
+	fich.setDT(YSF_DT_VD_MODE2);
+	fich.setDGId(dgId);
+
+	CYSFPayload payload;
+
+	for (uint8_t fn = 0U; fn <= 6U; fn++) {
+		uint8_t* frame = templates + (fn * YSF_FRAME_LENGTH_BYTES);
+		::memset(frame, 0x00U, YSF_FRAME_LENGTH_BYTES);
+
+		::memcpy(frame, YSF_SYNC_BYTES, YSF_SYNC_LENGTH_BYTES);
+
+		fich.setFN(fn);
+		fich.encode(frame);
+
+		switch (fn) {
+		case 2U:	// Downlink
+		case 3U:	// Uplink
+		case 4U:	// Rem1+2
+		case 5U:	// Rem3+4
+			payload.createVDMode2Data(frame, YSF_NULL_CALLSIGN1);
+			break;
+		case 0U:	// Destination
+			payload.createVDMode2Data(frame, YSF_NULL_CALLSIGN2);
+			break;
+		case 1U:	// Source
+			payload.createVDMode2Data(frame, source);
+			break;
+		default:	// DT1
+			payload.createVDMode2Data(frame, YSF_NULL_DT);
+			break;
 		}
-		return writeTerminator(data);
-	} else {
-		return writeCommunication(data);
 	}
 }
 
@@ -199,6 +262,9 @@ bool CYSFNetwork::writeHeader(CMetaData& data)
 	data.getYSF(m_network, source, dgId);
 
 	::memcpy(buffer + 14U, source, YSF_CALLSIGN_LENGTH);
+	::memcpy(buffer + 24U, "ALL       ", YSF_CALLSIGN_LENGTH);
+
+	encodeTemplates(m_templates, source, dgId);
 
 	buffer[34U] = 0x00U;
 
@@ -232,7 +298,7 @@ bool CYSFNetwork::writeHeader(CMetaData& data)
 			CUtils::dump(1U, "YSF Net Network Data Sent", buffer, 155U);
 	}
 
-	return m_socket.write(buffer, 155U, m_addr, m_addrLen);
+	return writePacket(buffer, 155U);
 }
 
 bool CYSFNetwork::writeCommunication(CMetaData& data)
@@ -252,47 +318,16 @@ bool CYSFNetwork::writeCommunication(CMetaData& data)
 	data.getYSF(m_network, source, dgId);
 
 	::memcpy(buffer + 14U, source, YSF_CALLSIGN_LENGTH);
+	::memcpy(buffer + 24U, "ALL       ", YSF_CALLSIGN_LENGTH);
 
 	buffer[34U] = (m_seqNo & 0x7FU) << 1;
 
-	::memcpy(buffer + 35U, YSF_SYNC_BYTES, YSF_SYNC_LENGTH_BYTES);
-
-	CYSFFICH fich;
-	fich.setFI(YSF_FI_COMMUNICATIONS);
-	fich.setCS(YSF_CS_ASSIGN);
-	fich.setCM(YSF_CM_GROUP_CQ);
-	fich.setBN(0U);
-	fich.setBT(0U);
-	fich.setFN(m_fn);
-	fich.setFT(6U);
-	fich.setDev(false);
-	fich.setMR(YSF_MR_DIRECT);
-	fich.setVoIP(false);
-	fich.setDT(YSF_DT_VD_MODE2);
-	fich.setDGId(dgId);
-	fich.encode(buffer + 35U);
+	// Only the audio changes within a call, the sync, FICH and DCH come from the template for this FN
+	::memcpy(buffer + 35U, m_templates + (m_fn * YSF_FRAME_LENGTH_BYTES), YSF_FRAME_LENGTH_BYTES);
 
 	CYSFPayload payload;
 	payload.createVDMode2Audio(buffer + 35U, m_audio);
 
-	switch (m_fn) {
-	case 2U:	// Downlink
-	case 3U:	// Uplink
-	case 4U:	// Rem1+2
-	case 5U:	// Rem3+4
-		payload.createVDMode2Data(buffer + 35U, YSF_NULL_CALLSIGN1);
-		break;
-	case 0U:	// Destination
-		payload.createVDMode2Data(buffer + 35U, YSF_NULL_CALLSIGN2);
-		break;
-	case 1U:	// Source
-		payload.createVDMode2Data(buffer + 35U, source);
-		break;
-	default:	// DT1
-		payload.createVDMode2Data(buffer + 35U, YSF_NULL_DT);
-		break;
-	}
-
 	m_audioCount = 0U;
 
 	m_seqNo++;
@@ -308,7 +343,7 @@ bool CYSFNetwork::writeCommunication(CMetaData& data)
 			CUtils::dump(1U, "YSF Net Network Data Sent", buffer, 155U);
 	}
 
-	return m_socket.write(buffer, 155U, m_addr, m_addrLen);
+	return writePacket(buffer, 155U, data.getSendTime());
 }
 
 bool CYSFNetwork::writeTerminator(CMetaData& data)
@@ -328,6 +363,7 @@ bool CYSFNetwork::writeTerminator(CMetaData& data)
 	data.getYSF(m_network, source, dgId);
 
 	::memcpy(buffer + 14U, source, YSF_CALLSIGN_LENGTH);
+	::memcpy(buffer + 24U, "ALL       ", YSF_CALLSIGN_LENGTH);
 
 	buffer[34U]  = (m_seqNo & 0x7FU) << 1;
 	buffer[34U] |= 0x01U;
@@ -359,7 +395,7 @@ bool CYSFNetwork::writeTerminator(CMetaData& data)
 			CUtils::dump(1U, "YSF Net Network Data Sent", buffer, 155U);
 	}
 
-	return m_socket.write(buffer, 155U, m_addr, m_addrLen);
+	return writePacket(buffer, 155U);
 }
 
 bool CYSFNetwork::writePoll()
@@ -384,16 +420,67 @@ bool CYSFNetwork::writePoll()
 	return m_socket.write(buffer, 14U, m_addr, m_addrLen);
 }
 
+bool CYSFNetwork::writePacket(const uint8_t* data, uint16_t length, uint64_t start)
+{
+	assert(data != nullptr);
+
+	if (m_pacer == nullptr) {
+		bool ret = m_socket.write(data, length, m_addr, m_addrLen);
+		LatencyAdd(STAGE::SEND, start);
+		return ret;
+	}
+
+	if (!m_pacer->add(data, length, start))
+		return false;
+
+	writePaced();
+
+	return true;
+}
+
+void CYSFNetwork::writePaced()
+{
+	uint8_t buffer[155U];
+	uint16_t length = 0U;
+	uint64_t start  = 0U;
+
+	while (m_pacer->get(buffer, length, start)) {
+		m_socket.write(buffer, length, m_addr, m_addrLen);
+		LatencyAdd(STAGE::SEND, start);
+	}
+}
+
+void CYSFNetwork::onPoll(void* obj)
+{
+	assert(obj != nullptr);
+
+	CYSFNetwork* p = static_cast<CYSFNetwork*>(obj);
+
+	p->writePoll();
+
+	p->m_pollTimer.start();
+}
+
 void CYSFNetwork::clock(unsigned int ms)
 {
-	m_pollTimer.clock(ms);
-	if (m_pollTimer.hasExpired()) {
-		writePoll();
-		m_pollTimer.start();
+	if (m_pacer != nullptr) {
+		m_pacer->clock(ms);
+		writePaced();
 	}
 
 	uint8_t buffer[BUFFER_LENGTH];
 
+	if (m_jitterBuffer != nullptr) {
+		m_jitterBuffer->clock(ms);
+
+		uint16_t length  = 0U;
+		uint64_t arrival = 0U;
+		while (m_jitterBuffer->get(buffer, length, arrival)) {
+			m_buffer.add((uint8_t*)&arrival, sizeof(uint64_t));
+			m_buffer.add(buffer, 155U);
+		}
+	}
+
 	sockaddr_storage address;
 	size_t addrLen;
 	int length = m_socket.read(buffer, BUFFER_LENGTH, address, addrLen);
@@ -401,6 +488,8 @@ void CYSFNetwork::clock(unsigned int ms)
 		return;
 
 	if (!CUDPSocket::match(m_addr, address)) {
+		m_metrics->m_invalidSource.add();
+
 		if (m_network == NETWORK::RF)
 			LogMessage("YSF RF packet received from an invalid source");
 		else
@@ -408,6 +497,8 @@ void CYSFNetwork::clock(unsigned int ms)
 		return;
 	}
 
+	uint64_t arrival = LatencyTime();
+
 	// Invalid packet type?
 	if (::memcmp(buffer, "YSFD", 4U) != 0)
 		return;
@@ -426,6 +517,13 @@ void CYSFNetwork::clock(unsigned int ms)
 			return;
 	}
 
+	if (m_jitterBuffer != nullptr) {
+		// The counter is in the top seven bits, the bottom bit marks the end of the transmission
+		m_jitterBuffer->add(buffer, 155U, buffer[34U] >> 1, arrival, (buffer[34U] & 0x01U) == 0x01U);
+		return;
+	}
+
+	m_buffer.add((uint8_t*)&arrival, sizeof(uint64_t));
 	m_buffer.add(buffer, 155U);
 }
 
@@ -455,13 +553,20 @@ bool CYSFNetwork::read(CMetaData& data)
 	if (m_buffer.empty())
 		return false;
 
+	uint64_t arrival = 0U;
+	m_buffer.get((uint8_t*)&arrival, sizeof(uint64_t));
+
 	uint8_t buffer[155U];
 	m_buffer.get(buffer, 155U);
 
+	data.setReceiveTime(arrival);
 	data.setRaw(buffer, 155U);
 
+	unsigned int errors;
 	CYSFFICH fich;
-	fich.decode(buffer + 35U);
+	fich.decode(buffer + 35U, errors);
+
+	data.addFECErrors(errors, 200U);
 
 	switch (fich.getDT()) {
 		case YSF_DT_VD_MODE1:
@@ -481,17 +586,31 @@ bool CYSFNetwork::read(CMetaData& data)
 	switch (fich.getFI()) {
 	case YSF_FI_HEADER:
 		processHeader(buffer, data, fich.getDGId());
+		m_rxSeqNo    = buffer[34U] >> 1;
+		m_rxSeqValid = true;
 		return true;
 	case YSF_FI_COMMUNICATIONS:
 		break;
 	case YSF_FI_TERMINATOR:
 		data.setEnd();
+		m_rxSeqValid = false;
 		return true;
 	default:
 		LogMessage("YSF Unknown block type, FI=0x%X", fich.getFI());
 		return false;
 	}
 
+	// Replace any lost frames, five audio frames each, before this one
+	uint8_t seqNo = buffer[34U] >> 1;
+	if (m_rxSeqValid) {
+		uint8_t missing = (seqNo - m_rxSeqNo - 1U) & 0x7FU;
+		if (missing < 64U)
+			data.setMissingData(missing * 5U);
+	}
+
+	m_rxSeqNo    = seqNo;
+	m_rxSeqValid = true;
+
 	CYSFPayload payload;
 	payload.processVDMode2Audio(buffer + 35U, m_audio);
 
@@ -506,6 +625,9 @@ bool CYSFNetwork::read()
 	if (m_buffer.empty())
 		return false;
 
+	uint64_t arrival = 0U;
+	m_buffer.get((uint8_t*)&arrival, sizeof(uint64_t));
+
 	uint8_t buffer[155U];
 	m_buffer.get(buffer, 155U);
 
@@ -531,9 +653,12 @@ void CYSFNetwork::reset()
 {
 	::memset(m_tag, ' ', YSF_CALLSIGN_LENGTH);
 	m_buffer.clear();
+	if (m_jitterBuffer != nullptr)
+		m_jitterBuffer->reset();
 	m_audioCount = 0U;
 	m_seqNo      = 0U;
 	m_fn         = 0U;
+	m_rxSeqValid = false;
 }
 
 bool CYSFNetwork::hasData()
@@ -543,6 +668,8 @@ bool CYSFNetwork::hasData()
 
 void CYSFNetwork::close()
 {
+	m_pollTimer.stop();
+
 	m_socket.close();
 
 	if (m_network == NETWORK::RF)
@@ -19,6 +19,8 @@
 #if !defined(YSFNetwork_H)
 #define	YSFNetwork_H
 
+#include "JitterBuffer.h"
+#include "Pacer.h"
 #include "YSFDefines.h"
 #include "RingBuffer.h"
 #include "UDPSocket.h"
@@ -34,6 +36,9 @@ public:
 	CYSFNetwork(NETWORK network, const std::string& callsign, const std::string& localAddress, uint16_t localPort, const std::string& remoteAddress, uint16_t remotePort, bool debug);
 	virtual ~CYSFNetwork();
 
+	void setJitterBuffer(unsigned int maxDelay);
+	void setPacing(unsigned int lead);
+
 	virtual bool open();
 
 	virtual bool writeRaw(CMetaData& data);
@@ -50,26 +55,39 @@ public:
 
 	virtual void clock(unsigned int ms);
 
+	// Builds the sync, FICH and DCH of the communications frame for each FN, ready for the audio
+	static void encodeTemplates(uint8_t* templates, const uint8_t* source, uint8_t dgId);
+
 private:
 	NETWORK          m_network;
+	CNetworkMetrics* m_metrics;
 	CUDPSocket       m_socket;
 	sockaddr_storage m_addr;
 	size_t           m_addrLen;
 	std::string      m_callsign;
 	bool             m_debug;
 	CRingBuffer<uint8_t> m_buffer;
+	CJitterBuffer*   m_jitterBuffer;
+	CPacer*          m_pacer;
 	CTimer           m_pollTimer;
 	uint8_t*         m_tag;
 	uint16_t         m_seqNo;
 	uint8_t*         m_audio;
 	uint8_t          m_audioCount;
 	uint8_t          m_fn;
+	uint8_t*         m_templates;
+	uint8_t          m_rxSeqNo;
+	bool             m_rxSeqValid;
 
 	bool writeHeader(CMetaData& data);
 	bool writeCommunication(CMetaData& data);
 	bool writeTerminator(CMetaData& data);
 	void processHeader(const uint8_t* buffer, CMetaData& data, uint8_t dgId);
+	bool writePacket(const uint8_t* data, uint16_t length, uint64_t start = 0U);
+	void writePaced();
 	bool writePoll();
+
+	static void onPoll(void* obj);
 };
 
 #endif
@@ -1,5 +1,5 @@
 /*
-*	Copyright (C) 2016,2017,2020,2024 Jonathan Naylor, G4KLX
+*	Copyright (C) 2016,2017,2020,2024,2026 Jonathan Naylor, G4KLX
 *	Copyright (C) 2016 Mathias Weyland, HB9FRV
 *
 *	This program is free software; you can redistribute it and/or modify
@@ -69,12 +69,47 @@ const unsigned int INTERLEAVE_TABLE_5_20[] = {
 	36U, 76U, 116U, 156U, 196U,
 	38U, 78U, 118U, 158U, 198U};
 
-// This one differs from the others in that it interleaves bits and not dibits
-const unsigned int INTERLEAVE_TABLE_26_4[] = {
-	0U, 4U,  8U, 12U, 16U, 20U, 24U, 28U, 32U, 36U, 40U, 44U, 48U, 52U, 56U, 60U, 64U, 68U, 72U, 76U, 80U, 84U, 88U, 92U, 96U, 100U,
-	1U, 5U,  9U, 13U, 17U, 21U, 25U, 29U, 33U, 37U, 41U, 45U, 49U, 53U, 57U, 61U, 65U, 69U, 73U, 77U, 81U, 85U, 89U, 93U, 97U, 101U,
-	2U, 6U, 10U, 14U, 18U, 22U, 26U, 30U, 34U, 38U, 42U, 46U, 50U, 54U, 58U, 62U, 66U, 70U, 74U, 78U, 82U, 86U, 90U, 94U, 98U, 102U,
-	3U, 7U, 11U, 15U, 19U, 23U, 27U, 31U, 35U, 39U, 43U, 47U, 51U, 55U, 59U, 63U, 67U, 71U, 75U, 79U, 83U, 87U, 91U, 95U, 99U, 103U};
+// The VCH interleave writes the 104 bits as 26 columns of 4 bits, so each byte of the
+// frame holds two columns. These tables move between a frame byte and the two bits of
+// each of the four rows, row 0 in the top two bits.
+struct CInterleaveTables26x4 {
+	uint8_t deinterleave[256U];
+	uint8_t interleave[256U];
+
+	constexpr CInterleaveTables26x4() :
+	deinterleave(),
+	interleave()
+	{
+		for (unsigned int in = 0U; in < 256U; in++) {
+			unsigned int out = 0U;
+
+			// Frame bit 7 - n is row n % 4 of column n / 4, which becomes row bit 7 - (2 * row + column)
+			for (unsigned int n = 0U; n < 8U; n++) {
+				if ((in & (0x80U >> n)) != 0U)
+					out |= 0x80U >> (2U * (n % 4U) + n / 4U);
+			}
+
+			deinterleave[in] = uint8_t(out);
+			interleave[out]  = uint8_t(in);
+		}
+	}
+
+	constexpr bool isInverse() const
+	{
+		for (unsigned int i = 0U; i < 256U; i++) {
+			if (interleave[deinterleave[i]] != i || deinterleave[interleave[i]] != i)
+				return false;
+		}
+
+		return true;
+	}
+};
+
+static constexpr CInterleaveTables26x4 TABLES_26_4;
+
+static_assert(TABLES_26_4.isInverse(), "The 26x4 interleave tables do not invert each other");
+static_assert(TABLES_26_4.deinterleave[0x01U] == 0x01U && TABLES_26_4.deinterleave[0x10U] == 0x02U, "The 26x4 deinterleave table is wrong");
+static_assert(TABLES_26_4.deinterleave[0x08U] == 0x40U && TABLES_26_4.deinterleave[0x80U] == 0x80U, "The 26x4 deinterleave table is wrong");
 
 const uint8_t WHITENING_DATA[] = {0x93U, 0xD7U, 0x51U, 0x21U, 0x9CU, 0x2FU, 0x6CU, 0xD0U, 0xEFU, 0x0FU,
 										0xF8U, 0x3DU, 0xF1U, 0x73U, 0x20U, 0x94U, 0xEDU, 0x1EU, 0x7CU, 0xD8U};
@@ -262,23 +297,34 @@ void CYSFPayload::processVDMode2Audio(const uint8_t* data, uint8_t* audio) const
 
 	data += YSF_SYNC_LENGTH_BYTES + YSF_FICH_LENGTH_BYTES;
 
-	unsigned int offset1 = 40U; // DCH(0)
-	unsigned int offset2 = 0U;
-
 	// We have a total of 5 VCH sections, iterate through each
-	for (unsigned int j = 0U; j < 5U; j++, offset1 += 144U) {
-		uint8_t vch[YSFDN_DATA_LENGTH];
-
-		// Deinterleave
-		for (unsigned int i = 0U; i < 104U; i++) {
-			unsigned int n = INTERLEAVE_TABLE_26_4[i];
-			bool s = READ_BIT1(data, offset1 + n);
-			WRITE_BIT1(vch, i, s);
+	for (unsigned int j = 0U; j < 5U; j++, data += 18U, audio += YSFDN_DATA_LENGTH) {
+		const uint8_t* vch = data + 5U;	// DCH(0)
+
+		// Deinterleave into the four 26 bit rows
+		uint32_t rows[4U] = {0U, 0U, 0U, 0U};
+		for (unsigned int i = 0U; i < YSFDN_DATA_LENGTH; i++) {
+			uint8_t b = TABLES_26_4.deinterleave[vch[i]];
+			rows[0U] = (rows[0U] << 2) | ((b >> 6) & 0x03U);
+			rows[1U] = (rows[1U] << 2) | ((b >> 4) & 0x03U);
+			rows[2U] = (rows[2U] << 2) | ((b >> 2) & 0x03U);
+			rows[3U] = (rows[3U] << 2) | ((b >> 0) & 0x03U);
 		}
 
-		// "Un-whiten" (descramble)
-		for (unsigned int i = 0U; i < YSFDN_DATA_LENGTH; i++, offset2++)
-			audio[offset2] = vch[i] ^ WHITENING_DATA[i];
+		// "Un-whiten" (descramble) as the rows are packed
+		uint64_t acc = 0U;
+		unsigned int n = 0U;
+		unsigned int pos = 0U;
+		for (unsigned int r = 0U; r < 4U; r++) {
+			acc = (acc << 26) | rows[r];
+			n += 26U;
+
+			while (n >= 8U) {
+				n -= 8U;
+				audio[pos] = uint8_t(acc >> n) ^ WHITENING_DATA[pos];
+				pos++;
+			}
+		}
 	}
 }
 
@@ -289,22 +335,34 @@ void CYSFPayload::createVDMode2Audio(uint8_t* data, const uint8_t* audio) const
 
 	data += YSF_SYNC_LENGTH_BYTES + YSF_FICH_LENGTH_BYTES;
 
-	unsigned int offset1 = 40U; // DCH(0)
-	unsigned int offset2 = 0U;
-
 	// We have a total of 5 VCH sections, iterate through each
-	for (unsigned int j = 0U; j < 5U; j++, offset1 += 144U) {
-		uint8_t vch[13U];
-
-		// Scramble
-		for (unsigned int i = 0U; i < YSFDN_DATA_LENGTH; i++, offset2++)
-			vch[i] = audio[offset2] ^ WHITENING_DATA[i];
+	for (unsigned int j = 0U; j < 5U; j++, data += 18U, audio += YSFDN_DATA_LENGTH) {
+		uint8_t* vch = data + 5U;	// DCH(0)
+
+		// Scramble as the four 26 bit rows are unpacked
+		uint32_t rows[4U];
+		uint64_t acc = 0U;
+		unsigned int n = 0U;
+		unsigned int pos = 0U;
+		for (unsigned int r = 0U; r < 4U; r++) {
+			while (n < 26U) {
+				acc = (acc << 8) | uint8_t(audio[pos] ^ WHITENING_DATA[pos]);
+				n += 8U;
+				pos++;
+			}
+
+			n -= 26U;
+			rows[r] = uint32_t(acc >> n) & 0x03FFFFFFU;
+		}
 
 		// Interleave
-		for (unsigned int i = 0U; i < 104U; i++) {
-			unsigned int n = INTERLEAVE_TABLE_26_4[i];
-			bool s = READ_BIT1(vch, i);
-			WRITE_BIT1(data, offset1 + n, s);
+		for (unsigned int i = 0U; i < YSFDN_DATA_LENGTH; i++) {
+			unsigned int shift = 24U - 2U * i;
+			uint8_t b = (((rows[0U] >> shift) & 0x03U) << 6) |
+				    (((rows[1U] >> shift) & 0x03U) << 4) |
+				    (((rows[2U] >> shift) & 0x03U) << 2) |
+				    (((rows[3U] >> shift) & 0x03U) << 0);
+			vch[i] = TABLES_26_4.interleave[b];
 		}
 	}
 }